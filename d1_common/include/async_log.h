@@ -0,0 +1,384 @@
+#ifndef D1_ASYNC_LOG_H
+#define D1_ASYNC_LOG_H
+
+// Асинхронный логгер для горячих путей relay и GUI.
+//
+// Каждый поток пишет в собственное lock-free кольцо (SpscRing): форматирование
+// в фиксированный буфер, без аллокаций, блокировок и системных вызовов.
+// Фоновый поток раз в FLUSH_INTERVAL_MS забирает записи из всех колец,
+// упорядочивает по времени и отдаёт приёмнику (по умолчанию stdout/stderr).
+// При переполнении кольца запись отбрасывается — логирование никогда не
+// тормозит управляющий поток; потери выводятся отдельной строкой.
+//
+// Категории могут ограничивать частоту (N сообщений в секунду); подавленные
+// сообщения подсчитываются и выводятся сводкой.
+//
+//   static const int LOG_TX = d1::log::category("TX", 20);
+//   D1_LOG_INFO(LOG_TX, "%s", json.c_str());
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "d1_protocol.h"
+#include "spsc_ring.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define D1_LOG_PRINTF_FORMAT(fmtIndex, argIndex) __attribute__((format(printf, fmtIndex, argIndex)))
+#else
+#define D1_LOG_PRINTF_FORMAT(fmtIndex, argIndex)
+#endif
+
+namespace d1 {
+namespace log {
+
+enum class Level : uint8_t {
+    Trace = 0,
+    Debug,
+    Info,
+    Warn,
+    Error,
+    Off
+};
+
+constexpr size_t RECORD_TEXT_MAX = 232;
+constexpr size_t THREAD_BUFFER_RECORDS = 512;
+constexpr int MAX_CATEGORIES = 32;
+constexpr size_t CATEGORY_NAME_MAX = 16;
+constexpr int FLUSH_INTERVAL_MS = 20;
+
+struct Record {
+    uint64_t timestampNs = 0;
+    Level level = Level::Info;
+    uint8_t category = 0;
+    uint16_t length = 0;
+    char text[RECORD_TEXT_MAX];
+};
+
+// Вызывается только из потока сброса
+using Sink = std::function<void(const Record& record, const char* categoryName)>;
+
+inline const char* levelName(Level level) {
+    switch (level) {
+        case Level::Trace: return "TRACE";
+        case Level::Debug: return "DEBUG";
+        case Level::Info: return "INFO";
+        case Level::Warn: return "WARN";
+        case Level::Error: return "ERROR";
+        default: return "";
+    }
+}
+
+inline Level levelFromString(const char* value, Level fallback) {
+    if (!value) return fallback;
+    if (!std::strcmp(value, "trace")) return Level::Trace;
+    if (!std::strcmp(value, "debug")) return Level::Debug;
+    if (!std::strcmp(value, "info")) return Level::Info;
+    if (!std::strcmp(value, "warn")) return Level::Warn;
+    if (!std::strcmp(value, "error")) return Level::Error;
+    if (!std::strcmp(value, "off")) return Level::Off;
+    return fallback;
+}
+
+class Logger {
+public:
+    static Logger& instance() {
+        static Logger logger;
+        return logger;
+    }
+
+    ~Logger() { stop(); }
+
+    // Запуск потока сброса. Необязателен: первая запись запускает его сама,
+    // но явный вызов из main() убирает создание потока из горячего пути.
+    void start() {
+        std::lock_guard<std::mutex> lock(m_controlMutex);
+        if (m_state.load(std::memory_order_relaxed) != State::Idle) {
+            return;
+        }
+        m_state.store(State::Running, std::memory_order_release);
+        m_flusher = std::thread(&Logger::flusherLoop, this);
+    }
+
+    // Останавливает поток сброса, предварительно выведя всё накопленное.
+    // Дальнейшие записи выводятся только явным flush().
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(m_controlMutex);
+            if (m_state.load(std::memory_order_relaxed) != State::Running) {
+                m_state.store(State::Stopped, std::memory_order_release);
+                return;
+            }
+            m_state.store(State::Stopped, std::memory_order_release);
+        }
+        if (m_flusher.joinable()) {
+            m_flusher.join();
+        }
+        flush();
+    }
+
+    void setLevel(Level level) { m_level.store(level, std::memory_order_relaxed); }
+    Level level() const { return m_level.load(std::memory_order_relaxed); }
+
+    void setSink(Sink sink) {
+        std::lock_guard<std::mutex> lock(m_sinkMutex);
+        m_sink = std::move(sink);
+    }
+
+    // Регистрирует категорию (или возвращает существующую). maxPerSecond = 0 — без лимита.
+    // Вызывается при инициализации, не из горячего пути.
+    int category(const char* name, uint32_t maxPerSecond = 0) {
+        {
+            std::lock_guard<std::mutex> lock(m_categoryMutex);
+            int count = m_categoryCount.load(std::memory_order_relaxed);
+            for (int i = 0; i < count; ++i) {
+                if (std::strncmp(m_categories[i].name, name, CATEGORY_NAME_MAX - 1) == 0) {
+                    return i;
+                }
+            }
+            if (count >= MAX_CATEGORIES) {
+                return 0;
+            }
+            Category& c = m_categories[count];
+            std::strncpy(c.name, name, CATEGORY_NAME_MAX - 1);
+            c.name[CATEGORY_NAME_MAX - 1] = '\0';
+            c.maxPerSecond = maxPerSecond;
+            m_categoryCount.store(count + 1, std::memory_order_release);
+            return count;
+        }
+    }
+
+    bool enabled(Level level) const { return level >= m_level.load(std::memory_order_relaxed); }
+
+    void write(Level level, int category, const char* fmt, ...) D1_LOG_PRINTF_FORMAT(4, 5) {
+        if (!enabled(level) || category < 0 || category >= m_categoryCount.load(std::memory_order_acquire)) {
+            return;
+        }
+        uint64_t now = monotonicNs();
+        if (!admit(category, now)) {
+            return;
+        }
+
+        if (m_state.load(std::memory_order_acquire) == State::Idle) {
+            start();
+        }
+
+        ThreadBuffer* buffer = localBuffer();
+        Record record;
+        record.timestampNs = now;
+        record.level = level;
+        record.category = static_cast<uint8_t>(category);
+
+        va_list args;
+        va_start(args, fmt);
+        int length = std::vsnprintf(record.text, RECORD_TEXT_MAX, fmt, args);
+        va_end(args);
+        if (length < 0) {
+            length = 0;
+        }
+        record.length = static_cast<uint16_t>(std::min<size_t>(static_cast<size_t>(length), RECORD_TEXT_MAX - 1));
+
+        buffer->ring.tryPush(record);
+    }
+
+    // Синхронный вывод накопленного (не из горячего пути)
+    void flush() {
+        std::lock_guard<std::mutex> lock(m_drainMutex);
+        drainLocked();
+    }
+
+private:
+    enum class State : uint8_t {
+        Idle,
+        Running,
+        Stopped
+    };
+
+    struct ThreadBuffer {
+        SpscRing<Record, THREAD_BUFFER_RECORDS> ring;
+        uint64_t reportedOverruns = 0;     // Только поток сброса
+        std::atomic<bool> alive{true};
+    };
+
+    struct Category {
+        char name[CATEGORY_NAME_MAX] = {0};
+        uint32_t maxPerSecond = 0;
+        std::atomic<uint64_t> windowStartNs{0};
+        std::atomic<uint32_t> countInWindow{0};
+        std::atomic<uint64_t> suppressed{0};
+        uint64_t reportedSuppressed = 0;   // Только поток сброса
+    };
+
+    // Владелец кольца на стороне потока: при завершении потока помечает кольцо,
+    // поток сброса освобождает его после вычитки
+    struct ThreadHandle {
+        std::shared_ptr<ThreadBuffer> buffer;
+        ~ThreadHandle() {
+            if (buffer) {
+                buffer->alive.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+    Logger() {
+        m_level.store(levelFromString(std::getenv("D1_LOG_LEVEL"), Level::Info), std::memory_order_relaxed);
+    }
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    ThreadBuffer* localBuffer() {
+        thread_local ThreadHandle handle;
+        if (!handle.buffer) {
+            handle.buffer = std::make_shared<ThreadBuffer>();
+            std::lock_guard<std::mutex> lock(m_buffersMutex);
+            m_buffers.push_back(handle.buffer);
+        }
+        return handle.buffer.get();
+    }
+
+    bool admit(int category, uint64_t now) {
+        Category& c = m_categories[category];
+        if (c.maxPerSecond == 0) {
+            return true;
+        }
+        uint64_t windowStart = c.windowStartNs.load(std::memory_order_relaxed);
+        if (now - windowStart >= 1000000000ULL
+            && c.windowStartNs.compare_exchange_strong(windowStart, now, std::memory_order_relaxed)) {
+            c.countInWindow.store(0, std::memory_order_relaxed);
+        }
+        if (c.countInWindow.fetch_add(1, std::memory_order_relaxed) >= c.maxPerSecond) {
+            c.suppressed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    void emitRecord(const Record& record) {
+        const char* name = m_categories[record.category].name;
+        std::lock_guard<std::mutex> lock(m_sinkMutex);
+        if (m_sink) {
+            m_sink(record, name);
+            return;
+        }
+        std::FILE* out = record.level >= Level::Warn ? stderr : stdout;
+        std::fprintf(out, "[%s] %.*s\n", name, static_cast<int>(record.length), record.text);
+    }
+
+    void emitNotice(int category, const char* fmt, unsigned long long value) {
+        Record record;
+        record.timestampNs = monotonicNs();
+        record.level = Level::Warn;
+        record.category = static_cast<uint8_t>(category);
+        int length = std::snprintf(record.text, RECORD_TEXT_MAX, fmt, value);
+        record.length = static_cast<uint16_t>(length > 0 ? std::min<size_t>(length, RECORD_TEXT_MAX - 1) : 0);
+        emitRecord(record);
+    }
+
+    void drainLocked() {
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+        {
+            std::lock_guard<std::mutex> lock(m_buffersMutex);
+            buffers = m_buffers;
+        }
+
+        m_scratch.clear();
+        Record record;
+        for (const std::shared_ptr<ThreadBuffer>& buffer : buffers) {
+            while (buffer->ring.tryPop(record)) {
+                m_scratch.push_back(record);
+            }
+        }
+        std::sort(m_scratch.begin(), m_scratch.end(), [](const Record& a, const Record& b) {
+            return a.timestampNs < b.timestampNs;
+        });
+        for (const Record& r : m_scratch) {
+            emitRecord(r);
+        }
+
+        // Потери и подавленные сообщения — сводкой после основного вывода
+        for (const std::shared_ptr<ThreadBuffer>& buffer : buffers) {
+            uint64_t overruns = buffer->ring.overruns();
+            if (overruns != buffer->reportedOverruns) {
+                emitNotice(0, "логгер: кольцо потока переполнено, потеряно %llu записей",
+                           static_cast<unsigned long long>(overruns - buffer->reportedOverruns));
+                buffer->reportedOverruns = overruns;
+            }
+        }
+        int count = m_categoryCount.load(std::memory_order_acquire);
+        for (int i = 0; i < count; ++i) {
+            Category& c = m_categories[i];
+            uint64_t suppressed = c.suppressed.load(std::memory_order_relaxed);
+            if (suppressed != c.reportedSuppressed) {
+                emitNotice(i, "подавлено %llu сообщений (лимит категории)",
+                           static_cast<unsigned long long>(suppressed - c.reportedSuppressed));
+                c.reportedSuppressed = suppressed;
+            }
+        }
+
+        // Кольца завершившихся потоков освобождаем после вычитки
+        std::lock_guard<std::mutex> lock(m_buffersMutex);
+        m_buffers.erase(std::remove_if(m_buffers.begin(), m_buffers.end(),
+                                       [](const std::shared_ptr<ThreadBuffer>& b) {
+                                           return !b->alive.load(std::memory_order_acquire) && b->ring.empty();
+                                       }),
+                        m_buffers.end());
+    }
+
+    void flusherLoop() {
+        while (m_state.load(std::memory_order_acquire) == State::Running) {
+            flush();
+            std::fflush(stdout);
+            std::this_thread::sleep_for(std::chrono::milliseconds(FLUSH_INTERVAL_MS));
+        }
+    }
+
+    std::atomic<Level> m_level{Level::Info};
+
+    std::mutex m_categoryMutex;
+    Category m_categories[MAX_CATEGORIES];
+    std::atomic<int> m_categoryCount{0};
+
+    std::mutex m_buffersMutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+
+    std::mutex m_drainMutex;
+    std::vector<Record> m_scratch;
+
+    std::mutex m_sinkMutex;
+    Sink m_sink;
+
+    std::mutex m_controlMutex;
+    std::atomic<State> m_state{State::Idle};
+    std::thread m_flusher;
+};
+
+inline int category(const char* name, uint32_t maxPerSecond = 0) {
+    return Logger::instance().category(name, maxPerSecond);
+}
+
+} // namespace log
+} // namespace d1
+
+#define D1_LOG(level, category, ...)                                             \
+    do {                                                                         \
+        if (::d1::log::Logger::instance().enabled(level)) {                      \
+            ::d1::log::Logger::instance().write((level), (category), __VA_ARGS__); \
+        }                                                                        \
+    } while (0)
+
+#define D1_LOG_DEBUG(category, ...) D1_LOG(::d1::log::Level::Debug, category, __VA_ARGS__)
+#define D1_LOG_INFO(category, ...) D1_LOG(::d1::log::Level::Info, category, __VA_ARGS__)
+#define D1_LOG_WARN(category, ...) D1_LOG(::d1::log::Level::Warn, category, __VA_ARGS__)
+#define D1_LOG_ERROR(category, ...) D1_LOG(::d1::log::Level::Error, category, __VA_ARGS__)
+
+#endif // D1_ASYNC_LOG_H
@@ -0,0 +1,206 @@
+#ifndef D1_PROTOCOL_H
+#define D1_PROTOCOL_H
+
+// Общий протокол обмена между udp_relay и D1Control.
+// Заголовок используется обеими сторонами и не зависит ни от Qt, ни от Unitree SDK.
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <chrono>
+
+namespace d1 {
+
+constexpr int PROTO_NUM_JOINTS = 7;
+
+// Магические числа кадров (байты в little-endian: "D1FB" и "D1RC")
+constexpr uint32_t FEEDBACK_MAGIC = 0x42463144;
+constexpr uint32_t CONTROL_MAGIC = 0x43523144;
+
+constexpr uint16_t FEEDBACK_VERSION = 2;
+constexpr uint16_t CONTROL_VERSION = 2;
+
+// Формат feedback, который клиент запрашивает у relay
+enum class FeedbackFormat : uint16_t {
+    Json = 0,    // Исходный текстовый формат (fallback)
+    Binary = 1   // Упакованный кадр FeedbackFrame
+};
+
+// Типы управляющих кадров (клиент -> relay, порт команд)
+enum class ControlType : uint16_t {
+    Hello = 1,        // Согласование формата feedback (v1, порт feedback по умолчанию)
+    Subscribe = 2,    // Подписка/продление аренды: формат, частота, порт
+    Unsubscribe = 3   // Отписка
+};
+
+// Одна выборка состояния руки
+struct FeedbackSample {
+    uint32_t seq = 0;
+    uint64_t timestampNs = 0;   // Монотонное время прихода выборки в callback DDS
+    uint64_t txTimestampNs = 0; // Монотонное время отправки relay (0 — неизвестно, кадр v1)
+    int32_t powerStatus = 0;
+    int32_t errorStatus = 0;
+    float angles[PROTO_NUM_JOINTS] = {0, 0, 0, 0, 0, 0, 0};
+};
+
+// Монотонное время в наносекундах (на Linux — CLOCK_MONOTONIC, общий для процессов)
+inline uint64_t monotonicNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// ==================== Little-endian кодирование ====================
+
+inline void putU16(uint8_t* p, uint16_t v) {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+}
+
+inline void putU32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; ++i) p[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+inline void putU64(uint8_t* p, uint64_t v) {
+    for (int i = 0; i < 8; ++i) p[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+inline void putF32(uint8_t* p, float f) {
+    uint32_t v;
+    std::memcpy(&v, &f, sizeof(v));
+    putU32(p, v);
+}
+
+inline uint16_t getU16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+inline uint32_t getU32(const uint8_t* p) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; ++i) v |= static_cast<uint32_t>(p[i]) << (8 * i);
+    return v;
+}
+
+inline uint64_t getU64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) v |= static_cast<uint64_t>(p[i]) << (8 * i);
+    return v;
+}
+
+inline float getF32(const uint8_t* p) {
+    uint32_t v = getU32(p);
+    float f;
+    std::memcpy(&f, &v, sizeof(f));
+    return f;
+}
+
+// ==================== Кадр feedback ====================
+//
+// Смещение  Размер  Поле
+//  0        4       magic (FEEDBACK_MAGIC)
+//  4        2       version
+//  6        2       size (полный размер кадра в байтах)
+//  8        4       seq
+// 12        8       timestamp_ns
+// 20        4       power_status
+// 24        4       error_status
+// 28        28      angle0..angle6 (float32)
+// 56        8       tx_timestamp_ns (с v2)
+//
+// Новые версии только дописывают поля в конец, поэтому декодер читает
+// известный префикс любого кадра с version >= 1 и size >= FEEDBACK_FRAME_SIZE_V1.
+// Оба времени берутся из CLOCK_MONOTONIC relay и сравнимы с monotonicNs()
+// только на том же хосте.
+
+constexpr size_t FEEDBACK_FRAME_SIZE_V1 = 56;
+constexpr size_t FEEDBACK_FRAME_SIZE = 64;
+
+inline bool isFeedbackFrame(const uint8_t* data, size_t len) {
+    return len >= 4 && getU32(data) == FEEDBACK_MAGIC;
+}
+
+inline size_t encodeFeedbackFrame(const FeedbackSample& s, uint8_t* out) {
+    putU32(out + 0, FEEDBACK_MAGIC);
+    putU16(out + 4, FEEDBACK_VERSION);
+    putU16(out + 6, static_cast<uint16_t>(FEEDBACK_FRAME_SIZE));
+    putU32(out + 8, s.seq);
+    putU64(out + 12, s.timestampNs);
+    putU32(out + 20, static_cast<uint32_t>(s.powerStatus));
+    putU32(out + 24, static_cast<uint32_t>(s.errorStatus));
+    for (int i = 0; i < PROTO_NUM_JOINTS; ++i) {
+        putF32(out + 28 + 4 * i, s.angles[i]);
+    }
+    putU64(out + 56, s.txTimestampNs);
+    return FEEDBACK_FRAME_SIZE;
+}
+
+inline bool decodeFeedbackFrame(const uint8_t* data, size_t len, FeedbackSample& s) {
+    if (len < FEEDBACK_FRAME_SIZE_V1 || getU32(data) != FEEDBACK_MAGIC) {
+        return false;
+    }
+    uint16_t version = getU16(data + 4);
+    uint16_t size = getU16(data + 6);
+    if (version < 1 || size < FEEDBACK_FRAME_SIZE_V1 || size > len) {
+        return false;
+    }
+    s.seq = getU32(data + 8);
+    s.timestampNs = getU64(data + 12);
+    s.powerStatus = static_cast<int32_t>(getU32(data + 20));
+    s.errorStatus = static_cast<int32_t>(getU32(data + 24));
+    for (int i = 0; i < PROTO_NUM_JOINTS; ++i) {
+        s.angles[i] = getF32(data + 28 + 4 * i);
+    }
+    s.txTimestampNs = (version >= 2 && size >= FEEDBACK_FRAME_SIZE) ? getU64(data + 56) : 0;
+    return true;
+}
+
+// ==================== Управляющий кадр ====================
+//
+// Смещение  Размер  Поле
+//  0        4       magic (CONTROL_MAGIC)
+//  4        2       version
+//  6        2       type (ControlType)
+//  8        2       format (FeedbackFormat)
+// 10        2       rate_hz (0 — полная частота; в v1 — reserved)
+// 12        2       port    (0 — порт-источник датаграммы; с v2)
+//
+// JSON-команды всегда начинаются с '{', поэтому relay отличает управляющие
+// кадры по magic и не пересылает их в DDS.
+
+constexpr size_t CONTROL_FRAME_SIZE_V1 = 12;
+constexpr size_t CONTROL_FRAME_SIZE = 14;
+
+struct ControlFrame {
+    ControlType type = ControlType::Hello;
+    FeedbackFormat format = FeedbackFormat::Json;
+    uint16_t rateHz = 0;
+    uint16_t port = 0;
+};
+
+inline size_t encodeControlFrame(const ControlFrame& c, uint8_t* out) {
+    putU32(out + 0, CONTROL_MAGIC);
+    putU16(out + 4, CONTROL_VERSION);
+    putU16(out + 6, static_cast<uint16_t>(c.type));
+    putU16(out + 8, static_cast<uint16_t>(c.format));
+    putU16(out + 10, c.rateHz);
+    putU16(out + 12, c.port);
+    return CONTROL_FRAME_SIZE;
+}
+
+inline bool decodeControlFrame(const uint8_t* data, size_t len, ControlFrame& c) {
+    if (len < CONTROL_FRAME_SIZE_V1 || getU32(data) != CONTROL_MAGIC) {
+        return false;
+    }
+    uint16_t version = getU16(data + 4);
+    if (version < 1) {
+        return false;
+    }
+    c.type = static_cast<ControlType>(getU16(data + 6));
+    c.format = static_cast<FeedbackFormat>(getU16(data + 8));
+    c.rateHz = version >= 2 ? getU16(data + 10) : 0;
+    c.port = (version >= 2 && len >= CONTROL_FRAME_SIZE) ? getU16(data + 12) : 0;
+    return true;
+}
+
+} // namespace d1
+
+#endif // D1_PROTOCOL_H
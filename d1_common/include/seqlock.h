@@ -0,0 +1,80 @@
+#ifndef D1_SEQLOCK_H
+#define D1_SEQLOCK_H
+
+// Seqlock "один писатель — много читателей" для небольших POD-снимков.
+// Писатель никогда не ждёт; читатель повторяет чтение, если попал на запись.
+// Данные хранятся как атомарные 64-битные слова, поэтому структура корректна
+// и внутри процесса, и в разделяемой памяти (не содержит указателей).
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace d1 {
+
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock хранит только POD-снимки");
+
+public:
+    SeqLock() {
+        for (size_t i = 0; i < WORDS; ++i) {
+            m_data[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // Только поток-писатель
+    void store(const T& value) {
+        uint64_t words[WORDS] = {};
+        std::memcpy(words, &value, sizeof(T));
+
+        const uint32_t seq = m_seq.load(std::memory_order_relaxed);
+        m_seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORDS; ++i) {
+            m_data[i].store(words[i], std::memory_order_relaxed);
+        }
+        m_seq.store(seq + 2, std::memory_order_release);
+    }
+
+    // Одна попытка чтения; false — писатель был активен, нужно повторить
+    bool tryLoad(T& value) const {
+        const uint32_t before = m_seq.load(std::memory_order_acquire);
+        if (before & 1u) {
+            return false;
+        }
+        uint64_t words[WORDS];
+        for (size_t i = 0; i < WORDS; ++i) {
+            words[i] = m_data[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_seq.load(std::memory_order_relaxed) != before) {
+            return false;
+        }
+        std::memcpy(&value, words, sizeof(T));
+        return true;
+    }
+
+    T load() const {
+        T value;
+        while (!tryLoad(value)) {
+        }
+        return value;
+    }
+
+    // Меняется при каждой записи: читатель может проверить "есть ли новое"
+    // без копирования снимка
+    uint32_t version() const { return m_seq.load(std::memory_order_acquire); }
+
+private:
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    alignas(64) std::atomic<uint32_t> m_seq{0};
+    std::atomic<uint64_t> m_data[WORDS];
+};
+
+} // namespace d1
+
+#endif // D1_SEQLOCK_H
@@ -0,0 +1,434 @@
+#ifndef D1_SHM_CHANNEL_H
+#define D1_SHM_CHANNEL_H
+
+// Канал через разделяемую память POSIX между udp_relay и D1Control на одном хосте.
+//
+// Relay создаёт сегмент SHM_NAME и пишет в него последний снимок состояния
+// (seqlock) и метку жизни; GUI читает снимок без системных вызовов и кладёт
+// команды в кольцо. Команд пишет только один процесс — тот, кто захватил
+// producerPid; остальные клиенты отправляют команды по UDP.
+// Если сегмента нет или relay не обновляет метку жизни — используется UDP.
+//
+// Один клиент (waiterPid) может ждать снимок, а не опрашивать его: поток
+// отправки relay после каждой пачки выборок шлёт пустую датаграмму на его
+// Unix-сокет (Linux, abstract namespace "\0d1_arm_wake.<pid>"), клиент ждёт её
+// в QSocketNotifier/poll. Так же владелец кольца команд будит relay после
+// каждой команды ("\0d1_arm_cmd.<relayPid>"). publish() системных вызовов не
+// делает: его зовут из callback DDS, а будят — из потоков, которые ждут сами.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include "d1_protocol.h"
+#include "seqlock.h"
+#include "spsc_ring.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define D1_HAVE_SHM 1
+#include <cerrno>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#define D1_HAVE_SHM_WAKEUP 1
+#include <cstdio>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+namespace d1 {
+
+constexpr const char* SHM_NAME = "/d1_arm_channel";
+constexpr uint32_t SHM_MAGIC = 0x4D533144;   // "D1SM"
+constexpr uint32_t SHM_VERSION = 3;
+constexpr size_t SHM_COMMAND_MAX = 508;
+constexpr size_t SHM_COMMAND_SLOTS = 64;
+
+// Текстовая JSON-команда в том же виде, что и по UDP
+struct ShmCommand {
+    uint32_t length = 0;
+    char data[SHM_COMMAND_MAX];
+};
+
+struct ShmLayout {
+    std::atomic<uint32_t> magic{0};           // Пишется последним при создании
+    uint32_t version = SHM_VERSION;
+    uint32_t layoutSize = sizeof(ShmLayout);
+    std::atomic<int32_t> relayPid{0};
+    std::atomic<uint64_t> relayHeartbeatNs{0};  // monotonicNs() relay
+    std::atomic<int32_t> producerPid{0};       // Владелец кольца команд (0 — свободно)
+    std::atomic<int32_t> waiterPid{0};         // Клиент, которого будит relay (0 — нет)
+
+    SeqLock<FeedbackSample> state;
+    SpscRing<ShmCommand, SHM_COMMAND_SLOTS> commands;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "Разделяемая память требует lock-free 64-битных атомиков");
+
+#ifdef D1_HAVE_SHM
+
+class ShmChannel {
+public:
+    ShmChannel() = default;
+    ~ShmChannel() { close(); }
+
+    ShmChannel(const ShmChannel&) = delete;
+    ShmChannel& operator=(const ShmChannel&) = delete;
+
+    // Relay: создаёт (или пересоздаёт) сегмент
+    bool create() {
+        close();
+        int fd = shm_open(SHM_NAME, O_CREAT | O_RDWR, 0660);
+        if (fd < 0) {
+            return false;
+        }
+        if (ftruncate(fd, sizeof(ShmLayout)) != 0) {
+            ::close(fd);
+            return false;
+        }
+        void* ptr = mmap(nullptr, sizeof(ShmLayout), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (ptr == MAP_FAILED) {
+            return false;
+        }
+        m_layout = new (ptr) ShmLayout();
+        m_layout->relayPid.store(static_cast<int32_t>(getpid()), std::memory_order_relaxed);
+        m_layout->relayHeartbeatNs.store(monotonicNs(), std::memory_order_relaxed);
+#ifdef D1_HAVE_SHM_WAKEUP
+        // Сокеты пробуждений — сразу, а не при первой выборке в потоке DDS.
+        // Без них канал работает, но relay опрашивает кольцо команд.
+        m_wakeSendFd = wakeSocket();
+        m_commandWakeFd = wakeSocket();
+        struct sockaddr_un addr;
+        socklen_t length = wakeAddress("d1_arm_cmd", static_cast<int32_t>(getpid()), addr);
+        if (m_commandWakeFd >= 0
+            && bind(m_commandWakeFd, reinterpret_cast<const struct sockaddr*>(&addr), length) != 0) {
+            ::close(m_commandWakeFd);
+            m_commandWakeFd = -1;
+        }
+#endif
+        m_layout->magic.store(SHM_MAGIC, std::memory_order_release);
+        m_owner = true;
+        return true;
+    }
+
+    // Клиент: подключается к существующему сегменту
+    bool attach() {
+        close();
+        int fd = shm_open(SHM_NAME, O_RDWR, 0);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(ShmLayout)) {
+            ::close(fd);
+            return false;
+        }
+        void* ptr = mmap(nullptr, sizeof(ShmLayout), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (ptr == MAP_FAILED) {
+            return false;
+        }
+        ShmLayout* layout = static_cast<ShmLayout*>(ptr);
+        if (layout->magic.load(std::memory_order_acquire) != SHM_MAGIC
+            || layout->version != SHM_VERSION || layout->layoutSize != sizeof(ShmLayout)) {
+            munmap(ptr, sizeof(ShmLayout));
+            return false;
+        }
+        m_layout = layout;
+        m_owner = false;
+        return true;
+    }
+
+    void close() {
+#ifdef D1_HAVE_SHM_WAKEUP
+        if (m_wakeSendFd >= 0) {
+            ::close(m_wakeSendFd);
+            m_wakeSendFd = -1;
+            m_wakePid = 0;
+        }
+        if (m_commandWakeFd >= 0) {
+            ::close(m_commandWakeFd);
+            m_commandWakeFd = -1;
+        }
+#endif
+        if (!m_layout) {
+            return;
+        }
+        releaseWaiter();
+        releaseProducer();
+        munmap(m_layout, sizeof(ShmLayout));
+        m_layout = nullptr;
+        if (m_owner) {
+            shm_unlink(SHM_NAME);
+            m_owner = false;
+        }
+    }
+
+    bool isOpen() const { return m_layout != nullptr; }
+
+    // Relay жив: процесс существует и недавно обновлял метку
+    bool relayAlive(uint64_t maxAgeNs) const {
+        if (!m_layout) {
+            return false;
+        }
+        uint64_t heartbeat = m_layout->relayHeartbeatNs.load(std::memory_order_acquire);
+        uint64_t now = monotonicNs();
+        if (now > heartbeat && now - heartbeat > maxAgeNs) {
+            return false;
+        }
+        return processAlive(m_layout->relayPid.load(std::memory_order_relaxed));
+    }
+
+    // ---------- Сторона relay ----------
+
+    // Снимок и метка жизни, без системных вызовов (callback DDS)
+    void publish(const FeedbackSample& sample) {
+        m_layout->state.store(sample);
+        m_layout->relayHeartbeatNs.store(sample.timestampNs, std::memory_order_release);
+    }
+
+    // Одна неблокирующая датаграмма ждущему клиенту. Зовётся из потока
+    // отправки relay; полная очередь у клиента (EAGAIN) не страшна — он и так
+    // проснётся и прочитает последний снимок.
+    void wakeWaiter() {
+#ifdef D1_HAVE_SHM_WAKEUP
+        int32_t waiter = m_layout->waiterPid.load(std::memory_order_acquire);
+        if (waiter == 0 || m_wakeSendFd < 0) {
+            return;
+        }
+        if (waiter != m_wakePid) {
+            m_wakePid = waiter;
+            m_wakeAddrLength = wakeAddress("d1_arm_wake", waiter, m_wakeAddr);
+        }
+        char byte = 0;
+        sendto(m_wakeSendFd, &byte, sizeof(byte), MSG_DONTWAIT,
+               reinterpret_cast<const struct sockaddr*>(&m_wakeAddr), m_wakeAddrLength);
+#endif
+    }
+
+    // Дескриптор, который становится читаемым после pushCommand() клиента,
+    // или -1 — тогда кольцо команд нужно опрашивать. Принадлежит каналу.
+    int commandWakeFd() const {
+#ifdef D1_HAVE_SHM_WAKEUP
+        return m_commandWakeFd;
+#else
+        return -1;
+#endif
+    }
+
+    void heartbeat() {
+        m_layout->relayHeartbeatNs.store(monotonicNs(), std::memory_order_release);
+    }
+
+    bool popCommand(ShmCommand& command) {
+        return m_layout->commands.tryPop(command);
+    }
+
+    uint64_t commandOverruns() const { return m_layout->commands.overruns(); }
+
+    // ---------- Сторона клиента ----------
+
+    uint32_t stateVersion() const { return m_layout->state.version(); }
+
+    bool readState(FeedbackSample& sample) const { return m_layout->state.tryLoad(sample); }
+
+    const SeqLock<FeedbackSample>* snapshot() const { return m_layout ? &m_layout->state : nullptr; }
+
+    // Захват кольца команд. Владелец, чей процесс завершился, вытесняется.
+    bool claimProducer() {
+        if (!m_layout) {
+            return false;
+        }
+        int32_t self = static_cast<int32_t>(getpid());
+        int32_t current = m_layout->producerPid.load(std::memory_order_acquire);
+        if (current == self) {
+            m_producer = true;
+            openCommandWake();
+            return true;
+        }
+        if (current != 0 && processAlive(current)) {
+            return false;
+        }
+        m_producer = m_layout->producerPid.compare_exchange_strong(current, self, std::memory_order_acq_rel);
+        if (m_producer) {
+            openCommandWake();
+        }
+        return m_producer;
+    }
+
+    void releaseProducer() {
+        if (!m_layout || !m_producer) {
+            return;
+        }
+        int32_t self = static_cast<int32_t>(getpid());
+        m_layout->producerPid.compare_exchange_strong(self, 0, std::memory_order_acq_rel);
+        m_producer = false;
+    }
+
+    bool isProducer() const { return m_producer; }
+
+    // Подписка на пробуждения: дескриптор для QSocketNotifier (чтение) или -1,
+    // если пробуждения недоступны или их уже получает другой живой клиент.
+    // Дескриптор принадлежит каналу и закрывается в close().
+    int claimWaiter() {
+#ifdef D1_HAVE_SHM_WAKEUP
+        if (!m_layout) {
+            return -1;
+        }
+        if (m_wakeFd >= 0) {
+            return m_wakeFd;
+        }
+        int32_t self = static_cast<int32_t>(getpid());
+        int32_t current = m_layout->waiterPid.load(std::memory_order_acquire);
+        if (current != 0 && current != self && processAlive(current)) {
+            return -1;
+        }
+        int fd = wakeSocket();
+        if (fd < 0) {
+            return -1;
+        }
+        struct sockaddr_un addr;
+        socklen_t length = wakeAddress("d1_arm_wake", self, addr);
+        // Сокет привязан до публикации pid: relay не шлёт в пустоту
+        if (bind(fd, reinterpret_cast<const struct sockaddr*>(&addr), length) != 0
+            || !m_layout->waiterPid.compare_exchange_strong(current, self, std::memory_order_acq_rel)) {
+            ::close(fd);
+            return -1;
+        }
+        m_wakeFd = fd;
+        return fd;
+#else
+        return -1;
+#endif
+    }
+
+    void releaseWaiter() {
+#ifdef D1_HAVE_SHM_WAKEUP
+        if (!m_layout || m_wakeFd < 0) {
+            return;
+        }
+        int32_t self = static_cast<int32_t>(getpid());
+        m_layout->waiterPid.compare_exchange_strong(self, 0, std::memory_order_acq_rel);
+        ::close(m_wakeFd);
+        m_wakeFd = -1;
+#endif
+    }
+
+    // Вычитывает накопившиеся пробуждения (снимок читается один раз)
+    static void drainWakeup(int fd) {
+#ifdef D1_HAVE_SHM_WAKEUP
+        char buffer[64];
+        while (recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT) > 0) {
+        }
+#else
+        (void)fd;
+#endif
+    }
+
+    bool pushCommand(const char* data, size_t length) {
+        if (!m_producer || length > SHM_COMMAND_MAX) {
+            return false;
+        }
+        ShmCommand command;
+        command.length = static_cast<uint32_t>(length);
+        std::memcpy(command.data, data, length);
+        if (!m_layout->commands.tryPush(command)) {
+            return false;
+        }
+#ifdef D1_HAVE_SHM_WAKEUP
+        if (m_wakeSendFd >= 0) {
+            char byte = 0;
+            sendto(m_wakeSendFd, &byte, sizeof(byte), MSG_DONTWAIT,
+                   reinterpret_cast<const struct sockaddr*>(&m_wakeAddr), m_wakeAddrLength);
+        }
+#endif
+        return true;
+    }
+
+private:
+    // Владелец кольца: сокет и адрес для пробуждения relay — при захвате,
+    // а не при первой команде
+    void openCommandWake() {
+#ifdef D1_HAVE_SHM_WAKEUP
+        if (m_wakeSendFd >= 0) {
+            return;
+        }
+        m_wakeSendFd = wakeSocket();
+        m_wakeAddrLength = wakeAddress("d1_arm_cmd", m_layout->relayPid.load(std::memory_order_relaxed), m_wakeAddr);
+#endif
+    }
+
+#ifdef D1_HAVE_SHM_WAKEUP
+    static int wakeSocket() {
+        return socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    }
+
+    static socklen_t wakeAddress(const char* prefix, int32_t pid, struct sockaddr_un& addr) {
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        int length = std::snprintf(addr.sun_path + 1, sizeof(addr.sun_path) - 1, "%s.%d", prefix, static_cast<int>(pid));
+        return static_cast<socklen_t>(offsetof(struct sockaddr_un, sun_path) + 1 + length);
+    }
+#endif
+
+    static bool processAlive(int32_t pid) {
+        if (pid <= 0) {
+            return false;
+        }
+        return kill(static_cast<pid_t>(pid), 0) == 0 || errno == EPERM;
+    }
+
+    ShmLayout* m_layout = nullptr;
+    bool m_owner = false;
+    bool m_producer = false;
+#ifdef D1_HAVE_SHM_WAKEUP
+    int m_wakeFd = -1;                  // Клиент: приём пробуждений
+    int m_wakeSendFd = -1;              // Отправка пробуждений (relay — клиенту, владелец кольца — relay)
+    int m_commandWakeFd = -1;           // Relay: приём пробуждений о командах
+    int32_t m_wakePid = 0;              // Relay: кому адресован m_wakeAddr
+    struct sockaddr_un m_wakeAddr;
+    socklen_t m_wakeAddrLength = 0;
+#endif
+};
+
+#else
+
+// Без POSIX shm канал всегда недоступен, клиенты работают по UDP
+class ShmChannel {
+public:
+    bool create() { return false; }
+    bool attach() { return false; }
+    void close() {}
+    bool isOpen() const { return false; }
+    bool relayAlive(uint64_t) const { return false; }
+    void publish(const FeedbackSample&) {}
+    void wakeWaiter() {}
+    int commandWakeFd() const { return -1; }
+    void heartbeat() {}
+    bool popCommand(ShmCommand&) { return false; }
+    uint64_t commandOverruns() const { return 0; }
+    uint32_t stateVersion() const { return 0; }
+    bool readState(FeedbackSample&) const { return false; }
+    const SeqLock<FeedbackSample>* snapshot() const { return nullptr; }
+    bool claimProducer() { return false; }
+    void releaseProducer() {}
+    bool isProducer() const { return false; }
+    bool pushCommand(const char*, size_t) { return false; }
+    int claimWaiter() { return -1; }
+    void releaseWaiter() {}
+    static void drainWakeup(int) {}
+};
+
+#endif // D1_HAVE_SHM
+
+} // namespace d1
+
+#endif // D1_SHM_CHANNEL_H
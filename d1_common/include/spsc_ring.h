@@ -0,0 +1,85 @@
+#ifndef D1_SPSC_RING_H
+#define D1_SPSC_RING_H
+
+// Lock-free кольцевой буфер "один писатель — один читатель".
+// Запись и чтение не выполняют системных вызовов и не аллоцируют память,
+// поэтому буфер можно использовать прямо в callback-потоке DDS.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace d1 {
+
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity должна быть степенью двойки");
+
+public:
+    // Только поток-писатель. При переполнении новая запись отбрасывается
+    // и учитывается в счётчике overruns().
+    bool tryPush(const T& value) {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        const size_t tail = m_tail.load(std::memory_order_acquire);
+        if (head - tail >= Capacity) {
+            m_overruns.store(m_overruns.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+        m_buffer[head & MASK] = value;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Только поток-читатель
+    bool tryPop(T& value) {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        const size_t head = m_head.load(std::memory_order_acquire);
+        if (tail == head) {
+            return false;
+        }
+        value = m_buffer[tail & MASK];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Только поток-читатель: забирает до maxCount записей за один проход
+    size_t popBatch(T* out, size_t maxCount) {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        const size_t head = m_head.load(std::memory_order_acquire);
+        size_t count = head - tail;
+        if (count > maxCount) {
+            count = maxCount;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = m_buffer[(tail + i) & MASK];
+        }
+        m_tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    bool empty() const {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+
+    size_t size() const {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+    uint64_t overruns() const { return m_overruns.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t MASK = Capacity - 1;
+
+    // Индексы на разных кэш-линиях, чтобы писатель и читатель не мешали друг другу
+    alignas(64) std::atomic<size_t> m_head{0};
+    alignas(64) std::atomic<size_t> m_tail{0};
+    alignas(64) std::atomic<uint64_t> m_overruns{0};
+    T m_buffer[Capacity];
+};
+
+} // namespace d1
+
+#endif // D1_SPSC_RING_H
@@ -0,0 +1,133 @@
+// Скорость проверки столкновений (CollisionChecker).
+//
+// Сборка: cmake -DD1_BUILD_BENCHMARKS=ON, запуск: ./collision_bench [каталог d1_description]
+// Позы — случайные углы в пределах лимитов URDF. Режимы:
+//   pose    — isPoseFree() одной позы (сферы, затем GJK по парам);
+//   segment — isSegmentFree() между двумя случайными свободными позами
+//             (консервативное продвижение до первого касания или конца);
+//   jog     — отрезок в 1° по каждому суставу (шаг декартова jog за тик);
+//   path    — isPathFree() ломаной из 64 поз в 1 потоке и по всем ядрам.
+
+#include <QCoreApplication>
+#include <QString>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+#include "collision_checker.h"
+
+namespace {
+
+constexpr int POSES = 20000;
+constexpr int SEGMENTS = 1000;
+constexpr int PATH_POINTS = 64;
+constexpr int PATHS = 20;
+
+using Clock = std::chrono::steady_clock;
+
+double seconds(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);   // applicationDirPath() для поиска мешей
+    ArmKinematics kinematics;
+    QString error;
+    if (!kinematics.loadUrdf(ArmKinematics::DEFAULT_URDF, &error)) {
+        std::fprintf(stderr, "%s\n", qPrintable(error));
+        return 1;
+    }
+    CollisionChecker checker;
+    QString dir = argc > 1 ? QString::fromLocal8Bit(argv[1]) : CollisionChecker::defaultDescriptionDir();
+    if (!checker.load(kinematics, dir, &error)) {
+        std::fprintf(stderr, "%s\n", qPrintable(error));
+        return 1;
+    }
+
+    std::mt19937 random(42);
+    auto randomPose = [&]() {
+        JointVector q{};
+        for (int j = 0; j < KINEMATIC_JOINTS; ++j) {
+            std::uniform_real_distribution<double> angle(kinematics.lowerLimitDeg(j), kinematics.upperLimitDeg(j));
+            q[j] = angle(random);
+        }
+        return q;
+    };
+
+    std::printf("Тел: %d, проверяемых пар: %d, зазор %.1f мм\n\n",
+                checker.bodyCount(), checker.checkedPairs(), checker.config().clearanceM * 1000.0);
+
+    std::vector<JointVector> poses(POSES);
+    for (JointVector& q : poses) {
+        q = randomPose();
+    }
+    int colliding = 0;
+    Clock::time_point start = Clock::now();
+    for (const JointVector& q : poses) {
+        colliding += checker.isPoseFree(q) ? 0 : 1;
+    }
+    double elapsed = seconds(start);
+    std::printf("pose:    %9.0f проверок/с  %6.2f мкс  столкновений %5.1f%%\n",
+                POSES / elapsed, elapsed / POSES * 1e6, 100.0 * colliding / POSES);
+
+    // Отрезки только между свободными позами: иначе проверка кончается на первой
+    std::vector<JointVector> free;
+    for (const JointVector& q : poses) {
+        if (checker.isPoseFree(q)) {
+            free.push_back(q);
+        }
+    }
+    colliding = 0;
+    start = Clock::now();
+    for (int i = 0; i < SEGMENTS; ++i) {
+        const JointVector& a = free[(2 * i) % free.size()];
+        const JointVector& b = free[(2 * i + 1) % free.size()];
+        colliding += checker.isSegmentFree(a, b) ? 0 : 1;
+    }
+    elapsed = seconds(start);
+    std::printf("segment: %9.0f проверок/с  %6.0f мкс  столкновений %5.1f%%\n",
+                SEGMENTS / elapsed, elapsed / SEGMENTS * 1e6, 100.0 * colliding / SEGMENTS);
+
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+    start = Clock::now();
+    for (int i = 0; i < POSES; ++i) {
+        const JointVector& a = free[i % free.size()];
+        JointVector b = a;
+        for (int j = 0; j < KINEMATIC_JOINTS; ++j) {
+            b[j] += unit(random);
+        }
+        checker.isSegmentFree(a, b);
+    }
+    elapsed = seconds(start);
+    std::printf("jog:     %9.0f проверок/с  %6.2f мкс\n", POSES / elapsed, elapsed / POSES * 1e6);
+
+    // Ломаная через свободные позы: без столкновения проверяются все отрезки
+    std::vector<std::vector<JointVector>> paths(PATHS);
+    for (int p = 0; p < PATHS; ++p) {
+        for (int i = 0; i < PATH_POINTS; ++i) {
+            paths[p].push_back(free[(p * PATH_POINTS + i) % free.size()]);
+        }
+    }
+    const int cores = std::max(1, int(std::thread::hardware_concurrency()));
+    double single = 0.0;
+    for (int threads : {1, cores}) {
+        start = Clock::now();
+        for (const std::vector<JointVector>& path : paths) {
+            checker.isPathFree(path, nullptr, threads);
+        }
+        elapsed = seconds(start) / PATHS;
+        if (threads == 1) {
+            single = elapsed;
+        }
+        std::printf("path:    %9.1f мс на %d отрезков, потоков %d, ускорение %.2fx\n",
+                    elapsed * 1000.0, PATH_POINTS - 1, threads, single / elapsed);
+        if (cores == 1) {
+            break;
+        }
+    }
+    return 0;
+}
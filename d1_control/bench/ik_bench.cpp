@@ -0,0 +1,154 @@
+// Скорость и сходимость обратной кинематики (ArmIkSolver).
+//
+// Сборка: cmake -DD1_BUILD_BENCHMARKS=ON, запуск: ./ik_bench [путь к URDF]
+// Цели — позы рабочей точки из прямой кинематики случайных углов в
+// пределах лимитов, поэтому все они достижимы. Режимы:
+//   jog    — тёплый старт в 1–2° от решения (шаг декартова jog за тик);
+//   near   — тёплый старт в пределах ±15°;
+//   cold   — старт из нулевой позы (худший случай, возможны локальные минимумы);
+//   map    — как cold, но через solveAnywhere() с картой досягаемости,
+//            построенной тут же (углы из вокселя и сектора направления цели).
+// Для каждого режима — доля сошедшихся, итерации, время решения (p50/p99/max)
+// и ошибка найденной позы.
+
+#include <QString>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "arm_ik.h"
+#include "reachability_map.h"
+
+namespace {
+
+constexpr int POSES = 4000;
+
+struct Case {
+    RigidTransform target;
+    JointVector seed{};
+};
+
+struct Summary {
+    int converged = 0;
+    int timeBudget = 0;
+    int stalled = 0;
+    double iterations = 0.0;
+    double maxPositionErrorMm = 0.0;
+    double maxOrientationErrorDeg = 0.0;
+    std::vector<double> solveUs;
+};
+
+Summary run(const ArmIkSolver& solver, const std::vector<Case>& cases, const IkOptions& options,
+            bool anywhere = false) {
+    Summary summary;
+    summary.solveUs.reserve(cases.size());
+    for (const Case& c : cases) {
+        IkResult result = anywhere ? solver.solveAnywhere(c.target, c.seed, options)
+                                   : solver.solve(c.target, c.seed, options);
+        summary.solveUs.push_back(result.solveUs);
+        summary.iterations += result.iterations;
+        if (result.status == IkResult::Converged) {
+            ++summary.converged;
+            summary.maxPositionErrorMm = std::max(summary.maxPositionErrorMm, result.positionErrorM * 1000.0);
+            summary.maxOrientationErrorDeg = std::max(summary.maxOrientationErrorDeg,
+                                                      result.orientationErrorRad * 180.0 / M_PI);
+        } else if (result.status == IkResult::TimeBudget) {
+            ++summary.timeBudget;
+        } else if (result.status == IkResult::Stalled) {
+            ++summary.stalled;
+        }
+    }
+    std::sort(summary.solveUs.begin(), summary.solveUs.end());
+    return summary;
+}
+
+void print(const char* name, const Summary& summary) {
+    const double count = static_cast<double>(summary.solveUs.size());
+    double totalUs = 0.0;
+    for (double us : summary.solveUs) {
+        totalUs += us;
+    }
+    auto percentile = [&](double p) {
+        return summary.solveUs[std::min(summary.solveUs.size() - 1, static_cast<size_t>(p * count))];
+    };
+
+    // Подписи режимов в конце: printf выравнивает байты, а не символы UTF-8
+    std::printf("%6.1f%% %5d %5d %6.1f %8.0f %7.1f %7.1f %7.1f %9.3f %8.3f   %s\n",
+                100.0 * summary.converged / count, summary.timeBudget, summary.stalled,
+                summary.iterations / count, count / (totalUs * 1e-6),
+                percentile(0.5), percentile(0.99), summary.solveUs.back(),
+                summary.maxPositionErrorMm, summary.maxOrientationErrorDeg, name);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    ArmKinematics kinematics;
+    QString error;
+    QString path = argc > 1 ? QString::fromLocal8Bit(argv[1]) : QString(ArmKinematics::DEFAULT_URDF);
+    if (!kinematics.loadUrdf(path, &error)) {
+        std::fprintf(stderr, "%s\n", qPrintable(error));
+        return 1;
+    }
+    ArmIkSolver solver(kinematics);
+
+    ReachabilityMap map;
+    ReachabilityBuildOptions mapOptions;
+    mapOptions.samples = 1000000;
+    if (!ReachabilityMap::build(kinematics, mapOptions, map, &error)) {
+        std::fprintf(stderr, "%s\n", qPrintable(error));
+        return 1;
+    }
+    solver.setReachabilityMap(&map);
+
+    std::mt19937 random(42);
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+
+    // Решения — в лимитах с запасом 5°, чтобы возмущённый старт не упирался в них
+    std::vector<JointVector> solutions(POSES);
+    for (JointVector& q : solutions) {
+        for (int j = 0; j < KINEMATIC_JOINTS; ++j) {
+            std::uniform_real_distribution<double> angle(kinematics.lowerLimitDeg(j) + 5.0,
+                                                         kinematics.upperLimitDeg(j) - 5.0);
+            q[j] = angle(random);
+        }
+    }
+
+    auto makeCases = [&](double spreadDeg, bool fromZero) {
+        std::vector<Case> cases(POSES);
+        for (int i = 0; i < POSES; ++i) {
+            cases[i].target = kinematics.forward(solutions[i]);
+            for (int j = 0; j < KINEMATIC_JOINTS; ++j) {
+                cases[i].seed[j] = fromZero ? 0.0 : solutions[i][j] + spreadDeg * unit(random);
+            }
+        }
+        return cases;
+    };
+    const std::vector<Case> jog = makeCases(2.0, false);
+    const std::vector<Case> near = makeCases(15.0, false);
+    const std::vector<Case> cold = makeCases(0.0, true);
+
+    // Без бюджета времени: меряем саму сходимость, а не таймер
+    IkOptions pose;
+    pose.timeBudgetUs = 0;
+    IkOptions position = pose;
+    position.positionOnly = true;
+
+    std::printf("Карта: %llu выборок, воксель %.0f мм, %u вокселей в зоне\n",
+                static_cast<unsigned long long>(map.sampleCount()), map.voxelSizeM() * 1000.0, map.reachableVoxels());
+    std::printf("%d достижимых поз; допуск %.1f мм / %.2f°, не больше %d итераций\n\n",
+                POSES, pose.positionToleranceM * 1000.0, pose.orientationToleranceRad * 180.0 / M_PI,
+                pose.maxIterations);
+    std::printf("  сошл.  врем. тупик  итер. реш./с     p50     p99     max  ошибка,мм ошибка,°\n");
+    print("jog: поза", run(solver, jog, pose));
+    print("near: поза", run(solver, near, pose));
+    print("cold: поза", run(solver, cold, pose));
+    print("map: поза", run(solver, cold, pose, true));
+    print("jog: только XYZ", run(solver, jog, position));
+    print("cold: только XYZ", run(solver, cold, position));
+    print("map: только XYZ", run(solver, cold, position, true));
+    std::printf("\nВремя решения — мкс; \"врем.\" — превышен бюджет, \"тупик\" — демпфирование упёрлось в предел\n");
+    return 0;
+}
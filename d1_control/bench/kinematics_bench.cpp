@@ -0,0 +1,172 @@
+// Стоимость прямой кинематики (ArmKinematics) на одну выборку feedback.
+//
+// Сборка: cmake -DD1_BUILD_BENCHMARKS=ON, запуск: ./kinematics_bench [путь к URDF]
+// (по умолчанию — URDF из ресурсов). Углы берутся из таблицы случайных поз
+// в пределах лимитов, чтобы sin/cos не сворачивались в константы.
+// Для сравнения — прямолинейный вариант: матрицы 4x4 на каждый origin и
+// поворот сустава; заодно проверяется, что оба дают одну позу.
+
+#include <QString>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "arm_kinematics.h"
+
+namespace {
+
+constexpr int ITERATIONS = 2000000;
+constexpr int POSES = 1024;
+
+using Matrix4 = std::array<double, 16>;
+
+Matrix4 multiply(const Matrix4& a, const Matrix4& b) {
+    Matrix4 m{};
+    for (int r = 0; r < 4; ++r) {
+        for (int c = 0; c < 4; ++c) {
+            double sum = 0.0;
+            for (int k = 0; k < 4; ++k) {
+                sum += a[4 * r + k] * b[4 * k + c];
+            }
+            m[4 * r + c] = sum;
+        }
+    }
+    return m;
+}
+
+Matrix4 toMatrix(const RigidTransform& t) {
+    Matrix4 m{};
+    for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < 3; ++c) {
+            m[4 * r + c] = t.rotation[3 * r + c];
+        }
+        m[4 * r + 3] = t.position[r];
+    }
+    m[15] = 1.0;
+    return m;
+}
+
+RigidTransform invert(const RigidTransform& t) {
+    RigidTransform inverse;
+    for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < 3; ++c) {
+            inverse.rotation[3 * r + c] = t.rotation[3 * c + r];
+        }
+    }
+    for (int r = 0; r < 3; ++r) {
+        inverse.position[r] = -(inverse.rotation[3 * r] * t.position[0]
+                                + inverse.rotation[3 * r + 1] * t.position[1]
+                                + inverse.rotation[3 * r + 2] * t.position[2]);
+    }
+    return inverse;
+}
+
+// Прежний способ "по учебнику": 4x4 на origin, 4x4 на поворот вокруг оси.
+// origin и знаки осей снимаются с ArmKinematics по кадрам звеньев.
+struct NaiveChain {
+    std::array<Matrix4, KINEMATIC_JOINTS> origins;
+    std::array<double, KINEMATIC_JOINTS> signs;
+    Matrix4 tcp;
+
+    explicit NaiveChain(const ArmKinematics& kinematics) {
+        JointVector zero{};
+        KinematicFrames frames;
+        kinematics.forward(zero, frames);
+        for (int j = 0; j < KINEMATIC_JOINTS; ++j) {
+            // При нулевом угле поворот сустава единичный: origin = links[j]^-1 * links[j+1]
+            RigidTransform origin = invert(frames.links[j]) * frames.links[j + 1];
+            origins[j] = toMatrix(origin);
+
+            // Поворот сустава на +1°: R(1,0) = sin(угла вокруг +Z)
+            JointVector probe{};
+            probe[j] = 1.0;
+            KinematicFrames turned;
+            kinematics.forward(probe, turned);
+            RigidTransform rotation = invert(origin) * invert(turned.links[j]) * turned.links[j + 1];
+            signs[j] = rotation.rotation[3] > 0 ? 1.0 : -1.0;
+        }
+        tcp = toMatrix(kinematics.tcpOffset());
+    }
+
+    Matrix4 forward(const JointVector& anglesDeg) const {
+        Matrix4 m{1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+        for (int j = 0; j < KINEMATIC_JOINTS; ++j) {
+            const double q = signs[j] * anglesDeg[j] * M_PI / 180.0;
+            const double c = std::cos(q);
+            const double s = std::sin(q);
+            Matrix4 rotation{c, -s, 0, 0, s, c, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+            m = multiply(multiply(m, origins[j]), rotation);
+        }
+        return multiply(m, tcp);
+    }
+};
+
+template <typename F>
+double measure(const std::vector<JointVector>& poses, F function) {
+    double checksum = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; ++i) {
+        checksum += function(poses[i & (POSES - 1)]);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    // Не даём компилятору выбросить вычисления
+    static volatile double sink;
+    sink = checksum;
+    (void)sink;
+
+    return std::chrono::duration<double, std::nano>(elapsed).count() / ITERATIONS;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    ArmKinematics kinematics;
+    QString error;
+    QString path = argc > 1 ? QString::fromLocal8Bit(argv[1]) : QString(ArmKinematics::DEFAULT_URDF);
+    if (!kinematics.loadUrdf(path, &error)) {
+        std::fprintf(stderr, "%s\n", qPrintable(error));
+        return 1;
+    }
+
+    std::mt19937 random(42);
+    std::vector<JointVector> poses(POSES);
+    for (JointVector& pose : poses) {
+        for (int j = 0; j < KINEMATIC_JOINTS; ++j) {
+            std::uniform_real_distribution<double> angle(kinematics.lowerLimitDeg(j), kinematics.upperLimitDeg(j));
+            pose[j] = angle(random);
+        }
+    }
+
+    NaiveChain naive(kinematics);
+    double maxDifference = 0.0;
+    for (const JointVector& pose : poses) {
+        RigidTransform fast = kinematics.forward(pose);
+        Matrix4 slow = naive.forward(pose);
+        for (int r = 0; r < 3; ++r) {
+            maxDifference = std::max(maxDifference, std::abs(fast.position[r] - slow[4 * r + 3]));
+        }
+    }
+
+    RigidTransform home = kinematics.forward(JointVector{});
+    std::printf("TCP при нулевых углах: %.1f, %.1f, %.1f мм; расхождение с 4x4: %.2e м\n\n",
+                home.position[0] * 1000.0, home.position[1] * 1000.0, home.position[2] * 1000.0, maxDifference);
+
+    KinematicFrames frames;
+    double tcpNs = measure(poses, [&](const JointVector& q) { return kinematics.forward(q).position[0]; });
+    double framesNs = measure(poses, [&](const JointVector& q) {
+        kinematics.forward(q, frames);
+        return frames.tcp.position[2];
+    });
+    double naiveNs = measure(poses, [&](const JointVector& q) { return naive.forward(q)[3]; });
+
+    std::printf("%d итераций, нс на вызов\n", ITERATIONS);
+    // Подписи строк в конце: printf выравнивает байты, а не символы UTF-8
+    std::printf("%10.1f   forward(): рабочая точка\n", tcpNs);
+    std::printf("%10.1f   forward(): все звенья и рабочая точка\n", framesNs);
+    std::printf("%10.1f   матрицы 4x4 (для сравнения)\n", naiveNs);
+    return 0;
+}
@@ -0,0 +1,99 @@
+// Загрузка и сохранение библиотеки движений: JSON против .d1ml (MotionLibrary).
+//
+// Сборка: cmake -DD1_BUILD_BENCHMARKS=ON, запуск: ./motion_library_bench [движений] [кадров]
+// Движения — записи с шумом датчиков (по умолчанию 2000 × 300 кадров).
+// Для каждого формата — размер файла, сохранение, загрузка и доступ ко
+// всем кадрам; у библиотеки загрузка читает только индекс, кадры
+// декодируются при первом обращении, а повторное сохранение без обращений
+// копирует блоки как есть.
+
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include "motion_manager.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double milliseconds(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Сумма углов всех кадров: доступ, который компилятор не выбросит
+double touchAll(const MotionManager& manager) {
+    double sum = 0.0;
+    for (int i = 0; i < manager.getMotionCount(); ++i) {
+        const Motion motion = manager.getMotion(i);
+        for (const MotionKeyframe& kf : motion.keyframes) {
+            sum += kf.jointAngles[0];
+        }
+    }
+    return sum;
+}
+
+void run(const char* name, MotionManager& source, const QString& path) {
+    Clock::time_point start = Clock::now();
+    source.saveToFile(path);
+    const double saveMs = milliseconds(start);
+
+    MotionManager loaded;
+    start = Clock::now();
+    loaded.loadFromFile(path);
+    const double loadMs = milliseconds(start);
+    start = Clock::now();
+    const double sum = touchAll(loaded);
+    const double touchMs = milliseconds(start);
+
+    // Повторное сохранение сразу после загрузки (правка одного движения)
+    MotionManager edited;
+    edited.loadFromFile(path);
+    edited.renameMotion(0, "renamed");
+    start = Clock::now();
+    edited.saveToFile(path);
+    const double resaveMs = milliseconds(start);
+
+    std::printf("%9.1f %9.1f %9.1f %9.1f %12.1f   %s (%.0f)\n",
+                QFileInfo(path).size() / 1048576.0, saveMs, loadMs, touchMs, resaveMs, name, sum);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    const int motions = argc > 1 ? std::atoi(argv[1]) : 2000;
+    const int keyframes = argc > 2 ? std::atoi(argv[2]) : 300;
+
+    std::mt19937 random(42);
+    std::normal_distribution<double> noise(0.0, 0.05);
+    MotionManager manager;
+    for (int m = 0; m < motions; ++m) {
+        Motion motion;
+        motion.name = QString("Motion_%1").arg(m);
+        motion.description = "Записано: бенчмарк";
+        for (int k = 0; k < keyframes; ++k) {
+            MotionKeyframe kf;
+            kf.transitionMs = 200;
+            for (int j = 0; j < MOTION_NUM_JOINTS; ++j) {
+                kf.jointAngles[j] = 60.0 * std::sin(0.01 * k * (j + 1) + m) + noise(random);
+            }
+            kf.stop = k % 50 == 0;
+            motion.keyframes.append(kf);
+        }
+        manager.addMotion(motion);
+    }
+
+    QTemporaryDir dir;
+    std::printf("%d движений × %d кадров\n\n", motions, keyframes);
+    std::printf("     МБ   сохр.,мс  загр.,мс  кадры,мс  пересохр.,мс\n");
+    run("JSON", manager, dir.filePath("motions.json"));
+    run("d1ml", manager, dir.filePath("motions.d1ml"));
+    std::printf("\n\"кадры\" — первое обращение ко всем кадрам после загрузки, "
+                "\"пересохр.\" — сохранение после загрузки и переименования одного движения\n");
+    return 0;
+}
@@ -0,0 +1,138 @@
+// Стоимость чтения состояния руки: QMutex + копия (прежний getState())
+// против seqlock-снимка и атомарного слова статуса (FeedbackWorker).
+//
+// Сборка: cmake -DD1_BUILD_BENCHMARKS=ON, запуск: ./state_read_bench
+// Каждый вариант меряется без писателя, с писателем 1 кГц (как поток приёма
+// при полной частоте relay) и с писателем без пауз (худший случай).
+// Меряется только сторона читателя: мьютекс дополнительно задерживает
+// писателя на время копии, seqlock — никогда.
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include "arm_state.h"
+#include "seqlock.h"
+
+namespace {
+
+constexpr int ITERATIONS = 2000000;
+
+enum class WriterMode {
+    None,
+    Rate1kHz,
+    Flat
+};
+
+const char* writerName(WriterMode mode) {
+    switch (mode) {
+        case WriterMode::None: return "без писателя";
+        case WriterMode::Rate1kHz: return "писатель 1 кГц";
+        case WriterMode::Flat: return "писатель без пауз";
+    }
+    return "";
+}
+
+ArmState makeState(uint32_t seq) {
+    ArmState state;
+    for (int i = 0; i < NUM_JOINTS; ++i) {
+        state.joints[i].angle = seq * 0.01 + i;
+    }
+    state.isConnected = true;
+    state.powerStatus = 1;
+    state.seq = seq;
+    return state;
+}
+
+struct MutexState {
+    mutable QMutex mutex;
+    ArmState state;
+
+    void write(const ArmState& value) {
+        QMutexLocker locker(&mutex);
+        state = value;
+    }
+    ArmState read() const {
+        QMutexLocker locker(&mutex);
+        return state;
+    }
+};
+
+struct SeqLockState {
+    d1::SeqLock<ArmState> state;
+    std::atomic<uint64_t> status{0};
+
+    void write(const ArmState& value) {
+        state.store(value);
+        status.store(packArmStatus(value), std::memory_order_release);
+    }
+};
+
+template <typename Write, typename Read>
+double measure(WriterMode mode, Write write, Read read) {
+    std::atomic<bool> running{true};
+    std::thread writer;
+    if (mode != WriterMode::None) {
+        writer = std::thread([&]() {
+            uint32_t seq = 0;
+            while (running.load(std::memory_order_relaxed)) {
+                write(makeState(++seq));
+                if (mode == WriterMode::Rate1kHz) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+        });
+    }
+
+    double checksum = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; ++i) {
+        checksum += read();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    running = false;
+    if (writer.joinable()) {
+        writer.join();
+    }
+
+    // Не даём компилятору выбросить чтения
+    static volatile double sink;
+    sink = checksum;
+    (void)sink;
+
+    return std::chrono::duration<double, std::nano>(elapsed).count() / ITERATIONS;
+}
+
+} // namespace
+
+int main() {
+    MutexState mutexState;
+    SeqLockState seqState;
+    mutexState.write(makeState(0));
+    seqState.write(makeState(0));
+
+    std::printf("Чтение ArmState (%zu байт), %d итераций, нс на вызов\n\n", sizeof(ArmState), ITERATIONS);
+    // Подписи строк в конце: printf выравнивает байты, а не символы UTF-8
+    std::printf("%14s %14s %14s\n", "QMutex+copy", "seqlock", "status-word");
+
+    const WriterMode modes[] = {WriterMode::None, WriterMode::Rate1kHz, WriterMode::Flat};
+    for (WriterMode mode : modes) {
+        double mutexNs = measure(mode,
+            [&](const ArmState& s) { mutexState.write(s); },
+            [&]() { return mutexState.read().joints[0].angle; });
+        double seqNs = measure(mode,
+            [&](const ArmState& s) { seqState.write(s); },
+            [&]() { return seqState.state.load().joints[0].angle; });
+        double statusNs = measure(mode,
+            [&](const ArmState& s) { seqState.write(s); },
+            [&]() {
+                ArmStatus status = unpackArmStatus(seqState.status.load(std::memory_order_acquire));
+                return static_cast<double>(status.isConnected + status.errorStatus);
+            });
+        std::printf("%14.1f %14.1f %14.1f   %s\n", mutexNs, seqNs, statusNs, writerName(mode));
+    }
+    return 0;
+}
@@ -3,34 +3,49 @@
 
 #include <QObject>
 #include <QTimer>
-#include <QMutex>
 #include <QUdpSocket>
 #include <QHostAddress>
 #include <memory>
 #include <array>
 #include <atomic>
+#include <mutex>
+#include "arm_kinematics.h"
+#include "arm_state.h"
+#include "collision_checker.h"
+#include "command_scheduler.h"
+#include "convergence_tracker.h"
+#include "d1_protocol.h"
+#include "feedback_worker.h"
+#include "joint_trajectory.h"
+#include "latency_monitor.h"
+#include "reachability_map.h"
+#include "shm_channel.h"
+#include "seqlock.h"
+#include "trajectory_executor.h"
 
-// Константы
-constexpr int NUM_JOINTS = 7;
-constexpr int UDP_CMD_PORT = 8888;      // Порт для отправки команд В udp_relay
-constexpr int UDP_FEEDBACK_PORT = 8889; // Порт для получения данных ИЗ udp_relay
-
-// Структура состояния сустава
-struct JointState {
-    double angle = 0.0;
-    double velocity = 0.0;
-    double torque = 0.0;
-    double minLimit = -180.0;
-    double maxLimit = 180.0;
+#ifdef D1_WITH_RELAY_CORE
+#include "relay_core.h"
+#endif
+
+// Транспорт feedback и команд между GUI и udp_relay
+enum class FeedbackTransport {
+    Udp,            // Подписка по UDP (удалённый relay или нет shm)
+    SharedMemory,   // Разделяемая память локального relay
+    InProcess       // Встроенное ядро DDS (d1_relay_core), без udp_relay
+};
+
+// Предпочтение транспорта из настроек подключения / D1_TRANSPORT
+enum class TransportPreference {
+    Auto,       // shm, если локальный relay его создал, иначе UDP
+    Udp,        // Только UDP
+    InProcess   // Встроенное ядро DDS (если собрано с D1_WITH_RELAY_CORE)
 };
 
-// Структура состояния руки
-struct ArmState {
-    std::array<JointState, NUM_JOINTS> joints;
-    int powerStatus = 0;       // 0 - выкл, 1 - вкл
-    int errorStatus = 0;       // 0 - OK
-    bool isConnected = false;
-    uint64_t lastUpdateTime = 0;
+// Способ отправки команды на все суставы
+enum class MultiJointMode {
+    PerJoint,       // Отдельная команда funcode 1 на каждый сустав
+    Synchronized,   // Одна команда funcode 2 на всю руку
+    Auto            // funcode 2, при отсутствии реакции — откат на funcode 1
 };
 
 // Контроллер руки D1 (через UDP к udp_relay)
@@ -52,17 +67,77 @@ public:
     void resetErrors();
     void emergencyStop();
     void clearEmergencyStop();  // Сброс флага аварийной остановки
-    void cancelAllPendingCommands();  // Отмена всех запланированных команд
+    void cancelAllPendingCommands();  // Отмена всех запланированных команд движения
     bool isEmergencyStopped() const { return m_emergencyStop.load(); }
-    uint32_t getCurrentCommandSequence() const { return m_commandSequence.load(); }
     void holdCurrentPosition();
 
     // Управление суставами
     void setJointAngle(int jointId, double angle, int delayMs = 500);
     void setAllJointAngles(const std::array<double, NUM_JOINTS>& angles, int delayMs = 500);
+    // Плавный переход исполнителем траекторий (stepsCount оставлен для совместимости:
+    // частота уставок задаётся TrajectoryConfig::rateHz)
     void setAllJointAnglesInterpolated(const std::array<double, NUM_JOINTS>& angles, int totalTimeMs, int stepsCount = 10);
-    void moveToHome();
+    quint64 moveToHome();  // Дескриптор ожидания прихода (awaitTarget), 0 — переход не начат
+
+    // Потоковое исполнение траектории: уставки с фиксированной частотой из
+    // отдельного потока. Возвращает номер для trajectoryFinished(), 0 — не запущено.
+    quint64 executeTrajectory(const JointTrajectory& trajectory);
+    void stopTrajectory();
+    // Одна уставка сразу, без пауз между суставами и проб funcode 2 — для
+    // внешнего потока уставок (декартов jog). Грипер держится на месте.
+    void streamSetpoint(const std::array<double, NUM_JOINTS>& angles, int reachMs);
+    bool isTrajectoryRunning() const { return m_executor->isRunning(); }
+    TrajectoryExecutor& trajectoryExecutor() { return *m_executor; }
+    const TrajectoryExecutor& trajectoryExecutor() const { return *m_executor; }
+
+    // Ожидание прихода руки в цель по feedback вместо фиксированной паузы:
+    // targetReached() или targetFailed() с возвращённым дескриптором.
+    // Углы ограничиваются так же, как в командах движения.
+    quint64 awaitTarget(const std::array<double, NUM_JOINTS>& angles, int expectedMs,
+                        const ConvergenceOptions& options = ConvergenceOptions());
+    void cancelTarget(quint64 handle);  // Без сигнала
+
+    // Запись каждой выборки feedback в буфер (поток приёма); после
+    // stopFeedbackRecording() буфер больше не пишется и его можно читать
+    void startFeedbackRecording(FeedbackRecording* recording);
+    void stopFeedbackRecording();
+    bool isTargetPending(quint64 handle) const { return m_convergence.isPending(handle); }
+    
+    // Синхронная команда на всю руку (funcode 2)
+    void setMultiJointMode(MultiJointMode mode);
+    MultiJointMode getMultiJointMode() const { return m_multiJointMode; }
+    bool isSyncCommandSupported() const { return !m_syncUnsupported; }
+
+    // Измерение рассинхронизации старта суставов
+    void setSkewMeasurementEnabled(bool enabled);
+    bool isSkewMeasurementEnabled() const { return m_skewMeasurementEnabled; }
+    QString skewReport() const;
+
+    FeedbackTransport feedbackTransport() const { return m_transport; }
+    // Читается при initialize() из настроек "Connection/transport";
+    // переменная окружения D1_TRANSPORT (auto|udp|inprocess) имеет приоритет
+    static TransportPreference transportPreferenceFromString(const QString& value);
+    static bool isInProcessTransportAvailable();
+
+    // Сквозные задержки и потери feedback
+    LatencyMonitor& latencyMonitor() { return m_latencyMonitor; }
+    const LatencyMonitor& latencyMonitor() const { return m_latencyMonitor; }
 
+    // Отложенные команды (поток GUI): колесо таймеров с полосами приоритета
+    CommandScheduler& scheduler() { return *m_scheduler; }
+    const CommandScheduler& scheduler() const { return *m_scheduler; }
+
+    // Прямая кинематика (URDF из ресурсов); рабочая точка уже есть в ArmState::tcp*
+    const ArmKinematics& kinematics() const { return m_kinematics; }
+    // Карта досягаемости (d1_reachability); не загружена, если файла нет
+    // или он построен для другой цепи
+    const ReachabilityMap& reachability() const { return m_reachability; }
+    // Самостолкновения и окружение (меши d1_description, Collision/* в настройках).
+    // Проверяют вызывающие: окно (переход в позу), плейер (весь путь), jog (каждый тик)
+    const CollisionChecker& collision() const { return m_collision; }
+    void setCollisionCheckEnabled(bool enabled);
+    bool isCollisionCheckEnabled() const { return m_collision.config().enabled; }
+    
     // Захват (грипер)
     void setGripperPosition(double position); // 0.0 - закрыт, 1.0 - открыт
 
@@ -74,8 +149,12 @@ public:
     void setHomePosition(const std::array<double, NUM_JOINTS>& positions);
     std::array<double, NUM_JOINTS> getHomePosition() const;
 
-    // Получение состояния
+    // Получение состояния (без блокировок, из любого потока).
+    // Для нескольких полей берите один снимок: getState() или getStatus(),
+    // а не несколько отдельных геттеров подряд.
     ArmState getState() const;
+    ArmStatus getStatus() const;
+    uint32_t stateVersion() const;   // Меняется с каждым обновлением состояния
     double getJointAngle(int jointId) const;
     bool isConnected() const;
     bool hasError() const;
@@ -92,27 +171,50 @@ signals:
     void motorsPowered(bool powered);
     void recoveryStarted();
     void recoveryFinished(bool success);
+    void jointStartSkewMeasured(double skewMs, bool synchronized);
+    void trajectoryFinished(quint64 trajectoryId, bool completed, const QString& reason);
+    void targetReached(quint64 handle, int elapsedMs);
+    void targetFailed(quint64 handle, bool timedOut, const QString& reason);
 
 public slots:
     void startRecovery();
 
 private slots:
-    void onReadyRead();
     void checkConnection();
     void processRecovery();
+    void onWorkerStateAvailable();
+    void onWorkerConnectionChanged(bool connected);
+    void onWorkerPowerStatusChanged(int powerStatus);
+    void onWorkerErrorStatusChanged(int errorStatus);
+    void onWorkerSkewMeasured(double skewMs, bool synchronized);
+    void onTrajectoryFinished(quint64 trajectoryId, bool completed, const QString& reason);
 
 private:
+    friend class StreamSink;
+
     void sendCommand(const QString& jsonCmd);
-    void parseJsonData(const QByteArray& data);
+    void sendSubscription(d1::ControlType type);
+    bool bindFeedbackSocket();
+    bool trySharedMemory();
+    bool tryInProcess();
+    void fallBackToUdp();
+    void sendPerJointCommands(const std::array<double, NUM_JOINTS>& angles, int delayMs);
+    void sendSyncCommand(const std::array<double, NUM_JOINTS>& angles, int delayMs);
+    void probeSyncResponse(const std::array<double, NUM_JOINTS>& startAngles,
+                           const std::array<double, NUM_JOINTS>& targets,
+                           int delayMs);
+    static int syncProbeWindowMs(double maxDeltaDeg, int delayMs);
+    void startSkewProbe(const std::array<double, NUM_JOINTS>& targets, bool synchronized);
+    double gripperTarget() const;
     QString buildCommand(int funcode, const QString& dataJson);
+    void abortTargets(const QString& reason);
+    void dispatchConvergenceEvents(const std::vector<ConvergenceEvent>& events, const QString& abortReason = QString());
+    static QString jointCommandData(int jointId, double angle, int delayMs);
+    static QString syncCommandData(const std::array<double, NUM_JOINTS>& targets, int delayMs);
 
-    // UDP сокеты
-    QUdpSocket* m_cmdSocket;    // Для отправки команд
-    QUdpSocket* m_feedbackSocket; // Для приёма feedback
+    // Сокет команд (feedback принимает FeedbackWorker в своём потоке)
+    QUdpSocket* m_cmdSocket;
 
-    // Состояние
-    mutable QMutex m_stateMutex;
-    ArmState m_state;
     std::array<double, NUM_JOINTS> m_homePosition;
 
     // Лимиты по умолчанию для D1-550 (из документации)
@@ -129,17 +231,84 @@ private:
     // Таймеры
     QTimer* m_connectionTimer;
     QTimer* m_recoveryTimer;
+    
+    // Отложенные команды: отмена по группе вместо счётчика последовательности
+    CommandScheduler* m_scheduler;
+    enum : CommandGroup {
+        GROUP_ENABLE = 1,     // Повторы включения и фиксация после него
+        GROUP_RESET,          // Повтор отключения при сбросе ошибок
+        GROUP_HOLD,           // Фиксация текущей позиции по суставам
+        GROUP_MOTION,         // Поочерёдные команды funcode 1
+        GROUP_SYNC_PROBE,     // Проверка реакции руки на funcode 2
+        GROUP_ESTOP           // Повтор отключения при аварийной остановке
+    };
+    static constexpr int ESTOP_REPEAT_MS = 100;
 
     // Флаги
     std::atomic<bool> m_initialized{false};
     std::atomic<bool> m_isRecovering{false};
     std::atomic<bool> m_emergencyStop{false};  // Флаг аварийной остановки
     std::atomic<uint32_t> m_seqCounter{0};
-    std::atomic<uint32_t> m_commandSequence{0};  // Счётчик для отмены запланированных команд
     int m_recoveryStep = 0;
 
-    // Timeout
-    static constexpr uint64_t CONNECTION_TIMEOUT_MS = 2000;  // 2 секунды для быстрого обнаружения
+    // Подписка на feedback у udp_relay (аренда ~5 с, продлеваем каждую секунду)
+    d1::FeedbackFormat m_requestedFormat = d1::FeedbackFormat::Binary;
+    uint16_t m_feedbackRateHz = 0;  // 0 — полная частота relay
+    qint64 m_lastSubscribeTime = 0;
+    static constexpr qint64 SUBSCRIBE_RENEW_MS = 1000;
+
+    // Разделяемая память (выбирается автоматически, если relay её создал)
+    // или встроенное ядро DDS: в обоих случаях читаем снимок под seqlock
+    d1::ShmChannel m_shm;
+    FeedbackTransport m_transport = FeedbackTransport::Udp;
+    TransportPreference m_transportPreference = TransportPreference::Auto;
+    std::mutex m_shmSendMutex;  // Кольцо команд: поток GUI и поток исполнителя траекторий
+    qint64 m_lastShmProbeTime = 0;
+#ifdef D1_WITH_RELAY_CORE
+    d1::SeqLock<d1::FeedbackSample> m_inProcessState;  // Пишет поток DDS
+    std::unique_ptr<d1::RelayCore> m_relayCore;        // Уничтожается раньше снимка
+#endif
+    static constexpr uint64_t SHM_STALE_NS = 1000000000ULL;
+    static constexpr qint64 SHM_PROBE_MS = 2000;
+
+    // Синхронные команды funcode 2
+    MultiJointMode m_multiJointMode = MultiJointMode::Auto;
+    bool m_syncConfirmed = false;     // Рука уже реагировала на funcode 2
+    bool m_syncUnsupported = false;   // Откат на funcode 1 после пробы
+    static constexpr int SYNC_PROBE_MS = 400;          // Без учёта времени перехода
+    static constexpr double SYNC_PROBE_MIN_DELTA_DEG = 2.0;
+    static constexpr double MOTION_START_THRESHOLD_DEG = 0.3;
+
+    // Последняя уставка грипера: повторяется в командах на всю руку
+    double m_gripperTarget = 0.0;
+    bool m_gripperCommanded = false;
+
+    // Статистика рассинхронизации старта (сама проба выполняется в FeedbackWorker)
+    struct SkewStats {
+        int count = 0;
+        double sumMs = 0.0;
+        double maxMs = 0.0;
+    };
+    bool m_skewMeasurementEnabled = false;
+    SkewStats m_skewStats[2];  // [0] — funcode 1, [1] — funcode 2
+
+    LatencyMonitor m_latencyMonitor;
+    static constexpr uint64_t SKEW_PROBE_TIMEOUT_NS = 3000000000ULL;
+
+    // Загружается в конструкторе, до запуска потока приёма; переживает его
+    ArmKinematics m_kinematics;
+    ReachabilityMap m_reachability;
+    CollisionChecker m_collision;
+    
+    // Цели, прихода в которые ждут GUI и плейер (проверка на каждом stateUpdated)
+    ConvergenceTracker m_convergence;
+    
+    // Потоковое исполнение траекторий; останавливается раньше транспорта
+    TrajectoryExecutor* m_executor;
+    
+    // Приём feedback в отдельном потоке; состояние руки — его снимок под seqlock.
+    // Объявлен после m_latencyMonitor: останавливается и удаляется раньше него.
+    std::unique_ptr<FeedbackWorker> m_worker;
 };
 
 #endif // ARM_CONTROLLER_H
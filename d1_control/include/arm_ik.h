@@ -0,0 +1,81 @@
+#ifndef ARM_IK_H
+#define ARM_IK_H
+
+#include "arm_kinematics.h"
+
+class ReachabilityMap;
+
+// Параметры решения обратной кинематики
+struct IkOptions {
+    int maxIterations = 60;
+    double positionToleranceM = 0.0005;        // 0,5 мм
+    double orientationToleranceRad = 0.0087;   // 0,5°
+    double orientationWeightM = 0.2;           // Сколько метров "стоит" радиан ошибки ориентации
+    double initialDamping = 0.01;              // Начальное λ (Левенберг-Марквардт)
+    double maxStepDeg = 10.0;                  // Ограничение шага сустава за итерацию
+    int timeBudgetUs = 2000;                   // 0 — без ограничения
+    bool positionOnly = false;                 // Ориентация не важна (только XYZ)
+};
+
+struct IkResult {
+    enum Status {
+        Converged,
+        MaxIterations,
+        TimeBudget,
+        Stalled         // Демпфирование упёрлось в предел: цель недостижима или сингулярность
+    };
+
+    Status status = MaxIterations;
+    JointVector anglesDeg{};        // Лучшее найденное решение (в лимитах)
+    int iterations = 0;
+    double positionErrorM = 0.0;
+    double orientationErrorRad = 0.0;
+    double solveUs = 0.0;
+
+    bool converged() const { return status == Converged; }
+};
+
+// Обратная кинематика: демпфированные наименьшие квадраты с адаптивным
+// демпфированием (Левенберг-Марквардт) на цепи ArmKinematics.
+//
+// Шаг: dq = Jᵀ (J Jᵀ + λ²I)⁻¹ e, e — ошибка положения и (с весом)
+// ориентации рабочей точки. Шаг принимается, только если ошибка уменьшилась
+// (тогда λ уменьшается), иначе λ растёт — у сингулярностей решение не
+// разлетается. После каждого шага углы зажимаются в лимиты суставов.
+// Начальное приближение — текущие углы (тёплый старт): при непрерывном
+// движении хватает 2–4 итераций. Всё на стеке, без выделения памяти.
+class ArmIkSolver {
+public:
+    explicit ArmIkSolver(const ArmKinematics& kinematics);
+
+    // Лимиты суставов, градусы (по умолчанию — из URDF); грипер не используется
+    void setJointLimits(const JointVector& lowerDeg, const JointVector& upperDeg);
+    double lowerLimitDeg(int joint) const { return m_lowerDeg[joint]; }
+    double upperLimitDeg(int joint) const { return m_upperDeg[joint]; }
+
+    // Углы seedDeg[6] (грипер) переносятся в результат без изменений
+    IkResult solve(const RigidTransform& target, const JointVector& seedDeg,
+                   const IkOptions& options = IkOptions()) const;
+
+    // Карта досягаемости для solveAnywhere() (владеет вызывающий)
+    void setReachabilityMap(const ReachabilityMap* map) { m_map = map; }
+    // Переход в произвольную позу: если от seedDeg не сошлось — вторая попытка
+    // от углов карты для вокселя и направления цели (бюджет времени — на
+    // каждую попытку). Решение может лежать в другой ветви, чем seedDeg,
+    // поэтому для непрерывного jog — только solve().
+    IkResult solveAnywhere(const RigidTransform& target, const JointVector& seedDeg,
+                           const IkOptions& options = IkOptions()) const;
+
+    static const char* statusName(IkResult::Status status);
+
+    // Ошибка ориентации target·currentᵀ в виде вектора оси-угла, рад
+    static std::array<double, 3> orientationError(const RigidTransform& target, const RigidTransform& current);
+
+private:
+    const ArmKinematics& m_kinematics;
+    const ReachabilityMap* m_map = nullptr;
+    JointVector m_lowerDeg{};
+    JointVector m_upperDeg{};
+};
+
+#endif // ARM_IK_H
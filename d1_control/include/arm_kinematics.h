@@ -0,0 +1,98 @@
+#ifndef ARM_KINEMATICS_H
+#define ARM_KINEMATICS_H
+
+#include <QByteArray>
+#include <QString>
+#include <array>
+#include "joint_trajectory.h"
+
+// Число вращательных суставов кинематической цепи (J1–J6; грипер в неё не входит)
+constexpr int KINEMATIC_JOINTS = 6;
+
+// Жёсткое преобразование: поворот 3x3 (по строкам) и перенос, метры.
+// 12 double подряд с выравниванием 32 байта — умножение разворачивается
+// компилятором в векторные операции без перестановок.
+struct alignas(32) RigidTransform {
+    std::array<double, 9> rotation{{1, 0, 0, 0, 1, 0, 0, 0, 1}};
+    std::array<double, 3> position{};
+
+    static RigidTransform fromXyzRpy(double x, double y, double z, double roll, double pitch, double yaw);
+
+    RigidTransform operator*(const RigidTransform& other) const;
+    std::array<double, 3> apply(const std::array<double, 3>& point) const;
+
+    // Углы крен-тангаж-рыскание (URDF: R = Rz(yaw) * Ry(pitch) * Rx(roll)), радианы
+    std::array<double, 3> rpy() const;
+};
+
+// Системы координат звеньев: links[0] — base_link, links[i] — звено после
+// сустава Ji; tcp — рабочая точка инструмента. Всё в системе base_link.
+struct KinematicFrames {
+    std::array<RigidTransform, KINEMATIC_JOINTS + 1> links;
+    RigidTransform tcp;
+};
+
+// Геометрический якобиан рабочей точки: строки — линейная скорость (м/рад)
+// и угловая скорость (рад/рад) в системе base_link, столбцы — суставы J1–J6
+using KinematicJacobian = std::array<std::array<double, KINEMATIC_JOINTS>, 6>;
+
+// Прямая кинематика руки D1 по описанию URDF (d1_description).
+//
+// Цепь base_link → Link6 строится из <joint type="revolute"> при загрузке:
+// для каждого сустава — постоянное преобразование origin и ось вращения.
+// Для осей ±Z (все суставы D1) поворот сустава сводится к смешиванию двух
+// столбцов произведения, поэтому forward() — шесть sin/cos и шесть умножений
+// 3x4 без выделения памяти (сотни наносекунд: можно на каждой выборке).
+//
+// Углы — в градусах, как в ArmState; предполагается, что нули и знаки углов
+// SDK совпадают с URDF (диапазоны лимитов совпадают).
+class ArmKinematics {
+public:
+    // Описание из ресурсов приложения (d1_description.urdf)
+    static constexpr const char* DEFAULT_URDF = ":/urdf/d1_description.urdf";
+
+    ArmKinematics() = default;
+
+    bool loadUrdf(const QString& path = DEFAULT_URDF, QString* error = nullptr);
+    bool loadUrdfData(const QByteArray& data, QString* error = nullptr);
+    bool isLoaded() const { return m_loaded; }
+
+    // Рабочая точка в системе последнего звена. По умолчанию — середина
+    // между основаниями пальцев грипера (Joint7_1/Joint7_2 из URDF).
+    void setTcpOffset(const RigidTransform& offset) { m_tcpOffset = offset; }
+    const RigidTransform& tcpOffset() const { return m_tcpOffset; }
+
+    // Поза рабочей точки
+    RigidTransform forward(const JointVector& anglesDeg) const;
+    // Все звенья и рабочая точка
+    void forward(const JointVector& anglesDeg, KinematicFrames& frames) const;
+
+    // Якобиан по кадрам, посчитанным forward() (для обратной кинематики)
+    void jacobian(const KinematicFrames& frames, KinematicJacobian& jacobian) const;
+
+    // Лимиты суставов из URDF, градусы
+    double lowerLimitDeg(int joint) const { return m_joints[joint].lowerDeg; }
+    double upperLimitDeg(int joint) const { return m_joints[joint].upperDeg; }
+    QString jointName(int joint) const { return m_jointNames[joint]; }
+
+private:
+    enum class AxisKind { PlusZ, MinusZ, General };
+
+    struct Joint {
+        RigidTransform origin;
+        AxisKind axisKind = AxisKind::PlusZ;
+        std::array<double, 3> axis{{0, 0, 1}};   // Для General
+        double lowerDeg = -180.0;
+        double upperDeg = 180.0;
+    };
+
+    // frame = frame * origin * поворот сустава
+    static void advance(RigidTransform& frame, const Joint& joint, double angleRad);
+
+    std::array<Joint, KINEMATIC_JOINTS> m_joints;
+    std::array<QString, KINEMATIC_JOINTS> m_jointNames;
+    RigidTransform m_tcpOffset;
+    bool m_loaded = false;
+};
+
+#endif // ARM_KINEMATICS_H
@@ -0,0 +1,69 @@
+#ifndef ARM_STATE_H
+#define ARM_STATE_H
+
+// Состояние руки: общие типы ArmController и потока приёма feedback.
+// ArmState — POD, поэтому публикуется между потоками через seqlock.
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+// Константы
+constexpr int NUM_JOINTS = 7;
+constexpr int UDP_CMD_PORT = 8888;      // Порт для отправки команд В udp_relay
+constexpr int UDP_FEEDBACK_PORT = 8889; // Порт для получения данных ИЗ udp_relay
+
+// Структура состояния сустава
+struct JointState {
+    double angle = 0.0;
+    double velocity = 0.0;       // °/с, оценка по feedback (JointMotionEstimator)
+    double acceleration = 0.0;   // °/с²
+    double torque = 0.0;
+    double minLimit = -180.0;
+    double maxLimit = 180.0;
+};
+
+// Структура состояния руки
+struct ArmState {
+    std::array<JointState, NUM_JOINTS> joints;
+    int powerStatus = 0;       // 0 - выкл, 1 - вкл
+    int errorStatus = 0;       // 0 - OK
+    bool isConnected = false;
+    uint64_t lastUpdateTime = 0;     // Монотонное время последнего feedback, мс
+    uint32_t seq = 0;                // Номер выборки relay
+    uint64_t ddsTimestampNs = 0;     // Время callback DDS (монотонное, relay)
+    uint64_t receiveTimestampNs = 0; // Время приёма в GUI (монотонное)
+
+    // Рабочая точка по прямой кинематике (ArmKinematics) для каждой выборки:
+    // положение в системе base_link (м) и крен-тангаж-рыскание (рад)
+    bool tcpValid = false;
+    std::array<double, 3> tcpPosition{};
+    std::array<double, 3> tcpRpy{};
+};
+
+static_assert(std::is_trivially_copyable<ArmState>::value, "ArmState публикуется через seqlock");
+
+// Сводка статуса для частых проверок (воспроизведение, обработчики кнопок).
+// Хранится в одном атомарном слове: чтение без ожидания, поля всегда
+// из одного обновления.
+struct ArmStatus {
+    bool isConnected = false;
+    int powerStatus = 0;
+    int errorStatus = 0;
+};
+
+inline uint64_t packArmStatus(const ArmState& state) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(state.errorStatus)) << 32)
+         | (static_cast<uint64_t>(static_cast<uint16_t>(state.powerStatus)) << 16)
+         | (state.isConnected ? 1u : 0u);
+}
+
+inline ArmStatus unpackArmStatus(uint64_t word) {
+    ArmStatus status;
+    status.isConnected = (word & 1u) != 0;
+    status.powerStatus = static_cast<int16_t>((word >> 16) & 0xFFFFu);
+    status.errorStatus = static_cast<int32_t>(word >> 32);
+    return status;
+}
+
+#endif // ARM_STATE_H
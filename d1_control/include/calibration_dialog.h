@@ -38,6 +38,9 @@ private:
     QDoubleSpinBox* m_maxSpin;
     QDoubleSpinBox* m_homeSpin;
     QDoubleSpinBox* m_offsetSpin;
+    QDoubleSpinBox* m_velocitySpin;
+    QDoubleSpinBox* m_accelerationSpin;
+    QDoubleSpinBox* m_jerkSpin;
     QLabel* m_currentAngleLabel;
     QPushButton* m_setMinBtn;
     QPushButton* m_setMaxBtn;
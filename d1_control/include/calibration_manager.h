@@ -6,6 +6,7 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <array>
+#include "joint_trajectory.h"
 
 constexpr int CALIB_NUM_JOINTS = 7;
 
@@ -17,6 +18,10 @@ struct JointCalibration {
     double offset = 0.0;        // Смещение от энкодера
     double speedFactor = 1.0;   // Множитель скорости (0.1 - 2.0)
     bool reversed = false;      // Инверсия направления
+    // Пределы для генерации траекторий воспроизведения (MotionLimits)
+    double maxVelocity = 90.0;          // °/с
+    double maxAcceleration = 360.0;     // °/с²
+    double maxJerk = 3600.0;            // °/с³
 };
 
 struct CalibrationData {
@@ -28,6 +33,9 @@ struct CalibrationData {
     
     QJsonObject toJson() const;
     static CalibrationData fromJson(const QJsonObject& obj);
+    
+    // Пределы суставов с учётом множителей скорости (сустава и общего)
+    MotionLimits motionLimits() const;
 };
 
 // Менеджер калибровки
@@ -58,6 +66,7 @@ public:
     void setJointOffset(int jointId, double offset);
     void setJointSpeedFactor(int jointId, double factor);
     void setJointReversed(int jointId, bool reversed);
+    void setJointMotionLimits(int jointId, double maxVelocity, double maxAcceleration, double maxJerk);
 
     // Глобальные настройки
     void setGlobalSpeedFactor(double factor);
@@ -0,0 +1,69 @@
+#ifndef CARTESIAN_JOG_H
+#define CARTESIAN_JOG_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <array>
+#include "arm_controller.h"
+#include "arm_ik.h"
+
+// Декартово перемещение (jog) рабочей точки: пока задана скорость, цель
+// сдвигается по XYZ / поворачивается по RPY, и на каждом тике обратная
+// кинематика пересчитывает углы с тёплым стартом от предыдущего решения.
+//
+// Уставки уходят через ArmController::streamSetpoint() со временем
+// достижения в два периода — рука движется непрерывно. Если цель
+// недостижима или решение прыгает (рядом с сингулярностью), шаг
+// отклоняется: цель остаётся на месте и приходит limited().
+class CartesianJogController : public QObject {
+    Q_OBJECT
+
+public:
+    explicit CartesianJogController(ArmController* armController, QObject* parent = nullptr);
+    ~CartesianJogController() = default;
+
+    // Скорости: линейная — м/с, угловая — рад/с. toolFrame — оси инструмента,
+    // иначе base_link. Нулевая скорость останавливает jog.
+    void setVelocity(const std::array<double, 3>& linear, const std::array<double, 3>& angular, bool toolFrame);
+    void stop();
+    bool isActive() const { return m_active; }
+
+    void setIkOptions(const IkOptions& options) { m_options = options; }
+    const IkResult& lastResult() const { return m_lastResult; }
+
+    static constexpr int RATE_HZ = 25;
+
+signals:
+    void activeChanged(bool active);
+    void limited(const QString& reason);
+
+private slots:
+    void onTick();
+
+private:
+    bool begin();
+    void refreshLimits();
+    QString readyError(const ArmState& state) const;
+
+    ArmController* m_armController;
+    ArmIkSolver m_solver;
+    IkOptions m_options;
+    IkResult m_lastResult;
+
+    QTimer* m_timer;
+    QElapsedTimer m_clock;
+    qint64 m_lastTickNs = 0;
+
+    RigidTransform m_target;
+    JointVector m_command{};        // Последнее отправленное решение
+    std::array<double, 3> m_linear{};
+    std::array<double, 3> m_angular{};
+    bool m_toolFrame = false;
+    bool m_active = false;
+
+    static constexpr double LIMIT_BUFFER_DEG = 2.0;       // Запас до лимитов калибровки
+    static constexpr double MAX_JOINT_STEP_DEG = 6.0;     // Больший скачок за тик — сингулярность
+};
+
+#endif // CARTESIAN_JOG_H
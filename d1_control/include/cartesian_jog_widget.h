@@ -0,0 +1,47 @@
+#ifndef CARTESIAN_JOG_WIDGET_H
+#define CARTESIAN_JOG_WIDGET_H
+
+#include <QGroupBox>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QCheckBox>
+#include <QLabel>
+#include <array>
+
+#include "cartesian_jog.h"
+
+// Панель декартова jog: кнопки X/Y/Z и Roll/Pitch/Yaw в обе стороны —
+// движение, пока кнопка нажата
+class CartesianJogWidget : public QGroupBox {
+    Q_OBJECT
+
+public:
+    explicit CartesianJogWidget(CartesianJogController* controller, QWidget* parent = nullptr);
+    ~CartesianJogWidget() = default;
+
+public slots:
+    void stopJog();
+
+private slots:
+    void onActiveChanged(bool active);
+    void onLimited(const QString& reason);
+
+private:
+    void setupUi();
+    void startAxis(int axis, int direction);
+    void releaseAxis(int axis);
+
+    CartesianJogController* m_controller;
+
+    // Оси 0–2 — X/Y/Z, 3–5 — Roll/Pitch/Yaw; [ось][0] — "−", [ось][1] — "+"
+    std::array<std::array<QPushButton*, 2>, 6> m_axisButtons;
+    QSpinBox* m_linearSpeedSpin;
+    QSpinBox* m_angularSpeedSpin;
+    QCheckBox* m_toolFrameCheck;
+    QLabel* m_statusLabel;
+
+    int m_activeAxis = -1;
+    bool m_limited = false;     // В строке статуса — причина остановки
+};
+
+#endif // CARTESIAN_JOG_WIDGET_H
@@ -0,0 +1,134 @@
+#ifndef COLLISION_CHECKER_H
+#define COLLISION_CHECKER_H
+
+#include <QString>
+#include <QVector>
+#include <array>
+#include <vector>
+#include "arm_kinematics.h"
+
+// Препятствие окружения: прямоугольный параллелепипед в осях base_link, метры
+struct CollisionObstacle {
+    QString name;
+    std::array<double, 3> center{};
+    std::array<double, 3> halfSize{};
+};
+
+// Окружение и допуски проверки (Collision/* в настройках)
+struct CollisionConfig {
+    bool enabled = true;
+    double clearanceM = 0.005;      // Минимальный зазор между телами
+    bool floorEnabled = true;       // Плоскость стола z = floorHeightM
+    double floorHeightM = 0.0;
+    QVector<CollisionObstacle> obstacles;
+};
+
+// Результат проверки: первое найденное столкновение
+struct CollisionReport {
+    bool collision = false;
+    int bodyA = -1;
+    int bodyB = -1;                 // -1 — окружение (obstacle)
+    int obstacle = -1;              // -1 — плоскость стола
+    int segment = -1;               // Отрезок пути (isPathFree)
+    double fraction = 0.0;          // Положение на отрезке, 0..1
+    double distanceM = 0.0;
+    JointVector anglesDeg{};
+};
+
+// Проверка самостолкновений руки и столкновений с окружением по мешам URDF.
+//
+// При загрузке для каждого звена из d1_description/meshes/*.STL строится
+// выпуклая оболочка: вершины меша, крайние в одном из 256 направлений
+// (сфера Фибоначчи), и описанная сфера. Такая оболочка вписана в настоящую,
+// поэтому зазоры уменьшаются на наибольшее удаление вершин меша от неё.
+// Проверка пары — сначала сферы, затем расстояние GJK между оболочками
+// (опорная функция перебирает до 256 вершин, без выделения памяти). Пары
+// соседних звеньев и пары, касающиеся уже в нулевой позе, не проверяются;
+// так же — тела, лежащие на столе в нулевой позе (основание).
+//
+// Отрезок пути проверяется консервативным продвижением: по зазору d в
+// текущей позе и верхней оценке скорости точек (плечо каждого сустава)
+// следующий шаг берётся таким, чтобы тела не могли сблизиться больше чем
+// на d − clearance; касание раздутых оболочек между выборками не
+// пропускается. Путь из нескольких отрезков делится между всеми ядрами.
+//
+// Все методы проверки — const и без общего изменяемого состояния:
+// их можно вызывать из нескольких потоков.
+class CollisionChecker {
+public:
+    // Каталог d1_description: D1_DESCRIPTION_DIR из окружения, установленный
+    // рядом с программой (../share/d1_control) или в дереве исходников
+    static QString defaultDescriptionDir();
+
+    bool load(const ArmKinematics& kinematics, const QString& descriptionDir = defaultDescriptionDir(),
+              QString* error = nullptr);
+    bool isLoaded() const { return m_kinematics != nullptr; }
+
+    void setConfig(const CollisionConfig& config);
+    const CollisionConfig& config() const { return m_config; }
+    // Загружена и включена
+    bool isActive() const { return isLoaded() && m_config.enabled; }
+
+    bool isPoseFree(const JointVector& anglesDeg, CollisionReport* report = nullptr) const;
+    bool isSegmentFree(const JointVector& fromDeg, const JointVector& toDeg,
+                       CollisionReport* report = nullptr) const;
+    // Ломаная через waypoints; threads = 0 — по числу ядер
+    bool isPathFree(const std::vector<JointVector>& waypoints, CollisionReport* report = nullptr,
+                    int threads = 0) const;
+
+    // Наименьший зазор в позе (до clearance + 1 м), метры
+    double clearance(const JointVector& anglesDeg, CollisionReport* report = nullptr) const;
+
+    int bodyCount() const { return static_cast<int>(m_bodies.size()); }
+    QString bodyName(int body) const { return m_bodies[body].name; }
+    int checkedPairs() const { return static_cast<int>(m_pairs.size()); }
+    QString describe(const CollisionReport& report) const;
+
+private:
+    using Vector3 = std::array<double, 3>;
+    static constexpr int MAX_BODIES = 16;
+
+    struct Body {
+        QString name;
+        int link = 0;                   // Кадр ArmKinematics: 0 — base_link, j — после Jj
+        RigidTransform offset;          // Меш в системе кадра
+        std::vector<Vector3> vertices;  // Вершины оболочки в системе меша
+        double margin = 0.0;            // Насколько меш выступает за оболочку, м
+        Vector3 center{};               // Описанная сфера в системе меша
+        double radius = 0.0;
+        double homeFloorDistance = 0.0; // Зазор до плоскости z = 0 в нулевой позе
+        bool checkFloor = true;
+    };
+
+    struct BodyPair {
+        int a;
+        int b;
+        double homeDistance;            // Зазор в нулевой позе
+    };
+
+    // Тела в мировой системе для одной позы
+    struct Placement {
+        std::array<RigidTransform, MAX_BODIES> transforms;
+        std::array<Vector3, MAX_BODIES> centers;
+    };
+
+    void place(const JointVector& anglesDeg, Placement& placement) const;
+    // Зазор между телами (или телом и препятствием); при зазоре не меньше
+    // stopAbove возвращает нижнюю оценку не меньше stopAbove
+    double bodyDistance(const Placement& placement, int a, int b, double stopAbove) const;
+    double obstacleDistance(const Placement& placement, int body, int obstacle, double stopAbove) const;
+    double floorDistance(const Placement& placement, int body) const;
+    // Наименьший зазор в позе, но не больше cap; выход на первом зазоре меньше stopBelow
+    double poseClearance(const Placement& placement, double cap, double stopBelow, CollisionReport* report) const;
+    bool segmentFree(const JointVector& from, const JointVector& to, CollisionReport* report) const;
+
+    const ArmKinematics* m_kinematics = nullptr;
+    std::vector<Body> m_bodies;
+    std::vector<BodyPair> m_allPairs;   // Несоседние пары тел
+    std::vector<BodyPair> m_pairs;      // Проверяемые при текущем зазоре
+    std::array<double, KINEMATIC_JOINTS> m_leverM{};    // Плечо сустава до самой дальней точки
+    std::vector<std::array<Vector3, 8>> m_obstacleVertices;
+    CollisionConfig m_config;
+};
+
+#endif // COLLISION_CHECKER_H
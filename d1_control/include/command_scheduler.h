@@ -0,0 +1,179 @@
+#ifndef COMMAND_SCHEDULER_H
+#define COMMAND_SCHEDULER_H
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "latency_monitor.h"
+
+// Полосы приоритета: команды с одним сроком выполняются от важной к менее важной
+enum class CommandLane : uint8_t {
+    Safety = 0,   // Аварийная остановка
+    Power,        // Включение, отключение, сброс ошибок
+    Motion,       // Команды движения суставов
+    Ui,           // Отложенные действия интерфейса (дросселирование слайдеров)
+    Count
+};
+
+// Дескриптор запланированной команды: индекс ячейки и её поколение.
+// 0 — недействительный; устаревший дескриптор безопасно игнорируется.
+using CommandHandle = uint64_t;
+
+// Группа для отмены пачкой (0 — без группы)
+using CommandGroup = uint32_t;
+
+// Замыкание во встроенном буфере: планирование команды не обращается к куче
+class InlineTask {
+public:
+    static constexpr size_t CAPACITY = 144;
+
+    InlineTask() = default;
+    ~InlineTask() { reset(); }
+    InlineTask(const InlineTask&) = delete;
+    InlineTask& operator=(const InlineTask&) = delete;
+
+    template <typename F>
+    void assign(F&& function) {
+        using Fn = typename std::decay<F>::type;
+        static_assert(sizeof(Fn) <= CAPACITY, "Замыкание команды не помещается в InlineTask");
+        static_assert(alignof(Fn) <= alignof(std::max_align_t), "Слишком строгое выравнивание замыкания");
+        reset();
+        new (m_storage) Fn(std::forward<F>(function));
+        m_invoke = [](void* p) { (*static_cast<Fn*>(p))(); };
+        m_destroy = [](void* p) { static_cast<Fn*>(p)->~Fn(); };
+    }
+
+    void operator()() { m_invoke(m_storage); }
+
+    void reset() {
+        if (m_destroy) {
+            m_destroy(m_storage);
+            m_invoke = nullptr;
+            m_destroy = nullptr;
+        }
+    }
+
+private:
+    alignas(std::max_align_t) unsigned char m_storage[CAPACITY];
+    void (*m_invoke)(void*) = nullptr;
+    void (*m_destroy)(void*) = nullptr;
+};
+
+// Планировщик отложенных команд GUI.
+//
+// Вместо QTimer::singleShot на каждую команду (объект таймера и событие в
+// очереди Qt на каждую лямбду) — хешированное колесо таймеров с шагом 1 мс,
+// пул ячеек фиксированного размера и один QTimer, взведённый на ближайший срок.
+// Команды с одним сроком выполняются по полосам (Safety > Power > Motion > Ui),
+// внутри полосы — в порядке планирования. Отмена — по дескриптору, группе или
+// полосе; по каждой полосе копятся опоздание запуска и время выполнения.
+//
+// Только поток GUI (владелец объекта).
+class CommandScheduler : public QObject {
+    Q_OBJECT
+
+public:
+    struct LaneStats {
+        uint64_t scheduled = 0;
+        uint64_t executed = 0;
+        uint64_t cancelled = 0;
+        uint64_t dropped = 0;          // Пул заполнен — команда не запланирована
+        LatencyHistogram lateness;     // Фактический запуск минус срок
+        LatencyHistogram runtime;      // Время выполнения замыкания
+    };
+
+    explicit CommandScheduler(QObject* parent = nullptr);
+    ~CommandScheduler();
+
+    // Выполнить task через delayMs (0 — на ближайшем проходе цикла событий).
+    // name — строковый литерал для отчёта о медленных командах.
+    template <typename F>
+    CommandHandle schedule(int delayMs, CommandLane lane, CommandGroup group, const char* name, F&& task) {
+        int32_t index = acquire(delayMs, lane, group, name);
+        if (index < 0) {
+            return 0;
+        }
+        m_entries[index].task.assign(std::forward<F>(task));
+        return makeHandle(index);
+    }
+
+    bool cancel(CommandHandle handle);
+    int cancelGroup(CommandGroup group);
+    int cancelLane(CommandLane lane);
+    int cancelAll();
+
+    bool isPending(CommandHandle handle) const;
+    int pendingCount() const { return m_pending; }
+
+    const LaneStats& laneStats(CommandLane lane) const { return m_stats[static_cast<size_t>(lane)]; }
+    void resetStats();
+    QString report() const;
+
+    static QString laneName(CommandLane lane);
+
+    static constexpr int TICK_MS = 1;
+    static constexpr int WHEEL_SLOTS = 256;          // Один оборот — 256 мс
+    static constexpr int CAPACITY = 512;             // Команд в полёте одновременно
+    static constexpr uint64_t SLOW_TASK_NS = 5000000ULL;
+
+private slots:
+    void dispatch();
+
+private:
+    enum class EntryState : uint8_t {
+        Free,
+        Scheduled,   // В колесе
+        Due,         // Срок наступил, ждёт запуска в текущем проходе
+        Running
+    };
+
+    struct Entry {
+        InlineTask task;
+        uint64_t deadlineTick = 0;
+        uint64_t deadlineNs = 0;
+        uint64_t order = 0;
+        uint32_t generation = 1;
+        int32_t prev = -1;
+        int32_t next = -1;
+        CommandGroup group = 0;
+        CommandLane lane = CommandLane::Motion;
+        EntryState state = EntryState::Free;
+        const char* name = "";
+    };
+
+    int32_t acquire(int delayMs, CommandLane lane, CommandGroup group, const char* name);
+    void link(int32_t index);
+    void unlink(int32_t index);
+    void release(int32_t index);
+    bool cancelIndex(int32_t index);
+    void rearm();
+    uint64_t currentTick() const;
+    int32_t indexOf(CommandHandle handle) const;
+    CommandHandle makeHandle(int32_t index) const {
+        return (static_cast<uint64_t>(m_entries[index].generation) << 32) | static_cast<uint32_t>(index + 1);
+    }
+
+    std::unique_ptr<Entry[]> m_entries;
+    std::vector<int32_t> m_freeList;
+    std::array<int32_t, WHEEL_SLOTS> m_slots;
+    std::vector<CommandHandle> m_due;
+    std::array<LaneStats, static_cast<size_t>(CommandLane::Count)> m_stats;
+
+    QTimer* m_timer;
+    uint64_t m_originNs;
+    uint64_t m_nextTick = 0;       // Первый ещё не обработанный тик колеса
+    uint64_t m_armedTick = 0;      // На какой тик взведён m_timer
+    uint64_t m_order = 0;
+    int m_pending = 0;             // Ячейки в колесе
+    bool m_dispatching = false;
+};
+
+#endif // COMMAND_SCHEDULER_H
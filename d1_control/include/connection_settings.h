@@ -25,6 +25,7 @@ struct ConnectionSettings {
     QString networkInterface = "auto";
     int ddsPort = 7400;
     QString udpRelayPath;
+    QString transport = "auto";   // auto | udp | inprocess (применяется при запуске)
     
     void save();
     void load();
@@ -66,6 +67,7 @@ private:
     QComboBox* m_interfaceCombo;
     QSpinBox* m_ddsPortSpin;
     QLineEdit* m_relayPathEdit;
+    QComboBox* m_transportCombo;
     QPushButton* m_browseBtn;
     
     QPushButton* m_pingBtn;
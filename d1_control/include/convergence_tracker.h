@@ -0,0 +1,81 @@
+#ifndef CONVERGENCE_TRACKER_H
+#define CONVERGENCE_TRACKER_H
+
+#include <cstdint>
+#include <vector>
+#include "arm_state.h"
+#include "joint_trajectory.h"
+
+// Условия "рука пришла в цель"
+struct ConvergenceOptions {
+    double toleranceDeg = 1.0;              // Допуск по каждому суставу маски
+    double settleVelocityDegPerSec = 2.0;   // Скорость, ниже которой сустав считается остановившимся
+    int settleMs = 100;                     // Сколько рука должна стоять в допуске; 0 — достаточно попасть в допуск
+    double timeoutFactor = 1.5;             // Таймаут = ожидаемое время * factor + margin
+    int timeoutMarginMs = 1000;
+    uint32_t jointMask = 0x3F;              // J1–J6; грипер может упереться в предмет и по умолчанию не ждём
+};
+
+// Итог ожидания цели
+struct ConvergenceEvent {
+    enum Kind {
+        Reached,
+        TimedOut,
+        Aborted     // Аварийная остановка, потеря связи, отключение моторов
+    };
+
+    uint64_t handle = 0;
+    Kind kind = Reached;
+    int elapsedMs = 0;
+    int worstJoint = -1;           // Сустав с наибольшим отклонением при последней проверке
+    double worstErrorDeg = 0.0;
+};
+
+// Ожидание прихода руки в заданные углы по feedback вместо фиксированных пауз.
+//
+// Цель достигнута, когда все суставы маски в допуске и (при settleMs > 0)
+// остаются в нём с малой скоростью не меньше settleMs. Проверяется на каждом
+// снимке состояния; не достигнутая к таймауту цель завершается TimedOut.
+// Завершённая цель удаляется, повторно о ней не сообщается.
+//
+// Не потокобезопасен: принадлежит потоку GUI (ArmController).
+class ConvergenceTracker {
+public:
+    // Возвращает дескриптор цели (не 0)
+    uint64_t add(const JointVector& targets, int expectedMs, const ConvergenceOptions& options, uint64_t nowNs);
+
+    // Отмена без события; false — цель уже завершена
+    bool cancel(uint64_t handle);
+    void clear();
+
+    bool isPending(uint64_t handle) const;
+    int pendingCount() const { return static_cast<int>(m_targets.size()); }
+
+    // Проверка целей по снимку состояния; завершённые — в конец events
+    void update(const ArmState& state, uint64_t nowNs, std::vector<ConvergenceEvent>& events);
+
+    // Только таймауты (feedback не приходит)
+    void checkTimeouts(uint64_t nowNs, std::vector<ConvergenceEvent>& events);
+
+    // Завершить все цели с Aborted
+    void abortAll(uint64_t nowNs, std::vector<ConvergenceEvent>& events);
+
+private:
+    struct Target {
+        uint64_t handle = 0;
+        JointVector angles{};
+        ConvergenceOptions options;
+        uint64_t startNs = 0;
+        uint64_t deadlineNs = 0;
+        uint64_t settledSinceNs = 0;   // 0 — сейчас не в допуске
+        int worstJoint = -1;
+        double worstErrorDeg = 0.0;
+    };
+
+    static ConvergenceEvent makeEvent(const Target& target, ConvergenceEvent::Kind kind, uint64_t nowNs);
+
+    std::vector<Target> m_targets;
+    uint64_t m_nextHandle = 1;
+};
+
+#endif // CONVERGENCE_TRACKER_H
@@ -0,0 +1,78 @@
+#ifndef FEEDBACK_RECORDING_H
+#define FEEDBACK_RECORDING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "arm_state.h"
+
+// Выборка feedback в записи: метка времени источника и углы как в протоколе
+struct RecordedSample {
+    uint64_t timestampNs = 0;
+    float angles[NUM_JOINTS] = {};
+};
+
+// Буфер записи движения по feedback.
+//
+// Память выделяется один раз в reserve() (и сразу заполняется, чтобы поток
+// приёма не ловил page fault на первой записи в страницу). append() — копия
+// в следующий слот и один атомарный store: ни выделений, ни блокировок.
+// Писатель один — поток приёма FeedbackWorker, читатель — поток GUI: size()
+// можно читать во время записи, выборки — после FeedbackWorker::stopRecording().
+//
+// Метка — время callback DDS, если relay его передаёт, иначе время приёма;
+// источник выбирается по первой выборке и дальше не меняется. Выборки без
+// метки этого источника, с меткой не позже предыдущей и сверх ёмкости
+// отбрасываются и считаются в dropped().
+//
+// По UDP сюда попадает каждая выборка relay. Shm и встроенное ядро отдают
+// снимок с одной последней выборкой: записываются только прочитанные
+// снимки, промежуточные выборки relay перезаписывает до чтения (их число —
+// LatencyMonitor::coalescedCount()). Запись по-прежнему идёт с меткой
+// источника, но шаг между выборками может быть неравномерным.
+class FeedbackRecording {
+public:
+    // Поток GUI, пока буфер не подключён к потоку приёма
+    void reserve(size_t capacity);
+    void clear();
+
+    // Поток приёма
+    void append(uint64_t sourceNs, uint64_t receiveNs, const float* angles) {
+        const size_t count = m_count.load(std::memory_order_relaxed);
+        if (count == 0) {
+            m_sourceClock = sourceNs != 0;
+        }
+        const uint64_t timestampNs = m_sourceClock ? sourceNs : receiveNs;
+        if (count >= m_samples.size() || timestampNs == 0
+            || (count > 0 && timestampNs <= m_samples[count - 1].timestampNs)) {
+            m_dropped.store(m_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return;
+        }
+        RecordedSample& sample = m_samples[count];
+        sample.timestampNs = timestampNs;
+        for (int i = 0; i < NUM_JOINTS; ++i) {
+            sample.angles[i] = angles[i];
+        }
+        m_count.store(count + 1, std::memory_order_release);
+    }
+
+    // Любой поток
+    size_t size() const { return m_count.load(std::memory_order_acquire); }
+    size_t capacity() const { return m_samples.size(); }
+    bool isFull() const { return size() >= capacity(); }
+    uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+    // Между первой и последней выборкой
+    double durationSec() const;
+
+    const RecordedSample& sample(size_t index) const { return m_samples[index]; }
+    bool usesSourceClock() const { return m_sourceClock; }
+
+private:
+    std::vector<RecordedSample> m_samples;
+    std::atomic<size_t> m_count{0};
+    std::atomic<uint64_t> m_dropped{0};
+    bool m_sourceClock = false;     // Только поток приёма (до stopRecording)
+};
+
+#endif // FEEDBACK_RECORDING_H
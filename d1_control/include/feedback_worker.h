@@ -0,0 +1,158 @@
+#ifndef FEEDBACK_WORKER_H
+#define FEEDBACK_WORKER_H
+
+#include <QObject>
+#include <QSocketNotifier>
+#include <QString>
+#include <QThread>
+#include <QTimer>
+#include <QUdpSocket>
+#include <array>
+#include <atomic>
+#include "arm_kinematics.h"
+#include "arm_state.h"
+#include "feedback_recording.h"
+#include "d1_protocol.h"
+#include "joint_motion_estimator.h"
+#include "seqlock.h"
+
+class LatencyMonitor;
+
+// Проба рассинхронизации старта: время команды и время начала движения по суставам
+struct SkewProbe {
+    bool active = false;
+    bool synchronized = false;
+    uint64_t commandNs = 0;
+    double thresholdDeg = 0.3;
+    uint64_t timeoutNs = 3000000000ULL;
+    std::array<double, NUM_JOINTS> startAngles{};
+    std::array<bool, NUM_JOINTS> expected{};
+    std::array<uint64_t, NUM_JOINTS> startNs{};
+};
+
+// Как поток приёма узнаёт о новом снимке (shm / встроенное ядро)
+enum class SnapshotWake {
+    Poll,       // Опрос каждые SNAPSHOT_POLL_MS (relay без пробуждений)
+    Socket,     // Датаграмма на дескриптор от ShmChannel::claimWaiter()
+    Call        // wakeSnapshot() из потока писателя
+};
+
+// Приём feedback в отдельном потоке.
+//
+// Сокет UDP и опрос снимка (shm / встроенное ядро) живут в собственном потоке,
+// поэтому разбор выборок и учёт задержек не конкурируют с отрисовкой виджетов.
+// Состояние публикуется через seqlock (state() читается из любого потока без
+// блокировок), а GUI получает stateAvailable() не чаще NOTIFY_RATE_HZ и не более
+// одного в очереди: пропущенные промежуточные выборки уже есть в снимке.
+//
+// Публичные методы вызываются из потока GUI и выполняются в потоке приёма.
+class FeedbackWorker : public QObject {
+    Q_OBJECT
+
+public:
+    explicit FeedbackWorker(LatencyMonitor* latencyMonitor);
+    ~FeedbackWorker();
+
+    // Прямая кинематика на каждой выборке; задаётся до start(), объект живёт дольше воркера
+    void setKinematics(const ArmKinematics* kinematics) { m_kinematics = kinematics; }
+
+    // Поток создаётся и останавливается вместе с объектом
+    void start();
+    void stop();
+
+    // Любой поток: полный согласованный снимок (seqlock) или статус одним атомиком
+    ArmState state() const { return m_published.load(); }
+    ArmStatus status() const { return unpackArmStatus(m_status.load(std::memory_order_acquire)); }
+    uint32_t stateVersion() const { return m_published.version(); }
+    quint16 udpPort() const { return m_udpPort.load(std::memory_order_acquire); }
+
+    // GUI забрал уведомление (вызывать до чтения state()): следующая выборка поставит новое
+    void acknowledgeNotification() { m_notifyQueued.store(false); }
+
+    // Привязка сокета feedback: сначала preferredPort, при занятости — свободный порт.
+    // Блокирует вызывающего до завершения в потоке приёма.
+    bool bindUdp(quint16 preferredPort, QString* error);
+    void closeUdp();
+
+    // Чтение снимка под seqlock по пробуждению от писателя; таймер остаётся
+    // страховкой. stopSnapshot() возвращается, когда поток приёма
+    // гарантированно больше не читает снимок и дескриптор (можно закрывать shm).
+    void startSnapshot(const d1::SeqLock<d1::FeedbackSample>* snapshot,
+                       SnapshotWake wake = SnapshotWake::Poll, int wakeupFd = -1);
+    void stopSnapshot();
+    // Любой поток (SnapshotWake::Call): в очереди не больше одного пробуждения
+    void wakeSnapshot();
+
+    // Каждая принятая выборка — в буфер записи (в потоке приёма, без выделения
+    // памяти). stopRecording() возвращается, когда поток приёма больше не
+    // пишет в буфер (можно читать выборки).
+    void startRecording(FeedbackRecording* recording);
+    void stopRecording();
+
+    void resetErrorStatus();
+    void setMotionEstimatorConfig(const MotionEstimatorConfig& config);
+    void startSkewProbe(const SkewProbe& probe);
+    void cancelSkewProbe();
+
+    static constexpr int NOTIFY_RATE_HZ = 60;
+    static constexpr int SNAPSHOT_POLL_MS = 1;
+    static constexpr int SNAPSHOT_SAFETY_POLL_MS = 50;   // При пробуждениях от писателя
+    static constexpr int WATCHDOG_MS = 500;
+    static constexpr uint64_t CONNECTION_TIMEOUT_MS = 2000;  // 2 секунды для быстрого обнаружения
+
+signals:
+    void stateAvailable();
+    void connectionChanged(bool connected);
+    void powerStatusChanged(int powerStatus);
+    void errorStatusChanged(int errorStatus);
+    void skewMeasured(double skewMs, bool synchronized);
+
+private slots:
+    void onReadyRead();
+    void pollSnapshot();
+    void onSnapshotWakeup();
+    void checkTimeout();
+    void notifyNow();
+
+private:
+    template <typename F>
+    void runBlocking(F&& function);
+
+    bool bindUdpInThread(quint16 preferredPort, QString* error);
+    bool parseJson(const char* data, qint64 size, d1::FeedbackSample& sample) const;
+    void ingest(const d1::FeedbackSample& sample, bool fromSnapshot = false);
+    void updateSkewProbe(const d1::FeedbackSample& sample, uint64_t nowNs);
+    void scheduleNotify();
+    void publish();
+    void releaseSnapshotWakeup();
+
+    QThread m_thread;
+    LatencyMonitor* m_latencyMonitor;
+
+    // Только поток приёма
+    QUdpSocket* m_socket;
+    QTimer* m_snapshotTimer;
+    QTimer* m_watchdogTimer;
+    QTimer* m_notifyTimer;
+    const d1::SeqLock<d1::FeedbackSample>* m_snapshot = nullptr;
+    QSocketNotifier* m_wakeupNotifier = nullptr;
+    int m_wakeupFd = -1;
+    uint32_t m_snapshotLastVersion = 0;
+    ArmState m_working;
+    JointMotionEstimator m_estimator;
+    const ArmKinematics* m_kinematics = nullptr;
+    bool m_estimatorDdsClock = false;   // Метки DDS relay или (старый relay) время приёма
+    SkewProbe m_skewProbe;
+    FeedbackRecording* m_recording = nullptr;
+    uint64_t m_lastNotifyNs = 0;
+    char m_datagram[2048];
+
+    // Снимок для остальных потоков
+    d1::SeqLock<ArmState> m_published;
+    std::atomic<uint64_t> m_status{0};
+    std::atomic<bool> m_notifyQueued{false};
+    std::atomic<bool> m_snapshotWakeQueued{false};
+    std::atomic<quint16> m_udpPort{0};
+};
+
+#endif // FEEDBACK_WORKER_H
@@ -0,0 +1,52 @@
+#ifndef JOINT_MOTION_ESTIMATOR_H
+#define JOINT_MOTION_ESTIMATOR_H
+
+#include <array>
+#include <cstdint>
+#include "arm_state.h"
+
+// Коэффициенты фильтра α-β-γ (одни на все суставы).
+// Больше alpha/beta — быстрее реакция, больше шум скорости и ускорения.
+struct MotionEstimatorConfig {
+    double alpha = 0.5;        // Коррекция угла
+    double beta = 0.2;         // Коррекция скорости
+    double gamma = 0.02;       // Коррекция ускорения
+    double maxGapMs = 250.0;   // Перерыв в feedback длиннее — фильтр начинается заново
+};
+
+// Оценка скорости и ускорения суставов по потоку feedback.
+//
+// Фильтр α-β-γ на каждый сустав: прогноз угла по прошлой скорости и ускорению,
+// коррекция по невязке с измерением. Шаг времени — по меткам самих выборок
+// (время DDS в relay), а не по времени приёма, поэтому пачки датаграмм и
+// опоздавший поток GUI не дают ложных скачков скорости. Состояние — массивы
+// фиксированного размера, update() не выделяет память.
+//
+// Не потокобезопасен: принадлежит потоку приёма feedback.
+class JointMotionEstimator {
+public:
+    JointMotionEstimator() = default;
+
+    void setConfig(const MotionEstimatorConfig& config);
+    const MotionEstimatorConfig& config() const { return m_config; }
+
+    // Сброс: следующая выборка становится начальной (скорость и ускорение — ноль)
+    void reset();
+
+    // Новая выборка углов (градусы) с меткой времени; результат — в joints[i]
+    // (velocity, °/с; acceleration, °/с²). Повтор метки времени пропускается.
+    void update(const float* angles, uint64_t timestampNs,
+                std::array<JointState, NUM_JOINTS>& joints);
+
+    bool isInitialized() const { return m_initialized; }
+
+private:
+    MotionEstimatorConfig m_config;
+    bool m_initialized = false;
+    uint64_t m_lastTimestampNs = 0;
+    std::array<double, NUM_JOINTS> m_angle{};
+    std::array<double, NUM_JOINTS> m_velocity{};
+    std::array<double, NUM_JOINTS> m_acceleration{};
+};
+
+#endif // JOINT_MOTION_ESTIMATOR_H
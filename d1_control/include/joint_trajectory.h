@@ -0,0 +1,98 @@
+#ifndef JOINT_TRAJECTORY_H
+#define JOINT_TRAJECTORY_H
+
+#include <array>
+#include <vector>
+#include "arm_state.h"
+
+using JointVector = std::array<double, NUM_JOINTS>;
+
+// Лимиты движения суставов: °/с, °/с², °/с³ (у грипера — те же единицы, что
+// у его положения); ноль или меньше — без ограничения
+struct MotionLimits {
+    JointVector velocity{};
+    JointVector acceleration{};
+    JointVector jerk{};
+
+    // Те же лимиты при ускорении по времени в scale раз (v·k, a·k², j·k³)
+    MotionLimits scaled(double scale) const;
+};
+
+// Траектория в пространстве суставов, параметризованная временем.
+//
+// Точки задаются моментом времени и углами; между ними — квинтика Эрмита
+// с нулевым ускорением в точках. Ускорение поэтому непрерывно и на стыках
+// отрезков, и при трогании с места: рывок конечен везде, а не только внутри
+// отрезков. Скорость в промежуточной точке — наклон между соседями
+// (Catmull-Rom с неравномерным шагом), в точке разворота, точке остановки и
+// на концах — ноль, поэтому сплайн не выходит за экстремумы точек и рука не
+// останавливается на каждом промежуточном кадре. Угол в точке можно
+// скруглить (blendCorner): сплайн пройдёт рядом с ней, а не через неё.
+class JointTrajectory {
+public:
+    struct Waypoint {
+        double timeSec = 0.0;
+        JointVector angles{};
+        JointVector velocities{};   // Заполняется finalize()
+        bool stop = false;          // Скорость в точке — ноль (захват, установка)
+    };
+
+    void clear();
+
+    // Точки добавляются по возрастанию времени; совпадающее время заменяет точку
+    void addWaypoint(double timeSec, const JointVector& angles, bool stop = false);
+
+    // Вычисляет скорости в точках; вызывается после последнего addWaypoint()
+    void finalize();
+
+    bool isEmpty() const { return m_points.empty(); }
+    int waypointCount() const { return static_cast<int>(m_points.size()); }
+    const Waypoint& waypoint(int index) const { return m_points[index]; }
+    double durationSec() const { return m_points.empty() ? 0.0 : m_points.back().timeSec; }
+
+    // Углы в момент t (до начала — первая точка, после конца — последняя)
+    JointVector sample(double timeSec) const;
+
+    // Индекс отрезка, на котором лежит t (для прогресса по кадрам)
+    int segmentAt(double timeSec) const;
+
+    // Наибольшие |скорость|, |ускорение| и |рывок| каждого сустава. Экстремумы
+    // производных квинтики — корни квадратных уравнений, поэтому пики
+    // считаются точно, без выборки по времени.
+    void peaks(JointVector& velocity, JointVector& acceleration, JointVector& jerk) const;
+
+    // Новые времена точек (углы те же), при которых сплайн укладывается в
+    // лимиты всех суставов сразу. Отрезок без движения ни одного сустава
+    // (выдержка) сохраняет свою длительность. Прочие начинают с оценки |Δq|/v и
+    // удлиняют по превышению лимита (скорость ∝ 1/h, ускорение ∝ 1/h²,
+    // рывок ∝ 1/h³); скорости в соседних точках от этого меняются, поэтому
+    // проход повторяется. Если за MAX_RETIME_PASSES не сошлось — вся
+    // траектория растягивается равномерно до наибольшего превышения, что
+    // гарантирует лимиты. Это быстрая эвристика, а не оптимум по времени:
+    // форма сплайна фиксирована, а отрезки только удлиняются. Вызывает finalize().
+    void retime(const MotionLimits& limits);
+
+    // Переход из from в to за durationSec с нулевой скоростью на концах
+    static JointTrajectory pointToPoint(const JointVector& from, const JointVector& to, double durationSec);
+
+    // Скругление угла prev → corner → next: точки входа и выхода на отрезках
+    // в radiusDeg от corner по наибольшему из J1–J6 (доли отрезков — в
+    // entryFraction/exitFraction, не больше MAX_BLEND_FRACTION). Сплайн между
+    // ними монотонен по каждому суставу, поэтому отходит от corner не больше
+    // чем на radiusDeg; без скругления (radiusDeg ≤ 0) доли — ноль.
+    static void blendCorner(const JointVector& prev, const JointVector& corner, const JointVector& next,
+                            double radiusDeg, JointVector& entry, JointVector& exit,
+                            double& entryFraction, double& exitFraction);
+    static constexpr double MAX_BLEND_FRACTION = 0.4;  // Между скруглениями остаётся прямой участок
+
+private:
+    static constexpr int MAX_RETIME_PASSES = 50;
+    static constexpr double MIN_SEGMENT_SEC = 0.01;
+
+    // Во сколько раз надо удлинить отрезок index (≤ 1 — уже в лимитах)
+    double segmentExcess(int index, const MotionLimits& limits) const;
+
+    std::vector<Waypoint> m_points;
+};
+
+#endif // JOINT_TRAJECTORY_H
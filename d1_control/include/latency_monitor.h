@@ -0,0 +1,108 @@
+#ifndef LATENCY_MONITOR_H
+#define LATENCY_MONITOR_H
+
+#include <QMutex>
+#include <QString>
+#include <array>
+#include <cstdint>
+#include "d1_protocol.h"
+
+// Гистограмма задержек с логарифмическими корзинами (8 корзин на октаву, от 1 мкс).
+// Фиксированный размер, без аллокаций — запись дешевле одного qDebug.
+class LatencyHistogram {
+public:
+    void record(uint64_t ns);
+    void reset();
+
+    uint64_t count() const { return m_count; }
+    double percentileMs(double p) const;
+    double maxMs() const { return m_maxNs / 1e6; }
+    double meanMs() const { return m_count ? (m_sumNs / static_cast<double>(m_count)) / 1e6 : 0.0; }
+
+private:
+    static constexpr int SUB_BUCKETS = 8;
+    static constexpr int OCTAVES = 28;  // 1 мкс .. ~4.5 минуты
+    static constexpr int NUM_BUCKETS = SUB_BUCKETS * OCTAVES;
+
+    static int bucketIndex(uint64_t us);
+    static double bucketUpperUs(int index);
+
+    std::array<uint32_t, NUM_BUCKETS> m_buckets{};
+    uint64_t m_count = 0;
+    uint64_t m_maxNs = 0;
+    double m_sumNs = 0.0;
+};
+
+// Сквозные задержки контура управления.
+//
+// Времена DDS и отправки relay приходят в кадре feedback (CLOCK_MONOTONIC relay),
+// время приёма и отправки команды — monotonicNs() GUI. Relay работает на том же
+// хосте, поэтому разности имеют смысл; подозрительные значения отбрасываются.
+//
+// Разрыв seq — потеря только для UDP. Снимок (shm, встроенное ядро) хранит
+// одну последнюю выборку, и выборки между чтениями перезаписываются по
+// замыслу: такие разрывы считаются отдельно, как объединённые.
+class LatencyMonitor {
+public:
+    enum Stage {
+        DdsToRelaySend = 0,   // callback DDS -> отправка relay
+        RelaySendToGui,       // отправка relay -> приём GUI
+        DdsToGui,             // callback DDS -> приём GUI
+        CommandToMotion,      // отправка команды -> первое движение в feedback
+        StageCount
+    };
+
+    struct StageSummary {
+        uint64_t count = 0;
+        double p50Ms = 0.0;
+        double p99Ms = 0.0;
+        double maxMs = 0.0;
+    };
+
+    // Бюджет доставки feedback: один такт публикации команд relay
+    static constexpr double FEEDBACK_BUDGET_MS = 20.0;
+
+    // fromSnapshot — выборка прочитана из снимка, а не принята датаграммой
+    void recordFeedback(const d1::FeedbackSample& sample, uint64_t receiveNs, bool fromSnapshot = false);
+    void recordMotionCommand(uint64_t sendNs);
+    void reset();
+
+    StageSummary summary(Stage stage) const;
+    uint64_t receivedCount() const;
+    uint64_t lostCount() const;
+    uint64_t coalescedCount() const;
+    double lossRate() const;
+    double coalescedRate() const;
+    bool withinBudget() const;
+
+    QString shortSummary() const;
+    QString report() const;
+
+    static QString stageName(Stage stage);
+
+private:
+    static constexpr uint64_t MAX_PLAUSIBLE_NS = 10000000000ULL;  // 10 с
+    static constexpr uint64_t MOTION_TIMEOUT_NS = 3000000000ULL;  // 3 с
+    static constexpr float MOTION_THRESHOLD_DEG = 0.3f;
+
+    void recordStage(Stage stage, uint64_t fromNs, uint64_t toNs);
+
+    mutable QMutex m_mutex;
+    std::array<LatencyHistogram, StageCount> m_histograms;
+
+    // Потери (UDP) и объединения (снимок) по разрывам seq
+    bool m_haveSeq = false;
+    uint32_t m_lastSeq = 0;
+    uint64_t m_received = 0;
+    uint64_t m_lost = 0;
+    uint64_t m_coalesced = 0;
+
+    // Ожидание движения после команды
+    bool m_haveAngles = false;
+    float m_lastAngles[d1::PROTO_NUM_JOINTS] = {0, 0, 0, 0, 0, 0, 0};
+    bool m_motionPending = false;
+    uint64_t m_motionCommandNs = 0;
+    float m_motionStartAngles[d1::PROTO_NUM_JOINTS] = {0, 0, 0, 0, 0, 0, 0};
+};
+
+#endif // LATENCY_MONITOR_H
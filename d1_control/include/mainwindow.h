@@ -26,6 +26,7 @@
 #include "joint_widget.h"
 #include "status_widget.h"
 #include "pose_list_widget.h"
+#include "cartesian_jog_widget.h"
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -62,6 +63,8 @@ private slots:
     void onArmError(int errorCode, const QString& message);
     void onArmRecoveryStarted();
     void onArmRecoveryFinished(bool success);
+    void onArmTargetReached(quint64 handle, int elapsedMs);
+    void onArmTargetFailed(quint64 handle, bool timedOut, const QString& reason);
     
     // Обработка изменений от UI
     void onJointAngleRequested(int jointId, double angle);
@@ -96,6 +99,10 @@ private:
     
     // Расчёт времени движения на основе настроек
     int calculateMoveDelay(double angleDelta) const;
+    
+    // Панель суставов — только чтение, пока рука не придёт в цель (по feedback)
+    void lockPanelUntilArrival(quint64 targetHandle, const QString& description);
+    void unlockPanel();
 
     // Компоненты приложения
     ArmController* m_armController;
@@ -106,6 +113,7 @@ private:
     MotionManager* m_motionManager;
     MotionPlayer* m_motionPlayer;
     MotionRecorder* m_motionRecorder;
+    CartesianJogController* m_cartesianJog;
 
     // UI виджеты
     QTabWidget* m_tabWidget;
@@ -113,6 +121,7 @@ private:
     StatusWidget* m_statusWidget;
     PoseListWidget* m_poseListWidget;
     MotionWidget* m_motionWidget;
+    CartesianJogWidget* m_cartesianJogWidget;
     
     // Меню
     QMenu* m_fileMenu;
@@ -122,6 +131,7 @@ private:
     // Действия (горячие клавиши)
     QAction* m_emergencyAction;
     QAction* m_homeAction;
+    QAction* m_collisionAction;
     
     // Пути к файлам
     QString m_configPath;
@@ -130,14 +140,21 @@ private:
 
     // Таймер обновления UI
     QTimer* m_uiUpdateTimer;
+    uint32_t m_statusBarVersion = UINT32_MAX;  // Версия состояния в строке статуса
+    QTimer* m_latencyTimer;  // Сводка задержек раз в секунду
     
     // Дроссельование команд (throttling)
     std::array<qint64, 7> m_lastCommandTime = {0};
     std::array<double, 7> m_pendingAngle = {0};
     std::array<bool, 7> m_hasPendingCommand = {false};
+    std::array<CommandHandle, 7> m_pendingCommandHandle = {0};  // Отложенная отправка в планировщике
     std::array<double, 7> m_lastSentAngle = {0};  // Для отслеживания направления
     static constexpr int THROTTLE_MS = 120;  // Увеличено для защиты от дёрганий
     
+    // Ожидание прихода руки (домашняя позиция, поза)
+    quint64 m_panelTarget = 0;
+    QString m_panelTargetDescription;
+    
     // Настройки движения
     bool m_smoothMotionEnabled = true;
     int m_speedPercent = 50;  // 10-100%
@@ -0,0 +1,111 @@
+#ifndef MOTION_LIBRARY_H
+#define MOTION_LIBRARY_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+#include "motion_manager.h"
+
+// Двоичная библиотека движений (.d1ml).
+//
+// Заголовок, индекс (запись фиксированного размера на движение: имя,
+// описание, флаги, число кадров, длительность, смещение и CRC-32 блока),
+// строки UTF-8 и блоки кадров. Блок — столбцы (SoA): углы float32 по
+// суставам (сначала все кадры J1, затем J2, …), transitionMs int32,
+// blendRadiusDeg float32, stop по байту. float32 хранит угол до ~1e-5°.
+//
+// open() отображает файл в память (QFile::map) и проверяет только
+// заголовок и индекс (CRC-32 индекса и строк): список движений доступен
+// сразу, без разбора кадров. Кадры движения декодируются по запросу
+// (decodeKeyframes) с проверкой CRC-32 его блока; непрочитанный блок при
+// сохранении копируется в новый файл как есть (Source::block).
+//
+// Сохранение — в два шага: encode() собирает файл в памяти (блоки открытой
+// библиотеки копируются сюда), writeFile() записывает его через QSaveFile.
+// Между ними библиотеку, открытую из того же файла, нужно закрыть:
+// отображённый файл в Windows заменить нельзя. openData() открывает
+// библиотеку из уже собранного буфера.
+// Порядок байт — как у x86/ARM (little-endian).
+class MotionLibrary {
+public:
+    // Движение для записи: декодированное или блок открытой библиотеки
+    // (метаданные — из motion, кадры — из блока)
+    struct Source {
+        const Motion* motion = nullptr;
+        const MotionLibrary* library = nullptr;
+        int block = -1;
+    };
+
+    MotionLibrary() = default;
+    ~MotionLibrary();
+    MotionLibrary(const MotionLibrary&) = delete;
+    MotionLibrary& operator=(const MotionLibrary&) = delete;
+
+    // Файл начинается с сигнатуры библиотеки (иначе — JSON)
+    static bool isLibrary(const QByteArray& head);
+
+    bool open(const QString& path, QString* error = nullptr);
+    bool openData(const QByteArray& data, QString* error = nullptr);
+    void close();
+    bool isOpen() const { return m_header != nullptr; }
+    // Файл открытой библиотеки (пусто — открыта из буфера)
+    QString fileName() const { return m_mapped ? m_file.fileName() : QString(); }
+
+    int motionCount() const;
+    // Движение без кадров: имя, описание, флаги
+    Motion motionInfo(int index) const;
+    int keyframeCount(int index) const;
+    int durationMs(int index) const;
+    bool decodeKeyframes(int index, QVector<MotionKeyframe>& keyframes, QString* error = nullptr) const;
+
+    static bool encode(const QVector<Source>& motions, QByteArray& file, QString* error = nullptr);
+    static bool writeFile(const QString& path, const QByteArray& file, QString* error = nullptr);
+
+private:
+    static constexpr quint32 MAGIC = 0x4c4d3144;    // "D1ML"
+    static constexpr quint32 VERSION = 1;
+    static constexpr quint32 FLAG_LOOPING = 1;
+
+    struct Header {
+        quint32 magic;
+        quint32 version;
+        quint32 motionCount;
+        quint32 jointCount;
+        quint64 fileSize;
+        quint32 stringsSize;
+        quint32 indexChecksum;      // CRC-32 индекса и строк
+        quint32 reserved[4];
+    };
+
+    struct IndexEntry {
+        quint64 blockOffset;
+        quint32 blockSize;
+        quint32 blockChecksum;
+        quint32 keyframeCount;
+        quint32 durationMs;
+        quint32 nameOffset;         // В строках
+        quint32 nameSize;
+        quint32 descriptionOffset;
+        quint32 descriptionSize;
+        quint32 flags;
+        qint32 defaultSpeed;
+    };
+
+    static quint64 blockSize(quint32 keyframeCount);
+    static void encodeBlock(const QVector<MotionKeyframe>& keyframes, uchar* block);
+    bool attach(const uchar* data, qint64 size, QString* error);
+    QString string(quint32 offset, quint32 size) const;
+
+    QFile m_file;
+    uchar* m_mapped = nullptr;
+    QByteArray m_buffer;            // Данные openData()
+
+    const Header* m_header = nullptr;
+    const IndexEntry* m_index = nullptr;
+    const char* m_strings = nullptr;
+    const uchar* m_data = nullptr;
+};
+
+#endif // MOTION_LIBRARY_H
@@ -8,6 +8,7 @@
 #include <QJsonArray>
 #include <QJsonObject>
 #include <array>
+#include <memory>
 
 constexpr int MOTION_NUM_JOINTS = 7;
 
@@ -15,6 +16,10 @@ constexpr int MOTION_NUM_JOINTS = 7;
 struct MotionKeyframe {
     std::array<double, MOTION_NUM_JOINTS> jointAngles;  // Углы суставов
     int transitionMs;  // Время перехода к этому кадру (мс)
+    // Скругление: 0 — траектория проходит точно через кадр; больше нуля —
+    // срезает угол, отходя от кадра не дальше чем на столько градусов
+    double blendRadiusDeg = 0.0;
+    bool stop = false;  // Остановка в кадре (захват, установка детали)
     
     QJsonObject toJson() const;
     static MotionKeyframe fromJson(const QJsonObject& obj);
@@ -37,15 +42,32 @@ struct Motion {
     bool isEmpty() const { return keyframes.isEmpty(); }
 };
 
-// Менеджер движений (сохранение/загрузка)
+// Строка списка движений: без декодирования кадров
+struct MotionSummary {
+    QString name;
+    int keyframeCount = 0;
+    int durationMs = 0;
+    bool looping = true;
+};
+
+class MotionLibrary;
+
+// Менеджер движений (сохранение/загрузка).
+//
+// Файл по умолчанию — двоичная библиотека motions.d1ml (MotionLibrary):
+// при загрузке читается только индекс, кадры движения декодируются при
+// первом обращении к нему, а при сохранении непрочитанные движения
+// копируются блоками. JSON (прежний motions.json) остаётся для импорта и
+// экспорта; при отсутствии библиотеки он загружается вместо неё.
 class MotionManager : public QObject {
     Q_OBJECT
 
 public:
     explicit MotionManager(QObject* parent = nullptr);
-    ~MotionManager() = default;
+    ~MotionManager();
 
-    // Загрузка/сохранение файла
+    // Загрузка/сохранение файла: формат при загрузке — по содержимому,
+    // при сохранении — по расширению (.json — JSON, иначе библиотека)
     bool loadFromFile(const QString& filePath);
     bool saveToFile(const QString& filePath);
     
@@ -66,6 +88,7 @@ public:
     Motion getMotionByName(const QString& name) const;
     int getMotionCount() const;
     QVector<Motion> getAllMotions() const;
+    QVector<MotionSummary> getSummaries() const;
     QStringList getMotionNames() const;
     
     // Поиск
@@ -81,8 +104,20 @@ signals:
     void errorOccurred(const QString& message);
 
 private:
-    QVector<Motion> m_motions;
+    bool loadJson(const QByteArray& data);
+    bool saveJson(const QString& filePath);
+    bool loadLibrary(const QString& filePath);
+    bool saveLibrary(const QString& filePath);
+    // Движение с кадрами (декодирует блок библиотеки при первом обращении)
+    const Motion& motionAt(int index) const;
+
+    // Пока m_lazyBlocks[i] >= 0, у m_motions[i] нет кадров: они в этом
+    // блоке m_library (и остаются там, если блок повреждён)
+    mutable QVector<Motion> m_motions;
+    mutable QVector<int> m_lazyBlocks;
+    std::unique_ptr<MotionLibrary> m_library;
     QString m_defaultPath;
+    QString m_legacyJsonPath;
 };
 
 #endif // MOTION_MANAGER_H
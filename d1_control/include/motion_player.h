@@ -5,6 +5,7 @@
 #include <QTimer>
 #include "motion_manager.h"
 #include "arm_controller.h"
+#include "calibration_manager.h"
 
 // Плейер для воспроизведения движений
 class MotionPlayer : public QObject {
@@ -24,6 +25,27 @@ public:
     void setSpeed(int percent);  // 50-200%
     int getSpeed() const { return m_speed; }
     
+    // Потоковое воспроизведение: все кадры цикла — одна траектория, которую
+    // исполнитель ArmController проходит без остановок на кадрах (кроме
+    // кадров со stop); углы кадров с blendRadiusDeg срезаются. Циклическое
+    // движение разворачивается на несколько циклов подряд (до LOOP_BATCH_SEC),
+    // поэтому и на стыке циклов рука не останавливается.
+    // Выключено — прежний режим "команда на кадр".
+    void setStreamingEnabled(bool enabled);
+    bool isStreamingEnabled() const { return m_streamingEnabled; }
+    
+    // Времена переходов по пределам суставов (MotionLimits из калибровки)
+    // вместо записанных: JointTrajectory::retime() укладывает переход в
+    // пределы, но не ищет минимальное время. Скорость воспроизведения ниже
+    // 100% замедляет, выше — не превышает пределы. Выключено — времена из записи.
+    void setLimitTimingEnabled(bool enabled);
+    bool isLimitTimingEnabled() const { return m_limitTiming; }
+    void setMotionLimits(const MotionLimits& limits) { m_limits = limits; }
+    const MotionLimits& motionLimits() const { return m_limits; }
+    
+    // Длительность цикла каждого движения по записи и по пределам суставов (текст для окна)
+    QString durationReport(const QVector<Motion>& motions) const;
+    
     // Статус
     bool isPlaying() const { return m_isPlaying; }
     bool isPaused() const { return m_isPaused; }
@@ -44,15 +66,39 @@ signals:
 
 private slots:
     void onTimerTick();
+    void onStreamProgress();
+    void onTrajectoryFinished(quint64 trajectoryId, bool completed, const QString& reason);
+    void onTargetReached(quint64 handle, int elapsedMs);
+    void onTargetFailed(quint64 handle, bool timedOut, const QString& reason);
 
 private:
     void executeKeyframe(int index);
     void executeKeyframeSmooth(int index, bool isLoopTransition);  // Плавный переход для loop
     int adjustedTransitionTime(int originalMs) const;
-    int calculateTransitionTime(int targetIndex) const;  // Вычисление времени по угловому расстоянию
+    int calculateTransitionTime(int targetIndex) const;  // От текущего положения до кадра
+    // recordedMs — записанное время: в режиме пределов остаётся у кадра без движения (выдержка)
+    int transitionTimeMs(const JointVector& from, const JointVector& to, bool limitTiming, int recordedMs = 1000) const;
+    MotionLimits effectiveLimits() const;  // Пределы с учётом скорости воспроизведения
+    // Траектория от from через кадры fromKeyframe..конец и ещё cycles − 1
+    // полных циклов; keyframeSeq — для каждой точки номер кадра, к которому
+    // она относится (цикл · кадров + кадр), у первой точки — −1
+    JointTrajectory buildTrajectory(const Motion& motion, const JointVector& from, int fromKeyframe,
+                                    bool limitTiming, int cycles = 1,
+                                    std::vector<int>* keyframeSeq = nullptr) const;
+    bool checkArmReady();  // Аварийная остановка, связь, ошибки; иначе stop()
+    // Траектория от текущего положения через кадры fromKeyframe..конец.
+    // Blocked — траектория задевает препятствие: ошибка уже выдана, воспроизведение остановлено
+    enum class StreamStart { Started, Unavailable, Blocked };
+    StreamStart startStreamed(int fromKeyframe);
+    // Проверка столкновений до запуска; при столкновении — errorOccurred
+    bool isKeyframePathFree(const Motion& motion);  // Ломаная: текущая поза → кадры
+    bool isTrajectoryFree(const JointTrajectory& trajectory, const std::vector<int>& keyframeSeq);
+    void awaitKeyframe(const MotionKeyframe& keyframe, int transitionMs);  // Следующий кадр — по приходу
+    void cancelAwait();
 
     ArmController* m_armController;
     QTimer* m_playTimer;
+    QTimer* m_streamTimer;  // Прогресс и проверки при потоковом воспроизведении
     
     Motion m_currentMotion;
     int m_currentKeyframe = 0;
@@ -61,6 +107,24 @@ private:
     
     bool m_isPlaying = false;
     bool m_isPaused = false;
+    
+    bool m_limitTiming = true;
+    MotionLimits m_limits = CalibrationData().motionLimits();
+    
+    bool m_streamingEnabled = true;
+    bool m_streaming = false;             // Текущее воспроизведение идёт траекторией
+    quint64 m_trajectoryId = 0;
+    std::vector<int> m_waypointKeyframes; // Номер кадра каждой точки траектории (см. buildTrajectory)
+    int m_streamCycle = 0;                // Цикл внутри развёрнутой траектории
+    static constexpr double LOOP_BATCH_SEC = 300.0;
+    static constexpr int MAX_LOOP_BATCH = 200;
+    JointTrajectory m_trajectory;
+    static constexpr int STREAM_PROGRESS_MS = 100;
+    static constexpr double COLLISION_SAMPLE_SEC = 0.02;  // Шаг выборки траектории (такт уставок по умолчанию)
+    
+    // Покадровый режим: следующий кадр — когда рука пришла в текущий
+    quint64 m_targetHandle = 0;
+    static constexpr double ARRIVAL_TOLERANCE_DEG = 2.0;
 };
 
 #endif // MOTION_PLAYER_H
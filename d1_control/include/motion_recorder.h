@@ -6,8 +6,17 @@
 #include <QElapsedTimer>
 #include "motion_manager.h"
 #include "arm_controller.h"
+#include "feedback_recording.h"
+#include "motion_simplifier.h"
 
-// Рекордер для записи движений
+// Рекордер для записи движений.
+//
+// Автозахват по таймеру снимает getState() в потоке GUI, и подвисание
+// интерфейса искажает время кадров. В режиме записи по feedback (включён по
+// умолчанию, действует вместе с автозахватом) каждая выборка с меткой времени
+// источника пишется в потоке приёма в заранее выделенный буфер, а кадры
+// строятся из неё после остановки: все выборки, если запись упрощается,
+// иначе — не чаще интервала автозахвата. Таймер тогда только обновляет статус.
 class MotionRecorder : public QObject {
     Q_OBJECT
 
@@ -23,6 +32,17 @@ public:
     // Захват кадров
     void captureKeyframe();
     void setAutoCapture(bool enabled, int intervalMs = 200);
+    // Запись по feedback вместо таймера (применяется к следующей записи)
+    void setFeedbackCapture(bool enabled) { m_feedbackCapture = enabled; }
+    bool isFeedbackCapture() const { return m_feedbackCapture; }
+    // Идёт запись по feedback (ручной захват кадра не действует)
+    bool isFeedbackRecording() const { return m_feedbackActive; }
+
+    // Упрощение записи с автозахватом при остановке (MotionSimplifier)
+    void setSimplify(bool enabled, const SimplifyOptions& options = SimplifyOptions());
+    bool isSimplifyEnabled() const { return m_simplify; }
+    // Итог упрощения последней записи (inputKeyframes = 0 — не упрощалась)
+    const SimplifyReport& lastSimplifyReport() const { return m_lastSimplifyReport; }
     
     // Статус
     bool isRecording() const { return m_isRecording; }
@@ -35,12 +55,21 @@ signals:
     void recordingStopped(const Motion& motion);
     void recordingCancelled();
     void keyframeCaptured(int count);
+    void samplesRecorded(int count, int durationMs);  // Запись по feedback, раз в интервал автозахвата
     void errorOccurred(const QString& message);
 
 private slots:
     void onAutoCaptureTimer();
 
 private:
+    // Выборки буфера → кадры: шаг не меньше intervalMs (0 — каждая выборка)
+    void appendFeedbackKeyframes(int intervalMs);
+
+    // Буфер на FEEDBACK_MAX_SEC при частоте до FEEDBACK_MAX_RATE_HZ (~12 МБ),
+    // выделяется при первой записи
+    static constexpr int FEEDBACK_MAX_SEC = 300;
+    static constexpr int FEEDBACK_MAX_RATE_HZ = 1000;
+
     ArmController* m_armController;
     QTimer* m_autoCaptureTimer;
     QElapsedTimer m_elapsedTimer;
@@ -52,6 +81,16 @@ private:
     bool m_isRecording = false;
     bool m_autoCapture = false;
     int m_autoCaptureInterval = 200;
+    bool m_autoCaptured = false;        // В записи был автозахват
+
+    bool m_feedbackCapture = true;
+    bool m_feedbackActive = false;
+    bool m_feedbackFullReported = false;
+    FeedbackRecording m_feedback;
+
+    bool m_simplify = true;
+    SimplifyOptions m_simplifyOptions;
+    SimplifyReport m_lastSimplifyReport;
 };
 
 #endif // MOTION_RECORDER_H
@@ -0,0 +1,56 @@
+#ifndef MOTION_SIMPLIFIER_H
+#define MOTION_SIMPLIFIER_H
+
+#include <QString>
+#include "motion_manager.h"
+
+// Параметры упрощения записи; углы — в градусах (у грипера — его единицы)
+struct SimplifyOptions {
+    double toleranceDeg = 1.0;      // Наибольшее отклонение сустава от записи
+    bool fitSpline = true;          // Допуск — по сплайну воспроизведения, а не по ломаной
+    bool removeIdle = true;         // Вырезать паузы
+    double idleToleranceDeg = 0.5;  // Пауза: все суставы в пределах допуска от её начала...
+    int idleMinMs = 500;            // ...не меньше этого времени
+    int maxDwellMs = 300;           // Сколько остаётся от паузы в середине (0 — остановка без выдержки)
+};
+
+// Итог упрощения: отклонение измерено во всех исходных кадрах вне пауз
+struct SimplifyReport {
+    int inputKeyframes = 0;
+    int outputKeyframes = 0;
+    double compressionRatio = 1.0;  // inputKeyframes / outputKeyframes
+    double maxDeviationDeg = 0.0;
+    int maxDeviationJoint = -1;
+    int maxDeviationKeyframe = -1;  // Индекс в исходной записи
+    int idleSegments = 0;
+    int idleRemovedMs = 0;
+    int inputDurationMs = 0;
+    int outputDurationMs = 0;
+};
+
+// Упрощение записи с автозахватом: кадр каждые 50–200 мс независимо от
+// движения даёт сотни лишних кадров.
+//
+// Время кадра — сумма transitionMs от начала, и все сравнения идут по
+// времени: исходный кадр сравнивается с положением упрощённой траектории в
+// тот же момент, поэтому оставшиеся кадры сохраняют исходное время, а
+// скорость движения не меняется. Порядок:
+//   1. Паузы (все суставы в idleToleranceDeg от начала паузы дольше
+//      idleMinMs) в начале и в конце вырезаются целиком, в середине —
+//      сжимаются до maxDwellMs; их края становятся кадрами со stop.
+//   2. Рамер–Дуглас–Пекер в 7-D между краями пауз: на отрезке оставляется
+//      кадр с наибольшим отклонением от линейной интерполяции по времени
+//      (максимум по суставам), пока отклонение больше toleranceDeg.
+//   3. С fitSpline — через оставшиеся кадры строится JointTrajectory,
+//      как при воспроизведении; на отрезках, где сплайн отходит от
+//      записи дальше допуска, добавляется худший кадр, и так до сходимости.
+class MotionSimplifier {
+public:
+    static Motion simplify(const Motion& motion, const SimplifyOptions& options,
+                           SimplifyReport* report = nullptr);
+
+    // «612 → 41 кадров (×14.9), отклонение 0.8° (J2)…» для сообщений
+    static QString describe(const SimplifyReport& report);
+};
+
+#endif // MOTION_SIMPLIFIER_H
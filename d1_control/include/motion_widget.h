@@ -12,6 +12,7 @@
 #include <QHBoxLayout>
 #include <QSpinBox>
 #include <QCheckBox>
+#include <QDoubleSpinBox>
 #include <QInputDialog>
 #include <QMessageBox>
 
@@ -63,6 +64,7 @@ private slots:
     void onSpeedChanged(int value);
     void onAutoCaptureChanged(int state);
     void onCaptureIntervalChanged(int value);
+    void onSimplifyChanged();
     void onLoopingChanged(int state);
     
     // Сигналы от компонентов
@@ -80,6 +82,7 @@ private:
     void updateButtonStates();
     void updateRecordingStatus();
     void updatePlaybackStatus();
+    void simplifySelected();
 
     MotionManager* m_manager;
     MotionPlayer* m_player;
@@ -102,6 +105,9 @@ private:
     // Настройки записи
     QCheckBox* m_autoCaptureCheck;
     QSpinBox* m_captureIntervalSpin;
+    QCheckBox* m_feedbackCaptureCheck;
+    QCheckBox* m_simplifyCheck;
+    QDoubleSpinBox* m_simplifyToleranceSpin;
     
     // Настройки воспроизведения
     QSlider* m_speedSlider;
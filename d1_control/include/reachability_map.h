@@ -0,0 +1,122 @@
+#ifndef REACHABILITY_MAP_H
+#define REACHABILITY_MAP_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QtGlobal>
+#include <array>
+#include "arm_kinematics.h"
+
+// Параметры построения карты досягаемости
+struct ReachabilityBuildOptions {
+    quint64 samples = 4000000;      // Случайных конфигураций J1–J6 в лимитах URDF
+    double voxelSizeM = 0.025;
+    int threads = 0;                // 0 — по числу ядер
+    quint64 randomSeed = 1;
+};
+
+// Карта досягаемости рабочей зоны: воксельная сетка вокруг base_link.
+//
+// Строится заранее (d1_reachability или build()): случайные конфигурации
+// в лимитах суставов прогоняются через прямую кинематику параллельно на всех
+// ядрах. Для каждого вокселя, куда попала рабочая точка, хранятся число
+// выборок, наибольшая манипулируемость (Йошикава по линейной части якобиана)
+// и набор направлений подхода — оси Z инструмента, одно из 26 направлений
+// куба. Для каждой пары воксель/направление — углы с наибольшей
+// манипулируемостью: начальное приближение для обратной кинематики.
+//
+// Запросы — O(1): индекс вокселя по координатам, затем бит направления и
+// popcount для номера углов. Файл (.d1rm) — заголовок, плотный индекс
+// uint32 на воксель и разреженные массивы вокселей и углов без указателей;
+// load() отображает его в память (QFile::map) без разбора и копирования.
+// Порядок байт — как у x86/ARM (little-endian).
+class ReachabilityMap {
+public:
+    static constexpr int DIRECTION_BINS = 26;
+
+    ReachabilityMap() = default;
+    ~ReachabilityMap();
+    ReachabilityMap(const ReachabilityMap&) = delete;
+    ReachabilityMap& operator=(const ReachabilityMap&) = delete;
+
+    // Файл в каталоге настроек приложения
+    static QString defaultPath();
+
+    static bool build(const ArmKinematics& kinematics, const ReachabilityBuildOptions& options,
+                      ReachabilityMap& map, QString* error = nullptr);
+
+    bool load(const QString& path, QString* error = nullptr);
+    bool save(const QString& path, QString* error = nullptr) const;
+    void clear();
+    bool isLoaded() const { return m_header != nullptr; }
+
+    // Карта построена для той же цепи и тех же лимитов, что kinematics
+    bool matches(const ArmKinematics& kinematics) const;
+
+    // Воксель с рабочей точкой в этом положении встречался при построении
+    bool isReachable(const std::array<double, 3>& position) const;
+    // То же, и с направлением подхода (ось Z рабочей точки) того же сектора
+    bool isReachable(const RigidTransform& pose) const;
+    // Наибольшая манипулируемость в вокселе, 0 — вне зоны
+    double manipulability(const std::array<double, 3>& position) const;
+    // Углы выборки из вокселя и сектора направления цели (грипер — 0)
+    bool seedFor(const RigidTransform& pose, JointVector& seedDeg) const;
+
+    static int directionBin(const std::array<double, 3>& axis);
+
+    double voxelSizeM() const;
+    quint32 voxelCount() const;
+    quint32 reachableVoxels() const;
+    quint32 seedCount() const;
+    quint64 sampleCount() const;
+
+private:
+    static constexpr quint32 MAGIC = 0x4d523144;    // "D1RM"
+    static constexpr quint32 VERSION = 1;
+    static constexpr quint32 EMPTY = 0xffffffffu;
+
+    // Поля фиксированного размера; смещения массивов кратны 16 байтам
+    struct Header {
+        quint32 magic;
+        quint32 version;
+        quint32 directionBins;
+        float voxelSize;
+        float origin[3];
+        quint32 dims[3];
+        quint32 cellCount;
+        quint32 seedCount;
+        quint64 sampleCount;
+        float lowerLimitDeg[KINEMATIC_JOINTS];
+        float upperLimitDeg[KINEMATIC_JOINTS];
+        float probeTcp[3][3];           // Рабочая точка в трёх контрольных позах
+        quint32 reserved[5];
+    };
+
+    struct Cell {
+        quint32 directions;     // Биты секторов направления подхода
+        quint32 firstSeed;      // Углы секторов — подряд, по возрастанию бита
+        float manipulability;
+        quint32 samples;
+    };
+
+    struct Seed {
+        qint16 centiDeg[KINEMATIC_JOINTS];
+        float manipulability;
+    };
+
+    static JointVector probePose(int probe);
+    bool attach(const uchar* data, qint64 size, QString* error);
+    const Cell* cellAt(const std::array<double, 3>& position) const;
+
+    QByteArray m_owned;         // Построенная в памяти карта
+    QFile m_file;               // Отображённый файл
+    uchar* m_mapped = nullptr;
+
+    const Header* m_header = nullptr;
+    const quint32* m_index = nullptr;
+    const Cell* m_cells = nullptr;
+    const Seed* m_seeds = nullptr;
+};
+
+#endif // REACHABILITY_MAP_H
@@ -37,6 +37,9 @@ public:
     // Информация о суставах
     void setJointInfo(int jointId, double angle, double torque = 0.0);
 
+    // Задержка feedback (краткая сводка; подробности — по кнопке)
+    void setLatencyInfo(const QString& summary, bool withinBudget, bool hasData);
+
 signals:
     void enableMotorsClicked();
     void disableMotorsClicked();
@@ -44,6 +47,7 @@ signals:
     void emergencyStopClicked();
     void connectionSettingsClicked();
     void calibrationClicked();
+    void latencyDetailsClicked();
 
 private slots:
     void onEnableClicked();
@@ -70,6 +74,9 @@ private:
     QLabel* m_errorLabel;
     QLabel* m_errorIndicator;
     QLabel* m_uptimeLabel;
+    QLabel* m_latencyIndicator;
+    QLabel* m_latencyLabel;
+    QPushButton* m_latencyDetailsBtn;
     
     QProgressBar* m_recoveryProgress = nullptr;
     QLabel* m_recoveryStepLabel = nullptr;
@@ -0,0 +1,142 @@
+#ifndef TRAJECTORY_EXECUTOR_H
+#define TRAJECTORY_EXECUTOR_H
+
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include "arm_state.h"
+#include "joint_trajectory.h"
+
+// Получатель уставок. Создаётся и уничтожается в потоке исполнителя,
+// поэтому может владеть собственным сокетом.
+class SetpointSink {
+public:
+    virtual ~SetpointSink() = default;
+    // Дойти до angles за reachMs (встроенная интерполяция руки сглаживает шаг)
+    virtual void send(const JointVector& angles, int reachMs) = 0;
+};
+
+// Диапазоны углов суставов (min, max), как в ArmController
+using JointLimits = std::array<std::pair<double, double>, NUM_JOINTS>;
+
+struct TrajectoryConfig {
+    int rateHz = 50;                  // Частота уставок (10–200 Гц)
+    int lookaheadMs = 60;             // Уставка берётся на столько впереди текущего времени
+    int feedbackLagMs = 60;           // Сравнение с feedback — с поправкой на его запаздывание
+    double trackingLimitDeg = 10.0;   // Допустимое отклонение сустава от траектории
+    int trackingGraceMs = 300;        // Сколько отклонение может держаться до прерывания
+};
+
+// Итог исполнения и статистика следования
+struct TrajectoryReport {
+    enum Result {
+        Completed,
+        Cancelled,       // stop() или новая траектория
+        Preempted,       // Аварийная остановка
+        TrackingError,   // Рука отстала от траектории
+        Disconnected
+    };
+
+    Result result = Completed;
+    double elapsedSec = 0.0;
+    uint64_t setpoints = 0;
+    uint64_t overruns = 0;            // Тики, проснувшиеся позже следующего периода
+    uint64_t skippedTicks = 0;        // Пропущены после опоздания (не догоняются пачкой)
+    double maxLatenessMs = 0.0;
+    JointVector maxTrackingErrorDeg{};
+    double rmsTrackingErrorDeg = 0.0;
+    int worstJoint = -1;
+};
+
+// Исполнитель траекторий: постоянный поток (создаётся при первом start() и
+// живёт до разрушения объекта) выдаёт уставки с фиксированной частотой по
+// абсолютным дедлайнам (steady_clock), независимо от загрузки GUI.
+//
+// На каждом тике: проверка аварийной остановки, сравнение feedback с
+// траекторией (с учётом запаздывания feedback), уставка q(t + lookahead) с
+// временем достижения lookahead — рука приходит в точку ровно тогда, когда
+// этого требует траектория, и не останавливается между кадрами. Проспавший
+// тик не догоняет пропущенные уставки пачкой: следующая сразу берётся для
+// текущего момента. Траектория ограничивается лимитами суставов до сравнения
+// и отправки, поэтому отклонение считается от той же цели, что и команда.
+//
+// start()/stop()/preempt() вызываются из потока GUI; finished() приходит в GUI.
+class TrajectoryExecutor : public QObject {
+    Q_OBJECT
+
+public:
+    using SinkFactory = std::function<std::unique_ptr<SetpointSink>()>;
+    using StateSource = std::function<ArmState()>;
+    using StopCondition = std::function<bool()>;
+
+    TrajectoryExecutor(StateSource stateSource, StopCondition stopCondition, QObject* parent = nullptr);
+    ~TrajectoryExecutor();
+
+    void setConfig(const TrajectoryConfig& config);
+    TrajectoryConfig config() const;
+
+    // Запускает траекторию (текущая, если есть, отменяется) и возвращает её
+    // номер для finished(); 0 — пустая траектория. Первая точка должна
+    // совпадать с текущим положением руки.
+    quint64 start(const JointTrajectory& trajectory, const JointLimits& limits, SinkFactory sinkFactory);
+
+    // Отмена: после возврата уставки больше не отправляются
+    void stop();
+    // То же для аварийной остановки (итог — Preempted)
+    void preempt();
+
+    bool isRunning() const { return m_running.load(std::memory_order_acquire); }
+    double elapsedSec() const { return m_elapsedUs.load(std::memory_order_relaxed) / 1e6; }
+    double durationSec() const { return m_durationSec; }
+
+    // Итог последнего завершённого исполнения
+    TrajectoryReport lastReport() const;
+
+    static QString resultName(TrajectoryReport::Result result);
+
+signals:
+    // Поток GUI: исполнение закончилось само (не через stop() или новый start())
+    void finished(quint64 runId, bool completed, const QString& reason);
+
+private:
+    struct Job {
+        JointTrajectory trajectory;
+        JointLimits limits;
+        SinkFactory sinkFactory;
+        TrajectoryConfig config;
+        quint64 runId = 0;
+    };
+
+    void join(TrajectoryReport::Result reason);
+    void threadLoop();
+    void run(const Job& job);
+
+    StateSource m_stateSource;
+    StopCondition m_stopCondition;
+
+    mutable std::mutex m_mutex;        // Конфигурация, отчёт, задание, ожидание тика
+    std::condition_variable m_cv;      // Поток исполнителя: задание, отмена, завершение
+    std::condition_variable m_idleCv;  // join(): исполнение закончилось
+    TrajectoryConfig m_config;
+    TrajectoryReport m_report;
+    Job m_job;
+    bool m_hasJob = false;             // Задание ещё не взято потоком
+    bool m_busy = false;               // Задание исполняется
+    bool m_cancel = false;
+    bool m_shutdown = false;
+    TrajectoryReport::Result m_cancelReason = TrajectoryReport::Cancelled;
+
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    std::atomic<int64_t> m_elapsedUs{0};
+    double m_durationSec = 0.0;        // Только поток GUI
+    quint64 m_runId = 0;               // Только поток GUI
+};
+
+#endif // TRAJECTORY_EXECUTOR_H
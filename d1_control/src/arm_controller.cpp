@@ -1,12 +1,82 @@
 #include "arm_controller.h"
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonArray>
-#include <QDateTime>
 #include <QDebug>
+#include <QFile>
 #include <QThread>
-#include <QNetworkDatagram>
+#include <QSettings>
 #include <cmath>
+#include <algorithm>
+#include <cstdint>
+#include "async_log.h"
+
+namespace {
+// Журнал команд движения: пишется на каждом кадре воспроизведения и слайдере,
+// поэтому идёт через асинхронный логгер, а не qDebug в потоке GUI
+const int LOG_ARM = d1::log::category("ARM", 50);
+}
+
+// Получатель уставок исполнителя траекторий. Живёт в потоке исполнителя:
+// команды идут тем же транспортом, что и остальные, но минуя поток GUI
+// (для UDP — собственным сокетом, созданным в этом потоке).
+class StreamSink : public SetpointSink {
+public:
+    struct Context {
+        FeedbackTransport transport = FeedbackTransport::Udp;
+        bool synchronized = true;
+        double gripperAngle = 0.0;   // Последняя уставка грипера: хват не ослабляем
+        std::array<std::pair<double, double>, NUM_JOINTS> limits;
+    };
+    
+    StreamSink(ArmController* controller, const Context& context)
+        : m_controller(controller)
+        , m_context(context)
+    {
+    }
+    
+    void send(const JointVector& angles, int reachMs) override {
+        std::array<double, NUM_JOINTS> targets;
+        for (int i = 0; i < NUM_JOINTS; ++i) {
+            targets[i] = std::max(m_context.limits[i].first, std::min(angles[i], m_context.limits[i].second));
+        }
+        targets[6] = m_context.gripperAngle;
+        
+        if (m_context.synchronized) {
+            deliver(m_controller->buildCommand(2, ArmController::syncCommandData(targets, reachMs)));
+            return;
+        }
+        for (int i = 0; i < NUM_JOINTS; ++i) {
+            if (i == 6) continue;
+            deliver(m_controller->buildCommand(1, ArmController::jointCommandData(i, targets[i], reachMs)));
+        }
+    }
+    
+private:
+    void deliver(const QString& command) {
+        QByteArray data = command.toUtf8();
+#ifdef D1_WITH_RELAY_CORE
+        if (m_context.transport == FeedbackTransport::InProcess && m_controller->m_relayCore) {
+            m_controller->m_relayCore->submitCommand(data.toStdString());
+            return;
+        }
+#endif
+        if (m_context.transport == FeedbackTransport::SharedMemory) {
+            std::lock_guard<std::mutex> lock(m_controller->m_shmSendMutex);
+            if (m_controller->m_shm.isProducer()
+                && m_controller->m_shm.pushCommand(data.constData(), static_cast<size_t>(data.size()))) {
+                return;
+            }
+        }
+        if (!m_socket) {
+            m_socket.reset(new QUdpSocket());
+        }
+        if (m_socket->writeDatagram(data, QHostAddress::LocalHost, UDP_CMD_PORT) < 0) {
+            D1_LOG_WARN(LOG_ARM, "Ошибка отправки уставки: %s", qPrintable(m_socket->errorString()));
+        }
+    }
+    
+    ArmController* m_controller;
+    Context m_context;
+    std::unique_ptr<QUdpSocket> m_socket;
+};
 
 ArmController::ArmController(QObject* parent) 
     : QObject(parent)
@@ -14,9 +84,8 @@ ArmController::ArmController(QObject* parent)
     // Инициализация home позиции (все в ноль)
     m_homePosition.fill(0.0);
     
-    // Создаём UDP сокеты
+    // Сокет команд; feedback принимается в отдельном потоке
     m_cmdSocket = new QUdpSocket(this);
-    m_feedbackSocket = new QUdpSocket(this);
     
     // Таймер проверки подключения
     m_connectionTimer = new QTimer(this);
@@ -27,10 +96,58 @@ ArmController::ArmController(QObject* parent)
     m_recoveryTimer = new QTimer(this);
     m_recoveryTimer->setInterval(100);
     connect(m_recoveryTimer, &QTimer::timeout, this, &ArmController::processRecovery);
+    
+    // Все отложенные команды (повторы питания, поочерёдные суставы, пробы) —
+    // через один планировщик вместо QTimer::singleShot на каждую
+    m_scheduler = new CommandScheduler(this);
+    
+    // Исполнитель траекторий: положение руки — из снимка потока приёма,
+    // аварийная остановка — по атомарному флагу
+    m_executor = new TrajectoryExecutor(
+        [this]() { return m_worker->state(); },
+        [this]() { return m_emergencyStop.load(); },
+        this);
+    connect(m_executor, &TrajectoryExecutor::finished, this, &ArmController::onTrajectoryFinished);
+    
+    // Поток приёма feedback: разбор и учёт задержек вне потока GUI,
+    // в GUI — только редкие события и stateUpdated не чаще 60 Гц
+    m_worker.reset(new FeedbackWorker(&m_latencyMonitor));
+    QString kinematicsError;
+    if (m_kinematics.loadUrdf(ArmKinematics::DEFAULT_URDF, &kinematicsError)) {
+        m_worker->setKinematics(&m_kinematics);
+        
+        // Карта досягаемости строится заранее (d1_reachability) и отображается в память
+        QString mapError;
+        QString mapPath = ReachabilityMap::defaultPath();
+        if (QFile::exists(mapPath)) {
+            if (!m_reachability.load(mapPath, &mapError)) {
+                qWarning() << "Карта досягаемости недоступна:" << mapError;
+            } else if (!m_reachability.matches(m_kinematics)) {
+                qWarning() << "Карта досягаемости построена для другой модели, перестройте d1_reachability";
+                m_reachability.clear();
+            }
+        }
+        
+        QString collisionError;
+        if (!m_collision.load(m_kinematics, CollisionChecker::defaultDescriptionDir(), &collisionError)) {
+            qWarning() << "Проверка столкновений недоступна:" << collisionError;
+        }
+    } else {
+        qWarning() << "Прямая кинематика недоступна:" << kinematicsError;
+    }
+    connect(m_worker.get(), &FeedbackWorker::stateAvailable, this, &ArmController::onWorkerStateAvailable);
+    connect(m_worker.get(), &FeedbackWorker::connectionChanged, this, &ArmController::onWorkerConnectionChanged);
+    connect(m_worker.get(), &FeedbackWorker::powerStatusChanged, this, &ArmController::onWorkerPowerStatusChanged);
+    connect(m_worker.get(), &FeedbackWorker::errorStatusChanged, this, &ArmController::onWorkerErrorStatusChanged);
+    connect(m_worker.get(), &FeedbackWorker::skewMeasured, this, &ArmController::onWorkerSkewMeasured);
+    m_worker->start();
 }
 
 ArmController::~ArmController() {
     shutdown();
+    m_scheduler->cancelAll();
+    m_executor->stop();
+    m_worker->stop();
 }
 
 bool ArmController::initialize() {
@@ -41,26 +158,73 @@ bool ArmController::initialize() {
     qDebug() << "===========================================";
     qDebug() << "Инициализация UDP соединения...";
     qDebug() << "  Команды отправляются на 127.0.0.1:" << UDP_CMD_PORT;
-    qDebug() << "  Feedback слушаем на 0.0.0.0:" << UDP_FEEDBACK_PORT;
+    qDebug() << "  Feedback: разделяемая память" << d1::SHM_NAME << "или UDP 0.0.0.0:" << UDP_FEEDBACK_PORT;
     qDebug() << "===========================================";
     
-    // Биндим сокет для приёма feedback от udp_relay
-    // ВАЖНО: используем AnyIPv4 (0.0.0.0) как в оригинальном bridge.py
-    if (!m_feedbackSocket->bind(QHostAddress::AnyIPv4, UDP_FEEDBACK_PORT, 
-                                 QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint)) {
-        qCritical() << "ОШИБКА: Не удалось забиндить порт" << UDP_FEEDBACK_PORT 
-                    << ":" << m_feedbackSocket->errorString();
-        emit errorOccurred(-1, QString("Не удалось открыть порт %1: %2")
-                           .arg(UDP_FEEDBACK_PORT).arg(m_feedbackSocket->errorString()));
-        return false;
+    QSettings settings("Unitree", "D1Control");
+    QString preference = settings.value("Connection/transport", "auto").toString();
+    if (qEnvironmentVariableIsSet("D1_TRANSPORT")) {
+        preference = QString::fromLocal8Bit(qgetenv("D1_TRANSPORT"));
+    }
+    m_transportPreference = transportPreferenceFromString(preference);
+    
+    TrajectoryConfig trajectoryConfig = m_executor->config();
+    trajectoryConfig.rateHz = settings.value("Motion/streamRateHz", trajectoryConfig.rateHz).toInt();
+    trajectoryConfig.lookaheadMs = settings.value("Motion/lookaheadMs", trajectoryConfig.lookaheadMs).toInt();
+    trajectoryConfig.trackingLimitDeg = settings.value("Motion/trackingLimitDeg", trajectoryConfig.trackingLimitDeg).toDouble();
+    m_executor->setConfig(trajectoryConfig);
+    
+    MotionEstimatorConfig estimatorConfig;
+    estimatorConfig.alpha = settings.value("Feedback/estimatorAlpha", estimatorConfig.alpha).toDouble();
+    estimatorConfig.beta = settings.value("Feedback/estimatorBeta", estimatorConfig.beta).toDouble();
+    estimatorConfig.gamma = settings.value("Feedback/estimatorGamma", estimatorConfig.gamma).toDouble();
+    m_worker->setMotionEstimatorConfig(estimatorConfig);
+    
+    // Препятствия: "имя;x;y;z;sx;sy;sz" — центр и размеры коробки в метрах, оси base_link
+    CollisionConfig collisionConfig = m_collision.config();
+    collisionConfig.enabled = settings.value("Collision/enabled", collisionConfig.enabled).toBool();
+    collisionConfig.clearanceM = settings.value("Collision/clearanceMm", collisionConfig.clearanceM * 1000.0).toDouble() / 1000.0;
+    collisionConfig.floorEnabled = settings.value("Collision/floorEnabled", collisionConfig.floorEnabled).toBool();
+    collisionConfig.floorHeightM = settings.value("Collision/floorHeightM", collisionConfig.floorHeightM).toDouble();
+    collisionConfig.obstacles.clear();
+    for (const QString& entry : settings.value("Collision/obstacles").toStringList()) {
+        QStringList fields = entry.split(';');
+        CollisionObstacle obstacle;
+        bool valid = fields.size() == 7;
+        for (int i = 0; valid && i < 6; ++i) {
+            double value = fields[i + 1].toDouble(&valid);
+            if (i < 3) {
+                obstacle.center[i] = value;
+            } else {
+                obstacle.halfSize[i - 3] = value * 0.5;
+                valid = valid && value > 0.0;
+            }
+        }
+        if (!valid) {
+            qWarning() << "Collision/obstacles: пропущена запись" << entry;
+            continue;
+        }
+        obstacle.name = fields[0].trimmed();
+        collisionConfig.obstacles.append(obstacle);
     }
+    m_collision.setConfig(collisionConfig);
     
-    // Подключаем сигнал readyRead
-    connect(m_feedbackSocket, &QUdpSocket::readyRead, this, &ArmController::onReadyRead);
+    // Встроенное ядро DDS, иначе relay на этом же хосте через разделяемую память,
+    // иначе подписка на feedback по UDP
+    bool useSnapshot = (m_transportPreference == TransportPreference::InProcess && tryInProcess())
+                    || trySharedMemory();
+    if (!useSnapshot && !bindFeedbackSocket()) {
+        return false;
+    }
     
     m_initialized = true;
     m_connectionTimer->start();
     
+    // Подписываемся на feedback (старый relay продолжит слать JSON на 8889)
+    if (!useSnapshot) {
+        sendSubscription(d1::ControlType::Subscribe);
+    }
+    
     qDebug() << "UDP инициализирован успешно!";
     qDebug() << "ВАЖНО: Запустите ./d1_sdk/build/udp_relay в отдельном терминале!";
     qDebug() << "===========================================";
@@ -76,122 +240,237 @@ void ArmController::shutdown() {
     m_connectionTimer->stop();
     m_recoveryTimer->stop();
     
+    // Поток исполнителя пишет в транспорт — останавливаем до его закрытия
+    m_executor->stop();
+    
     // Отключаем моторы перед выходом
     disableMotors();
     
-    m_feedbackSocket->close();
+    // Освобождаем место подписчика в relay, не дожидаясь истечения аренды
+    if (m_transport == FeedbackTransport::Udp) {
+        sendSubscription(d1::ControlType::Unsubscribe);
+    }
+    
+    // Поток приёма перестаёт читать снимок до закрытия shm / остановки ядра
+    m_worker->stopSnapshot();
+    m_shm.close();
+#ifdef D1_WITH_RELAY_CORE
+    // stop() успевает опубликовать отключение моторов из очереди
+    if (m_relayCore) {
+        m_relayCore->stop();
+        m_relayCore.reset();
+    }
+#endif
+    m_transport = FeedbackTransport::Udp;
+    
+    m_worker->closeUdp();
     m_cmdSocket->close();
     
     m_initialized = false;
     qDebug() << "UDP отключен";
 }
 
-void ArmController::onReadyRead() {
-    while (m_feedbackSocket->hasPendingDatagrams()) {
-        QNetworkDatagram datagram = m_feedbackSocket->receiveDatagram();
-        if (datagram.isValid()) {
-            parseJsonData(datagram.data());
-        }
+bool ArmController::bindFeedbackSocket() {
+    if (m_worker->udpPort() != 0) {
+        return true;
+    }
+    
+    QString error;
+    if (!m_worker->bindUdp(UDP_FEEDBACK_PORT, &error)) {
+        qCritical() << "ОШИБКА: Не удалось открыть сокет feedback:" << error;
+        emit errorOccurred(-1, QString("Не удалось открыть сокет feedback: %1").arg(error));
+        return false;
     }
+    qDebug() << "  Feedback принимаем по UDP на порту" << m_worker->udpPort() << "(поток приёма)";
+    return true;
 }
 
-void ArmController::parseJsonData(const QByteArray& data) {
-    QJsonDocument doc = QJsonDocument::fromJson(data);
-    if (!doc.isObject()) {
-        return;
+TransportPreference ArmController::transportPreferenceFromString(const QString& value) {
+    QString v = value.trimmed().toLower();
+    if (v == "udp") {
+        return TransportPreference::Udp;
     }
-    
-    QJsonObject root = doc.object();
-    if (!root.contains("data")) {
-        return;
+    if (v == "inprocess" || v == "in-process" || v == "dds") {
+        return TransportPreference::InProcess;
     }
-    
-    QJsonObject dataObj = root["data"].toObject();
-    
-    QMutexLocker locker(&m_stateMutex);
-    
-    // Статус питания
-    if (dataObj.contains("power_status")) {
-        int newPower = dataObj["power_status"].toInt();
-        if (newPower != m_state.powerStatus) {
-            m_state.powerStatus = newPower;
-            int capturedPower = newPower;
-            QMetaObject::invokeMethod(this, [this, capturedPower]() {
-                emit motorsPowered(capturedPower == 1);
-            }, Qt::QueuedConnection);
-        }
+    return TransportPreference::Auto;
+}
+
+bool ArmController::isInProcessTransportAvailable() {
+#ifdef D1_WITH_RELAY_CORE
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool ArmController::tryInProcess() {
+#ifdef D1_WITH_RELAY_CORE
+    QSettings settings("Unitree", "D1Control");
+    QString iface = settings.value("Connection/networkInterface", "auto").toString();
+    
+    // Обработчик выполняется в потоке DDS: запись снимка под seqlock и
+    // пробуждение потока приёма (не больше одного события в очереди)
+    m_relayCore.reset(new d1::RelayCore([this](const d1::FeedbackSample& sample) {
+        m_inProcessState.store(sample);
+        m_worker->wakeSnapshot();
+    }));
+    if (!m_relayCore->start(0, iface == "auto" ? std::string() : iface.toStdString())) {
+        qWarning() << "Не удалось запустить встроенное ядро DDS - используем udp_relay";
+        m_relayCore.reset();
+        return false;
     }
     
-    // Статус ошибки
-    if (dataObj.contains("error_status")) {
-        int newError = dataObj["error_status"].toInt();
-        if (newError != m_state.errorStatus) {
-            m_state.errorStatus = newError;
-            if (newError != 0) {
-                QString errorMsg = QString("Ошибка робота: код %1").arg(newError);
-                int capturedError = newError;
-                QMetaObject::invokeMethod(this, [this, capturedError, errorMsg]() {
-                    emit errorOccurred(capturedError, errorMsg);
-                }, Qt::QueuedConnection);
-            }
-        }
+    m_transport = FeedbackTransport::InProcess;
+    m_worker->startSnapshot(&m_inProcessState, SnapshotWake::Call);
+    qDebug() << "  Встроенное ядро DDS: udp_relay не нужен";
+    return true;
+#else
+    qWarning() << "Транспорт inprocess недоступен: приложение собрано без D1_WITH_RELAY_CORE";
+    return false;
+#endif
+}
+
+bool ArmController::trySharedMemory() {
+    m_lastShmProbeTime = static_cast<qint64>(d1::monotonicNs() / 1000000);
+    if (m_transportPreference == TransportPreference::Udp || !m_shm.attach()) {
+        return false;
     }
-    
-    // Углы суставов
-    for (int i = 0; i < NUM_JOINTS; ++i) {
-        QString key = QString("angle%1").arg(i);
-        if (dataObj.contains(key)) {
-            m_state.joints[i].angle = dataObj[key].toDouble();
-        }
+    if (!m_shm.relayAlive(SHM_STALE_NS)) {
+        // Сегмент остался от завершившегося relay
+        m_shm.close();
+        return false;
     }
     
-    // Обновляем время и статус подключения
-    m_state.lastUpdateTime = QDateTime::currentMSecsSinceEpoch();
-    bool wasConnected = m_state.isConnected;
-    m_state.isConnected = true;
+    // Кольцо команд занято другим GUI — команды этого клиента идут по UDP
+    bool producer = m_shm.claimProducer();
     
-    locker.unlock();
+    // Relay будит один клиент; остальные (второй GUI) опрашивают снимок
+    int wakeupFd = m_shm.claimWaiter();
     
-    // Сигнал о подключении (если было отключено)
-    if (!wasConnected) {
+    m_transport = FeedbackTransport::SharedMemory;
+    m_worker->startSnapshot(m_shm.snapshot(), SnapshotWake::Socket, wakeupFd);
+    qDebug() << "  Feedback читаем из разделяемой памяти" << d1::SHM_NAME
+             << (producer ? "(команды тоже через shm)" : "(команды по UDP)")
+             << (wakeupFd >= 0 ? "по пробуждению" : "опросом");
+    return true;
+}
+
+void ArmController::fallBackToUdp() {
+    qWarning() << "Relay перестал обновлять разделяемую память - переключаемся на UDP";
+    m_executor->stop();
+    m_worker->stopSnapshot();
+    m_shm.close();
+    m_transport = FeedbackTransport::Udp;
+    
+    if (bindFeedbackSocket()) {
+        sendSubscription(d1::ControlType::Subscribe);
+    }
+}
+
+void ArmController::onWorkerStateAvailable() {
+    // Сначала снимаем флаг, потом читаем: выборка, пришедшая после чтения, поставит новое уведомление
+    m_worker->acknowledgeNotification();
+    ArmState state = m_worker->state();
+    emit stateUpdated(state);
+    
+    if (m_convergence.pendingCount() > 0) {
+        std::vector<ConvergenceEvent> events;
+        m_convergence.update(state, d1::monotonicNs(), events);
+        dispatchConvergenceEvents(events);
+    }
+}
+
+void ArmController::onWorkerConnectionChanged(bool connected) {
+    if (connected) {
+        ArmState state = m_worker->state();
         qDebug() << ">>> РОБОТ ПОДКЛЮЧЕН! Углы:" 
-                 << m_state.joints[0].angle << m_state.joints[1].angle 
-                 << m_state.joints[2].angle << m_state.joints[3].angle;
-        emit connected();
+                 << state.joints[0].angle << state.joints[1].angle 
+                 << state.joints[2].angle << state.joints[3].angle;
+        emit this->connected();
+    } else {
+        qDebug() << ">>> РОБОТ ОТКЛЮЧЕН (нет данных >" << FeedbackWorker::CONNECTION_TIMEOUT_MS << "мс)";
+        abortTargets("потеря связи");
+        emit disconnected();
+    }
+}
+
+void ArmController::onWorkerPowerStatusChanged(int powerStatus) {
+    emit motorsPowered(powerStatus == 1);
+}
+
+void ArmController::onWorkerErrorStatusChanged(int errorStatus) {
+    if (errorStatus != 0) {
+        emit errorOccurred(errorStatus, QString("Ошибка робота: код %1").arg(errorStatus));
     }
-    
-    // Отправляем обновление состояния
-    ArmState stateCopy = getState();
-    emit stateUpdated(stateCopy);
 }
 
 void ArmController::checkConnection() {
-    QMutexLocker locker(&m_stateMutex);
+    // Таймауты целей, пока feedback не приходит (иначе их проверяет каждый снимок)
+    if (m_convergence.pendingCount() > 0) {
+        std::vector<ConvergenceEvent> events;
+        m_convergence.checkTimeouts(d1::monotonicNs(), events);
+        dispatchConvergenceEvents(events);
+    }
     
-    uint64_t now = QDateTime::currentMSecsSinceEpoch();
-    bool wasConnected = m_state.isConnected;
+    uint64_t now = d1::monotonicNs() / 1000000;
     
-    if (m_state.lastUpdateTime > 0 && (now - m_state.lastUpdateTime) > CONNECTION_TIMEOUT_MS) {
-        m_state.isConnected = false;
+    if (m_transport == FeedbackTransport::InProcess) {
+        return;
     }
     
-    locker.unlock();
+    if (m_transport == FeedbackTransport::SharedMemory) {
+        if (!m_shm.relayAlive(SHM_STALE_NS)) {
+            fallBackToUdp();
+        }
+        return;
+    }
     
-    if (wasConnected && !m_state.isConnected) {
-        qDebug() << ">>> РОБОТ ОТКЛЮЧЕН (нет данных > 10 сек)";
-        emit disconnected();
+    // Локальный relay снова доступен через разделяемую память
+    if (m_transportPreference != TransportPreference::Udp && now - m_lastShmProbeTime > static_cast<uint64_t>(SHM_PROBE_MS)) {
+        if (trySharedMemory()) {
+            sendSubscription(d1::ControlType::Unsubscribe);
+            m_worker->closeUdp();
+            return;
+        }
+    }
+    
+    // Продлеваем аренду подписки (заодно восстанавливает её после перезапуска relay)
+    if (now - m_lastSubscribeTime > static_cast<uint64_t>(SUBSCRIBE_RENEW_MS)) {
+        sendSubscription(d1::ControlType::Subscribe);
     }
 }
 
+void ArmController::sendSubscription(d1::ControlType type) {
+    if (!m_initialized) {
+        return;
+    }
+    
+    d1::ControlFrame ctrl;
+    ctrl.type = type;
+    ctrl.format = m_requestedFormat;
+    ctrl.rateHz = m_feedbackRateHz;
+    ctrl.port = m_worker->udpPort();
+    
+    uint8_t frame[d1::CONTROL_FRAME_SIZE];
+    size_t size = d1::encodeControlFrame(ctrl, frame);
+    m_cmdSocket->writeDatagram(reinterpret_cast<const char*>(frame), static_cast<qint64>(size),
+                               QHostAddress::LocalHost, UDP_CMD_PORT);
+    m_lastSubscribeTime = static_cast<qint64>(d1::monotonicNs() / 1000000);
+}
+
 void ArmController::enableMotors() {
     if (!m_initialized) return;
     
     qDebug() << "=== ВКЛЮЧЕНИЕ МОТОРОВ (улучшенная последовательность) ===";
     
+    // Повторное нажатие перезапускает последовательность, а не удваивает её
+    m_scheduler->cancelGroup(GROUP_ENABLE);
+    
     // Отправляем 3 команды включения с интервалами для надёжности
     for (int i = 0; i < 3; ++i) {
         int delay = i * 150;  // 0, 150, 300 мс
-        QTimer::singleShot(delay, this, [this, i]() {
+        m_scheduler->schedule(delay, CommandLane::Power, GROUP_ENABLE, "enable", [this, i]() {
             if (m_initialized) {
                 QString cmd = buildCommand(5, R"({"mode":1})");
                 sendCommand(cmd);
@@ -203,7 +482,7 @@ void ArmController::enableMotors() {
     }
     
     // Через 600мс фиксируем позицию быстро
-    QTimer::singleShot(600, this, [this]() {
+    m_scheduler->schedule(600, CommandLane::Power, GROUP_ENABLE, "enable-hold", [this]() {
         if (isConnected()) {
             qDebug() << "Фиксация позиции после включения...";
             holdCurrentPosition();
@@ -214,8 +493,14 @@ void ArmController::enableMotors() {
 void ArmController::disableMotors() {
     if (!m_initialized) return;
     
+    // Оставшиеся повторы включения не должны снова включить моторы
+    m_executor->stop();
+    m_scheduler->cancelGroup(GROUP_ENABLE);
+    m_scheduler->cancelGroup(GROUP_HOLD);
+    
     QString cmd = buildCommand(5, R"({"mode":0})");
     sendCommand(cmd);
+    abortTargets("моторы выключены");
     
     qDebug() << "Команда отключения моторов отправлена";
 }
@@ -225,18 +510,19 @@ void ArmController::resetErrors() {
     
     qDebug() << ">>> СБРОС ОШИБОК: начало полного цикла восстановления <<<";
     
+    m_scheduler->cancelGroup(GROUP_ENABLE);
+    m_scheduler->cancelGroup(GROUP_HOLD);
+    m_scheduler->cancelGroup(GROUP_RESET);
+    
     // Шаг 1: Отключаем моторы
     QString cmdOff = buildCommand(5, R"({"mode":0})");
     sendCommand(cmdOff);
     
     // Шаг 2: Сбрасываем локальный статус ошибки
-    {
-        QMutexLocker locker(&m_stateMutex);
-        m_state.errorStatus = 0;
-    }
+    m_worker->resetErrorStatus();
     
     // Шаг 3: Через 500мс отправляем ещё раз команду отключения (для надёжности)
-    QTimer::singleShot(500, this, [this]() {
+    m_scheduler->schedule(500, CommandLane::Power, GROUP_RESET, "reset-repeat", [this]() {
         QString cmdOff = buildCommand(5, R"({"mode":0})");
         sendCommand(cmdOff);
         qDebug() << "Сброс ошибок: повторная команда mode:0";
@@ -245,7 +531,7 @@ void ArmController::resetErrors() {
     // Шаг 4: Через 1.5 секунды можно включить моторы (если нужно автовключение)
     // Раскомментируйте следующий блок для автоматического включения после сброса:
     /*
-    QTimer::singleShot(1500, this, [this]() {
+    m_scheduler->schedule(1500, CommandLane::Power, GROUP_RESET, "reset-enable", [this]() {
         qDebug() << "Сброс ошибок: автовключение моторов";
         enableMotors();
     });
@@ -258,31 +544,50 @@ void ArmController::emergencyStop() {
     // НЕМЕДЛЕННАЯ аварийная остановка - прерывает все движения
     qDebug() << "!!! АВАРИЙНАЯ ОСТАНОВКА !!!";
     
-    // Увеличиваем счётчик команд - это отменит все запланированные команды
-    m_commandSequence++;
-    
     // Устанавливаем флаг - это прервёт новые команды
     m_emergencyStop = true;
     
+    // Поток траектории не отправит ни одной уставки после mode:0
+    m_executor->preempt();
+    
+    // Отменяем всё запланированное: движение, питание, отложенные действия GUI
+    m_scheduler->cancelLane(CommandLane::Motion);
+    m_scheduler->cancelLane(CommandLane::Power);
+    m_scheduler->cancelLane(CommandLane::Ui);
+    
     // Немедленно отключаем моторы
     if (m_initialized) {
         QString cmd = buildCommand(5, R"({"mode":0})");
         sendCommand(cmd);
         // Отправляем повторно для надёжности
         sendCommand(cmd);
+        
+        // И ещё раз чуть позже — на случай потери пакетов в момент остановки.
+        // Полоса Safety выполняется раньше любых команд с тем же сроком.
+        m_scheduler->cancelGroup(GROUP_ESTOP);
+        m_scheduler->schedule(ESTOP_REPEAT_MS, CommandLane::Safety, GROUP_ESTOP, "estop-repeat", [this]() {
+            if (m_initialized && m_emergencyStop) {
+                sendCommand(buildCommand(5, R"({"mode":0})"));
+            }
+        });
     }
+    
+    // Ожидающие прихода узнают об остановке после отправки mode:0
+    abortTargets("аварийная остановка");
 }
 
 void ArmController::clearEmergencyStop() {
     m_emergencyStop = false;
+    m_scheduler->cancelGroup(GROUP_ESTOP);
     qDebug() << "Флаг аварийной остановки сброшен";
     cancelAllPendingCommands();
 }
 
 void ArmController::cancelAllPendingCommands() {
-    // Увеличиваем счётчик - все запланированные команды будут игнорироваться
-    m_commandSequence++;
-    qDebug() << "Все запланированные команды отменены, sequence:" << m_commandSequence.load();
+    // Повторы питания не трогаем: остановка воспроизведения не отменяет включение моторов
+    m_executor->stop();
+    int cancelled = m_scheduler->cancelLane(CommandLane::Motion);
+    qDebug() << "Все запланированные команды движения отменены:" << cancelled;
 }
 
 void ArmController::holdCurrentPosition() {
@@ -293,12 +598,13 @@ void ArmController::holdCurrentPosition() {
     // Фиксируем все суставы на текущей позиции
     // Минимальный delay, т.к. движения нет - просто фиксация
     int delay = 50;  // Небольшая задержка перед началом
+    m_scheduler->cancelGroup(GROUP_HOLD);
     
     for (int i = 0; i < NUM_JOINTS; ++i) {
         if (i == 6) continue;  // Пропускаем грипер
         
         int jointIndex = i;
-        QTimer::singleShot(delay, this, [this, jointIndex]() {
+        m_scheduler->schedule(delay, CommandLane::Motion, GROUP_HOLD, "hold", [this, jointIndex]() {
             if (isConnected()) {
                 ArmState currentState = getState();
                 double safeAngle = clampAngle(jointIndex, currentState.joints[jointIndex].angle);
@@ -325,13 +631,13 @@ void ArmController::setJointAngle(int jointId, double angle, int delayMs) {
     // Применяем лимиты
     double clampedAngle = clampAngle(jointId, angle);
     
-    QString data = QString(R"({"id":%1,"angle":%2,"delay_ms":%3})")
-                       .arg(jointId)
-                       .arg(clampedAngle, 0, 'f', 2)
-                       .arg(delayMs);
-    
-    QString cmd = buildCommand(1, data);
+    QString cmd = buildCommand(1, jointCommandData(jointId, clampedAngle, delayMs));
     sendCommand(cmd);
+    if (jointId == 6) {
+        m_gripperTarget = clampedAngle;
+        m_gripperCommanded = true;
+    }
+    m_latencyMonitor.recordMotionCommand(d1::monotonicNs());
 }
 
 void ArmController::setAllJointAngles(const std::array<double, NUM_JOINTS>& angles, int delayMs) {
@@ -347,17 +653,32 @@ void ArmController::setAllJointAngles(const std::array<double, NUM_JOINTS>& angl
     
     // ПРОВЕРКА АВАРИЙНОЙ ОСТАНОВКИ
     if (m_emergencyStop) {
-        qDebug() << "setAllJointAngles: отменено - аварийная остановка";
+        D1_LOG_INFO(LOG_ARM, "setAllJointAngles: отменено - аварийная остановка");
         return;
     }
     
-    // Захватываем текущий sequence для проверки в лямбдах
-    uint32_t capturedSequence = m_commandSequence.load();
+    // Дискретная цель заменяет исполняемую траекторию
+    m_executor->stop();
     
-    // Получаем текущее состояние для логирования
-    ArmState currentState = getState();
+    bool useSync = m_multiJointMode == MultiJointMode::Synchronized
+                || (m_multiJointMode == MultiJointMode::Auto && !m_syncUnsupported);
+    
+    if (m_skewMeasurementEnabled) {
+        startSkewProbe(angles, useSync);
+    }
+    
+    if (useSync) {
+        sendSyncCommand(angles, delayMs);
+    } else {
+        sendPerJointCommands(angles, delayMs);
+    }
+}
+
+void ArmController::sendPerJointCommands(const std::array<double, NUM_JOINTS>& angles, int delayMs) {
+    // Новая цель заменяет ещё не отправленные суставы предыдущей
+    m_scheduler->cancelGroup(GROUP_MOTION);
     
-    qDebug() << "setAllJointAngles: синхронное движение, время перехода:" << delayMs << "мс";
+    D1_LOG_INFO(LOG_ARM, "setAllJointAngles: поочерёдные команды, время перехода: %d мс", delayMs);
     
     // Отправляем команды на все суставы с небольшими задержками
     // чтобы избежать переполнения буфера на шине
@@ -367,18 +688,19 @@ void ArmController::setAllJointAngles(const std::array<double, NUM_JOINTS>& angl
     for (int i = 0; i < NUM_JOINTS; ++i) {
         if (i == 6) continue;  // Пропускаем грипер
         
-        // Проверяем аварийную остановку и sequence
-        if (m_emergencyStop || m_commandSequence.load() != capturedSequence) {
-            qDebug() << "setAllJointAngles: прервано на суставе" << i;
+        // Проверяем аварийную остановку
+        if (m_emergencyStop) {
+            D1_LOG_INFO(LOG_ARM, "setAllJointAngles: прервано на суставе %d", i);
             return;
         }
         
         double clampedAngle = clampAngle(i, angles[i]);
         
-        // Отправляем команду с задержкой
+        // Отправляем команду с задержкой; отмена — через группу в планировщике
         int jointIndex = i;
-        QTimer::singleShot(jointDelay, this, [this, jointIndex, clampedAngle, delayMs, capturedSequence]() {
-            if (m_emergencyStop || m_commandSequence.load() != capturedSequence) return;
+        m_scheduler->schedule(jointDelay, CommandLane::Motion, GROUP_MOTION, "joint",
+                              [this, jointIndex, clampedAngle, delayMs]() {
+            if (m_emergencyStop) return;
             if (m_initialized && isConnected()) {
                 setJointAngle(jointIndex, clampedAngle, delayMs);
             }
@@ -387,7 +709,163 @@ void ArmController::setAllJointAngles(const std::array<double, NUM_JOINTS>& angl
         jointDelay += INTER_JOINT_DELAY_MS;
     }
     
-    qDebug() << "setAllJointAngles: команды запланированы с интервалом" << INTER_JOINT_DELAY_MS << "мс";
+    D1_LOG_INFO(LOG_ARM, "setAllJointAngles: команды запланированы с интервалом %d мс", INTER_JOINT_DELAY_MS);
+}
+
+void ArmController::sendSyncCommand(const std::array<double, NUM_JOINTS>& angles, int delayMs) {
+    ArmState currentState = getState();
+    
+    // Одна команда funcode 2 — все суставы стартуют одновременно.
+    // Грипер не трогаем: повторяем его последнюю уставку.
+    std::array<double, NUM_JOINTS> targets;
+    double maxDeltaDeg = 0.0;
+    for (int i = 0; i < NUM_JOINTS; ++i) {
+        targets[i] = (i == 6) ? gripperTarget() : clampAngle(i, angles[i]);
+        if (i != 6) {
+            maxDeltaDeg = std::max(maxDeltaDeg, std::abs(targets[i] - currentState.joints[i].angle));
+        }
+    }
+    
+    sendCommand(buildCommand(2, syncCommandData(targets, delayMs)));
+    m_latencyMonitor.recordMotionCommand(d1::monotonicNs());
+    
+    D1_LOG_INFO(LOG_ARM, "setAllJointAngles: синхронная команда funcode 2, время перехода: %d мс", delayMs);
+    
+    // В режиме Auto проверяем, что рука реагирует на funcode 2. По мелкому
+    // перемещению вывод не делаем: порог старта можно не пройти и при ответе.
+    if (m_multiJointMode == MultiJointMode::Auto && !m_syncConfirmed
+        && maxDeltaDeg >= SYNC_PROBE_MIN_DELTA_DEG) {
+        std::array<double, NUM_JOINTS> startAngles;
+        for (int i = 0; i < NUM_JOINTS; ++i) {
+            startAngles[i] = currentState.joints[i].angle;
+        }
+        m_scheduler->cancelGroup(GROUP_SYNC_PROBE);
+        m_scheduler->schedule(syncProbeWindowMs(maxDeltaDeg, delayMs), CommandLane::Motion, GROUP_SYNC_PROBE, "sync-probe",
+                              [this, startAngles, targets, delayMs]() {
+            probeSyncResponse(startAngles, targets, delayMs);
+        });
+    }
+}
+
+int ArmController::syncProbeWindowMs(double maxDeltaDeg, int delayMs) {
+    // Рука интерполирует переход сама; при плавном профиле доля пути f
+    // проходится не позже, чем за долю времени sqrt(f). Медленный переход
+    // или малое перемещение проходят порог старта позже — окно растёт.
+    const double fraction = std::min(1.0, MOTION_START_THRESHOLD_DEG / maxDeltaDeg);
+    return SYNC_PROBE_MS + static_cast<int>(std::max(0, delayMs) * std::sqrt(fraction));
+}
+
+void ArmController::probeSyncResponse(const std::array<double, NUM_JOINTS>& startAngles,
+                                      const std::array<double, NUM_JOINTS>& targets,
+                                      int delayMs) {
+    if (m_syncConfirmed || m_syncUnsupported) {
+        return;
+    }
+    
+    ArmState state = getState();
+    
+    // Проба имеет смысл только при включённых моторах и без ошибок
+    if (!state.isConnected || state.powerStatus != 1 || state.errorStatus != 0) {
+        return;
+    }
+    
+    bool expectedMotion = false;
+    for (int i = 0; i < NUM_JOINTS; ++i) {
+        if (i == 6) continue;
+        if (std::abs(targets[i] - startAngles[i]) < SYNC_PROBE_MIN_DELTA_DEG) continue;
+        expectedMotion = true;
+        if (std::abs(state.joints[i].angle - startAngles[i]) > MOTION_START_THRESHOLD_DEG) {
+            m_syncConfirmed = true;
+            qDebug() << "funcode 2 подтверждён: рука отвечает на синхронные команды";
+            return;
+        }
+    }
+    
+    if (!expectedMotion) {
+        return;
+    }
+    
+    // Рука не сдвинулась — откатываемся на поочерёдные команды и повторяем цель
+    m_syncUnsupported = true;
+    qWarning() << "funcode 2 не поддерживается рукой, переход на команды funcode 1";
+    
+    // Отменённая проба сюда не попадает, остаётся только аварийная остановка
+    if (!m_emergencyStop) {
+        sendPerJointCommands(targets, delayMs);
+    }
+}
+
+void ArmController::setMultiJointMode(MultiJointMode mode) {
+    m_multiJointMode = mode;
+    
+    // Новый выбор режима — новая проба
+    m_syncConfirmed = false;
+    m_syncUnsupported = false;
+}
+
+void ArmController::setCollisionCheckEnabled(bool enabled) {
+    CollisionConfig config = m_collision.config();
+    config.enabled = enabled;
+    m_collision.setConfig(config);
+    qDebug() << "Проверка столкновений:" << (enabled ? "включена" : "выключена");
+}
+
+void ArmController::setSkewMeasurementEnabled(bool enabled) {
+    m_skewMeasurementEnabled = enabled;
+    m_worker->cancelSkewProbe();
+    if (enabled) {
+        m_skewStats[0] = SkewStats();
+        m_skewStats[1] = SkewStats();
+    }
+}
+
+void ArmController::startSkewProbe(const std::array<double, NUM_JOINTS>& targets, bool synchronized) {
+    ArmState state = getState();
+    
+    SkewProbe probe;
+    probe.synchronized = synchronized;
+    probe.commandNs = d1::monotonicNs();
+    probe.thresholdDeg = MOTION_START_THRESHOLD_DEG;
+    probe.timeoutNs = SKEW_PROBE_TIMEOUT_NS;
+    
+    int expectedCount = 0;
+    for (int i = 0; i < NUM_JOINTS; ++i) {
+        probe.startAngles[i] = state.joints[i].angle;
+        probe.expected[i] = (i != 6)
+            && std::abs(clampAngle(i, targets[i]) - state.joints[i].angle) >= SYNC_PROBE_MIN_DELTA_DEG;
+        expectedCount += probe.expected[i] ? 1 : 0;
+    }
+    
+    // Для рассинхронизации нужны минимум два движущихся сустава.
+    // Старт суставов ловится в потоке приёма по каждой выборке, а не по уведомлениям GUI.
+    probe.active = expectedCount >= 2;
+    m_worker->startSkewProbe(probe);
+}
+
+void ArmController::onWorkerSkewMeasured(double skewMs, bool synchronized) {
+    SkewStats& stats = m_skewStats[synchronized ? 1 : 0];
+    stats.count++;
+    stats.sumMs += skewMs;
+    stats.maxMs = std::max(stats.maxMs, skewMs);
+    
+    D1_LOG_INFO(LOG_ARM, "Рассинхронизация старта суставов: %.1f мс %s", skewMs,
+                synchronized ? "(funcode 2)" : "(funcode 1)");
+    emit jointStartSkewMeasured(skewMs, synchronized);
+}
+
+QString ArmController::skewReport() const {
+    auto line = [](const char* title, const SkewStats& st) {
+        if (st.count == 0) {
+            return QString("%1: нет данных").arg(title);
+        }
+        return QString("%1: среднее %2 мс, максимум %3 мс (%4 измерений)")
+            .arg(title)
+            .arg(st.sumMs / st.count, 0, 'f', 1)
+            .arg(st.maxMs, 0, 'f', 1)
+            .arg(st.count);
+    };
+    return line("funcode 1 (поочерёдно)", m_skewStats[0]) + "\n"
+         + line("funcode 2 (синхронно)", m_skewStats[1]);
 }
 
 void ArmController::setAllJointAnglesInterpolated(const std::array<double, NUM_JOINTS>& targetAngles, int totalTimeMs, int stepsCount) {
@@ -403,36 +881,115 @@ void ArmController::setAllJointAnglesInterpolated(const std::array<double, NUM_J
     
     // ПРОВЕРКА АВАРИЙНОЙ ОСТАНОВКИ
     if (m_emergencyStop) {
-        qDebug() << "setAllJointAnglesInterpolated: отменено - аварийная остановка";
+        D1_LOG_INFO(LOG_ARM, "setAllJointAnglesInterpolated: отменено - аварийная остановка");
         return;
     }
     
-    // Получаем текущее состояние
+    // Частота уставок — из настроек исполнителя, а не из числа шагов
+    Q_UNUSED(stepsCount);
+    
+    // Переход с нулевой скоростью на концах, уставки с фиксированной частотой
+    // из потока исполнителя; раньше шаги вызывали рывки, потому что шли из GUI
     ArmState currentState = getState();
+    JointVector from;
+    for (int i = 0; i < NUM_JOINTS; ++i) {
+        from[i] = currentState.joints[i].angle;
+    }
+    JointTrajectory trajectory = JointTrajectory::pointToPoint(from, targetAngles, totalTimeMs / 1000.0);
     
-    // УПРОЩЕННАЯ РЕАЛИЗАЦИЯ:
-    // Вместо ручной разбивки на шаги (которая вызывает рывки),
-    // мы доверяем встроенной интерполяции робота.
-    // Мы отправляем ОДНУ команду с полным временем выполнения.
+    D1_LOG_INFO(LOG_ARM, "setAllJointAnglesInterpolated: траектория за %d мс", totalTimeMs);
     
-    qDebug() << "setAllJointAnglesInterpolated: Отправка единой команды"
-             << "время:" << totalTimeMs << "мс";
-             
-    setAllJointAngles(targetAngles, totalTimeMs);
+    if (executeTrajectory(trajectory) == 0) {
+        // Исполнитель недоступен — одна команда со встроенной интерполяцией руки
+        setAllJointAngles(targetAngles, totalTimeMs);
+    }
+}
+
+quint64 ArmController::executeTrajectory(const JointTrajectory& trajectory) {
+    if (!m_initialized || !isConnected() || m_emergencyStop) {
+        return 0;
+    }
+    
+    // Дискретные команды движения не должны перемешиваться с потоком уставок
+    m_scheduler->cancelGroup(GROUP_MOTION);
+    m_scheduler->cancelGroup(GROUP_SYNC_PROBE);
+    m_scheduler->cancelGroup(GROUP_HOLD);
+    
+    StreamSink::Context context;
+    context.transport = m_transport;
+    context.synchronized = m_multiJointMode == MultiJointMode::Synchronized
+                        || (m_multiJointMode == MultiJointMode::Auto && !m_syncUnsupported);
+    context.gripperAngle = gripperTarget();
+    context.limits = m_jointLimits;
+    
+    TrajectoryConfig config = m_executor->config();
+    D1_LOG_INFO(LOG_ARM, "Траектория: %d точек, %.2f с, уставки %d Гц (%s)",
+                trajectory.waypointCount(), trajectory.durationSec(), config.rateHz,
+                context.synchronized ? "funcode 2" : "funcode 1");
+    
+    m_latencyMonitor.recordMotionCommand(d1::monotonicNs());
+    return m_executor->start(trajectory, m_jointLimits, [this, context]() {
+        return std::unique_ptr<SetpointSink>(new StreamSink(this, context));
+    });
+}
+
+void ArmController::streamSetpoint(const std::array<double, NUM_JOINTS>& angles, int reachMs) {
+    if (!m_initialized || !isConnected() || m_emergencyStop) {
+        return;
+    }
+    
+    if (m_executor->isRunning()) {
+        m_executor->stop();
+    }
+    m_scheduler->cancelGroup(GROUP_MOTION);
+    m_scheduler->cancelGroup(GROUP_HOLD);
+    
+    std::array<double, NUM_JOINTS> targets;
+    for (int i = 0; i < NUM_JOINTS; ++i) {
+        targets[i] = (i == 6) ? gripperTarget() : clampAngle(i, angles[i]);
+    }
     
-    // Эмуляция завершения для логирования (опционально)
-    // QTimer::singleShot(totalTimeMs, this, [](){ qDebug() << "Интерполяция (нативная) завершена"; });
+    bool useSync = m_multiJointMode == MultiJointMode::Synchronized
+                || (m_multiJointMode == MultiJointMode::Auto && !m_syncUnsupported);
+    if (useSync) {
+        sendCommand(buildCommand(2, syncCommandData(targets, reachMs)));
+    } else {
+        for (int i = 0; i < NUM_JOINTS - 1; ++i) {
+            sendCommand(buildCommand(1, jointCommandData(i, targets[i], reachMs)));
+        }
+    }
+    m_latencyMonitor.recordMotionCommand(d1::monotonicNs());
 }
 
-void ArmController::moveToHome() {
+void ArmController::stopTrajectory() {
+    m_executor->stop();
+}
+
+void ArmController::onTrajectoryFinished(quint64 trajectoryId, bool completed, const QString& reason) {
+    TrajectoryReport report = m_executor->lastReport();
+    if (completed) {
+        D1_LOG_INFO(LOG_ARM, "Траектория %s: %llu уставок, отклонение rms %.2f° (макс J%d), опозданий тика %llu (пропущено %llu)",
+                    qPrintable(reason), static_cast<unsigned long long>(report.setpoints),
+                    report.rmsTrackingErrorDeg, report.worstJoint + 1,
+                    static_cast<unsigned long long>(report.overruns),
+                    static_cast<unsigned long long>(report.skippedTicks));
+    } else {
+        D1_LOG_WARN(LOG_ARM, "Траектория прервана: %s (J%d, отклонение до %.1f°)",
+                    qPrintable(reason), report.worstJoint + 1,
+                    report.worstJoint >= 0 ? report.maxTrackingErrorDeg[report.worstJoint] : 0.0);
+    }
+    emit trajectoryFinished(trajectoryId, completed, reason);
+}
+
+quint64 ArmController::moveToHome() {
     if (!m_initialized) {
         qWarning() << "ArmController: попытка moveToHome без инициализации!";
-        return;
+        return 0;
     }
     
     if (!isConnected()) {
         qWarning() << "ArmController: робот не подключён, moveToHome отменён";
-        return;
+        return 0;
     }
     
     // Вычисляем время перехода по максимальному угловому расстоянию
@@ -450,9 +1007,71 @@ void ArmController::moveToHome() {
     
     qDebug() << "Переход в домашнюю позицию, макс дельта:" << maxDelta << "°, время:" << transitionMs << "мс";
     setAllJointAnglesInterpolated(m_homePosition, transitionMs, 10);
+    return awaitTarget(m_homePosition, transitionMs);
 }
 
+quint64 ArmController::awaitTarget(const std::array<double, NUM_JOINTS>& angles, int expectedMs,
+                                   const ConvergenceOptions& options) {
+    if (!m_initialized || !isConnected()) {
+        return 0;
+    }
+    JointVector targets;
+    for (int i = 0; i < NUM_JOINTS; ++i) {
+        targets[i] = clampAngle(i, angles[i]);
+    }
+    return m_convergence.add(targets, expectedMs, options, d1::monotonicNs());
+}
 
+void ArmController::cancelTarget(quint64 handle) {
+    m_convergence.cancel(handle);
+}
+
+void ArmController::startFeedbackRecording(FeedbackRecording* recording) {
+    m_worker->startRecording(recording);
+}
+
+void ArmController::stopFeedbackRecording() {
+    m_worker->stopRecording();
+}
+
+void ArmController::abortTargets(const QString& reason) {
+    if (m_convergence.pendingCount() == 0) {
+        return;
+    }
+    std::vector<ConvergenceEvent> events;
+    m_convergence.abortAll(d1::monotonicNs(), events);
+    dispatchConvergenceEvents(events, reason);
+}
+
+void ArmController::dispatchConvergenceEvents(const std::vector<ConvergenceEvent>& events, const QString& abortReason) {
+    // Обработчики могут ставить новые цели — список событий уже отделён от трекера
+    for (const ConvergenceEvent& event : events) {
+        switch (event.kind) {
+            case ConvergenceEvent::Reached:
+                emit targetReached(event.handle, event.elapsedMs);
+                break;
+            case ConvergenceEvent::TimedOut:
+                if (event.worstJoint < 0) {
+                    emit targetFailed(event.handle, true, "таймаут: нет feedback");
+                    break;
+                }
+                D1_LOG_WARN(LOG_ARM, "Цель не достигнута за %d мс: J%d отклоняется на %.1f°",
+                            event.elapsedMs, event.worstJoint + 1, event.worstErrorDeg);
+                emit targetFailed(event.handle, true, QString("таймаут: J%1 не дошёл на %2°")
+                                                          .arg(event.worstJoint + 1)
+                                                          .arg(event.worstErrorDeg, 0, 'f', 1));
+                break;
+            case ConvergenceEvent::Aborted:
+                emit targetFailed(event.handle, false, abortReason);
+                break;
+        }
+    }
+}
+
+double ArmController::gripperTarget() const {
+    // До первой команды грипера уставки нет — держим измеренное положение
+    return m_gripperCommanded ? m_gripperTarget : getState().joints[6].angle;
+}
 
 void ArmController::setGripperPosition(double position) {
     // J6 или J7 для грипера (зависит от конфигурации)
@@ -482,31 +1101,34 @@ std::array<double, NUM_JOINTS> ArmController::getHomePosition() const {
 }
 
 ArmState ArmController::getState() const {
-    QMutexLocker locker(&m_stateMutex);
-    return m_state;
+    return m_worker->state();
+}
+
+ArmStatus ArmController::getStatus() const {
+    return m_worker->status();
+}
+
+uint32_t ArmController::stateVersion() const {
+    return m_worker->stateVersion();
 }
 
 double ArmController::getJointAngle(int jointId) const {
-    QMutexLocker locker(&m_stateMutex);
     if (jointId >= 0 && jointId < NUM_JOINTS) {
-        return m_state.joints[jointId].angle;
+        return m_worker->state().joints[jointId].angle;
     }
     return 0.0;
 }
 
 bool ArmController::isConnected() const {
-    QMutexLocker locker(&m_stateMutex);
-    return m_state.isConnected;
+    return m_worker->status().isConnected;
 }
 
 bool ArmController::hasError() const {
-    QMutexLocker locker(&m_stateMutex);
-    return m_state.errorStatus != 0;
+    return m_worker->status().errorStatus != 0;
 }
 
 int ArmController::getErrorCode() const {
-    QMutexLocker locker(&m_stateMutex);
-    return m_state.errorStatus;
+    return m_worker->status().errorStatus;
 }
 
 double ArmController::clampAngle(int jointId, double angle) const {
@@ -615,6 +1237,22 @@ void ArmController::processRecovery() {
     }
 }
 
+QString ArmController::jointCommandData(int jointId, double angle, int delayMs) {
+    return QString(R"({"id":%1,"angle":%2,"delay_ms":%3})")
+               .arg(jointId)
+               .arg(angle, 0, 'f', 2)
+               .arg(delayMs);
+}
+
+QString ArmController::syncCommandData(const std::array<double, NUM_JOINTS>& targets, int delayMs) {
+    QString data = QStringLiteral(R"({"mode":1)");
+    for (int i = 0; i < NUM_JOINTS; ++i) {
+        data += QString(R"(,"angle%1":%2)").arg(i).arg(targets[i], 0, 'f', 2);
+    }
+    data += QString(R"(,"delay_ms":%1})").arg(delayMs);
+    return data;
+}
+
 QString ArmController::buildCommand(int funcode, const QString& dataJson) {
     uint32_t seq = ++m_seqCounter;
     return QString(R"({"seq":%1,"address":1,"funcode":%2,"data":%3})")
@@ -628,10 +1266,27 @@ void ArmController::sendCommand(const QString& jsonCmd) {
         return;
     }
     
+#ifdef D1_WITH_RELAY_CORE
+    // Встроенное ядро: команда сразу в очередь публикации DDS
+    if (m_transport == FeedbackTransport::InProcess && m_relayCore) {
+        m_relayCore->submitCommand(jsonCmd.toStdString());
+        return;
+    }
+#endif
+    
     QByteArray data = jsonCmd.toUtf8();
+    
+    // Локальный relay: команда кладётся в кольцо разделяемой памяти
+    if (m_transport == FeedbackTransport::SharedMemory) {
+        std::lock_guard<std::mutex> lock(m_shmSendMutex);
+        if (m_shm.isProducer() && m_shm.pushCommand(data.constData(), static_cast<size_t>(data.size()))) {
+            return;
+        }
+    }
+    
     qint64 sent = m_cmdSocket->writeDatagram(data, QHostAddress::LocalHost, UDP_CMD_PORT);
     
     if (sent < 0) {
-        qWarning() << "Ошибка отправки команды:" << m_cmdSocket->errorString();
+        D1_LOG_WARN(LOG_ARM, "Ошибка отправки команды: %s", qPrintable(m_cmdSocket->errorString()));
     }
 }
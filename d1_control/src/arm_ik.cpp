@@ -0,0 +1,282 @@
+#include "arm_ik.h"
+#include "reachability_map.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+constexpr double DEG_TO_RAD = M_PI / 180.0;
+constexpr double RAD_TO_DEG = 180.0 / M_PI;
+constexpr double MAX_DAMPING = 1e3;
+
+using Vector6 = std::array<double, 6>;
+using Matrix6 = std::array<std::array<double, 6>, 6>;
+
+// Решение A·x = b для симметричной положительно определённой A (Холецкий).
+// A = J·Jᵀ + λ²I с λ > 0 — всегда положительно определена.
+bool choleskySolve(Matrix6& a, Vector6& b) {
+    for (int i = 0; i < 6; ++i) {
+        for (int j = 0; j <= i; ++j) {
+            double sum = a[i][j];
+            for (int k = 0; k < j; ++k) {
+                sum -= a[i][k] * a[j][k];
+            }
+            if (i == j) {
+                if (sum <= 0.0) {
+                    return false;
+                }
+                a[i][i] = std::sqrt(sum);
+            } else {
+                a[i][j] = sum / a[j][j];
+            }
+        }
+    }
+    for (int i = 0; i < 6; ++i) {
+        double sum = b[i];
+        for (int k = 0; k < i; ++k) {
+            sum -= a[i][k] * b[k];
+        }
+        b[i] = sum / a[i][i];
+    }
+    for (int i = 5; i >= 0; --i) {
+        double sum = b[i];
+        for (int k = i + 1; k < 6; ++k) {
+            sum -= a[k][i] * b[k];
+        }
+        b[i] = sum / a[i][i];
+    }
+    return true;
+}
+
+struct PoseError {
+    Vector6 e{};               // Положение (м) и взвешенная ориентация
+    double positionM = 0.0;
+    double orientationRad = 0.0;
+    double norm = 0.0;
+};
+
+PoseError poseError(const RigidTransform& target, const RigidTransform& current, const IkOptions& options) {
+    PoseError error;
+    double positionSq = 0.0;
+    for (int r = 0; r < 3; ++r) {
+        error.e[r] = target.position[r] - current.position[r];
+        positionSq += error.e[r] * error.e[r];
+    }
+    error.positionM = std::sqrt(positionSq);
+
+    double weighted = positionSq;
+    if (!options.positionOnly) {
+        std::array<double, 3> w = ArmIkSolver::orientationError(target, current);
+        double orientationSq = w[0] * w[0] + w[1] * w[1] + w[2] * w[2];
+        error.orientationRad = std::sqrt(orientationSq);
+        for (int r = 0; r < 3; ++r) {
+            error.e[3 + r] = options.orientationWeightM * w[r];
+        }
+        weighted += options.orientationWeightM * options.orientationWeightM * orientationSq;
+    }
+    error.norm = std::sqrt(weighted);
+    return error;
+}
+
+} // namespace
+
+ArmIkSolver::ArmIkSolver(const ArmKinematics& kinematics)
+    : m_kinematics(kinematics)
+{
+    m_lowerDeg.fill(-180.0);
+    m_upperDeg.fill(180.0);
+    for (int j = 0; j < KINEMATIC_JOINTS; ++j) {
+        m_lowerDeg[j] = kinematics.lowerLimitDeg(j);
+        m_upperDeg[j] = kinematics.upperLimitDeg(j);
+    }
+}
+
+void ArmIkSolver::setJointLimits(const JointVector& lowerDeg, const JointVector& upperDeg) {
+    for (int j = 0; j < NUM_JOINTS; ++j) {
+        m_lowerDeg[j] = std::min(lowerDeg[j], upperDeg[j]);
+        m_upperDeg[j] = std::max(lowerDeg[j], upperDeg[j]);
+    }
+}
+
+std::array<double, 3> ArmIkSolver::orientationError(const RigidTransform& target, const RigidTransform& current) {
+    // R = Rt · Rcᵀ
+    const double* a = target.rotation.data();
+    const double* b = current.rotation.data();
+    double r[9];
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            r[3 * i + j] = a[3 * i] * b[3 * j] + a[3 * i + 1] * b[3 * j + 1] + a[3 * i + 2] * b[3 * j + 2];
+        }
+    }
+
+    const double cosAngle = std::max(-1.0, std::min((r[0] + r[4] + r[8] - 1.0) * 0.5, 1.0));
+    const double angle = std::acos(cosAngle);
+    const std::array<double, 3> vee = {{r[7] - r[5], r[2] - r[6], r[3] - r[1]}};
+
+    if (angle < 1e-6) {
+        return {{0.5 * vee[0], 0.5 * vee[1], 0.5 * vee[2]}};
+    }
+    if (angle > M_PI - 1e-6) {
+        // Поворот на 180°: ось из диагонали, знаки — по наибольшей компоненте
+        std::array<double, 3> axis = {{
+            std::sqrt(std::max(0.0, (r[0] + 1.0) * 0.5)),
+            std::sqrt(std::max(0.0, (r[4] + 1.0) * 0.5)),
+            std::sqrt(std::max(0.0, (r[8] + 1.0) * 0.5))
+        }};
+        if (axis[0] >= axis[1] && axis[0] >= axis[2]) {
+            axis[1] = std::copysign(axis[1], r[1] + r[3]);
+            axis[2] = std::copysign(axis[2], r[2] + r[6]);
+        } else if (axis[1] >= axis[2]) {
+            axis[0] = std::copysign(axis[0], r[1] + r[3]);
+            axis[2] = std::copysign(axis[2], r[5] + r[7]);
+        } else {
+            axis[0] = std::copysign(axis[0], r[2] + r[6]);
+            axis[1] = std::copysign(axis[1], r[5] + r[7]);
+        }
+        return {{axis[0] * angle, axis[1] * angle, axis[2] * angle}};
+    }
+    const double scale = angle / (2.0 * std::sin(angle));
+    return {{vee[0] * scale, vee[1] * scale, vee[2] * scale}};
+}
+
+IkResult ArmIkSolver::solve(const RigidTransform& target, const JointVector& seedDeg, const IkOptions& options) const {
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start = Clock::now();
+
+    IkResult result;
+    result.anglesDeg = seedDeg;
+    JointVector& q = result.anglesDeg;
+    for (int j = 0; j < KINEMATIC_JOINTS; ++j) {
+        q[j] = std::max(m_lowerDeg[j], std::min(q[j], m_upperDeg[j]));
+    }
+
+    KinematicFrames frames;
+    m_kinematics.forward(q, frames);
+    PoseError error = poseError(target, frames.tcp, options);
+
+    const double orientationWeight = options.positionOnly ? 0.0 : options.orientationWeightM;
+    const double maxStepRad = options.maxStepDeg * DEG_TO_RAD;
+    double damping = std::max(1e-6, options.initialDamping);
+    KinematicJacobian jacobian;
+    bool jacobianValid = false;
+
+    result.status = IkResult::MaxIterations;
+    for (int iteration = 0; iteration < options.maxIterations; ++iteration) {
+        if (error.positionM <= options.positionToleranceM
+            && (options.positionOnly || error.orientationRad <= options.orientationToleranceRad)) {
+            result.status = IkResult::Converged;
+            break;
+        }
+        if (options.timeBudgetUs > 0
+            && Clock::now() - start > std::chrono::microseconds(options.timeBudgetUs)) {
+            result.status = IkResult::TimeBudget;
+            break;
+        }
+        result.iterations = iteration + 1;
+
+        // Якобиан меняется только после принятого шага
+        if (!jacobianValid) {
+            m_kinematics.jacobian(frames, jacobian);
+            for (int r = 3; r < 6; ++r) {
+                for (int j = 0; j < KINEMATIC_JOINTS; ++j) {
+                    jacobian[r][j] *= orientationWeight;
+                }
+            }
+            jacobianValid = true;
+        }
+
+        // (J·Jᵀ + λ²I)·y = e,  dq = Jᵀ·y
+        Matrix6 a;
+        for (int r = 0; r < 6; ++r) {
+            for (int c = 0; c <= r; ++c) {
+                double sum = 0.0;
+                for (int j = 0; j < KINEMATIC_JOINTS; ++j) {
+                    sum += jacobian[r][j] * jacobian[c][j];
+                }
+                a[r][c] = sum;
+                a[c][r] = sum;
+            }
+            a[r][r] += damping * damping;
+        }
+        Vector6 y = error.e;
+        if (!choleskySolve(a, y)) {
+            result.status = IkResult::Stalled;
+            break;
+        }
+
+        std::array<double, KINEMATIC_JOINTS> dq;
+        double largest = 0.0;
+        for (int j = 0; j < KINEMATIC_JOINTS; ++j) {
+            double sum = 0.0;
+            for (int r = 0; r < 6; ++r) {
+                sum += jacobian[r][j] * y[r];
+            }
+            dq[j] = sum;
+            largest = std::max(largest, std::abs(sum));
+        }
+        const double stepScale = largest > maxStepRad ? maxStepRad / largest : 1.0;
+
+        JointVector candidate = q;
+        for (int j = 0; j < KINEMATIC_JOINTS; ++j) {
+            candidate[j] = std::max(m_lowerDeg[j],
+                                    std::min(q[j] + dq[j] * stepScale * RAD_TO_DEG, m_upperDeg[j]));
+        }
+
+        KinematicFrames candidateFrames;
+        m_kinematics.forward(candidate, candidateFrames);
+        PoseError candidateError = poseError(target, candidateFrames.tcp, options);
+
+        if (candidateError.norm < error.norm) {
+            q = candidate;
+            frames = candidateFrames;
+            error = candidateError;
+            jacobianValid = false;
+            damping = std::max(1e-6, damping * 0.5);
+        } else {
+            damping *= 4.0;
+            if (damping > MAX_DAMPING) {
+                result.status = IkResult::Stalled;
+                break;
+            }
+        }
+    }
+
+    // Последняя итерация могла довести до допуска
+    if (result.status == IkResult::MaxIterations
+        && error.positionM <= options.positionToleranceM
+        && (options.positionOnly || error.orientationRad <= options.orientationToleranceRad)) {
+        result.status = IkResult::Converged;
+    }
+
+    result.positionErrorM = error.positionM;
+    result.orientationErrorRad = error.orientationRad;
+    result.solveUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    return result;
+}
+
+IkResult ArmIkSolver::solveAnywhere(const RigidTransform& target, const JointVector& seedDeg,
+                                    const IkOptions& options) const {
+    IkResult result = solve(target, seedDeg, options);
+    JointVector mapSeed;
+    if (result.converged() || !m_map || !m_map->seedFor(target, mapSeed)) {
+        return result;
+    }
+    mapSeed[NUM_JOINTS - 1] = seedDeg[NUM_JOINTS - 1];
+
+    IkResult retry = solve(target, mapSeed, options);
+    IkResult& best = (retry.converged() || retry.positionErrorM < result.positionErrorM) ? retry : result;
+    best.iterations = result.iterations + retry.iterations;
+    best.solveUs = result.solveUs + retry.solveUs;
+    return best;
+}
+
+const char* ArmIkSolver::statusName(IkResult::Status status) {
+    switch (status) {
+        case IkResult::Converged: return "решение найдено";
+        case IkResult::MaxIterations: return "не сошлось за отведённые итерации";
+        case IkResult::TimeBudget: return "превышено время решения";
+        case IkResult::Stalled: return "цель недостижима";
+    }
+    return "";
+}
@@ -0,0 +1,322 @@
+#include "arm_kinematics.h"
+#include <QFile>
+#include <QMap>
+#include <QStringList>
+#include <QVector>
+#include <QXmlStreamReader>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr double DEG_TO_RAD = M_PI / 180.0;
+constexpr double RAD_TO_DEG = 180.0 / M_PI;
+
+struct UrdfJoint {
+    QString name;
+    QString type;
+    QString parent;
+    QString child;
+    std::array<double, 6> origin{};          // xyz, rpy
+    std::array<double, 3> axis{{1, 0, 0}};   // URDF: ось по умолчанию — X
+    double lower = 0.0;
+    double upper = 0.0;
+};
+
+bool parseVector(const QStringRef& text, double* out, int count) {
+    QStringList parts = text.toString().simplified().split(' ');
+    if (parts.size() != count) {
+        return false;
+    }
+    for (int i = 0; i < count; ++i) {
+        bool ok = false;
+        out[i] = parts[i].toDouble(&ok);
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+// ============= RigidTransform =============
+
+RigidTransform RigidTransform::fromXyzRpy(double x, double y, double z, double roll, double pitch, double yaw) {
+    const double cr = std::cos(roll), sr = std::sin(roll);
+    const double cp = std::cos(pitch), sp = std::sin(pitch);
+    const double cy = std::cos(yaw), sy = std::sin(yaw);
+
+    RigidTransform t;
+    t.rotation = {{
+        cy * cp, cy * sp * sr - sy * cr, cy * sp * cr + sy * sr,
+        sy * cp, sy * sp * sr + cy * cr, sy * sp * cr - cy * sr,
+        -sp,     cp * sr,                cp * cr
+    }};
+    t.position = {{x, y, z}};
+    return t;
+}
+
+RigidTransform RigidTransform::operator*(const RigidTransform& other) const {
+    const double* a = rotation.data();
+    const double* b = other.rotation.data();
+    RigidTransform t;
+    for (int r = 0; r < 3; ++r) {
+        const double a0 = a[3 * r], a1 = a[3 * r + 1], a2 = a[3 * r + 2];
+        t.rotation[3 * r]     = a0 * b[0] + a1 * b[3] + a2 * b[6];
+        t.rotation[3 * r + 1] = a0 * b[1] + a1 * b[4] + a2 * b[7];
+        t.rotation[3 * r + 2] = a0 * b[2] + a1 * b[5] + a2 * b[8];
+        t.position[r] = a0 * other.position[0] + a1 * other.position[1] + a2 * other.position[2] + position[r];
+    }
+    return t;
+}
+
+std::array<double, 3> RigidTransform::apply(const std::array<double, 3>& point) const {
+    std::array<double, 3> result;
+    for (int r = 0; r < 3; ++r) {
+        result[r] = rotation[3 * r] * point[0] + rotation[3 * r + 1] * point[1]
+                  + rotation[3 * r + 2] * point[2] + position[r];
+    }
+    return result;
+}
+
+std::array<double, 3> RigidTransform::rpy() const {
+    const double pitch = std::asin(std::max(-1.0, std::min(-rotation[6], 1.0)));
+    if (std::abs(rotation[6]) > 1.0 - 1e-9) {
+        // Вырождение (тангаж ±90°): крен и рыскание неразличимы, крен = 0
+        return {{0.0, pitch, std::atan2(-rotation[1], rotation[4])}};
+    }
+    return {{std::atan2(rotation[7], rotation[8]), pitch, std::atan2(rotation[3], rotation[0])}};
+}
+
+// ============= ArmKinematics =============
+
+bool ArmKinematics::loadUrdf(const QString& path, QString* error) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) {
+            *error = QString("Не удалось открыть %1: %2").arg(path, file.errorString());
+        }
+        return false;
+    }
+    return loadUrdfData(file.readAll(), error);
+}
+
+bool ArmKinematics::loadUrdfData(const QByteArray& data, QString* error) {
+    auto fail = [error](const QString& message) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    };
+
+    // Разбор: только <joint> верхнего уровня (в <link> тоже есть <origin>)
+    QVector<UrdfJoint> joints;
+    QXmlStreamReader xml(data);
+    UrdfJoint* current = nullptr;
+    while (!xml.atEnd()) {
+        xml.readNext();
+        if (xml.isEndElement() && xml.name() == QLatin1String("joint")) {
+            current = nullptr;
+            continue;
+        }
+        if (!xml.isStartElement()) {
+            continue;
+        }
+
+        const QXmlStreamAttributes attrs = xml.attributes();
+        if (xml.name() == QLatin1String("joint")) {
+            joints.append(UrdfJoint());
+            current = &joints.last();
+            current->name = attrs.value("name").toString();
+            current->type = attrs.value("type").toString();
+        } else if (!current) {
+            continue;
+        } else if (xml.name() == QLatin1String("parent")) {
+            current->parent = attrs.value("link").toString();
+        } else if (xml.name() == QLatin1String("child")) {
+            current->child = attrs.value("link").toString();
+        } else if (xml.name() == QLatin1String("origin")) {
+            if ((attrs.hasAttribute("xyz") && !parseVector(attrs.value("xyz"), current->origin.data(), 3))
+                || (attrs.hasAttribute("rpy") && !parseVector(attrs.value("rpy"), current->origin.data() + 3, 3))) {
+                return fail(QString("Некорректный origin сустава %1").arg(current->name));
+            }
+        } else if (xml.name() == QLatin1String("axis")) {
+            if (!parseVector(attrs.value("xyz"), current->axis.data(), 3)) {
+                return fail(QString("Некорректная ось сустава %1").arg(current->name));
+            }
+        } else if (xml.name() == QLatin1String("limit")) {
+            current->lower = attrs.value("lower").toDouble();
+            current->upper = attrs.value("upper").toDouble();
+        }
+    }
+    if (xml.hasError()) {
+        return fail(QString("Ошибка разбора URDF (строка %1): %2").arg(xml.lineNumber()).arg(xml.errorString()));
+    }
+
+    // Корень — звено, которое не является потомком ни одного сустава
+    QMap<QString, int> byParent;   // Вращательный сустав, выходящий из звена
+    QStringList children;
+    for (int i = 0; i < joints.size(); ++i) {
+        children << joints[i].child;
+        if (joints[i].type == QLatin1String("revolute") || joints[i].type == QLatin1String("continuous")) {
+            if (byParent.contains(joints[i].parent)) {
+                return fail(QString("Звено %1 ветвится: цепь неоднозначна").arg(joints[i].parent));
+            }
+            byParent.insert(joints[i].parent, i);
+        }
+    }
+    QString link;
+    for (const UrdfJoint& joint : joints) {
+        // <joint> без parent — ссылка из <transmission>, не звено цепи
+        if (!joint.parent.isEmpty() && !children.contains(joint.parent)) {
+            link = joint.parent;
+            break;
+        }
+    }
+    if (link.isEmpty()) {
+        return fail("В URDF не найдено корневое звено");
+    }
+
+    std::array<Joint, KINEMATIC_JOINTS> chain;
+    std::array<QString, KINEMATIC_JOINTS> names;
+    for (int j = 0; j < KINEMATIC_JOINTS; ++j) {
+        auto it = byParent.constFind(link);
+        if (it == byParent.constEnd()) {
+            return fail(QString("Цепь обрывается на звене %1: нужно %2 вращательных суставов")
+                        .arg(link).arg(KINEMATIC_JOINTS));
+        }
+        const UrdfJoint& source = joints[it.value()];
+        Joint& joint = chain[j];
+        joint.origin = RigidTransform::fromXyzRpy(source.origin[0], source.origin[1], source.origin[2],
+                                                  source.origin[3], source.origin[4], source.origin[5]);
+
+        const double norm = std::sqrt(source.axis[0] * source.axis[0] + source.axis[1] * source.axis[1]
+                                      + source.axis[2] * source.axis[2]);
+        if (norm < 1e-9) {
+            return fail(QString("Нулевая ось сустава %1").arg(source.name));
+        }
+        for (int k = 0; k < 3; ++k) {
+            joint.axis[k] = source.axis[k] / norm;
+        }
+        if (std::abs(joint.axis[0]) < 1e-9 && std::abs(joint.axis[1]) < 1e-9) {
+            joint.axisKind = joint.axis[2] > 0 ? AxisKind::PlusZ : AxisKind::MinusZ;
+        } else {
+            joint.axisKind = AxisKind::General;
+        }
+        joint.lowerDeg = source.lower * RAD_TO_DEG;
+        joint.upperDeg = source.upper * RAD_TO_DEG;
+        names[j] = source.name;
+        link = source.child;
+    }
+
+    // Рабочая точка по умолчанию: середина начал пальцев грипера на последнем звене
+    RigidTransform tcp;
+    int fingers = 0;
+    for (const UrdfJoint& joint : joints) {
+        if (joint.parent == link && joint.type == QLatin1String("prismatic")) {
+            for (int k = 0; k < 3; ++k) {
+                tcp.position[k] += joint.origin[k];
+            }
+            ++fingers;
+        }
+    }
+    if (fingers > 0) {
+        for (double& v : tcp.position) {
+            v /= fingers;
+        }
+    }
+
+    m_joints = chain;
+    m_jointNames = names;
+    m_tcpOffset = tcp;
+    m_loaded = true;
+    return true;
+}
+
+void ArmKinematics::advance(RigidTransform& frame, const Joint& joint, double angleRad) {
+    if (joint.axisKind == AxisKind::General) {
+        // Произвольная ось: формула Родрига
+        const double c = std::cos(angleRad);
+        const double s = std::sin(angleRad);
+        const double t = 1.0 - c;
+        const double x = joint.axis[0], y = joint.axis[1], z = joint.axis[2];
+        RigidTransform rotation;
+        rotation.rotation = {{
+            t * x * x + c,     t * x * y - s * z, t * x * z + s * y,
+            t * x * y + s * z, t * y * y + c,     t * y * z - s * x,
+            t * x * z - s * y, t * y * z + s * x, t * z * z + c
+        }};
+        frame = frame * joint.origin * rotation;
+        return;
+    }
+
+    // frame * origin * Rz(q) за один проход: поворот вокруг Z смешивает
+    // столбцы 0 и 1 произведения, столбец 2 и перенос от q не зависят
+    const double q = joint.axisKind == AxisKind::PlusZ ? angleRad : -angleRad;
+    const double c = std::cos(q);
+    const double s = std::sin(q);
+    const double* o = joint.origin.rotation.data();
+    const std::array<double, 3>& op = joint.origin.position;
+    double* m = frame.rotation.data();
+    for (int r = 0; r < 3; ++r) {
+        const double a0 = m[3 * r], a1 = m[3 * r + 1], a2 = m[3 * r + 2];
+        const double x = a0 * o[0] + a1 * o[3] + a2 * o[6];
+        const double y = a0 * o[1] + a1 * o[4] + a2 * o[7];
+        m[3 * r] = c * x + s * y;
+        m[3 * r + 1] = c * y - s * x;
+        m[3 * r + 2] = a0 * o[2] + a1 * o[5] + a2 * o[8];
+        frame.position[r] += a0 * op[0] + a1 * op[1] + a2 * op[2];
+    }
+}
+
+RigidTransform ArmKinematics::forward(const JointVector& anglesDeg) const {
+    RigidTransform frame;
+    for (int j = 0; j < KINEMATIC_JOINTS; ++j) {
+        advance(frame, m_joints[j], anglesDeg[j] * DEG_TO_RAD);
+    }
+    return frame * m_tcpOffset;
+}
+
+void ArmKinematics::jacobian(const KinematicFrames& frames, KinematicJacobian& jacobian) const {
+    const std::array<double, 3>& tcp = frames.tcp.position;
+    for (int j = 0; j < KINEMATIC_JOINTS; ++j) {
+        // Ось сустава в системе base_link: поворот вокруг оси её не меняет,
+        // поэтому берём из кадра звена после сустава
+        const RigidTransform& frame = frames.links[j + 1];
+        const Joint& joint = m_joints[j];
+        std::array<double, 3> axis;
+        if (joint.axisKind == AxisKind::General) {
+            for (int r = 0; r < 3; ++r) {
+                axis[r] = frame.rotation[3 * r] * joint.axis[0] + frame.rotation[3 * r + 1] * joint.axis[1]
+                        + frame.rotation[3 * r + 2] * joint.axis[2];
+            }
+        } else {
+            const double sign = joint.axisKind == AxisKind::PlusZ ? 1.0 : -1.0;
+            for (int r = 0; r < 3; ++r) {
+                axis[r] = sign * frame.rotation[3 * r + 2];
+            }
+        }
+
+        // v = axis × (tcp - p_j), w = axis
+        const double dx = tcp[0] - frame.position[0];
+        const double dy = tcp[1] - frame.position[1];
+        const double dz = tcp[2] - frame.position[2];
+        jacobian[0][j] = axis[1] * dz - axis[2] * dy;
+        jacobian[1][j] = axis[2] * dx - axis[0] * dz;
+        jacobian[2][j] = axis[0] * dy - axis[1] * dx;
+        jacobian[3][j] = axis[0];
+        jacobian[4][j] = axis[1];
+        jacobian[5][j] = axis[2];
+    }
+}
+
+void ArmKinematics::forward(const JointVector& anglesDeg, KinematicFrames& frames) const {
+    RigidTransform frame;
+    frames.links[0] = frame;
+    for (int j = 0; j < KINEMATIC_JOINTS; ++j) {
+        advance(frame, m_joints[j], anglesDeg[j] * DEG_TO_RAD);
+        frames.links[j + 1] = frame;
+    }
+    frames.tcp = frame * m_tcpOffset;
+}
@@ -79,6 +79,22 @@ JointCalibrationWidget::JointCalibrationWidget(int jointId, const QString& name,
             this, &JointCalibrationWidget::calibrationChanged);
     layout->addWidget(m_offsetSpin, 4, 1);
     
+    // Пределы для траекторий воспроизведения
+    auto addLimitSpin = [&](int row, const QString& label, double max, double step) {
+        layout->addWidget(new QLabel(label), row, 0);
+        QDoubleSpinBox* spin = new QDoubleSpinBox();
+        spin->setRange(1.0, max);
+        spin->setDecimals(0);
+        spin->setSingleStep(step);
+        connect(spin, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+                this, &JointCalibrationWidget::calibrationChanged);
+        layout->addWidget(spin, row, 1);
+        return spin;
+    };
+    m_velocitySpin = addLimitSpin(5, "Макс. скорость (°/с):", 720.0, 10.0);
+    m_accelerationSpin = addLimitSpin(6, "Макс. ускорение (°/с²):", 10000.0, 50.0);
+    m_jerkSpin = addLimitSpin(7, "Макс. рывок (°/с³):", 100000.0, 500.0);
+    
     // Специальная настройка для грипера (J6) - расширенный диапазон
     if (jointId == 6) {
         // Убираем жёсткие лимиты для грипера - позиция может быть от -360 до 360
@@ -99,16 +115,25 @@ void JointCalibrationWidget::setCalibration(const JointCalibration& calib) {
     m_maxSpin->blockSignals(true);
     m_homeSpin->blockSignals(true);
     m_offsetSpin->blockSignals(true);
+    m_velocitySpin->blockSignals(true);
+    m_accelerationSpin->blockSignals(true);
+    m_jerkSpin->blockSignals(true);
     
     m_minSpin->setValue(calib.minAngle);
     m_maxSpin->setValue(calib.maxAngle);
     m_homeSpin->setValue(calib.homeAngle);
     m_offsetSpin->setValue(calib.offset);
+    m_velocitySpin->setValue(calib.maxVelocity);
+    m_accelerationSpin->setValue(calib.maxAcceleration);
+    m_jerkSpin->setValue(calib.maxJerk);
     
     m_minSpin->blockSignals(false);
     m_maxSpin->blockSignals(false);
     m_homeSpin->blockSignals(false);
     m_offsetSpin->blockSignals(false);
+    m_velocitySpin->blockSignals(false);
+    m_accelerationSpin->blockSignals(false);
+    m_jerkSpin->blockSignals(false);
 }
 
 JointCalibration JointCalibrationWidget::getCalibration() const {
@@ -119,6 +144,9 @@ JointCalibration JointCalibrationWidget::getCalibration() const {
     calib.offset = m_offsetSpin->value();
     calib.speedFactor = 1.0;
     calib.reversed = false;
+    calib.maxVelocity = m_velocitySpin->value();
+    calib.maxAcceleration = m_accelerationSpin->value();
+    calib.maxJerk = m_jerkSpin->value();
     return calib;
 }
 
@@ -229,6 +257,7 @@ void CalibrationDialog::saveToManager() {
         m_manager->setJointLimits(i, calib.minAngle, calib.maxAngle);
         m_manager->setJointHome(i, calib.homeAngle);
         m_manager->setJointOffset(i, calib.offset);
+        m_manager->setJointMotionLimits(i, calib.maxVelocity, calib.maxAcceleration, calib.maxJerk);
     }
     
     m_manager->setGlobalSpeedFactor(m_globalSpeedSpin->value());
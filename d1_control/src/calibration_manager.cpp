@@ -22,6 +22,9 @@ QJsonObject CalibrationData::toJson() const {
         jObj["offset"] = joint.offset;
         jObj["speedFactor"] = joint.speedFactor;
         jObj["reversed"] = joint.reversed;
+        jObj["maxVelocity"] = joint.maxVelocity;
+        jObj["maxAcceleration"] = joint.maxAcceleration;
+        jObj["maxJerk"] = joint.maxJerk;
         jointsArray.append(jObj);
     }
     root["joints"] = jointsArray;
@@ -45,11 +48,26 @@ CalibrationData CalibrationData::fromJson(const QJsonObject& obj) {
         data.joints[i].offset = jObj["offset"].toDouble(0.0);
         data.joints[i].speedFactor = jObj["speedFactor"].toDouble(1.0);
         data.joints[i].reversed = jObj["reversed"].toBool(false);
+        data.joints[i].maxVelocity = jObj["maxVelocity"].toDouble(data.joints[i].maxVelocity);
+        data.joints[i].maxAcceleration = jObj["maxAcceleration"].toDouble(data.joints[i].maxAcceleration);
+        data.joints[i].maxJerk = jObj["maxJerk"].toDouble(data.joints[i].maxJerk);
     }
     
     return data;
 }
 
+MotionLimits CalibrationData::motionLimits() const {
+    MotionLimits limits;
+    for (int i = 0; i < CALIB_NUM_JOINTS; ++i) {
+        // Множитель скорости k растягивает время: v·k, a·k², j·k³
+        const double k = joints[i].speedFactor * globalSpeedFactor;
+        limits.velocity[i] = joints[i].maxVelocity * k;
+        limits.acceleration[i] = joints[i].maxAcceleration * k * k;
+        limits.jerk[i] = joints[i].maxJerk * k * k * k;
+    }
+    return limits;
+}
+
 CalibrationManager::CalibrationManager(QObject* parent)
     : QObject(parent)
 {
@@ -186,6 +204,15 @@ void CalibrationManager::setJointReversed(int jointId, bool reversed) {
     }
 }
 
+void CalibrationManager::setJointMotionLimits(int jointId, double maxVelocity, double maxAcceleration, double maxJerk) {
+    if (jointId >= 0 && jointId < CALIB_NUM_JOINTS) {
+        m_data.joints[jointId].maxVelocity = maxVelocity;
+        m_data.joints[jointId].maxAcceleration = maxAcceleration;
+        m_data.joints[jointId].maxJerk = maxJerk;
+        emit calibrationChanged();
+    }
+}
+
 void CalibrationManager::setGlobalSpeedFactor(double factor) {
     m_data.globalSpeedFactor = std::max(0.1, std::min(2.0, factor));
     emit calibrationChanged();
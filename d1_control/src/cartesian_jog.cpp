@@ -0,0 +1,214 @@
+#include "cartesian_jog.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Поворот на вектор оси-угла (Родригес), рад
+RigidTransform rotationFromVector(const std::array<double, 3>& v) {
+    RigidTransform t;
+    const double angle = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    if (angle < 1e-12) {
+        return t;
+    }
+    const double x = v[0] / angle, y = v[1] / angle, z = v[2] / angle;
+    const double c = std::cos(angle), s = std::sin(angle), k = 1.0 - c;
+    t.rotation = {{
+        c + x * x * k,     x * y * k - z * s, x * z * k + y * s,
+        y * x * k + z * s, c + y * y * k,     y * z * k - x * s,
+        z * x * k - y * s, z * y * k + x * s, c + z * z * k
+    }};
+    return t;
+}
+
+} // namespace
+
+CartesianJogController::CartesianJogController(ArmController* armController, QObject* parent)
+    : QObject(parent)
+    , m_armController(armController)
+    , m_solver(armController->kinematics())
+{
+    // Предыдущее решение в шаге одного тика: итераций нужно немного,
+    // а бюджет времени не даёт застопорить поток GUI
+    m_options.maxIterations = 30;
+    m_options.timeBudgetUs = 2000;
+
+    m_timer = new QTimer(this);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    m_timer->setInterval(1000 / RATE_HZ);
+    connect(m_timer, &QTimer::timeout, this, &CartesianJogController::onTick);
+
+    connect(m_armController, &ArmController::disconnected, this, &CartesianJogController::stop);
+    connect(m_armController, &ArmController::motorsPowered, this, [this](bool powered) {
+        if (!powered) {
+            stop();
+        }
+    });
+}
+
+void CartesianJogController::setVelocity(const std::array<double, 3>& linear,
+                                         const std::array<double, 3>& angular, bool toolFrame) {
+    bool moving = false;
+    for (int i = 0; i < 3; ++i) {
+        moving = moving || linear[i] != 0.0 || angular[i] != 0.0;
+    }
+    if (!moving) {
+        stop();
+        return;
+    }
+
+    m_linear = linear;
+    m_angular = angular;
+    m_toolFrame = toolFrame;
+    if (!m_active) {
+        begin();
+    }
+}
+
+void CartesianJogController::stop() {
+    if (!m_active) {
+        return;
+    }
+    m_timer->stop();
+    m_active = false;
+    m_linear = {};
+    m_angular = {};
+    // Последняя уставка уже отправлена: рука доходит до неё и стоит
+    emit activeChanged(false);
+}
+
+QString CartesianJogController::readyError(const ArmState& state) const {
+    if (!m_armController->kinematics().isLoaded()) {
+        return "нет модели кинематики (URDF)";
+    }
+    if (!state.isConnected) {
+        return "нет связи с рукой";
+    }
+    if (m_armController->isEmergencyStopped()) {
+        return "аварийная остановка";
+    }
+    if (state.powerStatus != 1) {
+        return "моторы выключены";
+    }
+    return QString();
+}
+
+bool CartesianJogController::begin() {
+    ArmState state = m_armController->getState();
+    QString error = readyError(state);
+    if (!error.isEmpty()) {
+        emit limited(error);
+        return false;
+    }
+
+    refreshLimits();
+
+    // Цель — текущая поза по feedback, тёплый старт — текущие углы
+    for (int i = 0; i < NUM_JOINTS; ++i) {
+        m_command[i] = state.joints[i].angle;
+    }
+    m_target = m_armController->kinematics().forward(m_command);
+
+    m_clock.start();
+    m_lastTickNs = 0;
+    m_active = true;
+    m_timer->start();
+    emit activeChanged(true);
+    return true;
+}
+
+void CartesianJogController::refreshLimits() {
+    // Лимиты калибровки (их применяет ArmController) с запасом, внутри лимитов URDF
+    const ArmKinematics& kinematics = m_armController->kinematics();
+    JointVector lower{}, upper{};
+    for (int j = 0; j < NUM_JOINTS; ++j) {
+        std::pair<double, double> limits = m_armController->getJointLimits(j);
+        lower[j] = limits.first + LIMIT_BUFFER_DEG;
+        upper[j] = limits.second - LIMIT_BUFFER_DEG;
+        if (j < KINEMATIC_JOINTS) {
+            lower[j] = std::max(lower[j], kinematics.lowerLimitDeg(j));
+            upper[j] = std::min(upper[j], kinematics.upperLimitDeg(j));
+        }
+    }
+    m_solver.setJointLimits(lower, upper);
+}
+
+void CartesianJogController::onTick() {
+    ArmState state = m_armController->getState();
+    QString error = readyError(state);
+    if (!error.isEmpty()) {
+        stop();
+        emit limited(error);
+        return;
+    }
+
+    // Шаг по реальному времени тика: пропущенный тик не замедляет jog,
+    // но и не даёт скачка больше двух периодов
+    const qint64 nowNs = m_clock.nsecsElapsed();
+    const double periodSec = 1.0 / RATE_HZ;
+    const double dt = std::min((nowNs - m_lastTickNs) / 1e9, 2.0 * periodSec);
+    m_lastTickNs = nowNs;
+
+    RigidTransform candidate = m_target;
+    std::array<double, 3> linear = m_linear;
+    if (m_toolFrame) {
+        linear = {{0.0, 0.0, 0.0}};
+        for (int r = 0; r < 3; ++r) {
+            for (int c = 0; c < 3; ++c) {
+                linear[r] += m_target.rotation[3 * r + c] * m_linear[c];
+            }
+        }
+    }
+    for (int r = 0; r < 3; ++r) {
+        candidate.position[r] += linear[r] * dt;
+    }
+
+    std::array<double, 3> turn = {{m_angular[0] * dt, m_angular[1] * dt, m_angular[2] * dt}};
+    RigidTransform rotation = rotationFromVector(turn);
+    if (m_toolFrame) {
+        candidate.rotation = (m_target * rotation).rotation;
+    } else {
+        // Поворот вокруг осей base_link, центр — рабочая точка
+        candidate.rotation = (rotation * m_target).rotation;
+    }
+
+    m_lastResult = m_solver.solve(candidate, m_command, m_options);
+    if (!m_lastResult.converged()) {
+        // Карта досягаемости отличает границу рабочей зоны от сингулярности и лимитов
+        const ReachabilityMap& map = m_armController->reachability();
+        if (map.isLoaded() && !map.isReachable(candidate.position)) {
+            emit limited("Цель вне рабочей зоны руки");
+        } else {
+            emit limited(QString("Цель недостижима: %1").arg(ArmIkSolver::statusName(m_lastResult.status)));
+        }
+        return;
+    }
+
+    double largestStep = 0.0;
+    for (int j = 0; j < KINEMATIC_JOINTS; ++j) {
+        largestStep = std::max(largestStep, std::abs(m_lastResult.anglesDeg[j] - m_command[j]));
+    }
+    if (largestStep > MAX_JOINT_STEP_DEG) {
+        emit limited(QString("Рядом с сингулярностью: скачок сустава %1°").arg(largestStep, 0, 'f', 1));
+        return;
+    }
+
+    // Шаг за тик мал — консервативная проверка отрезка укладывается в доли мс.
+    // Уже в касании разрешён только шаг, увеличивающий зазор (выход из него)
+    const CollisionChecker& collision = m_armController->collision();
+    if (collision.isActive()) {
+        CollisionReport report;
+        bool free = collision.isSegmentFree(m_command, m_lastResult.anglesDeg, &report);
+        if (!free && report.fraction == 0.0) {
+            free = collision.clearance(m_lastResult.anglesDeg) > collision.clearance(m_command);
+        }
+        if (!free) {
+            emit limited(QString("Столкновение: %1").arg(collision.describe(report)));
+            return;
+        }
+    }
+
+    m_target = candidate;
+    m_command = m_lastResult.anglesDeg;
+    m_armController->streamSetpoint(m_command, 2 * 1000 / RATE_HZ);
+}
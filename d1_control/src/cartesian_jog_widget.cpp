@@ -0,0 +1,113 @@
+#include "cartesian_jog_widget.h"
+#include <QGridLayout>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <cmath>
+
+namespace {
+const char* const AXIS_NAMES[6] = {"X", "Y", "Z", "Roll", "Pitch", "Yaw"};
+}
+
+CartesianJogWidget::CartesianJogWidget(CartesianJogController* controller, QWidget* parent)
+    : QGroupBox("Декартово перемещение", parent)
+    , m_controller(controller)
+{
+    setupUi();
+
+    connect(m_controller, &CartesianJogController::activeChanged, this, &CartesianJogWidget::onActiveChanged);
+    connect(m_controller, &CartesianJogController::limited, this, &CartesianJogWidget::onLimited);
+}
+
+void CartesianJogWidget::setupUi() {
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+    mainLayout->setSpacing(6);
+
+    QGridLayout* gridLayout = new QGridLayout();
+    gridLayout->setSpacing(4);
+    for (int axis = 0; axis < 6; ++axis) {
+        // Линейные оси — левая колонка, повороты — правая
+        const int row = axis % 3;
+        const int column = axis < 3 ? 0 : 3;
+        gridLayout->addWidget(new QLabel(AXIS_NAMES[axis]), row, column);
+        for (int side = 0; side < 2; ++side) {
+            QPushButton* button = new QPushButton(side == 0 ? "−" : "+");
+            button->setFixedWidth(40);
+            button->setAutoRepeat(false);
+            const int direction = side == 0 ? -1 : 1;
+            connect(button, &QPushButton::pressed, this, [this, axis, direction]() {
+                startAxis(axis, direction);
+            });
+            connect(button, &QPushButton::released, this, [this, axis]() {
+                releaseAxis(axis);
+            });
+            m_axisButtons[axis][side] = button;
+            gridLayout->addWidget(button, row, column + 1 + side);
+        }
+    }
+    gridLayout->setColumnMinimumWidth(3, 40);
+    mainLayout->addLayout(gridLayout);
+
+    QHBoxLayout* speedLayout = new QHBoxLayout();
+    speedLayout->addWidget(new QLabel("Скорость:"));
+    m_linearSpeedSpin = new QSpinBox();
+    m_linearSpeedSpin->setRange(1, 100);
+    m_linearSpeedSpin->setValue(20);
+    m_linearSpeedSpin->setSuffix(" мм/с");
+    speedLayout->addWidget(m_linearSpeedSpin);
+    m_angularSpeedSpin = new QSpinBox();
+    m_angularSpeedSpin->setRange(1, 45);
+    m_angularSpeedSpin->setValue(10);
+    m_angularSpeedSpin->setSuffix(" °/с");
+    speedLayout->addWidget(m_angularSpeedSpin);
+    mainLayout->addLayout(speedLayout);
+
+    m_toolFrameCheck = new QCheckBox("Оси инструмента");
+    m_toolFrameCheck->setToolTip("Перемещение вдоль осей рабочей точки, а не base_link");
+    mainLayout->addWidget(m_toolFrameCheck);
+
+    m_statusLabel = new QLabel("Удерживайте кнопку для движения");
+    m_statusLabel->setWordWrap(true);
+    m_statusLabel->setStyleSheet("color: gray;");
+    mainLayout->addWidget(m_statusLabel);
+}
+
+void CartesianJogWidget::startAxis(int axis, int direction) {
+    std::array<double, 3> linear{};
+    std::array<double, 3> angular{};
+    if (axis < 3) {
+        linear[axis] = direction * m_linearSpeedSpin->value() / 1000.0;
+    } else {
+        angular[axis - 3] = direction * m_angularSpeedSpin->value() * M_PI / 180.0;
+    }
+    m_activeAxis = axis;
+    m_limited = false;
+    m_statusLabel->setStyleSheet("color: gray;");
+    m_statusLabel->setText(QString("Движение: %1%2").arg(AXIS_NAMES[axis]).arg(direction > 0 ? "+" : "−"));
+    m_controller->setVelocity(linear, angular, m_toolFrameCheck->isChecked());
+}
+
+void CartesianJogWidget::releaseAxis(int axis) {
+    if (axis == m_activeAxis) {
+        stopJog();
+    }
+}
+
+void CartesianJogWidget::stopJog() {
+    m_activeAxis = -1;
+    m_controller->stop();
+}
+
+void CartesianJogWidget::onActiveChanged(bool active) {
+    if (!active) {
+        m_activeAxis = -1;
+        if (!m_limited) {
+            m_statusLabel->setText("Удерживайте кнопку для движения");
+        }
+    }
+}
+
+void CartesianJogWidget::onLimited(const QString& reason) {
+    m_limited = true;
+    m_statusLabel->setStyleSheet("color: #d32f2f;");
+    m_statusLabel->setText(reason);
+}
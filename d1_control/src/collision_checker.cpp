@@ -0,0 +1,805 @@
+#include "collision_checker.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QMap>
+#include <QStringList>
+#include <QXmlStreamReader>
+#include <QtEndian>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+using Vector3 = std::array<double, 3>;
+
+constexpr double DEG_TO_RAD = M_PI / 180.0;
+constexpr int HULL_DIRECTIONS = 256;
+constexpr int GJK_MAX_ITERATIONS = 48;
+constexpr double CLEARANCE_LOOKAHEAD_M = 0.2;   // Зазор, дальше которого шаг продвижения не растёт
+constexpr double MIN_ADVANCE_M = 0.0005;        // Наименьший шаг продвижения (точность касания)
+
+inline Vector3 sub(const Vector3& a, const Vector3& b) { return {{a[0] - b[0], a[1] - b[1], a[2] - b[2]}}; }
+inline Vector3 add(const Vector3& a, const Vector3& b) { return {{a[0] + b[0], a[1] + b[1], a[2] + b[2]}}; }
+inline Vector3 scale(const Vector3& a, double s) { return {{a[0] * s, a[1] * s, a[2] * s}}; }
+inline double dot(const Vector3& a, const Vector3& b) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+inline Vector3 cross(const Vector3& a, const Vector3& b) {
+    return {{a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]}};
+}
+inline double norm(const Vector3& a) { return std::sqrt(dot(a, a)); }
+
+// Направление в систему тела: Rᵀ·d
+inline Vector3 toLocal(const RigidTransform& t, const Vector3& d) {
+    const double* r = t.rotation.data();
+    return {{r[0] * d[0] + r[3] * d[1] + r[6] * d[2],
+             r[1] * d[0] + r[4] * d[1] + r[7] * d[2],
+             r[2] * d[0] + r[5] * d[1] + r[8] * d[2]}};
+}
+
+const Vector3& farthest(const std::vector<Vector3>& vertices, const Vector3& direction) {
+    size_t best = 0;
+    double bestDot = dot(vertices[0], direction);
+    for (size_t i = 1; i < vertices.size(); ++i) {
+        const double d = dot(vertices[i], direction);
+        if (d > bestDot) {
+            bestDot = d;
+            best = i;
+        }
+    }
+    return vertices[best];
+}
+
+// Симплекс GJK: до 4 точек разности Минковского
+struct Simplex {
+    Vector3 points[4];
+    int size = 0;
+};
+
+// Ближайшая к началу координат точка отрезка / треугольника (Эриксон, 5.1),
+// симплекс сокращается до вершин, на которые она опирается
+Vector3 closestOnSegment(Simplex& s) {
+    const Vector3 a = s.points[0], b = s.points[1];
+    const Vector3 ab = sub(b, a);
+    const double t = -dot(a, ab);
+    if (t <= 0.0) {
+        s.size = 1;
+        return a;
+    }
+    const double denom = dot(ab, ab);
+    if (t >= denom) {
+        s.points[0] = b;
+        s.size = 1;
+        return b;
+    }
+    return add(a, scale(ab, t / denom));
+}
+
+Vector3 closestOnTriangle(Simplex& s) {
+    const Vector3 a = s.points[0], b = s.points[1], c = s.points[2];
+    const Vector3 ab = sub(b, a), ac = sub(c, a), ap = scale(a, -1.0);
+    const double d1 = dot(ab, ap), d2 = dot(ac, ap);
+    if (d1 <= 0.0 && d2 <= 0.0) {
+        s.size = 1;
+        return a;
+    }
+    const Vector3 bp = scale(b, -1.0);
+    const double d3 = dot(ab, bp), d4 = dot(ac, bp);
+    if (d3 >= 0.0 && d4 <= d3) {
+        s.points[0] = b;
+        s.size = 1;
+        return b;
+    }
+    const double vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0) {
+        s.size = 2;
+        return add(a, scale(ab, d1 / (d1 - d3)));
+    }
+    const Vector3 cp = scale(c, -1.0);
+    const double d5 = dot(ab, cp), d6 = dot(ac, cp);
+    if (d6 >= 0.0 && d5 <= d6) {
+        s.points[0] = c;
+        s.size = 1;
+        return c;
+    }
+    const double vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0) {
+        s.points[1] = c;
+        s.size = 2;
+        return add(a, scale(ac, d2 / (d2 - d6)));
+    }
+    const double va = d3 * d6 - d5 * d4;
+    if (va <= 0.0 && (d4 - d3) >= 0.0 && (d5 - d6) >= 0.0) {
+        s.points[0] = b;
+        s.points[1] = c;
+        s.size = 2;
+        return add(b, scale(sub(c, b), (d4 - d3) / ((d4 - d3) + (d5 - d6))));
+    }
+    const double denom = 1.0 / (va + vb + vc);
+    return add(a, add(scale(ab, vb * denom), scale(ac, vc * denom)));
+}
+
+// Начало координат и вершина d по разные стороны плоскости abc
+bool originOutsideFace(const Vector3& a, const Vector3& b, const Vector3& c, const Vector3& d) {
+    const Vector3 n = cross(sub(b, a), sub(c, a));
+    const double signOrigin = -dot(a, n);
+    const double signD = dot(sub(d, a), n);
+    return signOrigin * signD < 0.0;
+}
+
+// false — начало координат внутри тетраэдра (пересечение)
+bool closestOnTetrahedron(Simplex& s, Vector3& closest) {
+    static const int faces[4][4] = {{0, 1, 2, 3}, {0, 2, 3, 1}, {0, 3, 1, 2}, {1, 3, 2, 0}};
+    double best = std::numeric_limits<double>::max();
+    Simplex bestSimplex;
+    bool outside = false;
+    for (const auto& f : faces) {
+        if (!originOutsideFace(s.points[f[0]], s.points[f[1]], s.points[f[2]], s.points[f[3]])) {
+            continue;
+        }
+        outside = true;
+        Simplex face;
+        face.points[0] = s.points[f[0]];
+        face.points[1] = s.points[f[1]];
+        face.points[2] = s.points[f[2]];
+        face.size = 3;
+        const Vector3 p = closestOnTriangle(face);
+        const double d = dot(p, p);
+        if (d < best) {
+            best = d;
+            closest = p;
+            bestSimplex = face;
+        }
+    }
+    if (!outside) {
+        return false;
+    }
+    s = bestSimplex;
+    return true;
+}
+
+// Расстояние между выпуклыми телами по опорным функциям (GJK).
+// Если зазор заведомо не меньше stopAbove — возвращает нижнюю оценку.
+template <typename SupportA, typename SupportB>
+double gjkDistance(const SupportA& supportA, const SupportB& supportB, const Vector3& initial, double stopAbove) {
+    Vector3 v = initial;
+    if (dot(v, v) < 1e-18) {
+        v = {{1.0, 0.0, 0.0}};
+    }
+    Simplex simplex;
+    simplex.points[0] = sub(supportA(scale(v, -1.0)), supportB(v));
+    simplex.size = 1;
+    v = simplex.points[0];
+
+    for (int iteration = 0; iteration < GJK_MAX_ITERATIONS; ++iteration) {
+        const double vv = dot(v, v);
+        if (vv < 1e-18) {
+            return 0.0;
+        }
+        const Vector3 w = sub(supportA(scale(v, -1.0)), supportB(v));
+        const double vw = dot(v, w);
+        // v·w/|v| — нижняя оценка расстояния
+        if (vw > 0.0 && vw * vw > vv * stopAbove * stopAbove) {
+            return vw / std::sqrt(vv);
+        }
+        if (vv - vw <= 1e-10 * vv) {
+            return std::sqrt(vv);
+        }
+
+        simplex.points[simplex.size++] = w;
+        switch (simplex.size) {
+            case 2: v = closestOnSegment(simplex); break;
+            case 3: v = closestOnTriangle(simplex); break;
+            default:
+                if (!closestOnTetrahedron(simplex, v)) {
+                    return 0.0;
+                }
+                break;
+        }
+    }
+    return std::sqrt(dot(v, v));
+}
+
+struct UrdfLink {
+    RigidTransform collisionOrigin;
+    QString mesh;
+};
+
+struct UrdfJoint {
+    QString name;
+    QString type;
+    QString parent;
+    QString child;
+    RigidTransform origin;
+};
+
+bool parseOrigin(const QXmlStreamAttributes& attrs, RigidTransform& origin) {
+    double v[6] = {0, 0, 0, 0, 0, 0};
+    const QStringList xyz = attrs.value("xyz").toString().simplified().split(' ', QString::SkipEmptyParts);
+    const QStringList rpy = attrs.value("rpy").toString().simplified().split(' ', QString::SkipEmptyParts);
+    if ((!xyz.isEmpty() && xyz.size() != 3) || (!rpy.isEmpty() && rpy.size() != 3)) {
+        return false;
+    }
+    bool ok = true;
+    for (int i = 0; i < xyz.size() && ok; ++i) {
+        v[i] = xyz[i].toDouble(&ok);
+    }
+    for (int i = 0; i < rpy.size() && ok; ++i) {
+        v[3 + i] = rpy[i].toDouble(&ok);
+    }
+    origin = RigidTransform::fromXyzRpy(v[0], v[1], v[2], v[3], v[4], v[5]);
+    return ok;
+}
+
+// Двоичный STL: 80 байт заголовка, число треугольников, по 50 байт на треугольник
+bool loadStlVertices(const QString& path, std::vector<std::array<float, 3>>& vertices, QString* error) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        *error = QString("Не удалось открыть %1: %2").arg(path, file.errorString());
+        return false;
+    }
+    const QByteArray data = file.readAll();
+    if (data.size() < 84) {
+        *error = QString("%1: не двоичный STL").arg(path);
+        return false;
+    }
+    const uchar* bytes = reinterpret_cast<const uchar*>(data.constData());
+    const quint32 triangles = qFromLittleEndian<quint32>(bytes + 80);
+    if (quint64(data.size()) < 84 + quint64(triangles) * 50) {
+        *error = QString("%1: файл обрезан или в текстовом формате").arg(path);
+        return false;
+    }
+    vertices.resize(size_t(triangles) * 3);
+    for (quint32 t = 0; t < triangles; ++t) {
+        const uchar* tri = bytes + 84 + size_t(t) * 50 + 12;   // Пропускаем нормаль
+        for (int k = 0; k < 3; ++k) {
+            for (int c = 0; c < 3; ++c) {
+                const quint32 raw = qFromLittleEndian<quint32>(tri + 12 * k + 4 * c);
+                std::memcpy(&vertices[size_t(t) * 3 + k][c], &raw, sizeof(float));
+            }
+        }
+    }
+    return true;
+}
+
+// Вершины выпуклой оболочки: крайние в каждом из направлений сферы Фибоначчи
+std::vector<Vector3> hullVertices(std::vector<std::array<float, 3>>& mesh) {
+    // Каждая вершина STL повторяется в соседних треугольниках
+    std::sort(mesh.begin(), mesh.end());
+    mesh.erase(std::unique(mesh.begin(), mesh.end()), mesh.end());
+
+    std::vector<int> chosen;
+    const double golden = M_PI * (3.0 - std::sqrt(5.0));
+    for (int i = 0; i < HULL_DIRECTIONS; ++i) {
+        const double z = 1.0 - (2.0 * i + 1.0) / HULL_DIRECTIONS;
+        const double r = std::sqrt(1.0 - z * z);
+        const double phi = golden * i;
+        const float d[3] = {float(r * std::cos(phi)), float(r * std::sin(phi)), float(z)};
+        int best = 0;
+        float bestDot = -std::numeric_limits<float>::max();
+        for (size_t v = 0; v < mesh.size(); ++v) {
+            const float p = mesh[v][0] * d[0] + mesh[v][1] * d[1] + mesh[v][2] * d[2];
+            if (p > bestDot) {
+                bestDot = p;
+                best = int(v);
+            }
+        }
+        chosen.push_back(best);
+    }
+    std::sort(chosen.begin(), chosen.end());
+    chosen.erase(std::unique(chosen.begin(), chosen.end()), chosen.end());
+
+    std::vector<Vector3> hull;
+    hull.reserve(chosen.size());
+    for (int v : chosen) {
+        hull.push_back({{mesh[v][0], mesh[v][1], mesh[v][2]}});
+    }
+    return hull;
+}
+
+// Оболочка по выборке направлений лежит внутри настоящей: насколько вершины
+// меша выступают за неё (GJK от точки до оболочки). На эту величину тело
+// раздувается при проверке, чтобы зазор оставался нижней оценкой.
+double hullMargin(const std::vector<Vector3>& hull, const std::vector<std::array<float, 3>>& mesh) {
+    auto supportHull = [&hull](const Vector3& d) { return farthest(hull, d); };
+    double margin = 0.0;
+    for (const std::array<float, 3>& vertex : mesh) {
+        const Vector3 p = {{vertex[0], vertex[1], vertex[2]}};
+        auto supportPoint = [&p](const Vector3&) { return p; };
+        margin = std::max(margin, gjkDistance(supportHull, supportPoint, sub(hull[0], p),
+                                              std::numeric_limits<double>::max()));
+    }
+    return margin;
+}
+
+} // namespace
+
+QString CollisionChecker::defaultDescriptionDir() {
+    if (qEnvironmentVariableIsSet("D1_DESCRIPTION_DIR")) {
+        return QString::fromLocal8Bit(qgetenv("D1_DESCRIPTION_DIR"));
+    }
+    // Установка: bin/ и share/d1_control/d1_description; иначе каталог сборки внутри репозитория
+    const QString appDir = QCoreApplication::applicationDirPath();
+    const QString installed = appDir + "/../share/d1_control/d1_description";
+    if (QFile::exists(installed + "/urdf/d1_description.urdf")) {
+        return installed;
+    }
+    return appDir + "/../../d1_description";
+}
+
+bool CollisionChecker::load(const ArmKinematics& kinematics, const QString& descriptionDir, QString* error) {
+    QString message;
+    auto fail = [&](const QString& text) {
+        if (error) {
+            *error = text;
+        }
+        m_kinematics = nullptr;
+        m_bodies.clear();
+        m_allPairs.clear();
+        m_pairs.clear();
+        return false;
+    };
+    if (!kinematics.isLoaded()) {
+        return fail("Нет модели кинематики (URDF)");
+    }
+
+    // Меши берутся из того же описания, что и цепь суставов
+    const QString urdfPath = descriptionDir + "/urdf/d1_description.urdf";
+    QFile file(urdfPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return fail(QString("Не удалось открыть %1: %2").arg(urdfPath, file.errorString()));
+    }
+
+    QMap<QString, UrdfLink> links;
+    QVector<UrdfJoint> joints;
+    QString currentLink;
+    QXmlStreamReader xml(&file);
+    QStringList path;
+    while (!xml.atEnd()) {
+        xml.readNext();
+        if (xml.isEndElement()) {
+            path.removeLast();
+            continue;
+        }
+        if (!xml.isStartElement()) {
+            continue;
+        }
+        const QString name = xml.name().toString();
+        const QXmlStreamAttributes attrs = xml.attributes();
+        path.append(name);
+
+        // robot/link/collision/origin, robot/link/collision/geometry/mesh, robot/joint/*
+        if (path.size() == 2 && name == QLatin1String("link")) {
+            currentLink = attrs.value("name").toString();
+            links.insert(currentLink, UrdfLink());
+        } else if (path.size() == 4 && path[1] == QLatin1String("link") && path[2] == QLatin1String("collision")
+                   && name == QLatin1String("origin")) {
+            if (!parseOrigin(attrs, links[currentLink].collisionOrigin)) {
+                return fail("Некорректный origin столкновений в URDF");
+            }
+        } else if (path.size() == 5 && path[1] == QLatin1String("link") && path[2] == QLatin1String("collision")
+                   && name == QLatin1String("mesh")) {
+            // package://d1_description/meshes/Link1.STL → <каталог>/meshes/Link1.STL
+            QString mesh = attrs.value("filename").toString();
+            const int meshes = mesh.indexOf("meshes/");
+            links[currentLink].mesh = descriptionDir + "/" + (meshes >= 0 ? mesh.mid(meshes) : mesh);
+        } else if (path.size() == 2 && name == QLatin1String("joint")) {
+            UrdfJoint joint;
+            joint.name = attrs.value("name").toString();
+            joint.type = attrs.value("type").toString();
+            joints.append(joint);
+        } else if (path.size() == 3 && path[1] == QLatin1String("joint")) {
+            if (name == QLatin1String("parent")) {
+                joints.last().parent = attrs.value("link").toString();
+            } else if (name == QLatin1String("child")) {
+                joints.last().child = attrs.value("link").toString();
+            } else if (name == QLatin1String("origin") && !parseOrigin(attrs, joints.last().origin)) {
+                return fail(QString("Некорректный origin сустава %1").arg(joints.last().name));
+            }
+        }
+    }
+    if (xml.hasError()) {
+        return fail(QString("Ошибка разбора URDF (строка %1): %2").arg(xml.lineNumber()).arg(xml.errorString()));
+    }
+
+    // Кадр каждого звена: base_link — 0, звено после Jj — j; прочие (пальцы
+    // грипера) — кадр родителя с постоянным смещением (сустав в нуле)
+    QMap<QString, QPair<int, RigidTransform>> frames;
+    QString root;
+    for (auto it = links.constBegin(); it != links.constEnd(); ++it) {
+        bool isChild = false;
+        for (const UrdfJoint& joint : joints) {
+            isChild = isChild || joint.child == it.key();
+        }
+        if (!isChild) {
+            root = it.key();
+        }
+    }
+    frames.insert(root, qMakePair(0, RigidTransform()));
+    for (int j = 0; j < KINEMATIC_JOINTS; ++j) {
+        bool found = false;
+        for (const UrdfJoint& joint : joints) {
+            if (joint.name == kinematics.jointName(j)) {
+                frames.insert(joint.child, qMakePair(j + 1, RigidTransform()));
+                found = true;
+            }
+        }
+        if (!found) {
+            return fail(QString("В URDF мешей нет сустава %1").arg(kinematics.jointName(j)));
+        }
+    }
+    for (bool added = true; added;) {
+        added = false;
+        for (const UrdfJoint& joint : joints) {
+            if (frames.contains(joint.parent) && !frames.contains(joint.child)) {
+                const QPair<int, RigidTransform>& parent = frames[joint.parent];
+                frames.insert(joint.child, qMakePair(parent.first, parent.second * joint.origin));
+                added = true;
+            }
+        }
+    }
+
+    std::vector<Body> bodies;
+    for (auto it = links.constBegin(); it != links.constEnd(); ++it) {
+        if (it.value().mesh.isEmpty() || !frames.contains(it.key())) {
+            continue;
+        }
+        std::vector<std::array<float, 3>> mesh;
+        if (!loadStlVertices(it.value().mesh, mesh, &message)) {
+            return fail(message);
+        }
+        if (mesh.empty()) {
+            continue;
+        }
+        Body body;
+        body.name = it.key();
+        body.link = frames[it.key()].first;
+        body.offset = frames[it.key()].second * it.value().collisionOrigin;
+        body.vertices = hullVertices(mesh);
+        body.margin = hullMargin(body.vertices, mesh);
+
+        Vector3 lo = body.vertices[0], hi = body.vertices[0];
+        for (const Vector3& v : body.vertices) {
+            for (int r = 0; r < 3; ++r) {
+                lo[r] = std::min(lo[r], v[r]);
+                hi[r] = std::max(hi[r], v[r]);
+            }
+        }
+        body.center = scale(add(lo, hi), 0.5);
+        for (const Vector3& v : body.vertices) {
+            body.radius = std::max(body.radius, norm(sub(v, body.center)));
+        }
+        body.radius += body.margin;
+        bodies.push_back(std::move(body));
+    }
+    if (bodies.size() < 2 || bodies.size() > size_t(MAX_BODIES)) {
+        return fail(QString("Неподходящее число тел с мешами: %1").arg(bodies.size()));
+    }
+
+    m_kinematics = &kinematics;
+    m_bodies = std::move(bodies);
+
+    // Плечо сустава j: расстояние от его оси до любой точки звеньев после него,
+    // оценка сверху через длины звеньев в нулевой позе
+    KinematicFrames zero;
+    kinematics.forward(JointVector{}, zero);
+    std::array<double, KINEMATIC_JOINTS> linkLength{};
+    for (int k = 0; k < KINEMATIC_JOINTS; ++k) {
+        linkLength[k] = norm(sub(zero.links[k + 1].position, zero.links[k].position));
+    }
+    m_leverM.fill(0.0);
+    for (int j = 0; j < KINEMATIC_JOINTS; ++j) {
+        for (const Body& body : m_bodies) {
+            if (body.link < j + 1) {
+                continue;
+            }
+            double lever = norm(body.offset.apply(body.center)) + body.radius;
+            for (int k = j + 1; k < body.link; ++k) {
+                lever += linkLength[k];
+            }
+            m_leverM[j] = std::max(m_leverM[j], lever);
+        }
+    }
+
+    // Несоседние пары и их зазор в нулевой позе
+    Placement home;
+    place(JointVector{}, home);
+    m_allPairs.clear();
+    for (int a = 0; a < bodyCount(); ++a) {
+        m_bodies[a].homeFloorDistance = floorDistance(home, a) + m_config.floorHeightM;
+        for (int b = a + 1; b < bodyCount(); ++b) {
+            if (std::abs(m_bodies[a].link - m_bodies[b].link) <= 1) {
+                continue;
+            }
+            m_allPairs.push_back({a, b, bodyDistance(home, a, b, std::numeric_limits<double>::max())});
+        }
+    }
+    setConfig(m_config);
+    return true;
+}
+
+void CollisionChecker::setConfig(const CollisionConfig& config) {
+    m_config = config;
+
+    m_obstacleVertices.clear();
+    for (const CollisionObstacle& obstacle : m_config.obstacles) {
+        std::array<Vector3, 8> corners;
+        for (int i = 0; i < 8; ++i) {
+            for (int r = 0; r < 3; ++r) {
+                corners[i][r] = obstacle.center[r] + ((i >> r) & 1 ? obstacle.halfSize[r] : -obstacle.halfSize[r]);
+            }
+        }
+        m_obstacleVertices.push_back(corners);
+    }
+
+    // Касающиеся в нулевой позе пары и тела на столе (основание) не проверяются
+    m_pairs.clear();
+    for (const BodyPair& pair : m_allPairs) {
+        if (pair.homeDistance >= m_config.clearanceM) {
+            m_pairs.push_back(pair);
+        }
+    }
+    for (Body& body : m_bodies) {
+        body.checkFloor = body.link > 0 && body.homeFloorDistance - m_config.floorHeightM >= m_config.clearanceM;
+    }
+}
+
+void CollisionChecker::place(const JointVector& anglesDeg, Placement& placement) const {
+    KinematicFrames frames;
+    m_kinematics->forward(anglesDeg, frames);
+    for (size_t b = 0; b < m_bodies.size(); ++b) {
+        const Body& body = m_bodies[b];
+        placement.transforms[b] = frames.links[body.link] * body.offset;
+        placement.centers[b] = placement.transforms[b].apply(body.center);
+    }
+}
+
+double CollisionChecker::bodyDistance(const Placement& placement, int a, int b, double stopAbove) const {
+    const RigidTransform& ta = placement.transforms[a];
+    const RigidTransform& tb = placement.transforms[b];
+    const std::vector<Vector3>& va = m_bodies[a].vertices;
+    const std::vector<Vector3>& vb = m_bodies[b].vertices;
+    auto supportA = [&](const Vector3& d) { return ta.apply(farthest(va, toLocal(ta, d))); };
+    auto supportB = [&](const Vector3& d) { return tb.apply(farthest(vb, toLocal(tb, d))); };
+    const double margin = m_bodies[a].margin + m_bodies[b].margin;
+    return gjkDistance(supportA, supportB, sub(placement.centers[a], placement.centers[b]), stopAbove + margin)
+         - margin;
+}
+
+double CollisionChecker::obstacleDistance(const Placement& placement, int body, int obstacle, double stopAbove) const {
+    const RigidTransform& t = placement.transforms[body];
+    const std::vector<Vector3>& vertices = m_bodies[body].vertices;
+    const std::array<Vector3, 8>& corners = m_obstacleVertices[obstacle];
+    auto supportBody = [&](const Vector3& d) { return t.apply(farthest(vertices, toLocal(t, d))); };
+    auto supportBox = [&](const Vector3& d) {
+        int best = 0;
+        for (int i = 1; i < 8; ++i) {
+            if (dot(corners[i], d) > dot(corners[best], d)) {
+                best = i;
+            }
+        }
+        return corners[best];
+    };
+    const double margin = m_bodies[body].margin;
+    return gjkDistance(supportBody, supportBox,
+                       sub(placement.centers[body], m_config.obstacles[obstacle].center), stopAbove + margin)
+         - margin;
+}
+
+double CollisionChecker::floorDistance(const Placement& placement, int body) const {
+    const RigidTransform& t = placement.transforms[body];
+    const Vector3 lowest = t.apply(farthest(m_bodies[body].vertices, toLocal(t, {{0.0, 0.0, -1.0}})));
+    return lowest[2] - m_bodies[body].margin - m_config.floorHeightM;
+}
+
+double CollisionChecker::poseClearance(const Placement& placement, double cap, double stopBelow,
+                                       CollisionReport* report) const {
+    double best = cap;
+    int bestA = -1, bestB = -1, bestObstacle = -1;
+
+    for (const BodyPair& pair : m_pairs) {
+        const double gap = norm(sub(placement.centers[pair.a], placement.centers[pair.b]))
+                         - m_bodies[pair.a].radius - m_bodies[pair.b].radius;
+        if (gap >= best) {
+            continue;
+        }
+        const double d = bodyDistance(placement, pair.a, pair.b, best);
+        if (d < best) {
+            best = d;
+            bestA = pair.a;
+            bestB = pair.b;
+            if (best < stopBelow) {
+                break;
+            }
+        }
+    }
+
+    for (int body = 0; body < bodyCount() && best >= stopBelow; ++body) {
+        if (m_bodies[body].link == 0) {
+            continue;
+        }
+        if (m_config.floorEnabled && m_bodies[body].checkFloor) {
+            const double d = floorDistance(placement, body);
+            if (d < best) {
+                best = d;
+                bestA = body;
+                bestB = -1;
+                bestObstacle = -1;
+            }
+        }
+        for (int o = 0; o < int(m_obstacleVertices.size()) && best >= stopBelow; ++o) {
+            const Vector3& half = m_config.obstacles[o].halfSize;
+            const double gap = norm(sub(placement.centers[body], m_config.obstacles[o].center))
+                             - m_bodies[body].radius - norm(half);
+            if (gap >= best) {
+                continue;
+            }
+            const double d = obstacleDistance(placement, body, o, best);
+            if (d < best) {
+                best = d;
+                bestA = body;
+                bestB = -1;
+                bestObstacle = o;
+            }
+        }
+    }
+
+    if (report) {
+        report->bodyA = bestA;
+        report->bodyB = bestB;
+        report->obstacle = bestObstacle;
+        report->distanceM = best;
+    }
+    return best;
+}
+
+bool CollisionChecker::isPoseFree(const JointVector& anglesDeg, CollisionReport* report) const {
+    if (!isLoaded()) {
+        return true;
+    }
+    Placement placement;
+    place(anglesDeg, placement);
+    CollisionReport local;
+    const double d = poseClearance(placement, m_config.clearanceM, m_config.clearanceM, &local);
+    const bool free = d >= m_config.clearanceM;
+    if (report) {
+        *report = local;
+        report->collision = !free;
+        report->anglesDeg = anglesDeg;
+    }
+    return free;
+}
+
+double CollisionChecker::clearance(const JointVector& anglesDeg, CollisionReport* report) const {
+    if (!isLoaded()) {
+        return std::numeric_limits<double>::max();
+    }
+    Placement placement;
+    place(anglesDeg, placement);
+    const double d = poseClearance(placement, m_config.clearanceM + 1.0, -std::numeric_limits<double>::max(), report);
+    if (report) {
+        report->collision = d < m_config.clearanceM;
+        report->anglesDeg = anglesDeg;
+    }
+    return d;
+}
+
+bool CollisionChecker::segmentFree(const JointVector& from, const JointVector& to, CollisionReport* report) const {
+    // Верхняя оценка пути любой точки за весь отрезок, метры
+    double travel = 0.0;
+    for (int j = 0; j < KINEMATIC_JOINTS; ++j) {
+        travel += m_leverM[j] * std::abs(to[j] - from[j]) * DEG_TO_RAD;
+    }
+
+    const double limit = m_config.clearanceM;
+    double t = 0.0;
+    Placement placement;
+    CollisionReport local;
+    for (;;) {
+        JointVector q = from;
+        for (int j = 0; j < KINEMATIC_JOINTS; ++j) {
+            q[j] = from[j] + (to[j] - from[j]) * t;
+        }
+        place(q, placement);
+        const double d = poseClearance(placement, limit + CLEARANCE_LOOKAHEAD_M, limit, &local);
+        if (d < limit) {
+            if (report) {
+                *report = local;
+                report->collision = true;
+                report->fraction = t;
+                report->anglesDeg = q;
+            }
+            return false;
+        }
+        if (t >= 1.0 || travel <= 0.0) {
+            return true;
+        }
+        // Оба тела пары движутся: сближение за шаг не больше 2·travel·Δt
+        const double step = std::max(d - limit, MIN_ADVANCE_M) / (2.0 * travel);
+        t = std::min(1.0, t + step);
+    }
+}
+
+bool CollisionChecker::isSegmentFree(const JointVector& fromDeg, const JointVector& toDeg,
+                                     CollisionReport* report) const {
+    if (!isLoaded()) {
+        return true;
+    }
+    const bool free = segmentFree(fromDeg, toDeg, report);
+    if (report) {
+        report->segment = free ? -1 : 0;
+    }
+    return free;
+}
+
+bool CollisionChecker::isPathFree(const std::vector<JointVector>& waypoints, CollisionReport* report,
+                                  int threads) const {
+    if (!isLoaded() || waypoints.empty()) {
+        return true;
+    }
+    if (waypoints.size() == 1) {
+        return isPoseFree(waypoints[0], report);
+    }
+
+    const int segments = int(waypoints.size()) - 1;
+    int threadCount = threads > 0 ? threads : int(std::thread::hardware_concurrency());
+    threadCount = std::max(1, std::min(threadCount, segments));
+
+    // Отрезки раздаются по одному; после найденного столкновения отрезки
+    // дальше него не проверяются — нужен первый по ходу движения
+    std::atomic<int> next(0);
+    std::atomic<int> firstHit(segments);
+    std::mutex reportMutex;
+    CollisionReport hitReport;
+    auto worker = [&]() {
+        for (int s = next++; s < segments; s = next++) {
+            if (s > firstHit.load()) {
+                break;
+            }
+            CollisionReport local;
+            if (!segmentFree(waypoints[s], waypoints[s + 1], &local)) {
+                std::lock_guard<std::mutex> lock(reportMutex);
+                if (s < firstHit.load()) {
+                    firstHit = s;
+                    hitReport = local;
+                    hitReport.segment = s;
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threadCount; ++t) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+
+    const bool free = firstHit.load() == segments;
+    if (report) {
+        *report = free ? CollisionReport() : hitReport;
+    }
+    return free;
+}
+
+QString CollisionChecker::describe(const CollisionReport& report) const {
+    if (!report.collision || report.bodyA < 0) {
+        return QString();
+    }
+    QString other;
+    if (report.bodyB >= 0) {
+        other = m_bodies[report.bodyB].name;
+    } else if (report.obstacle >= 0) {
+        other = m_config.obstacles[report.obstacle].name;
+    } else {
+        other = "стол";
+    }
+    return QString("%1 — %2 (зазор %3 мм)")
+        .arg(m_bodies[report.bodyA].name, other)
+        .arg(report.distanceM * 1000.0, 0, 'f', 1);
+}
@@ -0,0 +1,319 @@
+#include "command_scheduler.h"
+#include <QStringList>
+#include <algorithm>
+#include "async_log.h"
+#include "d1_protocol.h"
+
+namespace {
+const int LOG_SCHED = d1::log::category("SCHED", 20);
+}
+
+CommandScheduler::CommandScheduler(QObject* parent)
+    : QObject(parent)
+    , m_entries(new Entry[CAPACITY])
+    , m_originNs(d1::monotonicNs())
+{
+    // Пул и рабочие массивы выделяются один раз
+    m_freeList.reserve(CAPACITY);
+    for (int32_t i = CAPACITY - 1; i >= 0; --i) {
+        m_freeList.push_back(i);
+    }
+    m_due.reserve(CAPACITY);
+    m_slots.fill(-1);
+
+    m_timer = new QTimer(this);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    m_timer->setSingleShot(true);
+    connect(m_timer, &QTimer::timeout, this, &CommandScheduler::dispatch);
+}
+
+CommandScheduler::~CommandScheduler() {
+    m_timer->stop();
+}
+
+uint64_t CommandScheduler::currentTick() const {
+    return (d1::monotonicNs() - m_originNs) / (TICK_MS * 1000000ULL);
+}
+
+int32_t CommandScheduler::indexOf(CommandHandle handle) const {
+    int64_t index = static_cast<int64_t>(handle & 0xFFFFFFFFu) - 1;
+    if (index < 0 || index >= CAPACITY) {
+        return -1;
+    }
+    if (m_entries[index].generation != static_cast<uint32_t>(handle >> 32)) {
+        return -1;
+    }
+    return static_cast<int32_t>(index);
+}
+
+int32_t CommandScheduler::acquire(int delayMs, CommandLane lane, CommandGroup group, const char* name) {
+    LaneStats& stats = m_stats[static_cast<size_t>(lane)];
+    if (m_freeList.empty()) {
+        stats.dropped++;
+        D1_LOG_ERROR(LOG_SCHED, "пул команд заполнен (%d), команда %s (%s) отброшена",
+                     CAPACITY, name, qPrintable(laneName(lane)));
+        return -1;
+    }
+
+    uint64_t nowNs = d1::monotonicNs();
+    uint64_t nowTick = (nowNs - m_originNs) / (TICK_MS * 1000000ULL);
+    if (m_pending == 0 && !m_dispatching) {
+        m_nextTick = nowTick;  // Колесо пустое — не догоняем простой
+    }
+
+    int32_t index = m_freeList.back();
+    m_freeList.pop_back();
+
+    Entry& e = m_entries[index];
+    uint64_t delayTicks = delayMs > 0 ? (static_cast<uint64_t>(delayMs) + TICK_MS - 1) / TICK_MS : 0;
+    e.deadlineNs = nowNs + static_cast<uint64_t>(std::max(delayMs, 0)) * 1000000ULL;
+    e.deadlineTick = std::max(nowTick + delayTicks, m_nextTick);
+    e.order = m_order++;
+    e.group = group;
+    e.lane = lane;
+    e.name = name;
+    link(index);
+    stats.scheduled++;
+
+    // Во время прохода таймер взводится в конце dispatch()
+    if (!m_dispatching && (!m_timer->isActive() || e.deadlineTick < m_armedTick)) {
+        m_armedTick = e.deadlineTick;
+        m_timer->start(static_cast<int>((e.deadlineTick - std::min(e.deadlineTick, nowTick)) * TICK_MS));
+    }
+    return index;
+}
+
+void CommandScheduler::link(int32_t index) {
+    Entry& e = m_entries[index];
+    int32_t& head = m_slots[e.deadlineTick % WHEEL_SLOTS];
+    e.prev = -1;
+    e.next = head;
+    if (head >= 0) {
+        m_entries[head].prev = index;
+    }
+    head = index;
+    e.state = EntryState::Scheduled;
+    m_pending++;
+}
+
+void CommandScheduler::unlink(int32_t index) {
+    Entry& e = m_entries[index];
+    if (e.prev >= 0) {
+        m_entries[e.prev].next = e.next;
+    } else {
+        m_slots[e.deadlineTick % WHEEL_SLOTS] = e.next;
+    }
+    if (e.next >= 0) {
+        m_entries[e.next].prev = e.prev;
+    }
+    e.prev = -1;
+    e.next = -1;
+    m_pending--;
+}
+
+void CommandScheduler::release(int32_t index) {
+    Entry& e = m_entries[index];
+    e.task.reset();
+    e.state = EntryState::Free;
+    e.generation++;
+    if (e.generation == 0) {
+        e.generation = 1;  // 0 в старшей половине дал бы дескриптор, похожий на чужой
+    }
+    m_freeList.push_back(index);
+}
+
+bool CommandScheduler::cancelIndex(int32_t index) {
+    Entry& e = m_entries[index];
+    if (e.state == EntryState::Scheduled) {
+        unlink(index);
+    } else if (e.state != EntryState::Due) {
+        return false;  // Уже выполняется или свободна
+    }
+    m_stats[static_cast<size_t>(e.lane)].cancelled++;
+    release(index);
+    return true;
+}
+
+bool CommandScheduler::cancel(CommandHandle handle) {
+    int32_t index = indexOf(handle);
+    if (index < 0) {
+        return false;
+    }
+    bool cancelled = cancelIndex(index);
+    if (cancelled && m_pending == 0 && !m_dispatching) {
+        m_timer->stop();
+    }
+    return cancelled;
+}
+
+int CommandScheduler::cancelGroup(CommandGroup group) {
+    int count = 0;
+    for (int32_t i = 0; i < CAPACITY; ++i) {
+        if (m_entries[i].group == group && cancelIndex(i)) {
+            ++count;
+        }
+    }
+    if (m_pending == 0 && !m_dispatching) {
+        m_timer->stop();
+    }
+    return count;
+}
+
+int CommandScheduler::cancelLane(CommandLane lane) {
+    int count = 0;
+    for (int32_t i = 0; i < CAPACITY; ++i) {
+        if (m_entries[i].lane == lane && cancelIndex(i)) {
+            ++count;
+        }
+    }
+    if (m_pending == 0 && !m_dispatching) {
+        m_timer->stop();
+    }
+    return count;
+}
+
+int CommandScheduler::cancelAll() {
+    int count = 0;
+    for (int32_t i = 0; i < CAPACITY; ++i) {
+        if (cancelIndex(i)) {
+            ++count;
+        }
+    }
+    if (!m_dispatching) {
+        m_timer->stop();
+    }
+    return count;
+}
+
+bool CommandScheduler::isPending(CommandHandle handle) const {
+    int32_t index = indexOf(handle);
+    if (index < 0) {
+        return false;
+    }
+    EntryState state = m_entries[index].state;
+    return state == EntryState::Scheduled || state == EntryState::Due;
+}
+
+void CommandScheduler::dispatch() {
+    // Вложенный цикл событий внутри команды (диалог) не должен запускать второй проход
+    if (m_dispatching) {
+        return;
+    }
+    m_dispatching = true;
+
+    // Забираем всё, чей срок наступил. После долгого простоя GUI достаточно
+    // одного оборота колеса: каждая ячейка просматривается не больше раза.
+    uint64_t nowTick = currentTick();
+    uint64_t lastTick = std::min(nowTick, m_nextTick + WHEEL_SLOTS - 1);
+    m_due.clear();
+    for (uint64_t tick = m_nextTick; tick <= lastTick; ++tick) {
+        int32_t index = m_slots[tick % WHEEL_SLOTS];
+        while (index >= 0) {
+            Entry& e = m_entries[index];
+            int32_t next = e.next;
+            if (e.deadlineTick <= nowTick) {
+                unlink(index);
+                e.state = EntryState::Due;
+                m_due.push_back(makeHandle(index));
+            }
+            index = next;
+        }
+    }
+    m_nextTick = std::max(m_nextTick, nowTick + 1);
+
+    // Срок, затем полоса, затем порядок планирования
+    std::sort(m_due.begin(), m_due.end(), [this](CommandHandle a, CommandHandle b) {
+        const Entry& ea = m_entries[indexOf(a)];
+        const Entry& eb = m_entries[indexOf(b)];
+        if (ea.deadlineTick != eb.deadlineTick) return ea.deadlineTick < eb.deadlineTick;
+        if (ea.lane != eb.lane) return ea.lane < eb.lane;
+        return ea.order < eb.order;
+    });
+
+    for (CommandHandle handle : m_due) {
+        // Предыдущая команда могла отменить эту (аварийная остановка)
+        int32_t index = indexOf(handle);
+        if (index < 0 || m_entries[index].state != EntryState::Due) {
+            continue;
+        }
+        Entry& e = m_entries[index];
+        LaneStats& stats = m_stats[static_cast<size_t>(e.lane)];
+
+        uint64_t startNs = d1::monotonicNs();
+        stats.lateness.record(startNs > e.deadlineNs ? startNs - e.deadlineNs : 0);
+        e.state = EntryState::Running;
+        e.task();
+        uint64_t runNs = d1::monotonicNs() - startNs;
+        stats.runtime.record(runNs);
+        stats.executed++;
+        if (runNs > SLOW_TASK_NS) {
+            D1_LOG_WARN(LOG_SCHED, "команда %s (%s) выполнялась %.1f мс",
+                        e.name, qPrintable(laneName(e.lane)), runNs / 1e6);
+        }
+        release(index);
+    }
+    m_due.clear();
+
+    m_dispatching = false;
+    rearm();
+}
+
+void CommandScheduler::rearm() {
+    if (m_pending == 0) {
+        m_timer->stop();
+        return;
+    }
+
+    // Ближайший срок: идём по ячейкам от текущего тика; в ячейке со смещением k
+    // сроки не меньше m_nextTick + k, поэтому найденный срок дальше не улучшится
+    uint64_t next = UINT64_MAX;
+    for (int k = 0; k < WHEEL_SLOTS && next > m_nextTick + k; ++k) {
+        for (int32_t index = m_slots[(m_nextTick + k) % WHEEL_SLOTS]; index >= 0; index = m_entries[index].next) {
+            next = std::min(next, m_entries[index].deadlineTick);
+        }
+    }
+
+    uint64_t nowTick = currentTick();
+    m_armedTick = next;
+    m_timer->start(static_cast<int>((next - std::min(next, nowTick)) * TICK_MS));
+}
+
+void CommandScheduler::resetStats() {
+    for (LaneStats& stats : m_stats) {
+        stats = LaneStats();
+    }
+}
+
+QString CommandScheduler::laneName(CommandLane lane) {
+    switch (lane) {
+        case CommandLane::Safety: return "безопасность";
+        case CommandLane::Power: return "питание";
+        case CommandLane::Motion: return "движение";
+        case CommandLane::Ui: return "интерфейс";
+        default: return QString();
+    }
+}
+
+QString CommandScheduler::report() const {
+    QStringList lines;
+    lines << QString("Планировщик команд (в ожидании: %1)").arg(m_pending);
+    for (size_t i = 0; i < m_stats.size(); ++i) {
+        const LaneStats& s = m_stats[i];
+        QString name = laneName(static_cast<CommandLane>(i));
+        if (s.scheduled == 0) {
+            lines << QString("%1: нет команд").arg(name);
+            continue;
+        }
+        lines << QString("%1: выполнено %2, отменено %3, отброшено %4; опоздание p99 %5 мс, max %6 мс; "
+                         "выполнение p99 %7 мс, max %8 мс")
+                     .arg(name)
+                     .arg(s.executed)
+                     .arg(s.cancelled)
+                     .arg(s.dropped)
+                     .arg(s.lateness.percentileMs(99.0), 0, 'f', 2)
+                     .arg(s.lateness.maxMs(), 0, 'f', 2)
+                     .arg(s.runtime.percentileMs(99.0), 0, 'f', 2)
+                     .arg(s.runtime.maxMs(), 0, 'f', 2);
+    }
+    return lines.join('\n');
+}
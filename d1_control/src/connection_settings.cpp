@@ -1,4 +1,5 @@
 #include "connection_settings.h"
+#include "arm_controller.h"
 #include <QFileDialog>
 #include <QStandardPaths>
 #include <QDateTime>
@@ -13,6 +14,7 @@ void ConnectionSettings::save() {
     settings.setValue("networkInterface", networkInterface);
     settings.setValue("ddsPort", ddsPort);
     settings.setValue("udpRelayPath", udpRelayPath);
+    settings.setValue("transport", transport);
     settings.endGroup();
 }
 
@@ -23,6 +25,7 @@ void ConnectionSettings::load() {
     networkInterface = settings.value("networkInterface", "auto").toString();
     ddsPort = settings.value("ddsPort", 7400).toInt();
     udpRelayPath = settings.value("udpRelayPath", "").toString();
+    transport = settings.value("transport", "auto").toString();
     settings.endGroup();
     
     // Попытка найти udp_relay автоматически
@@ -134,6 +137,19 @@ void ConnectionSettingsDialog::setupUi() {
     pathLayout->addWidget(m_browseBtn);
     relayLayout->addLayout(pathLayout);
     
+    QHBoxLayout* transportLayout = new QHBoxLayout();
+    transportLayout->addWidget(new QLabel("Транспорт:"));
+    m_transportCombo = new QComboBox();
+    m_transportCombo->addItem("Авто (разделяемая память → UDP)", "auto");
+    m_transportCombo->addItem("Только UDP", "udp");
+    if (ArmController::isInProcessTransportAvailable()) {
+        m_transportCombo->addItem("Встроенный DDS (без udp_relay)", "inprocess");
+    }
+    m_transportCombo->setToolTip("Применяется при следующем запуске приложения");
+    transportLayout->addWidget(m_transportCombo);
+    transportLayout->addStretch();
+    relayLayout->addLayout(transportLayout);
+    
     QHBoxLayout* relayBtnLayout = new QHBoxLayout();
     m_generateBtn = new QPushButton("📄 Сгенерировать cyclonedds.xml");
     connect(m_generateBtn, &QPushButton::clicked, this, &ConnectionSettingsDialog::onGenerateConfigClicked);
@@ -243,6 +259,7 @@ ConnectionSettings ConnectionSettingsDialog::getSettings() const {
     settings.networkInterface = m_interfaceCombo->currentData().toString();
     settings.ddsPort = m_ddsPortSpin->value();
     settings.udpRelayPath = m_relayPathEdit->text().trimmed();
+    settings.transport = m_transportCombo->currentData().toString();
     return settings;
 }
 
@@ -251,6 +268,9 @@ void ConnectionSettingsDialog::setSettings(const ConnectionSettings& settings) {
     m_ddsPortSpin->setValue(settings.ddsPort);
     m_relayPathEdit->setText(settings.udpRelayPath);
     
+    int transportIdx = m_transportCombo->findData(settings.transport);
+    m_transportCombo->setCurrentIndex(transportIdx >= 0 ? transportIdx : 0);
+    
     int idx = m_interfaceCombo->findData(settings.networkInterface);
     if (idx >= 0) {
         m_interfaceCombo->setCurrentIndex(idx);
@@ -0,0 +1,109 @@
+#include "convergence_tracker.h"
+#include <algorithm>
+#include <cmath>
+
+uint64_t ConvergenceTracker::add(const JointVector& targets, int expectedMs,
+                                 const ConvergenceOptions& options, uint64_t nowNs) {
+    Target target;
+    target.handle = m_nextHandle++;
+    target.angles = targets;
+    target.options = options;
+    target.startNs = nowNs;
+    double timeoutMs = std::max(0, expectedMs) * std::max(1.0, options.timeoutFactor)
+                     + std::max(0, options.timeoutMarginMs);
+    target.deadlineNs = nowNs + static_cast<uint64_t>(timeoutMs * 1e6);
+    m_targets.push_back(target);
+    return target.handle;
+}
+
+bool ConvergenceTracker::cancel(uint64_t handle) {
+    auto it = std::find_if(m_targets.begin(), m_targets.end(),
+                           [handle](const Target& t) { return t.handle == handle; });
+    if (it == m_targets.end()) {
+        return false;
+    }
+    m_targets.erase(it);
+    return true;
+}
+
+void ConvergenceTracker::clear() {
+    m_targets.clear();
+}
+
+bool ConvergenceTracker::isPending(uint64_t handle) const {
+    return std::any_of(m_targets.begin(), m_targets.end(),
+                       [handle](const Target& t) { return t.handle == handle; });
+}
+
+void ConvergenceTracker::update(const ArmState& state, uint64_t nowNs, std::vector<ConvergenceEvent>& events) {
+    auto it = m_targets.begin();
+    while (it != m_targets.end()) {
+        Target& target = *it;
+        const ConvergenceOptions& options = target.options;
+
+        bool inTolerance = true;
+        bool still = true;
+        target.worstJoint = -1;
+        target.worstErrorDeg = 0.0;
+        for (int j = 0; j < NUM_JOINTS; ++j) {
+            if (!(options.jointMask & (1u << j))) continue;
+            double error = std::abs(state.joints[j].angle - target.angles[j]);
+            if (error > target.worstErrorDeg) {
+                target.worstErrorDeg = error;
+                target.worstJoint = j;
+            }
+            inTolerance = inTolerance && error <= options.toleranceDeg;
+            still = still && std::abs(state.joints[j].velocity) <= options.settleVelocityDegPerSec;
+        }
+
+        bool reached = false;
+        if (inTolerance && (options.settleMs <= 0 || still)) {
+            if (target.settledSinceNs == 0) {
+                target.settledSinceNs = nowNs;
+            }
+            reached = options.settleMs <= 0
+                   || nowNs - target.settledSinceNs >= static_cast<uint64_t>(options.settleMs) * 1000000ULL;
+        } else {
+            target.settledSinceNs = 0;
+        }
+
+        if (reached) {
+            events.push_back(makeEvent(target, ConvergenceEvent::Reached, nowNs));
+        } else if (nowNs >= target.deadlineNs) {
+            events.push_back(makeEvent(target, ConvergenceEvent::TimedOut, nowNs));
+        } else {
+            ++it;
+            continue;
+        }
+        it = m_targets.erase(it);
+    }
+}
+
+void ConvergenceTracker::checkTimeouts(uint64_t nowNs, std::vector<ConvergenceEvent>& events) {
+    auto it = m_targets.begin();
+    while (it != m_targets.end()) {
+        if (nowNs < it->deadlineNs) {
+            ++it;
+            continue;
+        }
+        events.push_back(makeEvent(*it, ConvergenceEvent::TimedOut, nowNs));
+        it = m_targets.erase(it);
+    }
+}
+
+void ConvergenceTracker::abortAll(uint64_t nowNs, std::vector<ConvergenceEvent>& events) {
+    for (const Target& target : m_targets) {
+        events.push_back(makeEvent(target, ConvergenceEvent::Aborted, nowNs));
+    }
+    m_targets.clear();
+}
+
+ConvergenceEvent ConvergenceTracker::makeEvent(const Target& target, ConvergenceEvent::Kind kind, uint64_t nowNs) {
+    ConvergenceEvent event;
+    event.handle = target.handle;
+    event.kind = kind;
+    event.elapsedMs = static_cast<int>((nowNs - target.startNs) / 1000000ULL);
+    event.worstJoint = target.worstJoint;
+    event.worstErrorDeg = target.worstErrorDeg;
+    return event;
+}
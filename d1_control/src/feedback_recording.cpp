@@ -0,0 +1,23 @@
+#include "feedback_recording.h"
+
+void FeedbackRecording::reserve(size_t capacity) {
+    if (m_samples.size() != capacity) {
+        // assign, а не reserve: страницы заполняются здесь, а не в потоке приёма
+        m_samples.assign(capacity, RecordedSample());
+    }
+    clear();
+}
+
+void FeedbackRecording::clear() {
+    m_count.store(0, std::memory_order_release);
+    m_dropped.store(0, std::memory_order_relaxed);
+    m_sourceClock = false;
+}
+
+double FeedbackRecording::durationSec() const {
+    const size_t count = size();
+    if (count < 2) {
+        return 0.0;
+    }
+    return (m_samples[count - 1].timestampNs - m_samples[0].timestampNs) / 1e9;
+}
@@ -0,0 +1,461 @@
+#include "feedback_worker.h"
+#include "latency_monitor.h"
+#include "shm_channel.h"
+#include <QByteArray>
+#include <QDebug>
+#include <QHostAddress>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace {
+
+// QJsonDocument хранит числа в double (53 бита мантиссы): метки времени в нс
+// точнее 2^53 не переживают разбор, поэтому их цифры читаются из текста кадра
+uint64_t rawUInt64Field(const QByteArray& json, const char* key) {
+    int pos = json.indexOf(key);
+    if (pos < 0) {
+        return 0;
+    }
+    pos += static_cast<int>(qstrlen(key));
+    while (pos < json.size() && (json.at(pos) == ' ' || json.at(pos) == ':')) {
+        ++pos;
+    }
+    int end = pos;
+    while (end < json.size() && json.at(end) >= '0' && json.at(end) <= '9') {
+        ++end;
+    }
+    bool ok = false;
+    const qulonglong value = json.mid(pos, end - pos).toULongLong(&ok);
+    return ok ? value : 0;
+}
+
+} // namespace
+
+FeedbackWorker::FeedbackWorker(LatencyMonitor* latencyMonitor)
+    : QObject(nullptr)
+    , m_latencyMonitor(latencyMonitor)
+{
+    m_thread.setObjectName("d1-feedback-rx");
+
+    // Дочерние объекты переезжают в поток приёма вместе с воркером
+    m_socket = new QUdpSocket(this);
+    connect(m_socket, &QUdpSocket::readyRead, this, &FeedbackWorker::onReadyRead);
+
+    // Снимок (shm или встроенное ядро) читается по пробуждению от писателя;
+    // таймер — опрос для relay без пробуждений и страховка для остальных
+    m_snapshotTimer = new QTimer(this);
+    m_snapshotTimer->setTimerType(Qt::PreciseTimer);
+    m_snapshotTimer->setInterval(SNAPSHOT_POLL_MS);
+    connect(m_snapshotTimer, &QTimer::timeout, this, &FeedbackWorker::pollSnapshot);
+
+    // Таймаут связи считается здесь же: занятый поток GUI не должен "отключать" робота
+    m_watchdogTimer = new QTimer(this);
+    m_watchdogTimer->setInterval(WATCHDOG_MS);
+    connect(m_watchdogTimer, &QTimer::timeout, this, &FeedbackWorker::checkTimeout);
+
+    m_notifyTimer = new QTimer(this);
+    m_notifyTimer->setTimerType(Qt::PreciseTimer);
+    m_notifyTimer->setSingleShot(true);
+    connect(m_notifyTimer, &QTimer::timeout, this, &FeedbackWorker::notifyNow);
+
+    publish();
+}
+
+FeedbackWorker::~FeedbackWorker() {
+    stop();
+}
+
+template <typename F>
+void FeedbackWorker::runBlocking(F&& function) {
+    if (QThread::currentThread() == thread() || !m_thread.isRunning()) {
+        function();
+        return;
+    }
+    QMetaObject::invokeMethod(this, std::forward<F>(function), Qt::BlockingQueuedConnection);
+}
+
+void FeedbackWorker::start() {
+    if (m_thread.isRunning()) {
+        return;
+    }
+    moveToThread(&m_thread);
+    m_thread.start(QThread::HighPriority);
+    runBlocking([this]() {
+        m_watchdogTimer->start();
+    });
+}
+
+void FeedbackWorker::stop() {
+    if (!m_thread.isRunning()) {
+        return;
+    }
+
+    // Таймеры и сокет останавливаются в своём потоке, затем объект
+    // возвращается в поток владельца и может быть удалён оттуда
+    QThread* ownerThread = QThread::currentThread();
+    runBlocking([this, ownerThread]() {
+        m_snapshotTimer->stop();
+        m_watchdogTimer->stop();
+        m_notifyTimer->stop();
+        m_socket->close();
+        releaseSnapshotWakeup();
+        m_snapshot = nullptr;
+        m_recording = nullptr;
+        m_udpPort.store(0, std::memory_order_release);
+        moveToThread(ownerThread);
+    });
+    m_thread.quit();
+    m_thread.wait();
+}
+
+bool FeedbackWorker::bindUdp(quint16 preferredPort, QString* error) {
+    bool ok = false;
+    runBlocking([this, preferredPort, error, &ok]() {
+        ok = bindUdpInThread(preferredPort, error);
+    });
+    return ok;
+}
+
+bool FeedbackWorker::bindUdpInThread(quint16 preferredPort, QString* error) {
+    if (m_socket->state() == QAbstractSocket::BoundState) {
+        return true;
+    }
+
+    // Порт 8889 нужен только старому relay без подписок; если он занят
+    // (второй GUI, логгер), берём свободный порт и сообщаем его в Subscribe.
+    if (!m_socket->bind(QHostAddress::AnyIPv4, preferredPort)) {
+        qWarning() << "Порт" << preferredPort << "занят:" << m_socket->errorString()
+                   << "- используем свободный порт (нужен relay с поддержкой подписок)";
+        if (!m_socket->bind(QHostAddress::AnyIPv4, 0)) {
+            if (error) {
+                *error = m_socket->errorString();
+            }
+            return false;
+        }
+    }
+    m_udpPort.store(m_socket->localPort(), std::memory_order_release);
+    return true;
+}
+
+void FeedbackWorker::closeUdp() {
+    runBlocking([this]() {
+        m_socket->close();
+        m_udpPort.store(0, std::memory_order_release);
+    });
+}
+
+void FeedbackWorker::startSnapshot(const d1::SeqLock<d1::FeedbackSample>* snapshot,
+                                   SnapshotWake wake, int wakeupFd) {
+    if (wake == SnapshotWake::Socket && wakeupFd < 0) {
+        wake = SnapshotWake::Poll;
+    }
+    runBlocking([this, snapshot, wake, wakeupFd]() {
+        releaseSnapshotWakeup();
+        m_snapshot = snapshot;
+        m_snapshotLastVersion = 0;
+        if (wake == SnapshotWake::Socket) {
+            m_wakeupFd = wakeupFd;
+            m_wakeupNotifier = new QSocketNotifier(wakeupFd, QSocketNotifier::Read, this);
+            // Строковый connect: у activated() в Qt 5.15 две перегрузки
+            connect(m_wakeupNotifier, SIGNAL(activated(int)), this, SLOT(onSnapshotWakeup()));
+        }
+        m_snapshotTimer->setInterval(wake == SnapshotWake::Poll ? SNAPSHOT_POLL_MS : SNAPSHOT_SAFETY_POLL_MS);
+        m_snapshotTimer->start();
+    });
+}
+
+void FeedbackWorker::stopSnapshot() {
+    runBlocking([this]() {
+        m_snapshotTimer->stop();
+        releaseSnapshotWakeup();
+        m_snapshot = nullptr;
+    });
+}
+
+void FeedbackWorker::releaseSnapshotWakeup() {
+    delete m_wakeupNotifier;
+    m_wakeupNotifier = nullptr;
+    m_wakeupFd = -1;
+}
+
+void FeedbackWorker::wakeSnapshot() {
+    // Выборки между пробуждениями уже в снимке — второе событие не нужно
+    if (!m_snapshotWakeQueued.exchange(true, std::memory_order_acq_rel)) {
+        QMetaObject::invokeMethod(this, [this]() {
+            m_snapshotWakeQueued.store(false, std::memory_order_release);
+            pollSnapshot();
+        }, Qt::QueuedConnection);
+    }
+}
+
+void FeedbackWorker::startRecording(FeedbackRecording* recording) {
+    runBlocking([this, recording]() {
+        m_recording = recording;
+    });
+}
+
+void FeedbackWorker::stopRecording() {
+    runBlocking([this]() {
+        m_recording = nullptr;
+    });
+}
+
+void FeedbackWorker::resetErrorStatus() {
+    QMetaObject::invokeMethod(this, [this]() {
+        m_working.errorStatus = 0;
+        publish();
+    }, Qt::QueuedConnection);
+}
+
+void FeedbackWorker::setMotionEstimatorConfig(const MotionEstimatorConfig& config) {
+    QMetaObject::invokeMethod(this, [this, config]() {
+        m_estimator.setConfig(config);
+        m_estimator.reset();
+    }, Qt::QueuedConnection);
+}
+
+void FeedbackWorker::startSkewProbe(const SkewProbe& probe) {
+    QMetaObject::invokeMethod(this, [this, probe]() {
+        m_skewProbe = probe;
+    }, Qt::QueuedConnection);
+}
+
+void FeedbackWorker::cancelSkewProbe() {
+    QMetaObject::invokeMethod(this, [this]() {
+        m_skewProbe.active = false;
+    }, Qt::QueuedConnection);
+}
+
+void FeedbackWorker::onReadyRead() {
+    bool updated = false;
+
+    // Датаграммы читаются в постоянный буфер — без QNetworkDatagram/QByteArray на каждую
+    while (m_socket->hasPendingDatagrams()) {
+        qint64 size = m_socket->readDatagram(m_datagram, sizeof(m_datagram));
+        if (size <= 0) {
+            continue;
+        }
+
+        d1::FeedbackSample sample;
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(m_datagram);
+        bool ok = d1::isFeedbackFrame(bytes, static_cast<size_t>(size))
+                ? d1::decodeFeedbackFrame(bytes, static_cast<size_t>(size), sample)
+                : parseJson(m_datagram, size, sample);
+        if (ok) {
+            ingest(sample);
+            updated = true;
+        }
+    }
+
+    if (updated) {
+        scheduleNotify();
+    }
+}
+
+void FeedbackWorker::onSnapshotWakeup() {
+    d1::ShmChannel::drainWakeup(m_wakeupFd);
+    pollSnapshot();
+}
+
+void FeedbackWorker::pollSnapshot() {
+    if (!m_snapshot) {
+        return;
+    }
+    uint32_t version = m_snapshot->version();
+    if (version == m_snapshotLastVersion || (version & 1u)) {
+        return;
+    }
+
+    d1::FeedbackSample sample;
+    if (!m_snapshot->tryLoad(sample)) {
+        return;  // Попали на запись — прочитаем на следующем тике
+    }
+    m_snapshotLastVersion = version;
+    ingest(sample, true);
+    scheduleNotify();
+}
+
+bool FeedbackWorker::parseJson(const char* data, qint64 size, d1::FeedbackSample& sample) const {
+    const QByteArray json = QByteArray::fromRawData(data, static_cast<int>(size));
+    QJsonDocument doc = QJsonDocument::fromJson(json);
+    if (!doc.isObject()) {
+        return false;
+    }
+
+    QJsonObject root = doc.object();
+    if (!root.contains("data")) {
+        return false;
+    }
+
+    QJsonObject dataObj = root["data"].toObject();
+
+    // Отсутствующие поля сохраняют текущие значения
+    sample.powerStatus = m_working.powerStatus;
+    sample.errorStatus = m_working.errorStatus;
+    for (int i = 0; i < NUM_JOINTS; ++i) {
+        sample.angles[i] = static_cast<float>(m_working.joints[i].angle);
+    }
+
+    sample.seq = static_cast<uint32_t>(root["seq"].toDouble());
+    sample.timestampNs = rawUInt64Field(json, "\"t_dds\"");
+    sample.txTimestampNs = rawUInt64Field(json, "\"t_tx\"");
+    sample.powerStatus = dataObj["power_status"].toInt(sample.powerStatus);
+    sample.errorStatus = dataObj["error_status"].toInt(sample.errorStatus);
+
+    static const char* const angleKeys[NUM_JOINTS] = {
+        "angle0", "angle1", "angle2", "angle3", "angle4", "angle5", "angle6"
+    };
+    for (int i = 0; i < NUM_JOINTS; ++i) {
+        QJsonValue value = dataObj.value(QLatin1String(angleKeys[i]));
+        if (!value.isUndefined()) {
+            sample.angles[i] = static_cast<float>(value.toDouble());
+        }
+    }
+    return true;
+}
+
+void FeedbackWorker::ingest(const d1::FeedbackSample& sample, bool fromSnapshot) {
+    uint64_t receiveNs = d1::monotonicNs();
+    if (m_latencyMonitor) {
+        m_latencyMonitor->recordFeedback(sample, receiveNs, fromSnapshot);
+    }
+    // Запись — до остальной обработки, с меткой источника, а не тика GUI
+    if (m_recording) {
+        m_recording->append(sample.timestampNs, receiveNs, sample.angles);
+    }
+
+    // Изменения статуса — редкие события, уходят в GUI сразу (в порядке появления)
+    if (sample.powerStatus != m_working.powerStatus) {
+        m_working.powerStatus = sample.powerStatus;
+        emit powerStatusChanged(sample.powerStatus);
+    }
+    if (sample.errorStatus != m_working.errorStatus) {
+        m_working.errorStatus = sample.errorStatus;
+        emit errorStatusChanged(sample.errorStatus);
+    }
+
+    for (int i = 0; i < NUM_JOINTS; ++i) {
+        m_working.joints[i].angle = sample.angles[i];
+    }
+
+    // Скорость и ускорение — по меткам DDS; без них (старый relay) — по времени приёма.
+    // Смена источника меток — смена часов, фильтр начинается заново.
+    bool ddsClock = sample.timestampNs != 0;
+    if (ddsClock != m_estimatorDdsClock) {
+        m_estimatorDdsClock = ddsClock;
+        m_estimator.reset();
+    }
+    m_estimator.update(sample.angles, ddsClock ? sample.timestampNs : receiveNs, m_working.joints);
+
+    if (m_kinematics && m_kinematics->isLoaded()) {
+        JointVector angles;
+        for (int i = 0; i < NUM_JOINTS; ++i) {
+            angles[i] = m_working.joints[i].angle;
+        }
+        RigidTransform tcp = m_kinematics->forward(angles);
+        m_working.tcpPosition = tcp.position;
+        m_working.tcpRpy = tcp.rpy();
+        m_working.tcpValid = true;
+    }
+
+    m_working.lastUpdateTime = receiveNs / 1000000;
+    m_working.seq = sample.seq;
+    m_working.ddsTimestampNs = sample.timestampNs;
+    m_working.receiveTimestampNs = receiveNs;
+    bool wasConnected = m_working.isConnected;
+    m_working.isConnected = true;
+
+    publish();
+
+    updateSkewProbe(sample, receiveNs);
+
+    if (!wasConnected) {
+        emit connectionChanged(true);
+    }
+}
+
+void FeedbackWorker::checkTimeout() {
+    uint64_t now = d1::monotonicNs() / 1000000;
+    if (!m_working.isConnected || m_working.lastUpdateTime == 0
+        || now - m_working.lastUpdateTime <= CONNECTION_TIMEOUT_MS) {
+        return;
+    }
+    m_working.isConnected = false;
+    m_estimator.reset();
+    for (JointState& joint : m_working.joints) {
+        joint.velocity = 0.0;
+        joint.acceleration = 0.0;
+    }
+    publish();
+    emit connectionChanged(false);
+}
+
+void FeedbackWorker::publish() {
+    m_published.store(m_working);
+    m_status.store(packArmStatus(m_working), std::memory_order_release);
+}
+
+void FeedbackWorker::scheduleNotify() {
+    if (m_notifyTimer->isActive()) {
+        return;  // Уведомление уже запланировано — выборка в него войдёт
+    }
+
+    constexpr uint64_t intervalNs = 1000000000ULL / NOTIFY_RATE_HZ;
+    uint64_t sinceLast = d1::monotonicNs() - m_lastNotifyNs;
+    if (sinceLast >= intervalNs) {
+        notifyNow();
+    } else {
+        m_notifyTimer->start(static_cast<int>((intervalNs - sinceLast + 999999) / 1000000));
+    }
+}
+
+void FeedbackWorker::notifyNow() {
+    // GUI ещё не обработал прошлое уведомление: он прочитает свежий снимок сам
+    if (m_notifyQueued.exchange(true)) {
+        return;
+    }
+    m_lastNotifyNs = d1::monotonicNs();
+    emit stateAvailable();
+}
+
+void FeedbackWorker::updateSkewProbe(const d1::FeedbackSample& sample, uint64_t nowNs) {
+    if (!m_skewProbe.active) {
+        return;
+    }
+
+    bool allStarted = true;
+    for (int i = 0; i < NUM_JOINTS; ++i) {
+        if (!m_skewProbe.expected[i] || m_skewProbe.startNs[i] != 0) continue;
+        if (std::abs(sample.angles[i] - m_skewProbe.startAngles[i]) > m_skewProbe.thresholdDeg) {
+            m_skewProbe.startNs[i] = nowNs;
+        } else {
+            allStarted = false;
+        }
+    }
+
+    bool timedOut = nowNs - m_skewProbe.commandNs > m_skewProbe.timeoutNs;
+    if (!allStarted && !timedOut) {
+        return;
+    }
+
+    m_skewProbe.active = false;
+
+    uint64_t first = UINT64_MAX;
+    uint64_t last = 0;
+    int started = 0;
+    for (int i = 0; i < NUM_JOINTS; ++i) {
+        if (!m_skewProbe.expected[i] || m_skewProbe.startNs[i] == 0) continue;
+        first = std::min(first, m_skewProbe.startNs[i]);
+        last = std::max(last, m_skewProbe.startNs[i]);
+        ++started;
+    }
+    if (started < 2) {
+        return;
+    }
+
+    emit skewMeasured((last - first) / 1e6, m_skewProbe.synchronized);
+}
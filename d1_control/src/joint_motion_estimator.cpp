@@ -0,0 +1,59 @@
+#include "joint_motion_estimator.h"
+#include <algorithm>
+
+void JointMotionEstimator::setConfig(const MotionEstimatorConfig& config) {
+    // Область устойчивости α-β-γ: 0 < α < 2, 0 < β < 4 - 2α, 0 < γ < 4αβ / (2 - α)
+    m_config = config;
+    m_config.alpha = std::max(0.01, std::min(config.alpha, 1.0));
+    m_config.beta = std::max(0.0, std::min(config.beta, 0.9 * (4.0 - 2.0 * m_config.alpha)));
+    double gammaLimit = 4.0 * m_config.alpha * m_config.beta / (2.0 - m_config.alpha);
+    m_config.gamma = std::max(0.0, std::min(config.gamma, 0.9 * gammaLimit));
+    m_config.maxGapMs = std::max(1.0, config.maxGapMs);
+}
+
+void JointMotionEstimator::reset() {
+    m_initialized = false;
+    m_lastTimestampNs = 0;
+    m_velocity.fill(0.0);
+    m_acceleration.fill(0.0);
+}
+
+void JointMotionEstimator::update(const float* angles, uint64_t timestampNs,
+                                  std::array<JointState, NUM_JOINTS>& joints) {
+    if (m_initialized && timestampNs <= m_lastTimestampNs) {
+        return;  // Повтор той же выборки relay или метка из прошлого
+    }
+
+    const double dt = m_initialized ? (timestampNs - m_lastTimestampNs) / 1e9 : 0.0;
+    if (!m_initialized || dt * 1000.0 > m_config.maxGapMs) {
+        for (int i = 0; i < NUM_JOINTS; ++i) {
+            m_angle[i] = angles[i];
+            joints[i].velocity = 0.0;
+            joints[i].acceleration = 0.0;
+        }
+        m_velocity.fill(0.0);
+        m_acceleration.fill(0.0);
+        m_lastTimestampNs = timestampNs;
+        m_initialized = true;
+        return;
+    }
+
+    const double alpha = m_config.alpha;
+    const double betaOverDt = m_config.beta / dt;
+    const double gammaOverDt2 = 2.0 * m_config.gamma / (dt * dt);
+
+    for (int i = 0; i < NUM_JOINTS; ++i) {
+        // Прогноз по модели постоянного ускорения
+        double angle = m_angle[i] + m_velocity[i] * dt + 0.5 * m_acceleration[i] * dt * dt;
+        double velocity = m_velocity[i] + m_acceleration[i] * dt;
+        double residual = angles[i] - angle;
+
+        m_angle[i] = angle + alpha * residual;
+        m_velocity[i] = velocity + betaOverDt * residual;
+        m_acceleration[i] += gammaOverDt2 * residual;
+
+        joints[i].velocity = m_velocity[i];
+        joints[i].acceleration = m_acceleration[i];
+    }
+    m_lastTimestampNs = timestampNs;
+}
@@ -0,0 +1,299 @@
+#include "joint_trajectory.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Корни a·s² + b·s + c внутри (0, 1); возвращает их число
+int rootsInUnit(double a, double b, double c, double roots[2]) {
+    int count = 0;
+    auto keep = [&](double s) {
+        if (s > 0.0 && s < 1.0) {
+            roots[count++] = s;
+        }
+    };
+    if (a == 0.0) {
+        if (b != 0.0) {
+            keep(-c / b);
+        }
+        return count;
+    }
+    const double discriminant = b * b - 4.0 * a * c;
+    if (discriminant < 0.0) {
+        return 0;
+    }
+    const double root = std::sqrt(discriminant);
+    keep((-b - root) / (2.0 * a));
+    keep((-b + root) / (2.0 * a));
+    return count;
+}
+
+// Отрезок — квинтика Эрмита по s ∈ [0, 1] с нулевым ускорением на концах:
+// p(s) = p0 + c1·s + c3·s³ + c4·s⁴ + c5·s⁵. Производные по s:
+// p'(s) = c1 + 3c3·s² + 4c4·s³ + 5c5·s⁴, p''(s) = s·(6c3 + 12c4·s + 20c5·s²),
+// p'''(s) = 6c3 + 24c4·s + 60c5·s². Экстремумы каждой — в нулях следующей,
+// а это квадратные уравнения, поэтому пики считаются точно.
+struct QuinticSegment {
+    double c1;
+    double c3;
+    double c4;
+    double c5;
+
+    QuinticSegment(double delta, double v0, double v1, double h)
+        : c1(h * v0)
+        , c3(10.0 * delta - h * (6.0 * v0 + 4.0 * v1))
+        , c4(-15.0 * delta + h * (8.0 * v0 + 7.0 * v1))
+        , c5(6.0 * delta - 3.0 * h * (v0 + v1)) {}
+
+    double offset(double s) const { return s * (c1 + s * s * (c3 + s * (c4 + s * c5))); }
+    double slope(double s) const { return c1 + s * s * (3.0 * c3 + s * (4.0 * c4 + s * 5.0 * c5)); }
+    double curvature(double s) const { return s * (6.0 * c3 + s * (12.0 * c4 + s * 20.0 * c5)); }
+    double jerk(double s) const { return 6.0 * c3 + s * (24.0 * c4 + s * 60.0 * c5); }
+
+    double peakSlope() const {
+        double peak = std::max(std::abs(slope(0.0)), std::abs(slope(1.0)));
+        double roots[2];
+        const int count = rootsInUnit(20.0 * c5, 12.0 * c4, 6.0 * c3, roots);
+        for (int i = 0; i < count; ++i) {
+            peak = std::max(peak, std::abs(slope(roots[i])));
+        }
+        return peak;
+    }
+    double peakCurvature() const {
+        double peak = std::abs(curvature(1.0));
+        double roots[2];
+        const int count = rootsInUnit(60.0 * c5, 24.0 * c4, 6.0 * c3, roots);
+        for (int i = 0; i < count; ++i) {
+            peak = std::max(peak, std::abs(curvature(roots[i])));
+        }
+        return peak;
+    }
+    double peakJerk() const {
+        double peak = std::max(std::abs(jerk(0.0)), std::abs(jerk(1.0)));
+        if (c5 != 0.0) {
+            const double s = -c4 / (5.0 * c5);
+            if (s > 0.0 && s < 1.0) {
+                peak = std::max(peak, std::abs(jerk(s)));
+            }
+        }
+        return peak;
+    }
+};
+
+} // namespace
+
+MotionLimits MotionLimits::scaled(double scale) const {
+    MotionLimits result = *this;
+    for (int j = 0; j < NUM_JOINTS; ++j) {
+        result.velocity[j] *= scale;
+        result.acceleration[j] *= scale * scale;
+        result.jerk[j] *= scale * scale * scale;
+    }
+    return result;
+}
+
+void JointTrajectory::clear() {
+    m_points.clear();
+}
+
+void JointTrajectory::addWaypoint(double timeSec, const JointVector& angles, bool stop) {
+    if (!m_points.empty() && timeSec <= m_points.back().timeSec) {
+        m_points.back().angles = angles;
+        m_points.back().stop = m_points.back().stop || stop;
+        return;
+    }
+    Waypoint point;
+    point.timeSec = timeSec;
+    point.angles = angles;
+    point.stop = stop;
+    m_points.push_back(point);
+}
+
+void JointTrajectory::finalize() {
+    const int count = waypointCount();
+    for (int i = 0; i < count; ++i) {
+        Waypoint& point = m_points[i];
+        point.velocities.fill(0.0);
+        if (i == 0 || i == count - 1 || point.stop) {
+            continue;
+        }
+        const Waypoint& prev = m_points[i - 1];
+        const Waypoint& next = m_points[i + 1];
+        for (int j = 0; j < NUM_JOINTS; ++j) {
+            double slopeIn = (point.angles[j] - prev.angles[j]) / (point.timeSec - prev.timeSec);
+            double slopeOut = (next.angles[j] - point.angles[j]) / (next.timeSec - point.timeSec);
+            // Разворот или остановка сустава: в точке стоим, иначе сплайн перелетит цель
+            if (slopeIn * slopeOut <= 0.0) {
+                continue;
+            }
+            double v = (next.angles[j] - prev.angles[j]) / (next.timeSec - prev.timeSec);
+            // Аналог ограничения Фрича-Карлсона для квинтики (граница 15/7,
+            // с запасом 2): монотонный отрезок остаётся монотонным
+            double limit = 2.0 * std::min(std::abs(slopeIn), std::abs(slopeOut));
+            point.velocities[j] = std::max(-limit, std::min(v, limit));
+        }
+    }
+}
+
+int JointTrajectory::segmentAt(double timeSec) const {
+    if (m_points.size() < 2 || timeSec <= m_points.front().timeSec) {
+        return 0;
+    }
+    auto it = std::upper_bound(m_points.begin(), m_points.end(), timeSec,
+                               [](double t, const Waypoint& p) { return t < p.timeSec; });
+    int index = static_cast<int>(it - m_points.begin()) - 1;
+    return std::min(index, waypointCount() - 2);
+}
+
+JointVector JointTrajectory::sample(double timeSec) const {
+    if (m_points.empty()) {
+        return JointVector{};
+    }
+    if (timeSec <= m_points.front().timeSec) {
+        return m_points.front().angles;
+    }
+    if (timeSec >= m_points.back().timeSec) {
+        return m_points.back().angles;
+    }
+
+    const int index = segmentAt(timeSec);
+    const Waypoint& a = m_points[index];
+    const Waypoint& b = m_points[index + 1];
+    const double h = b.timeSec - a.timeSec;
+    const double s = (timeSec - a.timeSec) / h;
+
+    JointVector result;
+    for (int j = 0; j < NUM_JOINTS; ++j) {
+        QuinticSegment segment(b.angles[j] - a.angles[j], a.velocities[j], b.velocities[j], h);
+        result[j] = a.angles[j] + segment.offset(s);
+    }
+    return result;
+}
+
+void JointTrajectory::blendCorner(const JointVector& prev, const JointVector& corner, const JointVector& next,
+                                  double radiusDeg, JointVector& entry, JointVector& exit,
+                                  double& entryFraction, double& exitFraction) {
+    double inLength = 0.0;
+    double outLength = 0.0;
+    for (int j = 0; j < NUM_JOINTS - 1; ++j) {
+        inLength = std::max(inLength, std::abs(corner[j] - prev[j]));
+        outLength = std::max(outLength, std::abs(next[j] - corner[j]));
+    }
+    entryFraction = (radiusDeg > 0.0 && inLength > 0.0) ? std::min(radiusDeg / inLength, MAX_BLEND_FRACTION) : 0.0;
+    exitFraction = (radiusDeg > 0.0 && outLength > 0.0) ? std::min(radiusDeg / outLength, MAX_BLEND_FRACTION) : 0.0;
+    for (int j = 0; j < NUM_JOINTS; ++j) {
+        entry[j] = corner[j] + (prev[j] - corner[j]) * entryFraction;
+        exit[j] = corner[j] + (next[j] - corner[j]) * exitFraction;
+    }
+}
+
+JointTrajectory JointTrajectory::pointToPoint(const JointVector& from, const JointVector& to, double durationSec) {
+    JointTrajectory trajectory;
+    trajectory.addWaypoint(0.0, from);
+    trajectory.addWaypoint(std::max(durationSec, 1e-3), to);
+    trajectory.finalize();
+    return trajectory;
+}
+
+void JointTrajectory::peaks(JointVector& velocity, JointVector& acceleration, JointVector& jerk) const {
+    velocity.fill(0.0);
+    acceleration.fill(0.0);
+    jerk.fill(0.0);
+    for (int i = 0; i + 1 < waypointCount(); ++i) {
+        const Waypoint& a = m_points[i];
+        const Waypoint& b = m_points[i + 1];
+        const double h = b.timeSec - a.timeSec;
+        for (int j = 0; j < NUM_JOINTS; ++j) {
+            QuinticSegment d(b.angles[j] - a.angles[j], a.velocities[j], b.velocities[j], h);
+            velocity[j] = std::max(velocity[j], d.peakSlope() / h);
+            acceleration[j] = std::max(acceleration[j], d.peakCurvature() / (h * h));
+            jerk[j] = std::max(jerk[j], d.peakJerk() / (h * h * h));
+        }
+    }
+}
+
+double JointTrajectory::segmentExcess(int index, const MotionLimits& limits) const {
+    const Waypoint& a = m_points[index];
+    const Waypoint& b = m_points[index + 1];
+    const double h = b.timeSec - a.timeSec;
+    double excess = 0.0;
+    for (int j = 0; j < NUM_JOINTS; ++j) {
+        QuinticSegment d(b.angles[j] - a.angles[j], a.velocities[j], b.velocities[j], h);
+        if (limits.velocity[j] > 0.0) {
+            excess = std::max(excess, d.peakSlope() / h / limits.velocity[j]);
+        }
+        if (limits.acceleration[j] > 0.0) {
+            excess = std::max(excess, std::sqrt(d.peakCurvature() / (h * h) / limits.acceleration[j]));
+        }
+        if (limits.jerk[j] > 0.0) {
+            excess = std::max(excess, std::cbrt(d.peakJerk() / (h * h * h) / limits.jerk[j]));
+        }
+    }
+    return excess;
+}
+
+void JointTrajectory::retime(const MotionLimits& limits) {
+    const int segments = waypointCount() - 1;
+    if (segments < 1) {
+        finalize();
+        return;
+    }
+
+    // Нижняя оценка: сустав не быстрее своей предельной скорости. Отрезок без
+    // движения (выдержка, стоянка перед остановкой) лимитами не ограничен —
+    // его длительность сохраняется, иначе пауза сжалась бы до MIN_SEGMENT_SEC.
+    std::vector<double> durations(segments, MIN_SEGMENT_SEC);
+    for (int i = 0; i < segments; ++i) {
+        bool moves = false;
+        for (int j = 0; j < NUM_JOINTS; ++j) {
+            const double delta = std::abs(m_points[i + 1].angles[j] - m_points[i].angles[j]);
+            moves = moves || delta > 0.0;
+            if (limits.velocity[j] > 0.0) {
+                durations[i] = std::max(durations[i], delta / limits.velocity[j]);
+            }
+        }
+        if (!moves) {
+            durations[i] = std::max(durations[i], m_points[i + 1].timeSec - m_points[i].timeSec);
+        }
+    }
+    auto applyDurations = [&]() {
+        for (int i = 0; i < segments; ++i) {
+            m_points[i + 1].timeSec = m_points[i].timeSec + durations[i];
+        }
+        finalize();
+    };
+    auto worstExcess = [&]() {
+        double worst = 0.0;
+        for (int i = 0; i < segments; ++i) {
+            worst = std::max(worst, segmentExcess(i, limits));
+        }
+        return worst;
+    };
+
+    constexpr double TOLERANCE = 1e-3;
+    for (int pass = 0; pass < MAX_RETIME_PASSES; ++pass) {
+        applyDurations();
+        bool within = true;
+        for (int i = 0; i < segments; ++i) {
+            const double excess = segmentExcess(i, limits);
+            if (excess > 1.0 + TOLERANCE) {
+                durations[i] *= excess;
+                within = false;
+            }
+        }
+        if (within) {
+            break;
+        }
+    }
+
+    // Остаток допуска (или несошедшиеся проходы) — равномерным растяжением:
+    // форма та же, все производные падают в нужной степени
+    applyDurations();
+    const double worst = worstExcess();
+    if (worst > 1.0) {
+        for (double& duration : durations) {
+            duration *= worst;
+        }
+        applyDurations();
+    }
+}
@@ -0,0 +1,250 @@
+#include "latency_monitor.h"
+#include <QMutexLocker>
+#include <QStringList>
+#include <algorithm>
+#include <cmath>
+
+// ==================== LatencyHistogram ====================
+
+int LatencyHistogram::bucketIndex(uint64_t us) {
+    if (us < 1) {
+        return 0;
+    }
+    int octave = 0;
+    while ((us >> (octave + 1)) != 0) {
+        ++octave;
+    }
+    if (octave >= OCTAVES) {
+        return NUM_BUCKETS - 1;
+    }
+    // Положение внутри октавы [2^octave, 2^(octave+1)) делим на SUB_BUCKETS частей
+    int sub = static_cast<int>(((us * SUB_BUCKETS) >> octave) - SUB_BUCKETS);
+    return octave * SUB_BUCKETS + sub;
+}
+
+double LatencyHistogram::bucketUpperUs(int index) {
+    int octave = index / SUB_BUCKETS;
+    int sub = index % SUB_BUCKETS;
+    return std::ldexp(1.0 + (sub + 1) / static_cast<double>(SUB_BUCKETS), octave);
+}
+
+void LatencyHistogram::record(uint64_t ns) {
+    m_buckets[bucketIndex(ns / 1000)]++;
+    m_count++;
+    m_sumNs += static_cast<double>(ns);
+    if (ns > m_maxNs) {
+        m_maxNs = ns;
+    }
+}
+
+void LatencyHistogram::reset() {
+    m_buckets.fill(0);
+    m_count = 0;
+    m_maxNs = 0;
+    m_sumNs = 0.0;
+}
+
+double LatencyHistogram::percentileMs(double p) const {
+    if (m_count == 0) {
+        return 0.0;
+    }
+    uint64_t rank = static_cast<uint64_t>(std::ceil(p / 100.0 * m_count));
+    if (rank < 1) rank = 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < NUM_BUCKETS; ++i) {
+        seen += m_buckets[i];
+        if (seen >= rank) {
+            // Верхняя граница корзины, но не больше наблюдаемого максимума
+            return std::min(bucketUpperUs(i) / 1000.0, maxMs());
+        }
+    }
+    return maxMs();
+}
+
+// ==================== LatencyMonitor ====================
+
+void LatencyMonitor::recordStage(Stage stage, uint64_t fromNs, uint64_t toNs) {
+    if (fromNs == 0 || toNs < fromNs || toNs - fromNs > MAX_PLAUSIBLE_NS) {
+        return;
+    }
+    m_histograms[stage].record(toNs - fromNs);
+}
+
+void LatencyMonitor::recordFeedback(const d1::FeedbackSample& sample, uint64_t receiveNs, bool fromSnapshot) {
+    QMutexLocker locker(&m_mutex);
+
+    // Разрыв в seq: потеря для датаграмм, перезапись для снимка.
+    // Сильный откат назад — перезапуск relay.
+    if (sample.seq != 0) {
+        if (m_haveSeq) {
+            uint32_t delta = sample.seq - m_lastSeq;
+            if (delta == 0 || delta > 0x80000000u) {
+                if (sample.seq + 1000 < m_lastSeq) {
+                    m_lastSeq = sample.seq;
+                }
+            } else {
+                (fromSnapshot ? m_coalesced : m_lost) += delta - 1;
+                m_lastSeq = sample.seq;
+            }
+        } else {
+            m_haveSeq = true;
+            m_lastSeq = sample.seq;
+        }
+    }
+    m_received++;
+
+    recordStage(DdsToRelaySend, sample.timestampNs, sample.txTimestampNs);
+    recordStage(RelaySendToGui, sample.txTimestampNs, receiveNs);
+    recordStage(DdsToGui, sample.timestampNs, receiveNs);
+
+    // Первое заметное движение после команды
+    if (m_motionPending) {
+        uint64_t observedNs = sample.timestampNs ? sample.timestampNs : receiveNs;
+        bool moved = false;
+        for (int i = 0; i < d1::PROTO_NUM_JOINTS; ++i) {
+            if (std::fabs(sample.angles[i] - m_motionStartAngles[i]) > MOTION_THRESHOLD_DEG) {
+                moved = true;
+                break;
+            }
+        }
+        if (moved) {
+            recordStage(CommandToMotion, m_motionCommandNs, observedNs);
+            m_motionPending = false;
+        } else if (receiveNs - m_motionCommandNs > MOTION_TIMEOUT_NS) {
+            m_motionPending = false;  // Рука не сдвинулась (цель совпала с позицией)
+        }
+    }
+
+    for (int i = 0; i < d1::PROTO_NUM_JOINTS; ++i) {
+        m_lastAngles[i] = sample.angles[i];
+    }
+    m_haveAngles = true;
+}
+
+void LatencyMonitor::recordMotionCommand(uint64_t sendNs) {
+    QMutexLocker locker(&m_mutex);
+
+    // Пока ждём движение от предыдущей команды, новые не перезапускают замер:
+    // поочерёдные команды funcode 1 считаются от первой
+    if (m_motionPending || !m_haveAngles) {
+        return;
+    }
+    m_motionPending = true;
+    m_motionCommandNs = sendNs;
+    for (int i = 0; i < d1::PROTO_NUM_JOINTS; ++i) {
+        m_motionStartAngles[i] = m_lastAngles[i];
+    }
+}
+
+void LatencyMonitor::reset() {
+    QMutexLocker locker(&m_mutex);
+    for (LatencyHistogram& h : m_histograms) {
+        h.reset();
+    }
+    m_haveSeq = false;
+    m_received = 0;
+    m_lost = 0;
+    m_coalesced = 0;
+    m_motionPending = false;
+}
+
+LatencyMonitor::StageSummary LatencyMonitor::summary(Stage stage) const {
+    QMutexLocker locker(&m_mutex);
+    const LatencyHistogram& h = m_histograms[stage];
+    StageSummary s;
+    s.count = h.count();
+    s.p50Ms = h.percentileMs(50.0);
+    s.p99Ms = h.percentileMs(99.0);
+    s.maxMs = h.maxMs();
+    return s;
+}
+
+uint64_t LatencyMonitor::receivedCount() const {
+    QMutexLocker locker(&m_mutex);
+    return m_received;
+}
+
+uint64_t LatencyMonitor::lostCount() const {
+    QMutexLocker locker(&m_mutex);
+    return m_lost;
+}
+
+uint64_t LatencyMonitor::coalescedCount() const {
+    QMutexLocker locker(&m_mutex);
+    return m_coalesced;
+}
+
+double LatencyMonitor::lossRate() const {
+    QMutexLocker locker(&m_mutex);
+    uint64_t total = m_received + m_lost + m_coalesced;
+    return total ? static_cast<double>(m_lost) / total : 0.0;
+}
+
+double LatencyMonitor::coalescedRate() const {
+    QMutexLocker locker(&m_mutex);
+    uint64_t total = m_received + m_lost + m_coalesced;
+    return total ? static_cast<double>(m_coalesced) / total : 0.0;
+}
+
+bool LatencyMonitor::withinBudget() const {
+    StageSummary s = summary(DdsToGui);
+    return s.count == 0 || s.p99Ms <= FEEDBACK_BUDGET_MS;
+}
+
+QString LatencyMonitor::stageName(Stage stage) {
+    switch (stage) {
+        case DdsToRelaySend: return "DDS → отправка relay";
+        case RelaySendToGui: return "relay → GUI";
+        case DdsToGui: return "DDS → GUI";
+        case CommandToMotion: return "Команда → движение";
+        default: return QString();
+    }
+}
+
+QString LatencyMonitor::shortSummary() const {
+    StageSummary s = summary(DdsToGui);
+    if (s.count == 0) {
+        return receivedCount() ? "нет меток времени (старый relay)" : "--";
+    }
+    QString text = QString("p50 %1 / p99 %2 мс, потери %3%")
+                       .arg(s.p50Ms, 0, 'f', 2)
+                       .arg(s.p99Ms, 0, 'f', 2)
+                       .arg(lossRate() * 100.0, 0, 'f', 2);
+    if (coalescedCount() > 0) {
+        text += QString(", объединено %1%").arg(coalescedRate() * 100.0, 0, 'f', 1);
+    }
+    return text;
+}
+
+QString LatencyMonitor::report() const {
+    QStringList lines;
+    for (int i = 0; i < StageCount; ++i) {
+        Stage stage = static_cast<Stage>(i);
+        StageSummary s = summary(stage);
+        if (s.count == 0) {
+            lines << QString("%1: нет данных").arg(stageName(stage));
+            continue;
+        }
+        lines << QString("%1: p50 %2 мс, p99 %3 мс, max %4 мс (n=%5)")
+                     .arg(stageName(stage))
+                     .arg(s.p50Ms, 0, 'f', 2)
+                     .arg(s.p99Ms, 0, 'f', 2)
+                     .arg(s.maxMs, 0, 'f', 2)
+                     .arg(s.count);
+    }
+    lines << QString();
+    lines << QString("Получено кадров: %1, потеряно: %2 (%3%)")
+                 .arg(receivedCount())
+                 .arg(lostCount())
+                 .arg(lossRate() * 100.0, 0, 'f', 3);
+    if (coalescedCount() > 0) {
+        lines << QString("Объединено в снимке (shm/встроенное ядро, не потери): %1 (%2%)")
+                     .arg(coalescedCount())
+                     .arg(coalescedRate() * 100.0, 0, 'f', 1);
+    }
+    lines << QString("Бюджет доставки feedback (p99 DDS → GUI): %1 мс — %2")
+                 .arg(FEEDBACK_BUDGET_MS, 0, 'f', 0)
+                 .arg(withinBudget() ? "выполняется" : "ПРЕВЫШЕН");
+    return lines.join('\n');
+}
@@ -5,6 +5,7 @@
 #include <QDebug>
 
 #include "mainwindow.h"
+#include "async_log.h"
 
 int main(int argc, char *argv[]) {
     QApplication app(argc, argv);
@@ -143,6 +144,19 @@ int main(int argc, char *argv[]) {
         }
     )");
     
+    // Асинхронный логгер: горячие пути (команды, воспроизведение, встроенное ядро DDS)
+    // пишут в кольца потоков, вывод в обработчик Qt делает фоновый поток
+    d1::log::Logger::instance().setSink([](const d1::log::Record& record, const char* category) {
+        QString line = QString("[%1] %2").arg(QLatin1String(category),
+                                              QString::fromUtf8(record.text, record.length));
+        if (record.level >= d1::log::Level::Warn) {
+            qWarning().noquote() << line;
+        } else {
+            qDebug().noquote() << line;
+        }
+    });
+    d1::log::Logger::instance().start();
+    
     qDebug() << "Запуск Unitree D1 Control...";
     
     MainWindow mainWindow;
@@ -8,6 +8,8 @@
 #include <QDebug>
 #include <QDateTime>
 #include <QLabel>
+#include <algorithm>
+#include <cmath>
 
 MainWindow::MainWindow(QWidget* parent)
     : QMainWindow(parent)
@@ -21,6 +23,7 @@ MainWindow::MainWindow(QWidget* parent)
     m_motionManager = new MotionManager(this);
     m_motionPlayer = new MotionPlayer(m_armController, this);
     m_motionRecorder = new MotionRecorder(m_armController, this);
+    m_cartesianJog = new CartesianJogController(m_armController, this);
     
     setupUi();
     setupMenus();
@@ -42,12 +45,29 @@ MainWindow::MainWindow(QWidget* parent)
         m_armController->setJointLimits(i, calib.joints[i].minAngle, calib.joints[i].maxAngle);
         m_jointPanel->setJointLimits(i, calib.joints[i].minAngle, calib.joints[i].maxAngle);
     }
+    m_motionPlayer->setMotionLimits(calib.motionLimits());
+    connect(m_calibrationManager, &CalibrationManager::calibrationChanged, this, [this]() {
+        m_motionPlayer->setMotionLimits(m_calibrationManager->getData().motionLimits());
+    });
+    connect(m_calibrationManager, &CalibrationManager::calibrationLoaded, this, [this]() {
+        m_motionPlayer->setMotionLimits(m_calibrationManager->getData().motionLimits());
+    });
     
     // Таймер обновления UI
     m_uiUpdateTimer = new QTimer(this);
     m_uiUpdateTimer->setInterval(50);  // 20 FPS
     connect(m_uiUpdateTimer, &QTimer::timeout, this, &MainWindow::updateStatusBar);
     m_uiUpdateTimer->start();
+    
+    // Сводка задержек feedback в виджете статуса
+    m_latencyTimer = new QTimer(this);
+    m_latencyTimer->setInterval(1000);
+    connect(m_latencyTimer, &QTimer::timeout, this, [this]() {
+        const LatencyMonitor& monitor = m_armController->latencyMonitor();
+        m_statusWidget->setLatencyInfo(monitor.shortSummary(), monitor.withinBudget(),
+                                       monitor.summary(LatencyMonitor::DdsToGui).count > 0);
+    });
+    m_latencyTimer->start();
 
     // --- ВОТЕРМАРКА АВТОРА ---
     QLabel* watermarkLabel = new QLabel(this);
@@ -67,6 +87,7 @@ MainWindow::MainWindow(QWidget* parent)
                              "Не удалось инициализировать SDK.\n"
                              "Проверьте подключение к руке.");
     }
+    m_collisionAction->setChecked(m_armController->isCollisionCheckEnabled());
 }
 
 MainWindow::~MainWindow() {
@@ -120,6 +141,23 @@ void MainWindow::setupMenus() {
     m_fileMenu->addAction("Сохранить позы...", this, &MainWindow::onSavePoses);
     m_fileMenu->addAction("Экспорт поз...", this, &MainWindow::onExportPoses);
     m_fileMenu->addSeparator();
+    // Движения: библиотека .d1ml или JSON (обмен, прежние версии); формат при
+    // загрузке — по содержимому, при сохранении — по расширению
+    m_fileMenu->addAction("Загрузить движения...", this, [this]() {
+        QString path = QFileDialog::getOpenFileName(this, "Загрузить движения", QString(),
+                                                    "Движения (*.d1ml *.json)");
+        if (!path.isEmpty()) {
+            m_motionManager->loadFromFile(path);
+        }
+    });
+    m_fileMenu->addAction("Экспорт движений...", this, [this]() {
+        QString path = QFileDialog::getSaveFileName(this, "Экспорт движений", QString(),
+                                                    "Библиотека движений (*.d1ml);;JSON (*.json)");
+        if (!path.isEmpty()) {
+            m_motionManager->saveToFile(path);
+        }
+    });
+    m_fileMenu->addSeparator();
     m_fileMenu->addAction("Выход", this, &MainWindow::onQuit, QKeySequence::Quit);
     
     // Меню Редактирование
@@ -133,6 +171,57 @@ void MainWindow::setupMenus() {
     });
     m_editMenu->addSeparator();
     
+    // Синхронные команды на всю руку (funcode 2) и замер рассинхронизации старта
+    QAction* syncAction = m_editMenu->addAction("Синхронные команды (funcode 2)");
+    syncAction->setCheckable(true);
+    syncAction->setChecked(m_armController->getMultiJointMode() != MultiJointMode::PerJoint);
+    connect(syncAction, &QAction::toggled, this, [this](bool checked) {
+        m_armController->setMultiJointMode(checked ? MultiJointMode::Auto : MultiJointMode::PerJoint);
+    });
+    
+    QAction* skewAction = m_editMenu->addAction("Измерять рассинхронизацию суставов");
+    skewAction->setCheckable(true);
+    connect(skewAction, &QAction::toggled, this, [this](bool checked) {
+        if (!checked) {
+            QMessageBox::information(this, "Рассинхронизация старта суставов",
+                                     m_armController->skewReport());
+        }
+        m_armController->setSkewMeasurementEnabled(checked);
+    });
+    
+    // Движения одной траекторией с фиксированной частотой уставок (без остановок на кадрах)
+    QAction* streamAction = m_editMenu->addAction("Потоковое воспроизведение движений");
+    streamAction->setCheckable(true);
+    streamAction->setChecked(m_motionPlayer->isStreamingEnabled());
+    connect(streamAction, &QAction::toggled, this, [this](bool checked) {
+        m_motionPlayer->setStreamingEnabled(checked);
+    });
+    
+    // Времена переходов по пределам суставов из калибровки, а не из записи
+    QAction* limitTimingAction = m_editMenu->addAction("Переходы по пределам суставов");
+    limitTimingAction->setStatusTip("Времена переходов подбираются так, чтобы скорость, ускорение и рывок "
+                                    "суставов не превышали пределов калибровки (не минимальные по времени)");
+    limitTimingAction->setCheckable(true);
+    limitTimingAction->setChecked(m_motionPlayer->isLimitTimingEnabled());
+    connect(limitTimingAction, &QAction::toggled, this, [this](bool checked) {
+        m_motionPlayer->setLimitTimingEnabled(checked);
+    });
+    m_editMenu->addAction("Длительность движений...", this, [this]() {
+        QMessageBox::information(this, "Длительность цикла: по записи → по пределам суставов",
+                                 m_motionPlayer->durationReport(m_motionManager->getAllMotions()));
+    });
+    
+    // Самостолкновения и окружение: переход в позу, воспроизведение, jog
+    // (отметка обновляется после initialize(): там читается Collision/enabled)
+    m_collisionAction = m_editMenu->addAction("Проверка столкновений");
+    m_collisionAction->setCheckable(true);
+    m_collisionAction->setEnabled(m_armController->collision().isLoaded());
+    m_collisionAction->setChecked(m_armController->isCollisionCheckEnabled());
+    connect(m_collisionAction, &QAction::toggled, this, [this](bool checked) {
+        m_armController->setCollisionCheckEnabled(checked);
+    });
+    m_editMenu->addSeparator();
+    
     // Добавляем горячие клавиши для аварийной остановки и домашней позиции
     m_emergencyAction = m_editMenu->addAction("АВАРИЙНАЯ ОСТАНОВКА", this, &MainWindow::onEmergencyStop, QKeySequence(Qt::Key_Escape));
     m_homeAction = m_editMenu->addAction("Домашняя позиция", this, &MainWindow::onHomeAllRequested, QKeySequence(Qt::Key_Home));
@@ -172,6 +261,9 @@ void MainWindow::setupCentralWidget() {
     m_statusWidget = new StatusWidget();
     rightLayout->addWidget(m_statusWidget);
     
+    m_cartesianJogWidget = new CartesianJogWidget(m_cartesianJog);
+    rightLayout->addWidget(m_cartesianJogWidget);
+    
     m_poseListWidget = new PoseListWidget(m_poseManager);
     rightLayout->addWidget(m_poseListWidget, 1);
     
@@ -197,6 +289,13 @@ void MainWindow::setupConnections() {
     connect(m_armController, &ArmController::errorOccurred, this, &MainWindow::onArmError);
     connect(m_armController, &ArmController::recoveryStarted, this, &MainWindow::onArmRecoveryStarted);
     connect(m_armController, &ArmController::recoveryFinished, this, &MainWindow::onArmRecoveryFinished);
+    connect(m_armController, &ArmController::targetReached, this, &MainWindow::onArmTargetReached);
+    connect(m_armController, &ArmController::targetFailed, this, &MainWindow::onArmTargetFailed);
+    connect(m_armController, &ArmController::jointStartSkewMeasured, this, [this](double skewMs, bool synchronized) {
+        statusBar()->showMessage(QString("Рассинхронизация старта: %1 мс (%2)")
+                                 .arg(skewMs, 0, 'f', 1)
+                                 .arg(synchronized ? "funcode 2" : "funcode 1"), 3000);
+    });
     
     // Сигналы от панели суставов
     connect(m_jointPanel, &JointControlPanel::jointAngleChanged, this, &MainWindow::onJointAngleRequested);
@@ -214,6 +313,18 @@ void MainWindow::setupConnections() {
     connect(m_statusWidget, &StatusWidget::resetErrorsClicked, this, &MainWindow::onResetErrorsRequested);
     connect(m_statusWidget, &StatusWidget::emergencyStopClicked, this, &MainWindow::onEmergencyStop);
     connect(m_statusWidget, &StatusWidget::calibrationClicked, this, &MainWindow::onOpenCalibrationDialog);
+    connect(m_statusWidget, &StatusWidget::latencyDetailsClicked, this, [this]() {
+        QMessageBox box(QMessageBox::Information, "Задержки контура управления",
+                        m_armController->latencyMonitor().report() + "\n\n"
+                            + m_armController->scheduler().report(),
+                        QMessageBox::Close, this);
+        QPushButton* resetBtn = box.addButton("Сбросить", QMessageBox::ResetRole);
+        box.exec();
+        if (box.clickedButton() == resetBtn) {
+            m_armController->latencyMonitor().reset();
+            m_armController->scheduler().resetStats();
+        }
+    });
     
     // Сигналы от списка поз
     connect(m_poseListWidget, &PoseListWidget::poseSelected, this, &MainWindow::onPoseSelected);
@@ -225,10 +336,13 @@ void MainWindow::setupConnections() {
     connect(m_motionPlayer, &MotionPlayer::started, this, [this](const QString&) {
         m_jointPanel->setReadOnly(true);
         m_poseListWidget->setEnabled(false);
+        m_cartesianJogWidget->stopJog();
+        m_cartesianJogWidget->setEnabled(false);
     });
     connect(m_motionPlayer, &MotionPlayer::stopped, this, [this]() {
         m_jointPanel->setReadOnly(false);
         m_poseListWidget->setEnabled(true);
+        m_cartesianJogWidget->setEnabled(true);
     });
     connect(m_motionRecorder, &MotionRecorder::recordingStarted, this, [this](const QString&) {
         m_poseListWidget->setEnabled(false);
@@ -276,6 +390,13 @@ void MainWindow::updateWindowTitle() {
 }
 
 void MainWindow::updateStatusBar() {
+    // Состояние не менялось с прошлого тика — строку не пересобираем
+    uint32_t version = m_armController->stateVersion();
+    if (version == m_statusBarVersion) {
+        return;
+    }
+    m_statusBarVersion = version;
+    
     ArmState state = m_armController->getState();
     
     QString status;
@@ -289,6 +410,21 @@ void MainWindow::updateStatusBar() {
                      .arg(state.joints[3].angle, 0, 'f', 1)
                      .arg(state.joints[4].angle, 0, 'f', 1)
                      .arg(state.joints[5].angle, 0, 'f', 1);
+        
+        // Самый быстрый сустав (оценка по feedback) — видно, что рука ещё едет
+        double maxSpeed = 0.0;
+        for (int i = 0; i < NUM_JOINTS - 1; ++i) {
+            maxSpeed = std::max(maxSpeed, std::abs(state.joints[i].velocity));
+        }
+        if (maxSpeed >= 1.0) {
+            status += QString(" | Скорость: %1 °/с").arg(maxSpeed, 0, 'f', 0);
+        }
+        if (state.tcpValid) {
+            status += QString(" | TCP: %1, %2, %3 мм")
+                          .arg(state.tcpPosition[0] * 1000.0, 0, 'f', 0)
+                          .arg(state.tcpPosition[1] * 1000.0, 0, 'f', 0)
+                          .arg(state.tcpPosition[2] * 1000.0, 0, 'f', 0);
+        }
     }
     
     statusBar()->showMessage(status);
@@ -423,6 +559,9 @@ void MainWindow::onEmergencyStop() {
         m_motionRecorder->cancelRecording();
     }
     
+    // Jog больше не шлёт уставки
+    m_cartesianJog->stop();
+    
     // Отменяем запланированные команды и аварийная остановка контроллера
     m_armController->cancelAllPendingCommands();
     m_armController->emergencyStop();
@@ -529,9 +668,14 @@ void MainWindow::onJointAngleRequested(int jointId, double angle) {
         m_pendingAngle[jointId] = clampedAngle;
         m_hasPendingCommand[jointId] = true;
         
-        // Запланируем отправку через оставшееся время
+        // Запланируем отправку через оставшееся время. Одна отложенная отправка
+        // на сустав: пока она ждёт, новые значения слайдера только обновляют цель.
+        if (m_armController->scheduler().isPending(m_pendingCommandHandle[jointId])) {
+            return;
+        }
         int remaining = throttleMs - (now - m_lastCommandTime[jointId]);
-        QTimer::singleShot(remaining, this, [this, jointId]() {
+        m_pendingCommandHandle[jointId] = m_armController->scheduler().schedule(
+            remaining, CommandLane::Ui, 0, "slider", [this, jointId]() {
             if (m_hasPendingCommand[jointId]) {
                 m_hasPendingCommand[jointId] = false;
                 double targetAngle = m_pendingAngle[jointId];
@@ -550,6 +694,7 @@ void MainWindow::onJointAngleRequested(int jointId, double angle) {
     // Отправляем сразу
     m_lastCommandTime[jointId] = now;
     m_hasPendingCommand[jointId] = false;
+    m_armController->scheduler().cancel(m_pendingCommandHandle[jointId]);
     
     double angleDelta = std::abs(clampedAngle - currentAngle);
     int delay = calculateMoveDelay(angleDelta);
@@ -582,14 +727,46 @@ void MainWindow::onHomeAllRequested() {
         return;
     }
     statusBar()->showMessage("Переход в домашнюю позицию...");
-    m_jointPanel->setReadOnly(true);
-    m_armController->moveToHome();
     
-    // Разблокируем через 3 секунды
-    QTimer::singleShot(3000, this, [this]() {
+    // Разблокируем, когда рука придёт (а не через фиксированные 3 секунды)
+    lockPanelUntilArrival(m_armController->moveToHome(), "Домашняя позиция");
+}
+
+void MainWindow::lockPanelUntilArrival(quint64 targetHandle, const QString& description) {
+    // Предыдущая цель заменена новой командой — о ней больше не сообщаем
+    m_armController->cancelTarget(m_panelTarget);
+    m_panelTarget = targetHandle;
+    m_panelTargetDescription = description;
+    if (targetHandle == 0) {
+        unlockPanel();
+        return;
+    }
+    m_jointPanel->setReadOnly(true);
+}
+
+void MainWindow::unlockPanel() {
+    m_panelTarget = 0;
+    // Во время воспроизведения панель блокирует плейер
+    if (!m_motionPlayer->isPlaying()) {
         m_jointPanel->setReadOnly(false);
-        statusBar()->showMessage("Домашняя позиция достигнута", 3000);
-    });
+    }
+}
+
+void MainWindow::onArmTargetReached(quint64 handle, int elapsedMs) {
+    if (handle == 0 || handle != m_panelTarget) {
+        return;
+    }
+    unlockPanel();
+    statusBar()->showMessage(QString("%1: достигнута за %2 мс").arg(m_panelTargetDescription).arg(elapsedMs), 3000);
+}
+
+void MainWindow::onArmTargetFailed(quint64 handle, bool timedOut, const QString& reason) {
+    Q_UNUSED(timedOut);
+    if (handle == 0 || handle != m_panelTarget) {
+        return;
+    }
+    unlockPanel();
+    statusBar()->showMessage(QString("%1: не достигнута (%2)").arg(m_panelTargetDescription, reason), 5000);
 }
 
 
@@ -608,6 +785,8 @@ void MainWindow::onDisableMotorsRequested() {
         m_motionPlayer->stop();
     }
     
+    m_cartesianJog->stop();
+    
     // Отменяем все запланированные команды
     m_armController->cancelAllPendingCommands();
     
@@ -667,25 +846,40 @@ void MainWindow::onPoseActivated(int index, const Pose& pose) {
         }
     }
     
+    // Путь от текущей позы до цели; если рука уже в касании — только сама цель
+    const CollisionChecker& collision = m_armController->collision();
+    if (collision.isActive()) {
+        JointVector current;
+        for (int i = 0; i < 7; ++i) {
+            current[i] = state.joints[i].angle;
+        }
+        CollisionReport report;
+        bool free = collision.isPoseFree(current)
+            ? collision.isSegmentFree(current, safeAngles, &report)
+            : collision.isPoseFree(safeAngles, &report);
+        if (!free) {
+            statusBar()->showMessage(QString("Поза '%1' не выполнена: столкновение").arg(pose.name), 5000);
+            QMessageBox::warning(this, "Столкновение",
+                                 QString("Переход в позу '%1' приведёт к столкновению:\n%2\n\n"
+                                         "Проверку можно отключить в меню \"Редактирование\".")
+                                 .arg(pose.name, collision.describe(report)));
+            return;
+        }
+    }
+    
     // Расчёт времени перехода на основе настроек
     // Базовая скорость: 10% = 3000мс, 100% = 500мс (увеличено для плавности)
     int baseDelayMs = 3000 - (m_speedPercent - 10) * 28;  // 3000 при 10%, 480 при 100%
     baseDelayMs = qMax(500, baseDelayMs);  // Минимум 500мс для плавности
     
-    // Устанавливаем режим "только чтение" на время выполнения
-    m_jointPanel->setReadOnly(true);
-    
     // Выполняем с ИНТЕРПОЛЯЦИЕЙ для плавности (8 шагов)
     m_armController->setAllJointAnglesInterpolated(safeAngles, baseDelayMs, 8);
     
     qDebug() << "Поза: плавный переход за" << baseDelayMs << "мс";
     
-    // Разблокируем панель через время перехода + запас
-    int unlockDelay = baseDelayMs + 500;
-    QTimer::singleShot(unlockDelay, this, [this, pose]() {
-        m_jointPanel->setReadOnly(false);
-        statusBar()->showMessage(QString("Поза '%1' выполнена").arg(pose.name), 3000);
-    });
+    // Панель "только чтение", пока рука не придёт в позу
+    lockPanelUntilArrival(m_armController->awaitTarget(safeAngles, baseDelayMs),
+                          QString("Поза '%1'").arg(pose.name));
 }
 
 void MainWindow::onSaveCurrentPose(const QString& name) {
@@ -0,0 +1,338 @@
+#include "motion_library.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <array>
+#include <climits>
+#include <cstring>
+
+namespace {
+
+// CRC-32 (IEEE 802.3, как в zip/PNG), по 8 байт за шаг (slicing-by-8):
+// таблица k — вклад байта, за которым ещё k байт
+struct Crc32Table {
+    std::array<std::array<quint32, 256>, 8> values;
+
+    Crc32Table() {
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            }
+            values[0][i] = c;
+        }
+        for (int t = 1; t < 8; ++t) {
+            for (int i = 0; i < 256; ++i) {
+                const quint32 previous = values[t - 1][i];
+                values[t][i] = (previous >> 8) ^ values[0][previous & 0xff];
+            }
+        }
+    }
+};
+
+quint32 crc32(const uchar* data, quint64 size) {
+    static const Crc32Table table;
+    const auto& t = table.values;
+    quint32 c = 0xffffffffu;
+    for (; size >= 8; data += 8, size -= 8) {
+        quint32 low, high;
+        std::memcpy(&low, data, sizeof(low));
+        std::memcpy(&high, data + 4, sizeof(high));
+        low ^= c;
+        c = t[7][low & 0xff] ^ t[6][(low >> 8) & 0xff] ^ t[5][(low >> 16) & 0xff] ^ t[4][low >> 24]
+          ^ t[3][high & 0xff] ^ t[2][(high >> 8) & 0xff] ^ t[1][(high >> 16) & 0xff] ^ t[0][high >> 24];
+    }
+    for (; size > 0; ++data, --size) {
+        c = t[0][(c ^ *data) & 0xff] ^ (c >> 8);
+    }
+    return c ^ 0xffffffffu;
+}
+
+quint64 alignedSize(quint64 size) {
+    return (size + 15) & ~quint64(15);
+}
+
+} // namespace
+
+MotionLibrary::~MotionLibrary() {
+    close();
+}
+
+bool MotionLibrary::isLibrary(const QByteArray& head) {
+    if (head.size() < int(sizeof(quint32))) {
+        return false;
+    }
+    quint32 magic;
+    std::memcpy(&magic, head.constData(), sizeof(magic));
+    return magic == MAGIC;
+}
+
+void MotionLibrary::close() {
+    if (m_mapped) {
+        m_file.unmap(m_mapped);
+        m_mapped = nullptr;
+    }
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+    m_buffer.clear();
+    m_header = nullptr;
+    m_index = nullptr;
+    m_strings = nullptr;
+    m_data = nullptr;
+}
+
+bool MotionLibrary::open(const QString& path, QString* error) {
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        if (error) {
+            *error = QString("Не удалось открыть %1: %2").arg(path, m_file.errorString());
+        }
+        return false;
+    }
+    m_mapped = m_file.map(0, m_file.size());
+    if (!m_mapped) {
+        if (error) {
+            *error = QString("Не удалось отобразить %1: %2").arg(path, m_file.errorString());
+        }
+        close();
+        return false;
+    }
+    if (!attach(m_mapped, m_file.size(), error)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool MotionLibrary::openData(const QByteArray& data, QString* error) {
+    close();
+    m_buffer = data;
+    if (!attach(reinterpret_cast<const uchar*>(m_buffer.constData()), m_buffer.size(), error)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool MotionLibrary::attach(const uchar* data, qint64 size, QString* error) {
+    auto fail = [error](const QString& message) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    };
+    static_assert(sizeof(Header) == 48 && sizeof(IndexEntry) == 48, "File layout changed");
+
+    if (size < qint64(sizeof(Header))) {
+        return fail("Файл библиотеки короче заголовка");
+    }
+    const Header* header = reinterpret_cast<const Header*>(data);
+    if (header->magic != MAGIC) {
+        return fail("Это не библиотека движений D1");
+    }
+    if (header->version != VERSION || header->jointCount != MOTION_NUM_JOINTS) {
+        return fail(QString("Неподдерживаемая версия библиотеки: %1").arg(header->version));
+    }
+    if (header->fileSize != quint64(size)) {
+        return fail("Файл библиотеки обрезан");
+    }
+
+    const quint64 indexOffset = sizeof(Header);
+    const quint64 stringsOffset = indexOffset + quint64(header->motionCount) * sizeof(IndexEntry);
+    if (stringsOffset + header->stringsSize > quint64(size)) {
+        return fail("Файл библиотеки обрезан");
+    }
+    if (crc32(data + indexOffset, stringsOffset + header->stringsSize - indexOffset) != header->indexChecksum) {
+        return fail("Повреждён индекс библиотеки (CRC)");
+    }
+
+    // Один проход проверки ссылок: дальше чтение им доверяет
+    const IndexEntry* index = reinterpret_cast<const IndexEntry*>(data + indexOffset);
+    for (quint32 i = 0; i < header->motionCount; ++i) {
+        const IndexEntry& entry = index[i];
+        if (quint64(entry.nameOffset) + entry.nameSize > header->stringsSize
+            || quint64(entry.descriptionOffset) + entry.descriptionSize > header->stringsSize
+            || entry.blockSize != blockSize(entry.keyframeCount)
+            || entry.blockOffset % 16 != 0
+            || entry.blockOffset > quint64(size)
+            || entry.blockSize > quint64(size) - entry.blockOffset) {
+            return fail(QString("Повреждён индекс библиотеки (движение %1)").arg(i + 1));
+        }
+    }
+
+    m_header = header;
+    m_index = index;
+    m_strings = reinterpret_cast<const char*>(data + stringsOffset);
+    m_data = data;
+    return true;
+}
+
+int MotionLibrary::motionCount() const {
+    return m_header ? static_cast<int>(m_header->motionCount) : 0;
+}
+
+QString MotionLibrary::string(quint32 offset, quint32 size) const {
+    return QString::fromUtf8(m_strings + offset, static_cast<int>(size));
+}
+
+Motion MotionLibrary::motionInfo(int index) const {
+    const IndexEntry& entry = m_index[index];
+    Motion motion;
+    motion.name = string(entry.nameOffset, entry.nameSize);
+    motion.description = string(entry.descriptionOffset, entry.descriptionSize);
+    motion.looping = (entry.flags & FLAG_LOOPING) != 0;
+    motion.defaultSpeed = entry.defaultSpeed;
+    return motion;
+}
+
+int MotionLibrary::keyframeCount(int index) const {
+    return static_cast<int>(m_index[index].keyframeCount);
+}
+
+int MotionLibrary::durationMs(int index) const {
+    return static_cast<int>(m_index[index].durationMs);
+}
+
+quint64 MotionLibrary::blockSize(quint32 keyframeCount) {
+    // Углы, transitionMs, blendRadiusDeg — по 4 байта, stop — 1
+    return quint64(keyframeCount) * ((MOTION_NUM_JOINTS + 2) * 4 + 1);
+}
+
+void MotionLibrary::encodeBlock(const QVector<MotionKeyframe>& keyframes, uchar* block) {
+    const int count = keyframes.size();
+    float* angles = reinterpret_cast<float*>(block);
+    qint32* transitions = reinterpret_cast<qint32*>(angles + MOTION_NUM_JOINTS * count);
+    float* blends = reinterpret_cast<float*>(transitions + count);
+    uchar* stops = reinterpret_cast<uchar*>(blends + count);
+    for (int j = 0; j < MOTION_NUM_JOINTS; ++j) {
+        for (int k = 0; k < count; ++k) {
+            angles[j * count + k] = static_cast<float>(keyframes[k].jointAngles[j]);
+        }
+    }
+    for (int k = 0; k < count; ++k) {
+        transitions[k] = keyframes[k].transitionMs;
+        blends[k] = static_cast<float>(keyframes[k].blendRadiusDeg);
+        stops[k] = keyframes[k].stop ? 1 : 0;
+    }
+}
+
+bool MotionLibrary::decodeKeyframes(int index, QVector<MotionKeyframe>& keyframes, QString* error) const {
+    const IndexEntry& entry = m_index[index];
+    const uchar* block = m_data + entry.blockOffset;
+    if (crc32(block, entry.blockSize) != entry.blockChecksum) {
+        if (error) {
+            *error = QString("Повреждены кадры движения '%1' (CRC)").arg(string(entry.nameOffset, entry.nameSize));
+        }
+        return false;
+    }
+
+    const int count = static_cast<int>(entry.keyframeCount);
+    const float* angles = reinterpret_cast<const float*>(block);
+    const qint32* transitions = reinterpret_cast<const qint32*>(angles + MOTION_NUM_JOINTS * count);
+    const float* blends = reinterpret_cast<const float*>(transitions + count);
+    const uchar* stops = reinterpret_cast<const uchar*>(blends + count);
+    keyframes.resize(count);
+    for (int k = 0; k < count; ++k) {
+        MotionKeyframe& kf = keyframes[k];
+        for (int j = 0; j < MOTION_NUM_JOINTS; ++j) {
+            kf.jointAngles[j] = angles[j * count + k];
+        }
+        kf.transitionMs = transitions[k];
+        kf.blendRadiusDeg = blends[k];
+        kf.stop = stops[k] != 0;
+    }
+    return true;
+}
+
+bool MotionLibrary::encode(const QVector<Source>& motions, QByteArray& file, QString* error) {
+    auto fail = [error](const QString& message) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    };
+    const int count = motions.size();
+    QVector<IndexEntry> entries(count);
+    QByteArray strings;
+    auto addString = [&strings](const QString& text, quint32& offset, quint32& size) {
+        const QByteArray utf8 = text.toUtf8();
+        offset = static_cast<quint32>(strings.size());
+        size = static_cast<quint32>(utf8.size());
+        strings.append(utf8);
+    };
+
+    const quint64 stringsOffset = sizeof(Header) + quint64(count) * sizeof(IndexEntry);
+    for (int i = 0; i < count; ++i) {
+        const Source& source = motions[i];
+        IndexEntry& entry = entries[i];
+        std::memset(&entry, 0, sizeof(entry));
+        addString(source.motion->name, entry.nameOffset, entry.nameSize);
+        addString(source.motion->description, entry.descriptionOffset, entry.descriptionSize);
+        entry.flags = source.motion->looping ? FLAG_LOOPING : 0;
+        entry.defaultSpeed = source.motion->defaultSpeed;
+        if (source.library) {
+            entry.keyframeCount = static_cast<quint32>(source.library->keyframeCount(source.block));
+            entry.durationMs = static_cast<quint32>(source.library->durationMs(source.block));
+        } else {
+            entry.keyframeCount = static_cast<quint32>(source.motion->keyframeCount());
+            entry.durationMs = static_cast<quint32>(source.motion->totalDurationMs());
+        }
+        const quint64 size = blockSize(entry.keyframeCount);
+        if (size > UINT_MAX) {
+            return fail(QString("Движение '%1' слишком длинное для библиотеки").arg(source.motion->name));
+        }
+        entry.blockSize = static_cast<quint32>(size);
+    }
+    quint64 offset = alignedSize(stringsOffset + strings.size());
+    for (IndexEntry& entry : entries) {
+        entry.blockOffset = offset;
+        offset = alignedSize(offset + entry.blockSize);
+    }
+    // Файл собирается в QByteArray: размер — int
+    if (offset > INT_MAX) {
+        return fail("Библиотека движений больше 2 ГБ");
+    }
+
+    file = QByteArray(static_cast<int>(offset), '\0');
+    uchar* data = reinterpret_cast<uchar*>(file.data());
+    for (int i = 0; i < count; ++i) {
+        const Source& source = motions[i];
+        IndexEntry& entry = entries[i];
+        uchar* block = data + entry.blockOffset;
+        if (source.library) {
+            // Непрочитанный блок — как есть, вместе с его CRC
+            const IndexEntry& original = source.library->m_index[source.block];
+            std::memcpy(block, source.library->m_data + original.blockOffset, entry.blockSize);
+            entry.blockChecksum = original.blockChecksum;
+        } else {
+            encodeBlock(source.motion->keyframes, block);
+            entry.blockChecksum = crc32(block, entry.blockSize);
+        }
+    }
+    std::memcpy(data + sizeof(Header), entries.constData(), count * sizeof(IndexEntry));
+    std::memcpy(data + stringsOffset, strings.constData(), strings.size());
+
+    Header* header = reinterpret_cast<Header*>(data);
+    header->magic = MAGIC;
+    header->version = VERSION;
+    header->motionCount = static_cast<quint32>(count);
+    header->jointCount = MOTION_NUM_JOINTS;
+    header->fileSize = offset;
+    header->stringsSize = static_cast<quint32>(strings.size());
+    header->indexChecksum = crc32(data + sizeof(Header), stringsOffset + strings.size() - sizeof(Header));
+    return true;
+}
+
+bool MotionLibrary::writeFile(const QString& path, const QByteArray& file, QString* error) {
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile out(path);
+    if (!out.open(QIODevice::WriteOnly) || out.write(file) != file.size() || !out.commit()) {
+        if (error) {
+            *error = QString("Не удалось записать %1: %2").arg(path, out.errorString());
+        }
+        return false;
+    }
+    return true;
+}
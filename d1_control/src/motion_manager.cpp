@@ -1,6 +1,8 @@
 #include "motion_manager.h"
+#include "motion_library.h"
 #include <QFile>
 #include <QDir>
+#include <QFileInfo>
 #include <QStandardPaths>
 #include <QDebug>
 
@@ -9,6 +11,8 @@
 QJsonObject MotionKeyframe::toJson() const {
     QJsonObject obj;
     obj["transition_ms"] = transitionMs;
+    obj["blend_radius_deg"] = blendRadiusDeg;
+    obj["stop"] = stop;
     
     QJsonArray anglesArray;
     for (double angle : jointAngles) {
@@ -22,6 +26,8 @@ QJsonObject MotionKeyframe::toJson() const {
 MotionKeyframe MotionKeyframe::fromJson(const QJsonObject& obj) {
     MotionKeyframe kf;
     kf.transitionMs = obj["transition_ms"].toInt(500);
+    kf.blendRadiusDeg = qMax(0.0, obj["blend_radius_deg"].toDouble(0.0));
+    kf.stop = obj["stop"].toBool(false);
     
     QJsonArray anglesArray = obj["angles"].toArray();
     for (int i = 0; i < MOTION_NUM_JOINTS && i < anglesArray.size(); ++i) {
@@ -76,13 +82,17 @@ int Motion::totalDurationMs() const {
 
 MotionManager::MotionManager(QObject* parent)
     : QObject(parent)
+    , m_library(new MotionLibrary)
 {
     // Путь по умолчанию
     QString configDir = QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation);
     QDir().mkpath(configDir);
-    m_defaultPath = configDir + "/motions.json";
+    m_defaultPath = configDir + "/motions.d1ml";
+    m_legacyJsonPath = configDir + "/motions.json";
 }
 
+MotionManager::~MotionManager() = default;
+
 bool MotionManager::loadFromFile(const QString& filePath) {
     QFile file(filePath);
     if (!file.open(QIODevice::ReadOnly)) {
@@ -90,9 +100,25 @@ bool MotionManager::loadFromFile(const QString& filePath) {
         return false;
     }
     
-    QByteArray data = file.readAll();
-    file.close();
+    if (MotionLibrary::isLibrary(file.peek(sizeof(quint32)))) {
+        file.close();
+        if (!loadLibrary(filePath)) {
+            return false;
+        }
+    } else {
+        QByteArray data = file.readAll();
+        file.close();
+        if (!loadJson(data)) {
+            return false;
+        }
+    }
     
+    qDebug() << "Загружено" << m_motions.size() << "движений из" << filePath;
+    emit motionsLoaded();
+    return true;
+}
+
+bool MotionManager::loadJson(const QByteArray& data) {
     QJsonDocument doc = QJsonDocument::fromJson(data);
     if (!doc.isObject()) {
         emit errorOccurred("Неверный формат файла движений");
@@ -109,19 +135,49 @@ bool MotionManager::loadFromFile(const QString& filePath) {
             m_motions.append(Motion::fromJson(val.toObject()));
         }
     }
+    m_lazyBlocks.fill(-1, m_motions.size());
+    m_library->close();
+    return true;
+}
+
+bool MotionManager::loadLibrary(const QString& filePath) {
+    // Прежняя библиотека закрывается только после успешного открытия новой
+    std::unique_ptr<MotionLibrary> library(new MotionLibrary);
+    QString error;
+    if (!library->open(filePath, &error)) {
+        emit errorOccurred(error);
+        return false;
+    }
     
-    qDebug() << "Загружено" << m_motions.size() << "движений из" << filePath;
-    emit motionsLoaded();
+    const int count = library->motionCount();
+    m_motions.resize(count);
+    m_lazyBlocks.resize(count);
+    for (int i = 0; i < count; ++i) {
+        m_motions[i] = library->motionInfo(i);
+        m_lazyBlocks[i] = i;
+    }
+    m_library = std::move(library);
     return true;
 }
 
 bool MotionManager::saveToFile(const QString& filePath) {
+    bool ok = filePath.endsWith(".json", Qt::CaseInsensitive) ? saveJson(filePath) : saveLibrary(filePath);
+    if (!ok) {
+        return false;
+    }
+    
+    qDebug() << "Сохранено" << m_motions.size() << "движений в" << filePath;
+    emit motionsSaved();
+    return true;
+}
+
+bool MotionManager::saveJson(const QString& filePath) {
     QJsonObject root;
     
     // Сохранение списка движений
     QJsonArray motionsArray;
-    for (const Motion& motion : m_motions) {
-        motionsArray.append(motion.toJson());
+    for (int i = 0; i < m_motions.size(); ++i) {
+        motionsArray.append(motionAt(i).toJson());
     }
     root["motions"] = motionsArray;
     
@@ -135,12 +191,69 @@ bool MotionManager::saveToFile(const QString& filePath) {
     
     file.write(doc.toJson(QJsonDocument::Indented));
     file.close();
+    return true;
+}
+
+bool MotionManager::saveLibrary(const QString& filePath) {
+    // Непрочитанные движения — блоками из открытой библиотеки
+    QVector<MotionLibrary::Source> sources(m_motions.size());
+    for (int i = 0; i < m_motions.size(); ++i) {
+        sources[i].motion = &m_motions[i];
+        if (m_lazyBlocks[i] >= 0) {
+            sources[i].library = m_library.get();
+            sources[i].block = m_lazyBlocks[i];
+        }
+    }
     
-    qDebug() << "Сохранено" << m_motions.size() << "движений в" << filePath;
-    emit motionsSaved();
+    QString error;
+    QByteArray data;
+    if (!MotionLibrary::encode(sources, data, &error)) {
+        emit errorOccurred(error);
+        return false;
+    }
+
+    // Отображённый файл не заменить (Windows): блоки уже скопированы в data,
+    // библиотека закрывается до записи и открывается снова. В новом файле
+    // движение i — блок i; не записался или не открылся — те же блоки из data
+    const bool replacesLibrary = m_library->isOpen()
+        && QFileInfo(m_library->fileName()).canonicalFilePath() == QFileInfo(filePath).canonicalFilePath();
+    if (replacesLibrary) {
+        m_library->close();
+    }
+    const bool written = MotionLibrary::writeFile(filePath, data, &error);
+    if (replacesLibrary) {
+        if (!written || !m_library->open(filePath)) {
+            m_library->openData(data);
+        }
+        for (int i = 0; i < m_lazyBlocks.size(); ++i) {
+            if (m_lazyBlocks[i] >= 0) {
+                m_lazyBlocks[i] = i;
+            }
+        }
+    }
+    if (!written) {
+        emit errorOccurred(error);
+        return false;
+    }
     return true;
 }
 
+const Motion& MotionManager::motionAt(int index) const {
+    Motion& motion = m_motions[index];
+    if (m_lazyBlocks[index] >= 0) {
+        QString error;
+        if (m_library->decodeKeyframes(m_lazyBlocks[index], motion.keyframes, &error)) {
+            m_lazyBlocks[index] = -1;
+        } else {
+            // Блок остаётся за библиотекой и при сохранении копируется как
+            // есть; движение без кадров воспроизводить и править отказываются
+            motion.keyframes.clear();
+            emit const_cast<MotionManager*>(this)->errorOccurred(error);
+        }
+    }
+    return motion;
+}
+
 void MotionManager::setDefaultPath(const QString& path) {
     m_defaultPath = path;
 }
@@ -153,6 +266,10 @@ bool MotionManager::loadDefault() {
     if (QFile::exists(m_defaultPath)) {
         return loadFromFile(m_defaultPath);
     }
+    // Движения прежних версий: следующее сохранение переведёт их в библиотеку
+    if (QFile::exists(m_legacyJsonPath)) {
+        return loadFromFile(m_legacyJsonPath);
+    }
     return false;
 }
 
@@ -162,6 +279,7 @@ bool MotionManager::saveDefault() {
 
 void MotionManager::addMotion(const Motion& motion) {
     m_motions.append(motion);
+    m_lazyBlocks.append(-1);
     int index = m_motions.size() - 1;
     emit motionAdded(index, motion);
 }
@@ -169,6 +287,7 @@ void MotionManager::addMotion(const Motion& motion) {
 void MotionManager::updateMotion(int index, const Motion& motion) {
     if (index >= 0 && index < m_motions.size()) {
         m_motions[index] = motion;
+        m_lazyBlocks[index] = -1;
         emit motionUpdated(index, motion);
     }
 }
@@ -176,6 +295,7 @@ void MotionManager::updateMotion(int index, const Motion& motion) {
 void MotionManager::removeMotion(int index) {
     if (index >= 0 && index < m_motions.size()) {
         m_motions.removeAt(index);
+        m_lazyBlocks.removeAt(index);
         emit motionRemoved(index);
     }
 }
@@ -183,22 +303,21 @@ void MotionManager::removeMotion(int index) {
 void MotionManager::renameMotion(int index, const QString& newName) {
     if (index >= 0 && index < m_motions.size()) {
         m_motions[index].name = newName;
-        emit motionUpdated(index, m_motions[index]);
+        emit motionUpdated(index, motionAt(index));
     }
 }
 
 Motion MotionManager::getMotion(int index) const {
     if (index >= 0 && index < m_motions.size()) {
-        return m_motions[index];
+        return motionAt(index);
     }
     return Motion();
 }
 
 Motion MotionManager::getMotionByName(const QString& name) const {
-    for (const Motion& motion : m_motions) {
-        if (motion.name == name) {
-            return motion;
-        }
+    int index = findMotionIndex(name);
+    if (index >= 0) {
+        return motionAt(index);
     }
     return Motion();
 }
@@ -208,9 +327,30 @@ int MotionManager::getMotionCount() const {
 }
 
 QVector<Motion> MotionManager::getAllMotions() const {
+    for (int i = 0; i < m_motions.size(); ++i) {
+        motionAt(i);
+    }
     return m_motions;
 }
 
+QVector<MotionSummary> MotionManager::getSummaries() const {
+    QVector<MotionSummary> summaries(m_motions.size());
+    for (int i = 0; i < m_motions.size(); ++i) {
+        const Motion& motion = m_motions[i];
+        MotionSummary& summary = summaries[i];
+        summary.name = motion.name;
+        summary.looping = motion.looping;
+        if (m_lazyBlocks[i] >= 0) {
+            summary.keyframeCount = m_library->keyframeCount(m_lazyBlocks[i]);
+            summary.durationMs = m_library->durationMs(m_lazyBlocks[i]);
+        } else {
+            summary.keyframeCount = motion.keyframeCount();
+            summary.durationMs = motion.totalDurationMs();
+        }
+    }
+    return summaries;
+}
+
 QStringList MotionManager::getMotionNames() const {
     QStringList names;
     for (const Motion& motion : m_motions) {
@@ -1,6 +1,11 @@
 #include "motion_player.h"
 #include <QDebug>
 #include <cmath>
+#include "async_log.h"
+
+namespace {
+const int LOG_PLAY = d1::log::category("PLAY");
+}
 
 MotionPlayer::MotionPlayer(ArmController* armController, QObject* parent)
     : QObject(parent)
@@ -9,6 +14,13 @@ MotionPlayer::MotionPlayer(ArmController* armController, QObject* parent)
     m_playTimer = new QTimer(this);
     m_playTimer->setSingleShot(true);
     connect(m_playTimer, &QTimer::timeout, this, &MotionPlayer::onTimerTick);
+    
+    m_streamTimer = new QTimer(this);
+    m_streamTimer->setInterval(STREAM_PROGRESS_MS);
+    connect(m_streamTimer, &QTimer::timeout, this, &MotionPlayer::onStreamProgress);
+    connect(m_armController, &ArmController::trajectoryFinished, this, &MotionPlayer::onTrajectoryFinished);
+    connect(m_armController, &ArmController::targetReached, this, &MotionPlayer::onTargetReached);
+    connect(m_armController, &ArmController::targetFailed, this, &MotionPlayer::onTargetFailed);
 }
 
 void MotionPlayer::play(const Motion& motion) {
@@ -27,6 +39,12 @@ void MotionPlayer::play(const Motion& motion) {
         stop();
     }
     
+    // Потоковый режим проверяет саму траекторию (startStreamed), покадровый —
+    // ломаную через кадры: рука идёт к каждому кадру отдельной командой
+    if (!m_streamingEnabled && !isKeyframePathFree(motion)) {
+        return;
+    }
+    
     m_currentMotion = motion;
     m_currentKeyframe = 0;
     m_loopCount = 0;
@@ -39,6 +57,18 @@ void MotionPlayer::play(const Motion& motion) {
     
     emit started(motion.name);
     
+    // Весь цикл одной траекторией, без остановок на кадрах
+    if (m_streamingEnabled) {
+        if (startStreamed(0) != StreamStart::Unavailable) {
+            return;
+        }
+        // Исполнитель недоступен — покадрово, путь проверяется как ломаная
+        if (!isKeyframePathFree(motion)) {
+            stop();
+            return;
+        }
+    }
+    
     // Запускаем первый кадр с плавным переходом
     // (как при loop — вычисляем время по угловому расстоянию)
     executeKeyframeSmooth(0, true);
@@ -46,12 +76,16 @@ void MotionPlayer::play(const Motion& motion) {
 
 void MotionPlayer::stop() {
     m_playTimer->stop();
+    cancelAwait();
+    m_streamTimer->stop();
+    m_streaming = false;
+    m_trajectoryId = 0;
     m_isPlaying = false;
     m_isPaused = false;
     m_currentKeyframe = 0;
     m_loopCount = 0;
     
-    // Отменяем все запланированные команды на контроллере
+    // Отменяем все запланированные команды и траекторию на контроллере
     m_armController->cancelAllPendingCommands();
     
     qDebug() << "Воспроизведение остановлено";
@@ -61,6 +95,12 @@ void MotionPlayer::stop() {
 void MotionPlayer::pause() {
     if (m_isPlaying && !m_isPaused) {
         m_playTimer->stop();
+        cancelAwait();
+        if (m_streaming) {
+            // Рука доходит до последней уставки (не дальше lookahead) и стоит
+            m_streamTimer->stop();
+            m_armController->stopTrajectory();
+        }
         m_isPaused = true;
         qDebug() << "Воспроизведение на паузе";
         emit paused();
@@ -74,6 +114,10 @@ void MotionPlayer::resume() {
         emit resumed();
         
         // Продолжаем с текущего кадра
+        if (m_streaming && startStreamed(m_currentKeyframe) != StreamStart::Unavailable) {
+            return;
+        }
+        m_streaming = false;
         executeKeyframe(m_currentKeyframe);
     }
 }
@@ -83,29 +127,49 @@ void MotionPlayer::setSpeed(int percent) {
     qDebug() << "Скорость воспроизведения:" << m_speed << "%";
 }
 
-void MotionPlayer::onTimerTick() {
-    if (!m_isPlaying || m_isPaused) {
-        return;
-    }
-    
+void MotionPlayer::setStreamingEnabled(bool enabled) {
+    m_streamingEnabled = enabled;
+    qDebug() << "Потоковое воспроизведение:" << (enabled ? "включено" : "выключено");
+}
+
+void MotionPlayer::setLimitTimingEnabled(bool enabled) {
+    m_limitTiming = enabled;
+    qDebug() << "Переходы по пределам суставов:" << (enabled ? "включены" : "выключены");
+}
+
+bool MotionPlayer::checkArmReady() {
     // ПРОВЕРКА АВАРИЙНОЙ ОСТАНОВКИ
     if (m_armController->isEmergencyStopped()) {
         emit errorOccurred("Аварийная остановка - воспроизведение прекращено");
         stop();
-        return;
+        return false;
     }
     
+    // Подключение и ошибки — из одного снимка статуса
+    ArmStatus status = m_armController->getStatus();
+    
     // Проверяем подключение
-    if (!m_armController->isConnected()) {
+    if (!status.isConnected) {
         emit errorOccurred("Робот отключился во время воспроизведения");
         stop();
-        return;
+        return false;
     }
     
     // Проверяем ошибки
-    if (m_armController->hasError()) {
+    if (status.errorStatus != 0) {
         emit errorOccurred("Ошибка робота во время воспроизведения");
         stop();
+        return false;
+    }
+    return true;
+}
+
+void MotionPlayer::onTimerTick() {
+    if (!m_isPlaying || m_isPaused) {
+        return;
+    }
+    
+    if (!checkArmReady()) {
         return;
     }
     
@@ -120,7 +184,7 @@ void MotionPlayer::onTimerTick() {
         if (m_currentMotion.looping) {
             // Начинаем сначала
             m_currentKeyframe = 0;
-            qDebug() << "Цикл" << m_loopCount << "завершён, начинаем заново";
+            D1_LOG_INFO(LOG_PLAY, "Цикл %d завершён, начинаем заново", m_loopCount);
             
             // ВАЖНО: Плавный переход к начальной позиции
             // Вычисляем расстояние до первого кадра и используем адекватное время
@@ -156,19 +220,69 @@ void MotionPlayer::executeKeyframe(int index) {
     // speed 50%  = в 2 раза медленнее (двойное время)
     int transitionMs = adjustedTransitionTime(kf.transitionMs);
     
-    // Минимум 300мс для плавности
+    // Минимум 300мс для плавности; в режиме пределов — время перехода от
+    // предыдущего кадра по пределам суставов (retime)
     transitionMs = qMax(300, transitionMs);
+    if (m_limitTiming && index > 0) {
+        transitionMs = transitionTimeMs(m_currentMotion.keyframes[index - 1].jointAngles, kf.jointAngles, true,
+                                        transitionMs);
+    }
     
-    qDebug() << "Кадр" << index << "/" << m_currentMotion.keyframeCount() 
-             << "записанное время:" << kf.transitionMs << "мс"
-             << "с учётом скорости:" << transitionMs << "мс";
+    D1_LOG_INFO(LOG_PLAY, "Кадр %d/%d записанное время: %d мс, с учётом скорости: %d мс",
+                index, m_currentMotion.keyframeCount(), kf.transitionMs, transitionMs);
     
     // Отправляем углы напрямую — робот сам сделает плавное движение
     m_armController->setAllJointAngles(kf.jointAngles, transitionMs);
     
-    // Планируем следующий кадр через время перехода + небольшой буфер
-    int nextTimerMs = transitionMs + 100;
-    m_playTimer->start(nextTimerMs);
+    // Следующий кадр — по приходу руки, а не через время перехода + буфер
+    awaitKeyframe(kf, transitionMs);
+}
+
+void MotionPlayer::awaitKeyframe(const MotionKeyframe& keyframe, int transitionMs) {
+    cancelAwait();
+    
+    // Между кадрами рука не должна стоять: достаточно войти в допуск, а у
+    // кадра со скруглением — в его радиус. Кадр с остановкой — дождаться её.
+    ConvergenceOptions options;
+    if (!keyframe.stop) {
+        options.toleranceDeg = qMax(ARRIVAL_TOLERANCE_DEG, keyframe.blendRadiusDeg);
+        options.settleMs = 0;
+    }
+    m_targetHandle = m_armController->awaitTarget(keyframe.jointAngles, transitionMs, options);
+    if (m_targetHandle == 0) {
+        m_playTimer->start(transitionMs + 100);  // Ждать не по чему — по времени, как раньше
+    }
+}
+
+void MotionPlayer::cancelAwait() {
+    if (m_targetHandle != 0) {
+        m_armController->cancelTarget(m_targetHandle);
+        m_targetHandle = 0;
+    }
+}
+
+void MotionPlayer::onTargetReached(quint64 handle, int elapsedMs) {
+    if (handle == 0 || handle != m_targetHandle) {
+        return;
+    }
+    m_targetHandle = 0;
+    D1_LOG_INFO(LOG_PLAY, "Кадр %d достигнут за %d мс", m_currentKeyframe, elapsedMs);
+    onTimerTick();
+}
+
+void MotionPlayer::onTargetFailed(quint64 handle, bool timedOut, const QString& reason) {
+    if (handle == 0 || handle != m_targetHandle) {
+        return;
+    }
+    m_targetHandle = 0;
+    if (!timedOut) {
+        emit errorOccurred(QString("Воспроизведение прервано: %1").arg(reason));
+        stop();
+        return;
+    }
+    // Рука не дошла до допуска (нагрузка, упор) — идём дальше, а не копим команды
+    D1_LOG_WARN(LOG_PLAY, "Кадр %d: %s, переходим к следующему", m_currentKeyframe, qPrintable(reason));
+    onTimerTick();
 }
 
 int MotionPlayer::adjustedTransitionTime(int originalMs) const {
@@ -184,19 +298,34 @@ int MotionPlayer::adjustedTransitionTime(int originalMs) const {
 }
 
 int MotionPlayer::calculateTransitionTime(int targetIndex) const {
-    // Вычисляем время перехода на основе максимального углового расстояния
     if (targetIndex < 0 || targetIndex >= m_currentMotion.keyframeCount()) {
         return 1000;  // Дефолт 1 секунда
     }
     
-    const MotionKeyframe& targetKf = m_currentMotion.keyframes[targetIndex];
     ArmState currentState = m_armController->getState();
+    JointVector current;
+    for (int i = 0; i < MOTION_NUM_JOINTS; ++i) {
+        current[i] = currentState.joints[i].angle;
+    }
+    const MotionKeyframe& target = m_currentMotion.keyframes[targetIndex];
+    return transitionTimeMs(current, target.jointAngles, m_limitTiming, adjustedTransitionTime(target.transitionMs));
+}
+
+int MotionPlayer::transitionTimeMs(const JointVector& from, const JointVector& to, bool limitTiming,
+                                   int recordedMs) const {
+    if (limitTiming) {
+        // Переход с остановкой на концах, уложенный в пределы суставов; без
+        // движения retime() оставляет записанное время
+        JointTrajectory move = JointTrajectory::pointToPoint(from, to, recordedMs / 1000.0);
+        move.retime(effectiveLimits());
+        return static_cast<int>(std::ceil(move.durationSec() * 1000.0));
+    }
     
-    // Находим максимальную дельту угла среди всех суставов
+    // Вычисляем время перехода на основе максимального углового расстояния
     double maxDelta = 0.0;
     for (int i = 0; i < MOTION_NUM_JOINTS; ++i) {
         if (i == 6) continue;  // Пропускаем грипер
-        double delta = std::abs(targetKf.jointAngles[i] - currentState.joints[i].angle);
+        double delta = std::abs(to[i] - from[i]);
         if (delta > maxDelta) {
             maxDelta = delta;
         }
@@ -213,6 +342,10 @@ int MotionPlayer::calculateTransitionTime(int targetIndex) const {
     return adjustedTransitionTime(timeMs);
 }
 
+MotionLimits MotionPlayer::effectiveLimits() const {
+    return m_limits.scaled(qMin(m_speed, 100) / 100.0);
+}
+
 void MotionPlayer::executeKeyframeSmooth(int index, bool isLoopTransition) {
     if (index < 0 || index >= m_currentMotion.keyframeCount()) {
         return;
@@ -227,15 +360,14 @@ void MotionPlayer::executeKeyframeSmooth(int index, bool isLoopTransition) {
     int transitionMs;
     if (isLoopTransition) {
         transitionMs = calculateTransitionTime(index);
-        qDebug() << "LOOP-переход к кадру 0, вычисленное время:" << transitionMs << "мс";
+        D1_LOG_INFO(LOG_PLAY, "LOOP-переход к кадру 0, вычисленное время: %d мс", transitionMs);
     } else {
         transitionMs = adjustedTransitionTime(kf.transitionMs);
         transitionMs = qMax(300, transitionMs);
     }
     
-    qDebug() << "Кадр" << index << "/" << m_currentMotion.keyframeCount() 
-             << "время перехода:" << transitionMs << "мс"
-             << (isLoopTransition ? "(ПЛАВНЫЙ LOOP)" : "");
+    D1_LOG_INFO(LOG_PLAY, "Кадр %d/%d время перехода: %d мс%s", index, m_currentMotion.keyframeCount(),
+                transitionMs, isLoopTransition ? " (ПЛАВНЫЙ LOOP)" : "");
     
     // Используем встроенную интерполяцию робота (одна команда с длительностью)
     // Это обеспечивает более плавное движение, чем ручная отправка координат
@@ -248,7 +380,283 @@ void MotionPlayer::executeKeyframeSmooth(int index, bool isLoopTransition) {
         m_armController->setAllJointAngles(kf.jointAngles, transitionMs);
     }
     
-    // Планируем следующий кадр с увеличенным запасом
-    int nextTimerMs = transitionMs + 150; 
-    m_playTimer->start(nextTimerMs);
+    awaitKeyframe(kf, transitionMs);
+}
+
+bool MotionPlayer::isKeyframePathFree(const Motion& motion) {
+    // Весь путь до запуска: от текущей позы через все кадры (и обратно к
+    // первому при цикле); отрезки проверяются параллельно
+    const CollisionChecker& collision = m_armController->collision();
+    if (!collision.isActive()) {
+        return true;
+    }
+    ArmState state = m_armController->getState();
+    std::vector<JointVector> path;
+    path.reserve(motion.keyframeCount() + 2);
+    JointVector current;
+    for (int j = 0; j < NUM_JOINTS; ++j) {
+        current[j] = state.joints[j].angle;
+    }
+    // Рука уже в касании (стоит на столе и т. п.) — выход из него не проверить
+    const bool fromCurrent = collision.isPoseFree(current);
+    if (fromCurrent) {
+        path.push_back(current);
+    }
+    for (const MotionKeyframe& keyframe : motion.keyframes) {
+        path.push_back(keyframe.jointAngles);
+    }
+    if (motion.looping && motion.keyframeCount() > 1) {
+        path.push_back(motion.keyframes.first().jointAngles);
+    }
+    CollisionReport report;
+    if (!collision.isPathFree(path, &report)) {
+        const int segment = report.segment + (fromCurrent ? 0 : 1);
+        QString where = segment == 0
+            ? QString("на пути к кадру 1")
+            : QString("между кадрами %1 и %2").arg(segment)
+                  .arg(segment % motion.keyframeCount() + 1);
+        emit errorOccurred(QString("Столкновение %1: %2").arg(where, collision.describe(report)));
+        return false;
+    }
+    return true;
+}
+
+bool MotionPlayer::isTrajectoryFree(const JointTrajectory& trajectory, const std::vector<int>& keyframeSeq) {
+    // Проверяется то, что будет исполнено: сплайн со скруглёнными углами,
+    // выборки с шагом уставок (между ними рука идёт по прямой в суставах)
+    const CollisionChecker& collision = m_armController->collision();
+    if (!collision.isActive()) {
+        return true;
+    }
+    const double durationSec = trajectory.durationSec();
+    std::vector<JointVector> path;
+    path.reserve(static_cast<size_t>(durationSec / COLLISION_SAMPLE_SEC) + 2);
+    for (int i = 0; i * COLLISION_SAMPLE_SEC < durationSec; ++i) {
+        path.push_back(trajectory.sample(i * COLLISION_SAMPLE_SEC));
+    }
+    path.push_back(trajectory.sample(durationSec));
+    // Рука уже в касании (стоит на столе и т. п.) — выход из него не проверить:
+    // проверка начинается с первой свободной позы, как в покадровом режиме
+    size_t first = 0;
+    while (first < path.size() && !collision.isPoseFree(path[first])) {
+        ++first;
+    }
+    path.erase(path.begin(), path.begin() + first);
+    
+    CollisionReport report;
+    if (collision.isPathFree(path, &report)) {
+        return true;
+    }
+    const int sample = report.segment + static_cast<int>(first);
+    const int waypoint = trajectory.segmentAt(sample * COLLISION_SAMPLE_SEC) + 1;
+    const int count = m_currentMotion.keyframeCount();
+    const int keyframe = waypoint < static_cast<int>(keyframeSeq.size()) ? keyframeSeq[waypoint] % count : 0;
+    emit errorOccurred(QString("Столкновение на пути к кадру %1 (%2 с): %3")
+                           .arg(keyframe + 1)
+                           .arg(sample * COLLISION_SAMPLE_SEC, 0, 'f', 2)
+                           .arg(collision.describe(report)));
+    return false;
+}
+
+MotionPlayer::StreamStart MotionPlayer::startStreamed(int fromKeyframe) {
+    const int count = m_currentMotion.keyframeCount();
+    if (fromKeyframe < 0 || fromKeyframe >= count) {
+        return StreamStart::Unavailable;
+    }
+    
+    // Первый отрезок — от текущего положения, время по угловому расстоянию
+    // (как при LOOP-переходе); дальше — записанные времена с учётом скорости
+    ArmState state = m_armController->getState();
+    JointVector current;
+    for (int i = 0; i < NUM_JOINTS; ++i) {
+        current[i] = state.joints[i].angle;
+    }
+    
+    // Цикл повторяется без остановки на стыке: несколько циклов одной траекторией
+    std::vector<int> keyframeSeq;
+    JointTrajectory trajectory = buildTrajectory(m_currentMotion, current, fromKeyframe, m_limitTiming, 1, &keyframeSeq);
+    int cycles = 1;
+    if (m_currentMotion.looping && count > 1) {
+        const double cycleSec = buildTrajectory(m_currentMotion, m_currentMotion.keyframes.last().jointAngles,
+                                                0, m_limitTiming).durationSec();
+        cycles = qBound(2, static_cast<int>(LOOP_BATCH_SEC / qMax(cycleSec, 0.1)), MAX_LOOP_BATCH);
+        trajectory = buildTrajectory(m_currentMotion, current, fromKeyframe, m_limitTiming, cycles, &keyframeSeq);
+    }
+    const double timeSec = trajectory.durationSec();
+    
+    if (!isTrajectoryFree(trajectory, keyframeSeq)) {
+        stop();
+        return StreamStart::Blocked;
+    }
+    
+    quint64 trajectoryId = m_armController->executeTrajectory(trajectory);
+    if (trajectoryId == 0) {
+        return StreamStart::Unavailable;
+    }
+    
+    m_trajectory = trajectory;
+    m_trajectoryId = trajectoryId;
+    m_streaming = true;
+    m_waypointKeyframes = keyframeSeq;
+    m_streamCycle = 0;
+    m_currentKeyframe = fromKeyframe;
+    
+    D1_LOG_INFO(LOG_PLAY, "Траектория: кадры %d..%d, циклов %d, %d точек, %.2f с", fromKeyframe, count - 1,
+                cycles, trajectory.waypointCount(), timeSec);
+    emit keyframeChanged(fromKeyframe, count);
+    emit progressChanged((fromKeyframe * 100) / count);
+    m_streamTimer->start();
+    return StreamStart::Started;
+}
+
+JointTrajectory MotionPlayer::buildTrajectory(const Motion& motion, const JointVector& from, int fromKeyframe,
+                                             bool limitTiming, int cycles, std::vector<int>* keyframeSeq) const {
+    // Кадры подряд: до конца первого цикла, затем полные циклы. Время до кадра —
+    // записанное, а к первому кадру цикла — по угловому расстоянию (как LOOP)
+    struct Point {
+        JointVector angles;
+        double timeSec;
+        double blendRadiusDeg;
+        bool stop;
+        int seq;
+    };
+    const int count = motion.keyframeCount();
+    std::vector<Point> points;
+    points.push_back({from, 0.0, 0.0, false, -1});
+    for (int cycle = 0; cycle < cycles; ++cycle) {
+        for (int k = (cycle == 0 ? fromKeyframe : 0); k < count; ++k) {
+            const MotionKeyframe& kf = motion.keyframes[k];
+            const double stepSec = points.size() == 1 || k == 0
+                ? transitionTimeMs(points.back().angles, kf.jointAngles, false) / 1000.0
+                : adjustedTransitionTime(kf.transitionMs) / 1000.0;
+            points.push_back({kf.jointAngles, points.back().timeSec + stepSec, kf.blendRadiusDeg, kf.stop,
+                              cycle * count + k});
+        }
+    }
+    
+    // Скругление заменяет кадр точками входа и выхода; время — по доле отрезка
+    JointTrajectory trajectory;
+    if (keyframeSeq) {
+        keyframeSeq->clear();
+    }
+    auto add = [&](double timeSec, const JointVector& angles, bool stop, int seq) {
+        trajectory.addWaypoint(timeSec, angles, stop);
+        if (keyframeSeq) {
+            keyframeSeq->push_back(seq);
+        }
+    };
+    const int last = static_cast<int>(points.size()) - 1;
+    for (int i = 0; i <= last; ++i) {
+        const Point& p = points[i];
+        if (i > 0 && i < last && !p.stop && p.blendRadiusDeg > 0.0) {
+            JointVector entry, exit;
+            double entryFraction = 0.0;
+            double exitFraction = 0.0;
+            JointTrajectory::blendCorner(points[i - 1].angles, p.angles, points[i + 1].angles, p.blendRadiusDeg,
+                                         entry, exit, entryFraction, exitFraction);
+            if (entryFraction > 0.0 && exitFraction > 0.0) {
+                add(p.timeSec - (p.timeSec - points[i - 1].timeSec) * entryFraction, entry, false, p.seq);
+                add(p.timeSec + (points[i + 1].timeSec - p.timeSec) * exitFraction, exit, false, p.seq);
+                continue;
+            }
+        }
+        add(p.timeSec, p.angles, p.stop, p.seq);
+    }
+    
+    // Записанные времена — только порядок точек и длительность выдержек на
+    // месте: остальным отрезкам retime() назначает свои
+    if (limitTiming) {
+        trajectory.retime(effectiveLimits());
+    } else {
+        trajectory.finalize();
+    }
+    return trajectory;
+}
+
+QString MotionPlayer::durationReport(const QVector<Motion>& motions) const {
+    // Цикл: для циклического движения — от последнего кадра через все кадры
+    // (как идёт повтор), для одноразового — от первого кадра
+    QString report = QString("Скорость воспроизведения %1%\n\n").arg(m_speed);
+    double recordedTotal = 0.0;
+    double optimalTotal = 0.0;
+    for (const Motion& motion : motions) {
+        if (motion.isEmpty()) {
+            continue;
+        }
+        const JointVector& start = motion.looping ? motion.keyframes.last().jointAngles
+                                                  : motion.keyframes.first().jointAngles;
+        const double recorded = buildTrajectory(motion, start, 0, false).durationSec();
+        const double optimal = buildTrajectory(motion, start, 0, true).durationSec();
+        recordedTotal += recorded;
+        optimalTotal += optimal;
+        report += QString("%1: %2 с → %3 с (%4%)\n")
+                      .arg(motion.name)
+                      .arg(recorded, 0, 'f', 2)
+                      .arg(optimal, 0, 'f', 2)
+                      .arg(recorded > 0.0 ? qRound(100.0 * optimal / recorded) : 100);
+    }
+    if (recordedTotal <= 0.0) {
+        return report + "Нет движений с кадрами";
+    }
+    report += QString("\nВсего: %1 с → %2 с (%3%)")
+                  .arg(recordedTotal, 0, 'f', 2)
+                  .arg(optimalTotal, 0, 'f', 2)
+                  .arg(qRound(100.0 * optimalTotal / recordedTotal));
+    return report;
+}
+
+void MotionPlayer::onStreamProgress() {
+    if (!m_isPlaying || m_isPaused || !m_streaming) {
+        return;
+    }
+    
+    if (!checkArmReady()) {
+        return;
+    }
+    
+    // Кадр — тот, к которому ведёт текущий отрезок траектории; переход в
+    // следующий цикл развёрнутой траектории — завершённый цикл
+    const int count = m_currentMotion.keyframeCount();
+    double elapsedSec = m_armController->trajectoryExecutor().elapsedSec();
+    const int target = qMin(m_trajectory.segmentAt(elapsedSec) + 1, static_cast<int>(m_waypointKeyframes.size()) - 1);
+    const int seq = target > 0 ? m_waypointKeyframes[target] : m_currentKeyframe;
+    while (seq / count > m_streamCycle) {
+        ++m_streamCycle;
+        ++m_loopCount;
+        emit loopCompleted(m_loopCount);
+    }
+    int keyframe = seq % count;
+    if (keyframe != m_currentKeyframe) {
+        m_currentKeyframe = keyframe;
+        emit keyframeChanged(keyframe, count);
+        emit progressChanged((keyframe * 100) / count);
+    }
+}
+
+void MotionPlayer::onTrajectoryFinished(quint64 trajectoryId, bool completed, const QString& reason) {
+    if (!m_isPlaying || !m_streaming || trajectoryId != m_trajectoryId) {
+        return;
+    }
+    m_streamTimer->stop();
+    
+    if (!completed) {
+        emit errorOccurred(QString("Траектория прервана: %1").arg(reason));
+        stop();
+        return;
+    }
+    
+    m_loopCount++;
+    emit loopCompleted(m_loopCount);
+    
+    if (!m_currentMotion.looping) {
+        qDebug() << "Воспроизведение завершено (не циклическое)";
+        stop();
+        return;
+    }
+    
+    D1_LOG_INFO(LOG_PLAY, "Цикл %d завершён, начинаем заново", m_loopCount);
+    if (startStreamed(0) == StreamStart::Unavailable) {
+        emit errorOccurred("Не удалось запустить траекторию следующего цикла");
+        stop();
+    }
 }
@@ -36,11 +36,27 @@ void MotionRecorder::startRecording(const QString& name) {
     
     m_isRecording = true;
     m_lastCaptureTime = 0;
+    m_autoCaptured = m_autoCapture;
+    m_lastSimplifyReport = SimplifyReport();
     m_elapsedTimer.start();
     
-    qDebug() << "Начата запись движения:" << m_recordingName;
+    // Кадры — из выборок feedback после остановки; таймер — только статус
+    m_feedbackActive = m_autoCapture && m_feedbackCapture;
+    if (m_feedbackActive) {
+        m_feedback.reserve(static_cast<size_t>(FEEDBACK_MAX_SEC) * FEEDBACK_MAX_RATE_HZ);
+        m_feedbackFullReported = false;
+        m_armController->startFeedbackRecording(&m_feedback);
+    }
+    
+    qDebug() << "Начата запись движения:" << m_recordingName
+             << (m_feedbackActive ? "(по feedback)" : "");
     emit recordingStarted(m_recordingName);
     
+    if (m_feedbackActive) {
+        m_autoCaptureTimer->start(m_autoCaptureInterval);
+        return;
+    }
+    
     // Захватываем первый кадр сразу
     captureKeyframe();
     
@@ -59,14 +75,26 @@ Motion MotionRecorder::stopRecording() {
     m_autoCaptureTimer->stop();
     m_isRecording = false;
     
-    // Захватываем последний кадр
-    captureKeyframe();
+    if (m_feedbackActive) {
+        m_armController->stopFeedbackRecording();
+        m_feedbackActive = false;
+        // Упрощение само выберет нужные кадры — ему все выборки
+        appendFeedbackKeyframes(m_simplify ? 0 : m_autoCaptureInterval);
+    } else {
+        // Захватываем последний кадр
+        captureKeyframe();
+    }
     
     qDebug() << "Запись завершена:" << m_recordingName 
              << "кадров:" << m_currentRecording.keyframeCount()
              << "длительность:" << m_currentRecording.totalDurationMs() << "мс";
     
     Motion result = m_currentRecording;
+    // Кадры, снятые вручную, — выбор оператора; лишние кадры даёт только автозахват
+    if (m_simplify && m_autoCaptured) {
+        result = MotionSimplifier::simplify(m_currentRecording, m_simplifyOptions, &m_lastSimplifyReport);
+        qDebug() << "Запись упрощена:" << MotionSimplifier::describe(m_lastSimplifyReport);
+    }
     emit recordingStopped(result);
     
     return result;
@@ -79,6 +107,10 @@ void MotionRecorder::cancelRecording() {
     
     m_autoCaptureTimer->stop();
     m_isRecording = false;
+    if (m_feedbackActive) {
+        m_armController->stopFeedbackRecording();
+        m_feedbackActive = false;
+    }
     m_currentRecording = Motion();
     
     qDebug() << "Запись отменена";
@@ -86,7 +118,7 @@ void MotionRecorder::cancelRecording() {
 }
 
 void MotionRecorder::captureKeyframe() {
-    if (!m_isRecording) {
+    if (!m_isRecording || m_feedbackActive) {
         return;
     }
     
@@ -127,8 +159,9 @@ void MotionRecorder::setAutoCapture(bool enabled, int intervalMs) {
     m_autoCapture = enabled;
     m_autoCaptureInterval = qMax(50, intervalMs);  // Минимум 50мс
     
-    if (m_isRecording) {
+    if (m_isRecording && !m_feedbackActive) {
         if (enabled) {
+            m_autoCaptured = true;
             m_autoCaptureTimer->start(m_autoCaptureInterval);
         } else {
             m_autoCaptureTimer->stop();
@@ -139,12 +172,66 @@ void MotionRecorder::setAutoCapture(bool enabled, int intervalMs) {
              << "интервал:" << m_autoCaptureInterval << "мс";
 }
 
+void MotionRecorder::setSimplify(bool enabled, const SimplifyOptions& options) {
+    m_simplify = enabled;
+    m_simplifyOptions = options;
+}
+
 void MotionRecorder::onAutoCaptureTimer() {
+    if (m_feedbackActive) {
+        if (!m_armController->isConnected()) {
+            emit errorOccurred("Робот отключился во время записи");
+            cancelRecording();
+            return;
+        }
+        if (m_feedback.isFull() && !m_feedbackFullReported) {
+            m_feedbackFullReported = true;
+            emit errorOccurred(QString("Буфер записи заполнен (%1 выборок) - остановите запись")
+                .arg(m_feedback.capacity()));
+        }
+        emit samplesRecorded(static_cast<int>(m_feedback.size()),
+                             static_cast<int>(m_feedback.durationSec() * 1000.0));
+        return;
+    }
     if (m_isRecording && m_autoCapture) {
         captureKeyframe();
     }
 }
 
+void MotionRecorder::appendFeedbackKeyframes(int intervalMs) {
+    const size_t count = m_feedback.size();
+    qDebug() << "Запись по feedback:" << count << "выборок за" << m_feedback.durationSec() << "с,"
+             << "отброшено" << m_feedback.dropped() << "- метки"
+             << (m_feedback.usesSourceClock() ? "DDS" : "приёма");
+    if (count == 0) {
+        return;
+    }
+    
+    m_currentRecording.keyframes.reserve(static_cast<int>(intervalMs > 0 ? count / 2 + 2 : count));
+    const uint64_t startNs = m_feedback.sample(0).timestampNs;
+    const qint64 stepMs = qMax(1, intervalMs);
+    qint64 lastMs = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const RecordedSample& sample = m_feedback.sample(i);
+        // Время от первой выборки округляется целиком, а не по переходам:
+        // ошибка округления не копится
+        const qint64 timeMs = static_cast<qint64>((sample.timestampNs - startNs + 500000) / 1000000);
+        const bool last = i + 1 == count;
+        if (i > 0 && (timeMs == lastMs || (timeMs - lastMs < stepMs && !last))) {
+            continue;
+        }
+        
+        MotionKeyframe kf;
+        for (int j = 0; j < MOTION_NUM_JOINTS; ++j) {
+            kf.jointAngles[j] = sample.angles[j];
+        }
+        // Первый кадр - минимальное время, как при захвате по таймеру
+        kf.transitionMs = i == 0 ? 100 : static_cast<int>(timeMs - lastMs);
+        m_currentRecording.keyframes.append(kf);
+        lastMs = timeMs;
+    }
+}
+
 int MotionRecorder::getKeyframeCount() const {
     return m_currentRecording.keyframeCount();
 }
@@ -0,0 +1,299 @@
+#include "motion_simplifier.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+#include "joint_trajectory.h"
+
+namespace {
+
+using Angles = std::array<double, MOTION_NUM_JOINTS>;
+
+// Наибольшее по суставам отклонение и сустав, на котором оно достигается
+double deviation(const Angles& actual, const Angles& expected, int* joint = nullptr) {
+    double worst = 0.0;
+    for (int j = 0; j < MOTION_NUM_JOINTS; ++j) {
+        const double d = std::abs(actual[j] - expected[j]);
+        if (d > worst) {
+            worst = d;
+            if (joint) {
+                *joint = j;
+            }
+        }
+    }
+    return worst;
+}
+
+// Исходные кадры на общей шкале времени (после вырезания пауз)
+struct Sample {
+    int source = 0;         // Индекс в исходной записи
+    qint64 timeMs = 0;
+    bool anchor = false;    // Остаётся всегда: концы, края пауз, кадры со stop
+    bool stop = false;
+    bool keep = false;
+};
+
+// Положение упрощённой траектории в момент кадра: линейно между
+// оставленными кадрами или по сплайну воспроизведения
+class Model {
+public:
+    Model(const QVector<MotionKeyframe>& keyframes, const std::vector<Sample>& samples, bool spline)
+        : m_keyframes(keyframes), m_samples(samples), m_spline(spline)
+    {
+        if (!m_spline) {
+            return;
+        }
+        for (const Sample& s : m_samples) {
+            if (s.keep) {
+                m_trajectory.addWaypoint(s.timeMs / 1000.0, m_keyframes[s.source].jointAngles, s.stop);
+            }
+        }
+        m_trajectory.finalize();
+    }
+
+    // Кадр i между оставленными a и b
+    Angles at(int i, int a, int b) const {
+        if (m_spline) {
+            return m_trajectory.sample(m_samples[i].timeMs / 1000.0);
+        }
+        const Angles& qa = m_keyframes[m_samples[a].source].jointAngles;
+        const Angles& qb = m_keyframes[m_samples[b].source].jointAngles;
+        const double span = static_cast<double>(m_samples[b].timeMs - m_samples[a].timeMs);
+        const double u = span > 0.0 ? (m_samples[i].timeMs - m_samples[a].timeMs) / span : 0.0;
+        Angles q;
+        for (int j = 0; j < MOTION_NUM_JOINTS; ++j) {
+            q[j] = qa[j] + u * (qb[j] - qa[j]);
+        }
+        return q;
+    }
+
+private:
+    const QVector<MotionKeyframe>& m_keyframes;
+    const std::vector<Sample>& m_samples;
+    bool m_spline;
+    JointTrajectory m_trajectory;
+};
+
+} // namespace
+
+Motion MotionSimplifier::simplify(const Motion& motion, const SimplifyOptions& options, SimplifyReport* report) {
+    const QVector<MotionKeyframe>& keyframes = motion.keyframes;
+    const int count = keyframes.size();
+    SimplifyReport result;
+    result.inputKeyframes = count;
+    result.inputDurationMs = motion.totalDurationMs();
+
+    std::vector<qint64> times(count);
+    for (int i = 0; i < count; ++i) {
+        times[i] = (i > 0 ? times[i - 1] : 0) + keyframes[i].transitionMs;
+    }
+
+    // 1. Паузы: от кадра a все следующие в пределах допуска до b. Соседние
+    // паузы (следующая начинается там, где кончилась предыдущая) сливаются,
+    // только если и новые кадры, включая край b, в допуске от начала
+    // слитой паузы: иначе медленное движение склеилось бы в одну паузу
+    auto withinIdle = [&](int first, int from, int to) {
+        for (int i = from; i <= to; ++i) {
+            if (deviation(keyframes[i].jointAngles, keyframes[first].jointAngles) > options.idleToleranceDeg) {
+                return false;
+            }
+        }
+        return true;
+    };
+    std::vector<std::pair<int, int>> idle;
+    if (options.removeIdle) {
+        int a = 0;
+        while (a < count - 1) {
+            int b = a;
+            while (b + 1 < count
+                   && deviation(keyframes[b + 1].jointAngles, keyframes[a].jointAngles) <= options.idleToleranceDeg) {
+                ++b;
+            }
+            if (b > a && times[b] - times[a] >= options.idleMinMs) {
+                if (!idle.empty() && idle.back().second == a && withinIdle(idle.back().first, a + 1, b)) {
+                    idle.back().second = b;
+                } else {
+                    idle.emplace_back(a, b);
+                }
+                a = b;
+            } else {
+                ++a;
+            }
+        }
+    }
+
+    std::vector<char> removed(count, 0);
+    std::vector<char> anchor(count, 0);
+    std::vector<char> stop(count, 0);
+    std::vector<qint64> cutAt(count, 0);    // Сколько времени вырезано паузой, кончающейся в кадре
+    for (const std::pair<int, int>& run : idle) {
+        const int a = run.first;
+        const int b = run.second;
+        if (a > 0 && b < count - 1) {
+            // Пауза в середине сжимается, только если её край в допуске от позы,
+            // в которой рука стоит: начало паузы могла вырезать соседняя пауза
+            int held = a;
+            while (held > 0 && removed[held]) {
+                --held;
+            }
+            if (deviation(keyframes[b].jointAngles, keyframes[held].jointAngles) > options.idleToleranceDeg) {
+                continue;
+            }
+        }
+        const qint64 length = times[b] - times[a];
+        qint64 cut = length;
+        if (a == 0 && b == count - 1) {
+            // Запись целиком — пауза: остаётся одна поза
+            std::fill(removed.begin() + 1, removed.end(), 1);
+        } else if (a == 0) {
+            std::fill(removed.begin(), removed.begin() + b, 1);
+        } else if (b == count - 1) {
+            std::fill(removed.begin() + a + 1, removed.end(), 1);
+        } else {
+            const qint64 dwell = std::min<qint64>(options.maxDwellMs, length);
+            cut = length - dwell;
+            std::fill(removed.begin() + a + 1, removed.begin() + b + (dwell > 0 ? 0 : 1), 1);
+            anchor[a] = stop[a] = 1;
+            anchor[b] = stop[b] = dwell > 0 ? 1 : 0;
+        }
+        cutAt[b] += cut;
+        ++result.idleSegments;
+        result.idleRemovedMs += static_cast<int>(cut);
+    }
+
+    std::vector<Sample> samples;
+    samples.reserve(count);
+    qint64 shift = 0;                       // Сколько времени вырезано до кадра
+    for (int i = 0; i < count; ++i) {
+        shift += cutAt[i];
+        if (removed[i]) {
+            continue;
+        }
+        Sample s;
+        s.source = i;
+        s.timeMs = times[i] - shift;
+        s.stop = stop[i] || keyframes[i].stop;
+        s.anchor = anchor[i] || keyframes[i].stop;
+        samples.push_back(s);
+    }
+    if (!samples.empty()) {
+        samples.front().anchor = true;
+        samples.back().anchor = true;
+    }
+    for (Sample& s : samples) {
+        s.keep = s.anchor;
+    }
+
+    // 2. RDP между соседними опорными кадрами, без рекурсии
+    std::vector<std::pair<int, int>> stack;
+    int previousAnchor = 0;
+    for (int i = 1; i < static_cast<int>(samples.size()); ++i) {
+        if (samples[i].anchor) {
+            stack.emplace_back(previousAnchor, i);
+            previousAnchor = i;
+        }
+    }
+    const Model linear(keyframes, samples, false);
+    while (!stack.empty()) {
+        const int a = stack.back().first;
+        const int b = stack.back().second;
+        stack.pop_back();
+        int worst = -1;
+        double worstDeviation = options.toleranceDeg;
+        for (int i = a + 1; i < b; ++i) {
+            const double d = deviation(keyframes[samples[i].source].jointAngles, linear.at(i, a, b));
+            if (d > worstDeviation) {
+                worstDeviation = d;
+                worst = i;
+            }
+        }
+        if (worst >= 0) {
+            samples[worst].keep = true;
+            stack.emplace_back(a, worst);
+            stack.emplace_back(worst, b);
+        }
+    }
+
+    // 3. Проверка по модели воспроизведения; со сплайном — добавление
+    // худшего кадра на каждом отрезке вне допуска. Сплайн через все кадры
+    // проходит через них точно, поэтому цикл конечен.
+    for (;;) {
+        const Model model(keyframes, samples, options.fitSpline);
+        result.maxDeviationDeg = 0.0;
+        result.maxDeviationJoint = -1;
+        result.maxDeviationKeyframe = -1;
+        bool added = false;
+        int a = 0;
+        while (a + 1 < static_cast<int>(samples.size())) {
+            int b = a + 1;
+            while (!samples[b].keep) {
+                ++b;
+            }
+            int worst = -1;
+            double worstDeviation = 0.0;
+            for (int i = a + 1; i < b; ++i) {
+                int joint = -1;
+                const double d = deviation(keyframes[samples[i].source].jointAngles, model.at(i, a, b), &joint);
+                if (d > worstDeviation) {
+                    worstDeviation = d;
+                    worst = i;
+                }
+                if (d > result.maxDeviationDeg) {
+                    result.maxDeviationDeg = d;
+                    result.maxDeviationJoint = joint;
+                    result.maxDeviationKeyframe = samples[i].source;
+                }
+            }
+            if (options.fitSpline && worst >= 0 && worstDeviation > options.toleranceDeg) {
+                samples[worst].keep = true;
+                added = true;
+            }
+            a = b;
+        }
+        if (!added) {
+            break;
+        }
+    }
+
+    Motion simplified = motion;
+    simplified.keyframes.clear();
+    const Sample* previous = nullptr;
+    for (const Sample& s : samples) {
+        if (!s.keep) {
+            continue;
+        }
+        MotionKeyframe kf = keyframes[s.source];
+        kf.stop = s.stop;
+        // Первый кадр — переход из текущей позы, как в исходной записи
+        kf.transitionMs = previous ? static_cast<int>(s.timeMs - previous->timeMs)
+                                   : keyframes.front().transitionMs;
+        simplified.keyframes.append(kf);
+        previous = &s;
+    }
+
+    result.outputKeyframes = simplified.keyframeCount();
+    result.compressionRatio = result.outputKeyframes > 0
+        ? static_cast<double>(result.inputKeyframes) / result.outputKeyframes : 1.0;
+    result.outputDurationMs = simplified.totalDurationMs();
+    if (report) {
+        *report = result;
+    }
+    return simplified;
+}
+
+QString MotionSimplifier::describe(const SimplifyReport& report) {
+    QString text = QString("%1 → %2 кадров (×%3), отклонение %4°")
+        .arg(report.inputKeyframes)
+        .arg(report.outputKeyframes)
+        .arg(report.compressionRatio, 0, 'f', 1)
+        .arg(report.maxDeviationDeg, 0, 'f', 2);
+    if (report.maxDeviationJoint >= 0) {
+        text += QString(" (J%1)").arg(report.maxDeviationJoint + 1);
+    }
+    if (report.idleSegments > 0) {
+        text += QString(", пауз: %1, вырезано %2 с")
+            .arg(report.idleSegments)
+            .arg(report.idleRemovedMs / 1000.0, 0, 'f', 1);
+    }
+    return text;
+}
@@ -81,9 +81,34 @@ void MotionWidget::setupUi() {
     m_captureIntervalSpin->setValue(200);
     m_captureIntervalSpin->setSuffix(" мс");
     autoCaptureLayout->addWidget(m_captureIntervalSpin);
+    
+    m_feedbackCaptureCheck = new QCheckBox("по feedback");
+    m_feedbackCaptureCheck->setChecked(true);
+    m_feedbackCaptureCheck->setToolTip("Записывать каждую выборку feedback с её меткой времени; "
+                                       "кадры строятся после остановки");
+    autoCaptureLayout->addWidget(m_feedbackCaptureCheck);
     autoCaptureLayout->addStretch();
     recordLayout->addLayout(autoCaptureLayout);
     
+    // Упрощение записи автозахвата
+    QHBoxLayout* simplifyLayout = new QHBoxLayout();
+    m_simplifyCheck = new QCheckBox("Упрощать");
+    m_simplifyCheck->setChecked(true);
+    m_simplifyCheck->setToolTip("Убрать лишние кадры и паузы автозахвата, сохранив время движения");
+    simplifyLayout->addWidget(m_simplifyCheck);
+    
+    simplifyLayout->addWidget(new QLabel("допуск"));
+    m_simplifyToleranceSpin = new QDoubleSpinBox();
+    m_simplifyToleranceSpin->setRange(0.1, 10.0);
+    m_simplifyToleranceSpin->setSingleStep(0.1);
+    m_simplifyToleranceSpin->setDecimals(1);
+    m_simplifyToleranceSpin->setValue(1.0);
+    m_simplifyToleranceSpin->setSuffix("°");
+    m_simplifyToleranceSpin->setToolTip("Наибольшее отклонение сустава от записанной траектории");
+    simplifyLayout->addWidget(m_simplifyToleranceSpin);
+    simplifyLayout->addStretch();
+    recordLayout->addLayout(simplifyLayout);
+    
     mainLayout->addWidget(recordGroup);
     
     // ===== Кнопки воспроизведения =====
@@ -157,6 +182,10 @@ void MotionWidget::setupConnections() {
     connect(m_autoCaptureCheck, &QCheckBox::stateChanged, this, &MotionWidget::onAutoCaptureChanged);
     connect(m_captureIntervalSpin, QOverload<int>::of(&QSpinBox::valueChanged), 
             this, &MotionWidget::onCaptureIntervalChanged);
+    connect(m_feedbackCaptureCheck, &QCheckBox::toggled, m_recorder, &MotionRecorder::setFeedbackCapture);
+    connect(m_simplifyCheck, &QCheckBox::stateChanged, this, &MotionWidget::onSimplifyChanged);
+    connect(m_simplifyToleranceSpin, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+            this, &MotionWidget::onSimplifyChanged);
     connect(m_loopingCheck, &QCheckBox::stateChanged, this, &MotionWidget::onLoopingChanged);
     
     // Сигналы от рекордера
@@ -165,6 +194,11 @@ void MotionWidget::setupConnections() {
     connect(m_recorder, &MotionRecorder::keyframeCaptured, this, [this](int count) {
         m_statusLabel->setText(QString("Запись: %1 кадров").arg(count));
     });
+    connect(m_recorder, &MotionRecorder::samplesRecorded, this, [this](int count, int durationMs) {
+        m_statusLabel->setText(QString("Запись: %1 выборок, %2 сек")
+            .arg(count)
+            .arg(durationMs / 1000.0, 0, 'f', 1));
+    });
     connect(m_recorder, &MotionRecorder::errorOccurred, this, &MotionWidget::onMotionError);
     
     // Сигналы от плейера
@@ -178,20 +212,24 @@ void MotionWidget::setupConnections() {
     connect(m_manager, &MotionManager::motionAdded, this, [this](int, const Motion&) { refreshList(); });
     connect(m_manager, &MotionManager::motionRemoved, this, [this](int) { refreshList(); });
     connect(m_manager, &MotionManager::motionsLoaded, this, [this]() { refreshList(); });
+    connect(m_manager, &MotionManager::errorOccurred, this, &MotionWidget::onMotionError);
     
     // Инициализируем настройки рекордера
     m_recorder->setAutoCapture(m_autoCaptureCheck->isChecked(), m_captureIntervalSpin->value());
+    m_recorder->setFeedbackCapture(m_feedbackCaptureCheck->isChecked());
+    onSimplifyChanged();
 }
 
 void MotionWidget::refreshList() {
     m_listWidget->clear();
     
-    QVector<Motion> motions = m_manager->getAllMotions();
-    for (const Motion& motion : motions) {
+    // Сводка из индекса библиотеки: кадры движений здесь не декодируются
+    QVector<MotionSummary> motions = m_manager->getSummaries();
+    for (const MotionSummary& motion : motions) {
         QString text = QString("%1 (%2 кадров, %3 сек)")
             .arg(motion.name)
-            .arg(motion.keyframeCount())
-            .arg(motion.totalDurationMs() / 1000.0, 0, 'f', 1);
+            .arg(motion.keyframeCount)
+            .arg(motion.durationMs / 1000.0, 0, 'f', 1);
         
         QListWidgetItem* item = new QListWidgetItem(text);
         item->setData(Qt::UserRole, motion.name);
@@ -257,6 +295,7 @@ void MotionWidget::onContextMenu(const QPoint& pos) {
             refreshList();
         }
     });
+    menu.addAction("〰 Упростить...", this, &MotionWidget::simplifySelected);
     menu.addAction("🗑 Удалить", this, &MotionWidget::onDeleteClicked);
     
     menu.exec(m_listWidget->mapToGlobal(pos));
@@ -308,13 +347,17 @@ void MotionWidget::onStopRecordClicked() {
     m_manager->addMotion(motion);
     m_manager->saveDefault();
     
-    QMessageBox::information(this, "Запись завершена",
-        QString("Движение '%1' сохранено!\n"
-                "Кадров: %2\n"
-                "Длительность: %3 сек")
+    QString text = QString("Движение '%1' сохранено!\n"
+                           "Кадров: %2\n"
+                           "Длительность: %3 сек")
         .arg(motion.name)
         .arg(motion.keyframeCount())
-        .arg(motion.totalDurationMs() / 1000.0, 0, 'f', 1));
+        .arg(motion.totalDurationMs() / 1000.0, 0, 'f', 1);
+    const SimplifyReport& report = m_recorder->lastSimplifyReport();
+    if (report.inputKeyframes > 0) {
+        text += "\nУпрощено: " + MotionSimplifier::describe(report);
+    }
+    QMessageBox::information(this, "Запись завершена", text);
 }
 
 void MotionWidget::onPlayClicked() {
@@ -378,6 +421,7 @@ void MotionWidget::onSpeedChanged(int value) {
 void MotionWidget::onAutoCaptureChanged(int state) {
     bool enabled = (state == Qt::Checked);
     m_captureIntervalSpin->setEnabled(enabled);
+    m_feedbackCaptureCheck->setEnabled(enabled);
     m_recorder->setAutoCapture(enabled, m_captureIntervalSpin->value());
 }
 
@@ -385,6 +429,47 @@ void MotionWidget::onCaptureIntervalChanged(int value) {
     m_recorder->setAutoCapture(m_autoCaptureCheck->isChecked(), value);
 }
 
+void MotionWidget::onSimplifyChanged() {
+    SimplifyOptions options;
+    options.toleranceDeg = m_simplifyToleranceSpin->value();
+    m_simplifyToleranceSpin->setEnabled(m_simplifyCheck->isChecked());
+    m_recorder->setSimplify(m_simplifyCheck->isChecked(), options);
+}
+
+void MotionWidget::simplifySelected() {
+    int index = getSelectedIndex();
+    if (index < 0) return;
+    
+    Motion motion = m_manager->getMotion(index);
+    if (motion.isEmpty()) {
+        return;  // Кадры не прочитались — менеджер уже сообщил
+    }
+    bool ok;
+    double tolerance = QInputDialog::getDouble(this, "Упрощение",
+        "Допуск, °:", m_simplifyToleranceSpin->value(), 0.1, 10.0, 1, &ok);
+    if (!ok) return;
+    
+    SimplifyOptions options;
+    options.toleranceDeg = tolerance;
+    SimplifyReport report;
+    Motion simplified = MotionSimplifier::simplify(motion, options, &report);
+    if (simplified.keyframeCount() < 2) {
+        QMessageBox::warning(this, "Упрощение",
+            "Движение состоит из одной паузы — упрощение его удалит.");
+        return;
+    }
+    
+    m_manager->updateMotion(index, simplified);
+    m_manager->saveDefault();
+    refreshList();
+    QMessageBox::information(this, "Упрощение",
+        QString("Движение '%1' упрощено:\n%2\nДлительность: %3 → %4 сек")
+        .arg(motion.name)
+        .arg(MotionSimplifier::describe(report))
+        .arg(report.inputDurationMs / 1000.0, 0, 'f', 1)
+        .arg(report.outputDurationMs / 1000.0, 0, 'f', 1));
+}
+
 void MotionWidget::onLoopingChanged(int state) {
     Q_UNUSED(state);
     // Просто сохраняем для следующего воспроизведения
@@ -448,9 +533,11 @@ void MotionWidget::updateButtonStates() {
     // Запись
     m_recordBtn->setEnabled(!isRecording && !isPlaying);
     m_stopRecordBtn->setEnabled(isRecording);
-    m_captureBtn->setEnabled(isRecording);
+    m_captureBtn->setEnabled(isRecording && !m_recorder->isFeedbackRecording());
     m_autoCaptureCheck->setEnabled(!isRecording);
+    m_feedbackCaptureCheck->setEnabled(!isRecording && m_autoCaptureCheck->isChecked());
     m_captureIntervalSpin->setEnabled(!isRecording && m_autoCaptureCheck->isChecked());
+    m_simplifyCheck->setEnabled(!isRecording);
     
     // Воспроизведение
     m_playBtn->setEnabled(!isRecording && !isPlaying && hasSelection);
@@ -0,0 +1,574 @@
+#include "reachability_map.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr quint64 CHUNK_SAMPLES = 65536;
+constexpr int DIRECTION_SHIFT = 5;          // 26 секторов — 5 младших бит ключа
+
+// Направления подхода: все ненулевые векторы {-1, 0, 1}³ — грани, рёбра и
+// вершины куба; соседние отстоят на 35–45°
+struct DirectionTable {
+    std::array<std::array<double, 3>, ReachabilityMap::DIRECTION_BINS> axes;
+
+    DirectionTable() {
+        int n = 0;
+        for (int x = -1; x <= 1; ++x) {
+            for (int y = -1; y <= 1; ++y) {
+                for (int z = -1; z <= 1; ++z) {
+                    if (x == 0 && y == 0 && z == 0) {
+                        continue;
+                    }
+                    const double norm = std::sqrt(double(x * x + y * y + z * z));
+                    axes[n++] = {{x / norm, y / norm, z / norm}};
+                }
+            }
+        }
+    }
+};
+
+const DirectionTable& directions() {
+    static const DirectionTable table;
+    return table;
+}
+
+// Выборка после свёртки: лучшие углы пары воксель/сектор
+struct Sample {
+    quint64 key;                // (воксель << 5) | сектор
+    float manipulability;
+    quint32 count;
+    qint16 centiDeg[KINEMATIC_JOINTS];
+
+    // При равной манипулируемости — меньшие углы: результат не зависит от числа потоков
+    bool betterThan(const Sample& other) const {
+        if (manipulability != other.manipulability) {
+            return manipulability > other.manipulability;
+        }
+        return std::lexicographical_compare(centiDeg, centiDeg + KINEMATIC_JOINTS,
+                                            other.centiDeg, other.centiDeg + KINEMATIC_JOINTS);
+    }
+};
+
+// Сортировка по ключу и слияние одинаковых: одна запись на пару
+void reduce(std::vector<Sample>& samples) {
+    std::sort(samples.begin(), samples.end(), [](const Sample& a, const Sample& b) {
+        return a.key < b.key;
+    });
+    size_t out = 0;
+    for (size_t i = 0; i < samples.size(); ++i) {
+        if (out > 0 && samples[out - 1].key == samples[i].key) {
+            Sample& kept = samples[out - 1];
+            const quint32 count = kept.count + samples[i].count;
+            if (samples[i].betterThan(kept)) {
+                kept = samples[i];
+            }
+            kept.count = count;
+        } else {
+            samples[out++] = samples[i];
+        }
+    }
+    samples.resize(out);
+}
+
+// Манипулируемость по Йошикаве для линейной скорости: sqrt(det(Jv·Jvᵀ)), м³
+double translationalManipulability(const KinematicJacobian& j) {
+    double a[3][3];
+    for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < 3; ++c) {
+            double sum = 0.0;
+            for (int k = 0; k < KINEMATIC_JOINTS; ++k) {
+                sum += j[r][k] * j[c][k];
+            }
+            a[r][c] = sum;
+        }
+    }
+    const double det = a[0][0] * (a[1][1] * a[2][2] - a[1][2] * a[2][1])
+                     - a[0][1] * (a[1][0] * a[2][2] - a[1][2] * a[2][0])
+                     + a[0][2] * (a[1][0] * a[2][1] - a[1][1] * a[2][0]);
+    return det > 0.0 ? std::sqrt(det) : 0.0;
+}
+
+quint64 alignedSize(quint64 bytes) {
+    return (bytes + 15) & ~quint64(15);
+}
+
+} // namespace
+
+ReachabilityMap::~ReachabilityMap() {
+    clear();
+}
+
+QString ReachabilityMap::defaultPath() {
+    QString configDir = QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation);
+    return configDir + "/reachability.d1rm";
+}
+
+void ReachabilityMap::clear() {
+    if (m_mapped) {
+        m_file.unmap(m_mapped);
+        m_mapped = nullptr;
+    }
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+    m_owned.clear();
+    m_header = nullptr;
+    m_index = nullptr;
+    m_cells = nullptr;
+    m_seeds = nullptr;
+}
+
+JointVector ReachabilityMap::probePose(int probe) {
+    // Несимметричные позы: меняются при правке любого origin или оси
+    static const double poses[3][KINEMATIC_JOINTS] = {
+        {0.0, 0.0, 0.0, 0.0, 0.0, 0.0},
+        {30.0, -20.0, 45.0, 60.0, -30.0, 90.0},
+        {-75.0, 40.0, -35.0, -100.0, 50.0, -45.0}
+    };
+    JointVector q{};
+    for (int j = 0; j < KINEMATIC_JOINTS; ++j) {
+        q[j] = poses[probe][j];
+    }
+    return q;
+}
+
+int ReachabilityMap::directionBin(const std::array<double, 3>& axis) {
+    const DirectionTable& table = directions();
+    int best = 0;
+    double bestDot = -2.0;
+    for (int i = 0; i < DIRECTION_BINS; ++i) {
+        const double dot = axis[0] * table.axes[i][0] + axis[1] * table.axes[i][1] + axis[2] * table.axes[i][2];
+        if (dot > bestDot) {
+            bestDot = dot;
+            best = i;
+        }
+    }
+    return best;
+}
+
+bool ReachabilityMap::build(const ArmKinematics& kinematics, const ReachabilityBuildOptions& options,
+                            ReachabilityMap& map, QString* error) {
+    auto fail = [error](const QString& message) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    };
+    if (!kinematics.isLoaded()) {
+        return fail("Нет модели кинематики (URDF)");
+    }
+    if (options.voxelSizeM <= 0.0 || options.samples == 0) {
+        return fail("Неверные параметры построения");
+    }
+
+    // Сетка с запасом: куб с полуребром в сумму длин звеньев (при нулевых
+    // углах — расстояния между началами соседних звеньев) и вынос рабочей точки
+    KinematicFrames zero;
+    kinematics.forward(JointVector{}, zero);
+    double reach = 0.0;
+    for (int j = 0; j < KINEMATIC_JOINTS; ++j) {
+        double sq = 0.0;
+        for (int r = 0; r < 3; ++r) {
+            const double d = zero.links[j + 1].position[r] - zero.links[j].position[r];
+            sq += d * d;
+        }
+        reach += std::sqrt(sq);
+    }
+    const std::array<double, 3>& tcpOffset = kinematics.tcpOffset().position;
+    reach += std::sqrt(tcpOffset[0] * tcpOffset[0] + tcpOffset[1] * tcpOffset[1] + tcpOffset[2] * tcpOffset[2]);
+    reach += options.voxelSizeM;
+
+    const double voxel = options.voxelSizeM;
+    const quint64 side = static_cast<quint64>(std::ceil(2.0 * reach / voxel));
+    if (side * side * side >= (quint64(1) << 32) - 1) {
+        return fail("Слишком мелкий воксель для рабочей зоны");
+    }
+
+    int threadCount = options.threads > 0 ? options.threads : int(std::thread::hardware_concurrency());
+    threadCount = std::max(1, threadCount);
+    const quint64 chunks = (options.samples + CHUNK_SAMPLES - 1) / CHUNK_SAMPLES;
+
+    // Каждый поток берёт блоки выборок по номеру; генератор блока зависит только
+    // от номера и зерна — карта одинакова при любом числе потоков
+    std::atomic<quint64> nextChunk(0);
+    std::vector<std::vector<Sample>> partial(threadCount);
+    auto worker = [&](int thread) {
+        std::vector<Sample>& samples = partial[thread];
+        size_t reduceAt = 1 << 20;
+        KinematicFrames frames;
+        KinematicJacobian jacobian;
+        for (quint64 chunk = nextChunk++; chunk < chunks; chunk = nextChunk++) {
+            std::mt19937_64 random(options.randomSeed * 0x9e3779b97f4a7c15ULL + chunk);
+            std::uniform_real_distribution<double> unit(0.0, 1.0);
+            const quint64 end = std::min(options.samples, (chunk + 1) * CHUNK_SAMPLES);
+            for (quint64 i = chunk * CHUNK_SAMPLES; i < end; ++i) {
+                JointVector q{};
+                Sample sample;
+                for (int j = 0; j < KINEMATIC_JOINTS; ++j) {
+                    const double lower = kinematics.lowerLimitDeg(j);
+                    const double upper = kinematics.upperLimitDeg(j);
+                    sample.centiDeg[j] = static_cast<qint16>(std::lround((lower + (upper - lower) * unit(random)) * 100.0));
+                    q[j] = sample.centiDeg[j] / 100.0;
+                }
+                kinematics.forward(q, frames);
+                kinematics.jacobian(frames, jacobian);
+
+                const RigidTransform& tcp = frames.tcp;
+                quint64 cell[3];
+                for (int r = 0; r < 3; ++r) {
+                    cell[r] = static_cast<quint64>((tcp.position[r] + reach) / voxel);
+                }
+                const std::array<double, 3> approach = {{tcp.rotation[2], tcp.rotation[5], tcp.rotation[8]}};
+                sample.key = (((cell[2] * side + cell[1]) * side + cell[0]) << DIRECTION_SHIFT)
+                           | quint64(directionBin(approach));
+                sample.manipulability = static_cast<float>(translationalManipulability(jacobian));
+                sample.count = 1;
+                samples.push_back(sample);
+            }
+            if (samples.size() >= reduceAt) {
+                reduce(samples);
+                reduceAt = std::max(reduceAt, 2 * samples.size());
+            }
+        }
+        reduce(samples);
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 1; t < threadCount; ++t) {
+        threads.emplace_back(worker, t);
+    }
+    worker(0);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    std::vector<Sample> merged;
+    for (std::vector<Sample>& samples : partial) {
+        merged.insert(merged.end(), samples.begin(), samples.end());
+        std::vector<Sample>().swap(samples);
+    }
+    reduce(merged);
+    if (merged.empty()) {
+        return fail("Ни одна выборка не попала в сетку");
+    }
+
+    // Обрезаем сетку до занятых вокселей
+    quint64 lo[3] = {side, side, side};
+    quint64 hi[3] = {0, 0, 0};
+    for (const Sample& sample : merged) {
+        quint64 index = sample.key >> DIRECTION_SHIFT;
+        const quint64 cell[3] = {index % side, (index / side) % side, index / (side * side)};
+        for (int r = 0; r < 3; ++r) {
+            lo[r] = std::min(lo[r], cell[r]);
+            hi[r] = std::max(hi[r], cell[r]);
+        }
+    }
+    quint32 dims[3];
+    for (int r = 0; r < 3; ++r) {
+        dims[r] = static_cast<quint32>(hi[r] - lo[r] + 1);
+    }
+    const quint64 voxelTotal = quint64(dims[0]) * dims[1] * dims[2];
+
+    quint32 cellCount = 1;
+    for (size_t i = 1; i < merged.size(); ++i) {
+        if ((merged[i].key >> DIRECTION_SHIFT) != (merged[i - 1].key >> DIRECTION_SHIFT)) {
+            ++cellCount;
+        }
+    }
+    const quint32 seedCount = static_cast<quint32>(merged.size());
+
+    const quint64 indexOffset = alignedSize(sizeof(Header));
+    const quint64 cellsOffset = indexOffset + alignedSize(voxelTotal * sizeof(quint32));
+    const quint64 seedsOffset = cellsOffset + alignedSize(quint64(cellCount) * sizeof(Cell));
+    const quint64 totalSize = seedsOffset + quint64(seedCount) * sizeof(Seed);
+    if (totalSize > quint64(INT_MAX)) {
+        return fail(QString("Карта слишком велика (%1 МБ): увеличьте размер вокселя")
+                        .arg(totalSize / 1048576));
+    }
+
+    map.clear();
+    map.m_owned = QByteArray(static_cast<int>(totalSize), '\0');
+    uchar* data = reinterpret_cast<uchar*>(map.m_owned.data());
+
+    Header* header = reinterpret_cast<Header*>(data);
+    header->magic = MAGIC;
+    header->version = VERSION;
+    header->directionBins = DIRECTION_BINS;
+    header->voxelSize = static_cast<float>(voxel);
+    for (int r = 0; r < 3; ++r) {
+        header->origin[r] = static_cast<float>(lo[r] * voxel - reach);
+        header->dims[r] = dims[r];
+    }
+    header->cellCount = cellCount;
+    header->seedCount = seedCount;
+    header->sampleCount = options.samples;
+    for (int j = 0; j < KINEMATIC_JOINTS; ++j) {
+        header->lowerLimitDeg[j] = static_cast<float>(kinematics.lowerLimitDeg(j));
+        header->upperLimitDeg[j] = static_cast<float>(kinematics.upperLimitDeg(j));
+    }
+    for (int p = 0; p < 3; ++p) {
+        RigidTransform tcp = kinematics.forward(probePose(p));
+        for (int r = 0; r < 3; ++r) {
+            header->probeTcp[p][r] = static_cast<float>(tcp.position[r]);
+        }
+    }
+
+    quint32* index = reinterpret_cast<quint32*>(data + indexOffset);
+    std::fill(index, index + voxelTotal, EMPTY);
+    Cell* cells = reinterpret_cast<Cell*>(data + cellsOffset);
+    Seed* seeds = reinterpret_cast<Seed*>(data + seedsOffset);
+
+    quint32 cellNumber = 0;
+    for (size_t i = 0; i < merged.size(); ++cellNumber) {
+        const quint64 voxelKey = merged[i].key >> DIRECTION_SHIFT;
+        const quint64 x = voxelKey % side - lo[0];
+        const quint64 y = (voxelKey / side) % side - lo[1];
+        const quint64 z = voxelKey / (side * side) - lo[2];
+        index[(z * dims[1] + y) * dims[0] + x] = cellNumber;
+
+        Cell& cell = cells[cellNumber];
+        cell.directions = 0;
+        cell.firstSeed = static_cast<quint32>(i);
+        cell.manipulability = 0.0f;
+        cell.samples = 0;
+        // Ключи отсортированы: сектора вокселя идут подряд по возрастанию бита
+        for (; i < merged.size() && (merged[i].key >> DIRECTION_SHIFT) == voxelKey; ++i) {
+            const Sample& sample = merged[i];
+            cell.directions |= 1u << (sample.key & ((1u << DIRECTION_SHIFT) - 1));
+            cell.manipulability = std::max(cell.manipulability, sample.manipulability);
+            cell.samples += sample.count;
+            std::memcpy(seeds[i].centiDeg, sample.centiDeg, sizeof(seeds[i].centiDeg));
+            seeds[i].manipulability = sample.manipulability;
+        }
+    }
+
+    return map.attach(data, map.m_owned.size(), error);
+}
+
+bool ReachabilityMap::attach(const uchar* data, qint64 size, QString* error) {
+    auto fail = [error](const QString& message) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    };
+    static_assert(sizeof(Header) % 16 == 0, "Header must keep arrays 16-byte aligned");
+    static_assert(sizeof(Cell) == 16 && sizeof(Seed) == 16, "File layout changed");
+
+    if (size < qint64(sizeof(Header))) {
+        return fail("Файл карты короче заголовка");
+    }
+    const Header* header = reinterpret_cast<const Header*>(data);
+    if (header->magic != MAGIC) {
+        return fail("Это не карта досягаемости D1");
+    }
+    if (header->version != VERSION || header->directionBins != DIRECTION_BINS) {
+        return fail(QString("Неподдерживаемая версия карты: %1").arg(header->version));
+    }
+    if (!(header->voxelSize > 0.0f)) {
+        return fail("Неверный размер вокселя");
+    }
+
+    // Размеры сетки из файла: произведение не должно переполниться и не может
+    // требовать индекса больше самого файла
+    const quint64 maxVoxels = std::min<quint64>(quint64(size - qint64(sizeof(Header))) / sizeof(quint32), EMPTY);
+    quint64 voxelTotal = 1;
+    for (int r = 0; r < 3; ++r) {
+        if (header->dims[r] == 0 || header->dims[r] > maxVoxels / voxelTotal) {
+            return fail("Неверные размеры сетки карты");
+        }
+        voxelTotal *= header->dims[r];
+    }
+    const quint64 indexOffset = alignedSize(sizeof(Header));
+    const quint64 cellsOffset = indexOffset + alignedSize(voxelTotal * sizeof(quint32));
+    const quint64 seedsOffset = cellsOffset + alignedSize(quint64(header->cellCount) * sizeof(Cell));
+    if (quint64(size) < seedsOffset + quint64(header->seedCount) * sizeof(Seed)) {
+        return fail("Файл карты обрезан");
+    }
+
+    // Один проход проверки ссылок: дальше запросы им доверяют
+    const quint32* index = reinterpret_cast<const quint32*>(data + indexOffset);
+    const Cell* cells = reinterpret_cast<const Cell*>(data + cellsOffset);
+    for (quint64 i = 0; i < voxelTotal; ++i) {
+        if (index[i] != EMPTY && index[i] >= header->cellCount) {
+            return fail("Повреждён индекс карты");
+        }
+    }
+    for (quint32 i = 0; i < header->cellCount; ++i) {
+        const quint64 end = quint64(cells[i].firstSeed) + qPopulationCount(cells[i].directions);
+        if ((cells[i].directions >> DIRECTION_BINS) != 0 || end > header->seedCount) {
+            return fail("Повреждены воксели карты");
+        }
+    }
+
+    m_header = header;
+    m_index = index;
+    m_cells = cells;
+    m_seeds = reinterpret_cast<const Seed*>(data + seedsOffset);
+    return true;
+}
+
+bool ReachabilityMap::load(const QString& path, QString* error) {
+    clear();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        if (error) {
+            *error = QString("Не удалось открыть %1: %2").arg(path, m_file.errorString());
+        }
+        return false;
+    }
+    m_mapped = m_file.map(0, m_file.size());
+    if (!m_mapped) {
+        if (error) {
+            *error = QString("Не удалось отобразить %1: %2").arg(path, m_file.errorString());
+        }
+        clear();
+        return false;
+    }
+    if (!attach(m_mapped, m_file.size(), error)) {
+        clear();
+        return false;
+    }
+    return true;
+}
+
+bool ReachabilityMap::save(const QString& path, QString* error) const {
+    if (!isLoaded()) {
+        if (error) {
+            *error = "Карта не построена";
+        }
+        return false;
+    }
+
+    qint64 size = m_owned.size();
+    const char* data = m_owned.constData();
+    if (m_mapped) {
+        size = m_file.size();
+        data = reinterpret_cast<const char*>(m_mapped);
+    }
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data, size) != size || !file.commit()) {
+        if (error) {
+            *error = QString("Не удалось записать %1: %2").arg(path, file.errorString());
+        }
+        return false;
+    }
+    return true;
+}
+
+bool ReachabilityMap::matches(const ArmKinematics& kinematics) const {
+    if (!isLoaded() || !kinematics.isLoaded()) {
+        return false;
+    }
+    for (int j = 0; j < KINEMATIC_JOINTS; ++j) {
+        if (std::abs(m_header->lowerLimitDeg[j] - kinematics.lowerLimitDeg(j)) > 0.01
+            || std::abs(m_header->upperLimitDeg[j] - kinematics.upperLimitDeg(j)) > 0.01) {
+            return false;
+        }
+    }
+    // Контрольные позы совпадают до 0,1 мм — та же цепь и та же рабочая точка
+    for (int p = 0; p < 3; ++p) {
+        RigidTransform tcp = kinematics.forward(probePose(p));
+        for (int r = 0; r < 3; ++r) {
+            if (std::abs(m_header->probeTcp[p][r] - tcp.position[r]) > 1e-4) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+const ReachabilityMap::Cell* ReachabilityMap::cellAt(const std::array<double, 3>& position) const {
+    if (!m_header) {
+        return nullptr;
+    }
+    quint32 cell[3];
+    for (int r = 0; r < 3; ++r) {
+        const double offset = (position[r] - m_header->origin[r]) / m_header->voxelSize;
+        if (!(offset >= 0.0) || offset >= m_header->dims[r]) {
+            return nullptr;
+        }
+        cell[r] = static_cast<quint32>(offset);
+    }
+    const quint32 number = m_index[(quint64(cell[2]) * m_header->dims[1] + cell[1]) * m_header->dims[0] + cell[0]];
+    return number == EMPTY ? nullptr : &m_cells[number];
+}
+
+bool ReachabilityMap::isReachable(const std::array<double, 3>& position) const {
+    return cellAt(position) != nullptr;
+}
+
+bool ReachabilityMap::isReachable(const RigidTransform& pose) const {
+    const Cell* cell = cellAt(pose.position);
+    if (!cell) {
+        return false;
+    }
+    const std::array<double, 3> approach = {{pose.rotation[2], pose.rotation[5], pose.rotation[8]}};
+    return (cell->directions >> directionBin(approach)) & 1u;
+}
+
+double ReachabilityMap::manipulability(const std::array<double, 3>& position) const {
+    const Cell* cell = cellAt(position);
+    return cell ? cell->manipulability : 0.0;
+}
+
+bool ReachabilityMap::seedFor(const RigidTransform& pose, JointVector& seedDeg) const {
+    const Cell* cell = cellAt(pose.position);
+    if (!cell) {
+        return false;
+    }
+    const std::array<double, 3> approach = {{pose.rotation[2], pose.rotation[5], pose.rotation[8]}};
+    const int bin = directionBin(approach);
+    const Seed* seed = nullptr;
+    if ((cell->directions >> bin) & 1u) {
+        seed = &m_seeds[cell->firstSeed + qPopulationCount(cell->directions & ((1u << bin) - 1))];
+    } else {
+        // Сектора нет: углы самой манипулируемой выборки вокселя
+        const quint32 count = qPopulationCount(cell->directions);
+        for (quint32 i = 0; i < count; ++i) {
+            const Seed& candidate = m_seeds[cell->firstSeed + i];
+            if (!seed || candidate.manipulability > seed->manipulability) {
+                seed = &candidate;
+            }
+        }
+    }
+
+    seedDeg.fill(0.0);
+    for (int j = 0; j < KINEMATIC_JOINTS; ++j) {
+        seedDeg[j] = seed->centiDeg[j] / 100.0;
+    }
+    return true;
+}
+
+double ReachabilityMap::voxelSizeM() const {
+    return m_header ? m_header->voxelSize : 0.0;
+}
+
+quint32 ReachabilityMap::voxelCount() const {
+    return m_header ? m_header->dims[0] * m_header->dims[1] * m_header->dims[2] : 0;
+}
+
+quint32 ReachabilityMap::reachableVoxels() const {
+    return m_header ? m_header->cellCount : 0;
+}
+
+quint32 ReachabilityMap::seedCount() const {
+    return m_header ? m_header->seedCount : 0;
+}
+
+quint64 ReachabilityMap::sampleCount() const {
+    return m_header ? m_header->sampleCount : 0;
+}
@@ -50,6 +50,22 @@ void StatusWidget::setupUi() {
     m_uptimeLabel = new QLabel("--:--:--");
     gridLayout->addWidget(m_uptimeLabel, 3, 1, 1, 2);
     
+    // Задержка feedback
+    gridLayout->addWidget(new QLabel("Задержка:"), 4, 0);
+    m_latencyIndicator = new QLabel("●");
+    m_latencyIndicator->setStyleSheet("color: gray; font-size: 16px;");
+    gridLayout->addWidget(m_latencyIndicator, 4, 1);
+    QHBoxLayout* latencyLayout = new QHBoxLayout();
+    m_latencyLabel = new QLabel("--");
+    latencyLayout->addWidget(m_latencyLabel, 1);
+    m_latencyDetailsBtn = new QPushButton("📊");
+    m_latencyDetailsBtn->setToolTip("Гистограмма задержек и потерь");
+    m_latencyDetailsBtn->setFixedWidth(32);
+    m_latencyDetailsBtn->setCursor(Qt::PointingHandCursor);
+    connect(m_latencyDetailsBtn, &QPushButton::clicked, this, &StatusWidget::latencyDetailsClicked);
+    latencyLayout->addWidget(m_latencyDetailsBtn);
+    gridLayout->addLayout(latencyLayout, 4, 2);
+    
     mainLayout->addLayout(gridLayout);
     
     // Кнопки управления
@@ -321,6 +337,17 @@ void StatusWidget::setJointInfo(int jointId, double angle, double torque) {
     Q_UNUSED(torque);
 }
 
+void StatusWidget::setLatencyInfo(const QString& summary, bool withinBudget, bool hasData) {
+    m_latencyLabel->setText(summary);
+    if (!hasData) {
+        m_latencyIndicator->setStyleSheet("color: gray; font-size: 16px;");
+    } else if (withinBudget) {
+        m_latencyIndicator->setStyleSheet("color: #4CAF50; font-size: 16px;");
+    } else {
+        m_latencyIndicator->setStyleSheet("color: #FF9800; font-size: 16px;");
+    }
+}
+
 void StatusWidget::onEnableClicked() {
     emit enableMotorsClicked();
 }
@@ -0,0 +1,278 @@
+#include "trajectory_executor.h"
+#include <QMetaObject>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <utility>
+
+TrajectoryExecutor::TrajectoryExecutor(StateSource stateSource, StopCondition stopCondition, QObject* parent)
+    : QObject(parent)
+    , m_stateSource(std::move(stateSource))
+    , m_stopCondition(std::move(stopCondition))
+{
+}
+
+TrajectoryExecutor::~TrajectoryExecutor() {
+    join(TrajectoryReport::Cancelled);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shutdown = true;
+    }
+    m_cv.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void TrajectoryExecutor::setConfig(const TrajectoryConfig& config) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_config = config;
+    m_config.rateHz = std::max(10, std::min(config.rateHz, 200));
+    m_config.lookaheadMs = std::max(0, config.lookaheadMs);
+    m_config.feedbackLagMs = std::max(0, config.feedbackLagMs);
+    m_config.trackingGraceMs = std::max(0, config.trackingGraceMs);
+}
+
+TrajectoryConfig TrajectoryExecutor::config() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_config;
+}
+
+TrajectoryReport TrajectoryExecutor::lastReport() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_report;
+}
+
+quint64 TrajectoryExecutor::start(const JointTrajectory& trajectory, const JointLimits& limits, SinkFactory sinkFactory) {
+    if (trajectory.waypointCount() < 2 || !sinkFactory) {
+        return 0;
+    }
+
+    join(TrajectoryReport::Cancelled);
+
+    m_durationSec = trajectory.durationSec();
+    m_elapsedUs.store(0, std::memory_order_relaxed);
+    m_running.store(true, std::memory_order_release);
+    quint64 runId = ++m_runId;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cancel = false;
+        m_cancelReason = TrajectoryReport::Cancelled;
+        m_job.trajectory = trajectory;
+        m_job.limits = limits;
+        m_job.sinkFactory = std::move(sinkFactory);
+        m_job.config = m_config;
+        m_job.runId = runId;
+        m_hasJob = true;
+    }
+    // Поток один на всё время жизни исполнителя, задания передаются ему
+    if (!m_thread.joinable()) {
+        m_thread = std::thread(&TrajectoryExecutor::threadLoop, this);
+    }
+    m_cv.notify_all();
+    return runId;
+}
+
+void TrajectoryExecutor::stop() {
+    join(TrajectoryReport::Cancelled);
+}
+
+void TrajectoryExecutor::preempt() {
+    join(TrajectoryReport::Preempted);
+}
+
+void TrajectoryExecutor::join(TrajectoryReport::Result reason) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!m_hasJob && !m_busy) {
+        return;
+    }
+    m_cancel = true;
+    m_cancelReason = reason;
+    m_cv.notify_all();
+    m_idleCv.wait(lock, [this] { return !m_hasJob && !m_busy; });
+}
+
+void TrajectoryExecutor::threadLoop() {
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this] { return m_shutdown || m_hasJob; });
+            if (m_shutdown) {
+                return;
+            }
+            job = std::move(m_job);
+            m_job = Job();
+            m_hasJob = false;
+            m_busy = true;
+        }
+
+        run(job);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_busy = false;
+        }
+        m_idleCv.notify_all();
+    }
+}
+
+void TrajectoryExecutor::run(const Job& job) {
+    using Clock = std::chrono::steady_clock;
+
+    const JointTrajectory& trajectory = job.trajectory;
+    const TrajectoryConfig& config = job.config;
+    const quint64 runId = job.runId;
+    std::unique_ptr<SetpointSink> sink = job.sinkFactory();
+
+    // Точка траектории в пределах суставов: и уставка, и эталон для отклонения
+    auto sampleLimited = [&trajectory, &job](double t) {
+        JointVector q = trajectory.sample(t);
+        for (int j = 0; j < NUM_JOINTS; ++j) {
+            q[j] = std::max(job.limits[j].first, std::min(q[j], job.limits[j].second));
+        }
+        return q;
+    };
+
+    const auto period = std::chrono::nanoseconds(1000000000LL / config.rateHz);
+    const double periodSec = 1.0 / config.rateHz;
+    const int periodMs = std::max(1, 1000 / config.rateHz);
+    const double durationSec = trajectory.durationSec();
+    const double lookaheadSec = config.lookaheadMs / 1000.0;
+    const double lagSec = config.feedbackLagMs / 1000.0;
+    // Пока первая уставка не отработана и feedback её не показал, сравнивать не с чем
+    const double trackingStartSec = lookaheadSec + lagSec;
+
+    TrajectoryReport report;
+    TrajectoryReport::Result result = TrajectoryReport::Completed;
+    double sumSquares = 0.0;
+    uint64_t errorSamples = 0;
+    double exceededSinceSec = -1.0;
+    bool finalSent = false;
+
+    const Clock::time_point start = Clock::now();
+    Clock::time_point deadline = start;
+
+    for (uint64_t tick = 0;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_cv.wait_until(lock, deadline, [this] { return m_cancel; })) {
+                result = m_cancelReason;
+                break;
+            }
+        }
+
+        const Clock::time_point now = Clock::now();
+        const auto late = now - deadline;
+        report.maxLatenessMs = std::max(report.maxLatenessMs,
+                                        std::chrono::duration<double, std::milli>(late).count());
+        if (late >= period) {
+            report.overruns++;
+        }
+
+        // Время траектории — по расписанию, а не по факту пробуждения:
+        // опоздание тика не искажает форму движения
+        const double t = tick * periodSec;
+        m_elapsedUs.store(static_cast<int64_t>(t * 1e6), std::memory_order_relaxed);
+
+        if (m_stopCondition && m_stopCondition()) {
+            result = TrajectoryReport::Preempted;
+            break;
+        }
+
+        const ArmState state = m_stateSource();
+        if (!state.isConnected) {
+            result = TrajectoryReport::Disconnected;
+            break;
+        }
+
+        // Отклонение от траектории: feedback запаздывает, сравниваем с q(t - lag)
+        if (t >= trackingStartSec) {
+            const JointVector expected = sampleLimited(t - lagSec);
+            double worst = 0.0;
+            int worstJoint = -1;
+            for (int j = 0; j < NUM_JOINTS; ++j) {
+                if (j == 6) continue;  // Грипер траекторией не управляется
+                double error = std::abs(state.joints[j].angle - expected[j]);
+                report.maxTrackingErrorDeg[j] = std::max(report.maxTrackingErrorDeg[j], error);
+                sumSquares += error * error;
+                ++errorSamples;
+                if (error > worst) {
+                    worst = error;
+                    worstJoint = j;
+                }
+            }
+            if (worst > config.trackingLimitDeg) {
+                if (exceededSinceSec < 0.0) {
+                    exceededSinceSec = t;
+                } else if ((t - exceededSinceSec) * 1000.0 >= config.trackingGraceMs) {
+                    report.worstJoint = worstJoint;
+                    result = TrajectoryReport::TrackingError;
+                    break;
+                }
+            } else {
+                exceededSinceSec = -1.0;
+            }
+        }
+
+        if (t >= durationSec && finalSent) {
+            break;  // Конечная точка уже отправлена: уставка упирается в конец траектории
+        }
+
+        const double target = std::min(t + lookaheadSec, durationSec);
+        const int reachMs = std::max(periodMs, static_cast<int>(std::lround((target - t) * 1000.0)));
+        sink->send(sampleLimited(target), reachMs);
+        report.setpoints++;
+        finalSent = target >= durationSec;
+
+        deadline += period;
+        ++tick;
+        // Проспали больше периода: пропущенные уставки устарели, пачкой их не
+        // шлём — следующий тик сразу считается для текущего момента
+        const auto behind = Clock::now() - deadline;
+        if (behind >= period) {
+            const auto missed = behind / period;
+            tick += static_cast<uint64_t>(missed);
+            deadline += missed * period;
+            report.overruns++;
+            report.skippedTicks += static_cast<uint64_t>(missed);
+        }
+    }
+
+    report.result = result;
+    report.elapsedSec = std::chrono::duration<double>(Clock::now() - start).count();
+    report.rmsTrackingErrorDeg = errorSamples ? std::sqrt(sumSquares / errorSamples) : 0.0;
+    if (report.worstJoint < 0 && errorSamples) {
+        report.worstJoint = static_cast<int>(std::max_element(report.maxTrackingErrorDeg.begin(),
+                                                              report.maxTrackingErrorDeg.end())
+                                             - report.maxTrackingErrorDeg.begin());
+    }
+
+    // Сокет получателя закрывается в своём потоке
+    sink.reset();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_report = report;
+    }
+    m_running.store(false, std::memory_order_release);
+
+    // Отмену инициировал сам GUI — сообщать не о чем
+    if (result == TrajectoryReport::Cancelled) {
+        return;
+    }
+    QMetaObject::invokeMethod(this, [this, runId, result]() {
+        emit finished(runId, result == TrajectoryReport::Completed, resultName(result));
+    }, Qt::QueuedConnection);
+}
+
+QString TrajectoryExecutor::resultName(TrajectoryReport::Result result) {
+    switch (result) {
+        case TrajectoryReport::Completed: return "выполнена";
+        case TrajectoryReport::Cancelled: return "отменена";
+        case TrajectoryReport::Preempted: return "аварийная остановка";
+        case TrajectoryReport::TrackingError: return "рука отстала от траектории";
+        case TrajectoryReport::Disconnected: return "потеря связи";
+    }
+    return QString();
+}
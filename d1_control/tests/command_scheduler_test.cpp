@@ -0,0 +1,167 @@
+// CommandScheduler: порядок запуска, отмена, дескрипторы, перевзвод таймера.
+//
+// Сроки задаются реальным временем (колесо с шагом 1 мс), поэтому команды,
+// порядок которых проверяется, планируются из выполняющейся команды: в одном
+// проходе dispatch() их срок с нулевой задержкой совпадает.
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QString>
+#include <vector>
+#include "command_scheduler.h"
+#include "test_check.h"
+
+namespace {
+
+// Крутит цикл событий, пока условие не выполнится или не выйдет время
+template <typename F>
+bool waitFor(F condition, int timeoutMs) {
+    QElapsedTimer timer;
+    timer.start();
+    while (!condition()) {
+        if (timer.elapsed() > timeoutMs) {
+            return false;
+        }
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 1);
+    }
+    return true;
+}
+
+void runsByLaneThenOrderWithinOneDeadline() {
+    CommandScheduler scheduler;
+    std::vector<QString> log;
+
+    scheduler.schedule(0, CommandLane::Motion, 0, "setup", [&scheduler, &log]() {
+        scheduler.schedule(0, CommandLane::Ui, 0, "ui", [&log]() { log.push_back("ui"); });
+        scheduler.schedule(0, CommandLane::Motion, 0, "m1", [&log]() { log.push_back("m1"); });
+        scheduler.schedule(0, CommandLane::Safety, 0, "safety", [&log]() { log.push_back("safety"); });
+        scheduler.schedule(0, CommandLane::Motion, 0, "m2", [&log]() { log.push_back("m2"); });
+        scheduler.schedule(0, CommandLane::Power, 0, "power", [&log]() { log.push_back("power"); });
+    });
+
+    D1_CHECK(waitFor([&log]() { return log.size() == 5; }, 1000));
+    const std::vector<QString> expected = {"safety", "power", "m1", "m2", "ui"};
+    D1_CHECK(log == expected);
+    D1_CHECK(scheduler.pendingCount() == 0);
+    D1_CHECK(scheduler.laneStats(CommandLane::Motion).executed == 3);
+}
+
+void cancelsByHandleGroupAndLane() {
+    CommandScheduler scheduler;
+    int ran = 0;
+    auto task = [&ran]() { ++ran; };
+
+    CommandHandle single = scheduler.schedule(30, CommandLane::Motion, 0, "single", task);
+    scheduler.schedule(30, CommandLane::Motion, 7, "group-a", task);
+    scheduler.schedule(30, CommandLane::Power, 7, "group-b", task);
+    scheduler.schedule(30, CommandLane::Ui, 0, "ui-a", task);
+    scheduler.schedule(30, CommandLane::Ui, 0, "ui-b", task);
+    CommandHandle survivor = scheduler.schedule(30, CommandLane::Safety, 0, "survivor", task);
+    D1_CHECK(scheduler.pendingCount() == 6);
+
+    D1_CHECK(scheduler.isPending(single));
+    D1_CHECK(scheduler.cancel(single));
+    D1_CHECK(!scheduler.isPending(single));
+    D1_CHECK(!scheduler.cancel(single));
+    D1_CHECK(scheduler.cancelGroup(7) == 2);
+    D1_CHECK(scheduler.cancelLane(CommandLane::Ui) == 2);
+    D1_CHECK(scheduler.pendingCount() == 1);
+
+    D1_CHECK(waitFor([&ran]() { return ran > 0; }, 1000));
+    D1_CHECK(ran == 1);
+    D1_CHECK(!scheduler.isPending(survivor));
+    D1_CHECK(scheduler.laneStats(CommandLane::Ui).cancelled == 2);
+    D1_CHECK(scheduler.laneStats(CommandLane::Safety).executed == 1);
+}
+
+void staleHandleDoesNotTouchReusedSlot() {
+    CommandScheduler scheduler;
+    bool first = false;
+    CommandHandle old = scheduler.schedule(0, CommandLane::Motion, 0, "first", [&first]() { first = true; });
+    D1_CHECK(waitFor([&first]() { return first; }, 1000));
+    D1_CHECK(!scheduler.isPending(old));
+
+    // Свободная ячейка берётся снова — с новым поколением
+    bool second = false;
+    CommandHandle fresh = scheduler.schedule(20, CommandLane::Motion, 0, "second", [&second]() { second = true; });
+    D1_CHECK(fresh != old);
+    D1_CHECK(!scheduler.cancel(old));
+    D1_CHECK(scheduler.isPending(fresh));
+    D1_CHECK(waitFor([&second]() { return second; }, 1000));
+    D1_CHECK(!scheduler.cancel(0));
+}
+
+void earlierDeadlineRearmsTimer() {
+    CommandScheduler scheduler;
+    QElapsedTimer clock;
+    clock.start();
+    qint64 lateAt = -1;
+    qint64 earlyAt = -1;
+
+    scheduler.schedule(400, CommandLane::Motion, 0, "late", [&]() { lateAt = clock.elapsed(); });
+    scheduler.schedule(10, CommandLane::Motion, 0, "early", [&]() { earlyAt = clock.elapsed(); });
+
+    D1_CHECK(waitFor([&earlyAt]() { return earlyAt >= 0; }, 1000));
+    D1_CHECK(earlyAt >= 9);
+    D1_CHECK(lateAt < 0);
+    D1_CHECK(earlyAt < 300);
+    D1_CHECK(waitFor([&lateAt]() { return lateAt >= 0; }, 2000));
+    D1_CHECK(lateAt >= 399);
+}
+
+void delayLongerThanWheelRevolution() {
+    CommandScheduler scheduler;
+    QElapsedTimer clock;
+    clock.start();
+    qint64 ranAt = -1;
+    const int delayMs = CommandScheduler::WHEEL_SLOTS * CommandScheduler::TICK_MS + 60;
+
+    scheduler.schedule(delayMs, CommandLane::Ui, 0, "long", [&]() { ranAt = clock.elapsed(); });
+    D1_CHECK(waitFor([&ranAt]() { return ranAt >= 0; }, delayMs + 2000));
+    D1_CHECK(ranAt >= delayMs - 1);
+}
+
+void taskCancelsLaterDueTask() {
+    CommandScheduler scheduler;
+    bool victimRan = false;
+    bool done = false;
+
+    scheduler.schedule(0, CommandLane::Motion, 0, "setup", [&]() {
+        // Обе в одном проходе; аварийная остановка отменяет уже "созревшую" команду
+        scheduler.schedule(0, CommandLane::Motion, 3, "victim", [&victimRan]() { victimRan = true; });
+        scheduler.schedule(0, CommandLane::Safety, 0, "estop", [&]() {
+            scheduler.cancelGroup(3);
+            done = true;
+        });
+    });
+
+    D1_CHECK(waitFor([&done]() { return done; }, 1000));
+    waitFor([]() { return false; }, 20);
+    D1_CHECK(!victimRan);
+    D1_CHECK(scheduler.laneStats(CommandLane::Motion).cancelled == 1);
+}
+
+void fullPoolDropsCommand() {
+    CommandScheduler scheduler;
+    for (int i = 0; i < CommandScheduler::CAPACITY; ++i) {
+        D1_CHECK(scheduler.schedule(1000, CommandLane::Ui, 0, "fill", []() {}) != 0);
+    }
+    D1_CHECK(scheduler.schedule(1000, CommandLane::Motion, 0, "overflow", []() {}) == 0);
+    D1_CHECK(scheduler.laneStats(CommandLane::Motion).dropped == 1);
+    D1_CHECK(scheduler.cancelAll() == CommandScheduler::CAPACITY);
+    D1_CHECK(scheduler.pendingCount() == 0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    D1_RUN(runsByLaneThenOrderWithinOneDeadline);
+    D1_RUN(cancelsByHandleGroupAndLane);
+    D1_RUN(staleHandleDoesNotTouchReusedSlot);
+    D1_RUN(earlierDeadlineRearmsTimer);
+    D1_RUN(delayLongerThanWheelRevolution);
+    D1_RUN(taskCancelsLaterDueTask);
+    D1_RUN(fullPoolDropsCommand);
+    return d1test::result();
+}
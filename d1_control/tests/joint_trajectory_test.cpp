@@ -0,0 +1,230 @@
+// JointTrajectory: лимиты после retime(), непрерывность ускорения на стыках,
+// остановки в точках, выдержки, скругление углов.
+//
+// Случайные пути — с фиксированным зерном; производные сверяются с конечными
+// разностями по sample(), а не только с peaks(), чтобы ловить и скачки на стыках.
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include "joint_trajectory.h"
+#include "test_check.h"
+
+namespace {
+
+constexpr double VELOCITY = 90.0;
+constexpr double ACCELERATION = 360.0;
+constexpr double JERK = 3600.0;
+
+MotionLimits uniformLimits() {
+    MotionLimits limits;
+    limits.velocity.fill(VELOCITY);
+    limits.acceleration.fill(ACCELERATION);
+    limits.jerk.fill(JERK);
+    return limits;
+}
+
+JointTrajectory randomPath(std::mt19937& random, int points) {
+    std::uniform_real_distribution<double> step(-60.0, 60.0);
+    JointTrajectory trajectory;
+    JointVector angles{};
+    for (int i = 0; i < points; ++i) {
+        trajectory.addWaypoint(i, angles);
+        for (double& angle : angles) {
+            angle += step(random);
+        }
+    }
+    return trajectory;
+}
+
+void retimeKeepsExactPeaksWithinLimits() {
+    std::mt19937 random(3);
+    double worst = 0.0;
+    for (int n = 0; n < 500; ++n) {
+        JointTrajectory trajectory = randomPath(random, 2 + n % 12);
+        trajectory.retime(uniformLimits());
+        JointVector velocity, acceleration, jerk;
+        trajectory.peaks(velocity, acceleration, jerk);
+        for (int j = 0; j < NUM_JOINTS; ++j) {
+            worst = std::max({worst, velocity[j] / VELOCITY, acceleration[j] / ACCELERATION, jerk[j] / JERK});
+        }
+    }
+    D1_CHECK(worst <= 1.0 + 1e-6);
+    D1_CHECK(worst > 0.9);  // Лимит достигается: отрезки не растянуты с запасом
+}
+
+void accelerationIsContinuousAtKnots() {
+    // Конечные разности по всей траектории, включая трогание с места и стыки
+    std::mt19937 random(9);
+    const double dt = 2e-4;
+    double worstAcceleration = 0.0;
+    double worstJerk = 0.0;
+    for (int n = 0; n < 100; ++n) {
+        JointTrajectory trajectory = randomPath(random, 6);
+        trajectory.retime(uniformLimits());
+        for (double t = 0.0; t < trajectory.durationSec(); t += dt) {
+            const JointVector q0 = trajectory.sample(t - dt);
+            const JointVector q1 = trajectory.sample(t);
+            const JointVector q2 = trajectory.sample(t + dt);
+            const JointVector q3 = trajectory.sample(t + 2.0 * dt);
+            for (int j = 0; j < NUM_JOINTS; ++j) {
+                const double acceleration = (q0[j] - 2.0 * q1[j] + q2[j]) / (dt * dt);
+                const double jerk = (q3[j] - 3.0 * q2[j] + 3.0 * q1[j] - q0[j]) / (dt * dt * dt);
+                worstAcceleration = std::max(worstAcceleration, std::abs(acceleration) / ACCELERATION);
+                worstJerk = std::max(worstJerk, std::abs(jerk) / JERK);
+            }
+        }
+    }
+    D1_CHECK(worstAcceleration <= 1.01);
+    D1_CHECK(worstJerk <= 1.01);
+}
+
+void pointToPointStartsAndEndsAtRest() {
+    JointVector from{};
+    JointVector to{};
+    to[0] = 90.0;
+    to[3] = -45.0;
+    JointTrajectory move = JointTrajectory::pointToPoint(from, to, 1.0);
+    move.retime(uniformLimits());
+
+    const double duration = move.durationSec();
+    D1_CHECK(duration > 0.0);
+    D1_CHECK_NEAR(move.sample(0.0)[0], 0.0, 1e-12);
+    D1_CHECK_NEAR(move.sample(duration)[0], 90.0, 1e-12);
+    D1_CHECK_NEAR(move.sample(duration / 2.0)[0], 45.0, 1e-9);
+    D1_CHECK_NEAR(move.sample(duration / 2.0)[3], -22.5, 1e-9);
+
+    // Скорость и ускорение у концов — порядка dt² и dt³ соответственно
+    const double dt = 1e-3;
+    const double startVelocity = (move.sample(dt)[0] - move.sample(0.0)[0]) / dt;
+    const double endVelocity = (move.sample(duration)[0] - move.sample(duration - dt)[0]) / dt;
+    D1_CHECK(std::abs(startVelocity) < 0.01);
+    D1_CHECK(std::abs(endVelocity) < 0.01);
+    D1_CHECK(move.waypoint(0).velocities[0] == 0.0);
+}
+
+void stopPointsAndReversalsHaveZeroVelocity() {
+    JointVector a{}, b{}, c{}, d{};
+    b[0] = 10.0;
+    c[0] = 20.0;
+    d[0] = 5.0;   // Разворот в c
+    b[1] = 10.0;
+    c[1] = 20.0;
+    d[1] = 30.0;  // Проходной сустав
+    JointTrajectory trajectory;
+    trajectory.addWaypoint(0.0, a);
+    trajectory.addWaypoint(1.0, b, true);
+    trajectory.addWaypoint(2.0, c);
+    trajectory.addWaypoint(3.0, d);
+    trajectory.finalize();
+
+    D1_CHECK(trajectory.waypoint(1).velocities[0] == 0.0);
+    D1_CHECK(trajectory.waypoint(1).velocities[1] == 0.0);
+    D1_CHECK(trajectory.waypoint(2).velocities[0] == 0.0);
+    D1_CHECK_NEAR(trajectory.waypoint(2).velocities[1], 10.0, 1e-12);
+
+    // Сплайн не перелетает точку разворота
+    double highest = 0.0;
+    for (int i = 0; i <= 3000; ++i) {
+        highest = std::max(highest, trajectory.sample(i / 1000.0)[0]);
+    }
+    D1_CHECK(highest <= 20.0 + 1e-9);
+}
+
+void dwellsKeepRecordedDuration() {
+    JointVector a{}, b{}, c{};
+    b[0] = 45.0;
+    b[2] = -30.0;
+    c[0] = -20.0;
+    JointTrajectory trajectory;
+    trajectory.addWaypoint(0.0, a);
+    trajectory.addWaypoint(1.0, b, true);
+    trajectory.addWaypoint(3.5, b);         // Выдержка 2.5 с в остановке
+    trajectory.addWaypoint(4.5, c);
+    trajectory.addWaypoint(4.52, c);        // Короче MIN_SEGMENT_SEC не становится
+    trajectory.addWaypoint(5.32, c, true);  // Стоянка в конце
+    trajectory.retime(uniformLimits());
+
+    auto segment = [&trajectory](int i) {
+        return trajectory.waypoint(i + 1).timeSec - trajectory.waypoint(i).timeSec;
+    };
+    D1_CHECK_NEAR(segment(1), 2.5, 1e-12);
+    D1_CHECK_NEAR(segment(3), 0.02, 1e-12);
+    D1_CHECK_NEAR(segment(4), 0.8, 1e-12);
+
+    // Движение между выдержками по-прежнему в пределах
+    JointVector velocity, acceleration, jerk;
+    trajectory.peaks(velocity, acceleration, jerk);
+    for (int j = 0; j < NUM_JOINTS; ++j) {
+        D1_CHECK(velocity[j] <= VELOCITY * (1.0 + 1e-3));
+        D1_CHECK(acceleration[j] <= ACCELERATION * (1.0 + 1e-3));
+        D1_CHECK(jerk[j] <= JERK * (1.0 + 1e-3));
+    }
+    // И в выдержке рука стоит
+    const double t0 = trajectory.waypoint(1).timeSec;
+    double worst = 0.0;
+    for (int s = 0; s <= 100; ++s) {
+        const JointVector q = trajectory.sample(t0 + 2.5 * s / 100.0);
+        worst = std::max(worst, std::abs(q[0] - 45.0) + std::abs(q[2] + 30.0));
+    }
+    D1_CHECK(worst <= 1e-9);
+}
+
+void blendedCornerStaysWithinRadius() {
+    std::mt19937 random(5);
+    std::uniform_real_distribution<double> angle(-60.0, 60.0);
+    double worst = 0.0;
+    for (int n = 0; n < 1000; ++n) {
+        JointVector prev, corner, next;
+        for (int j = 0; j < NUM_JOINTS; ++j) {
+            prev[j] = angle(random);
+            corner[j] = angle(random);
+            next[j] = angle(random);
+        }
+        const double radius = 1.0 + n % 20;
+        JointVector entry, exit;
+        double entryFraction = 0.0, exitFraction = 0.0;
+        JointTrajectory::blendCorner(prev, corner, next, radius, entry, exit, entryFraction, exitFraction);
+        D1_CHECK(entryFraction <= JointTrajectory::MAX_BLEND_FRACTION);
+        D1_CHECK(exitFraction <= JointTrajectory::MAX_BLEND_FRACTION);
+
+        JointTrajectory trajectory;
+        trajectory.addWaypoint(0.0, prev);
+        trajectory.addWaypoint(1.0 - entryFraction, entry);
+        trajectory.addWaypoint(1.0 + exitFraction, exit);
+        trajectory.addWaypoint(2.0, next);
+        trajectory.retime(uniformLimits());
+
+        const double t0 = trajectory.waypoint(1).timeSec;
+        const double t1 = trajectory.waypoint(2).timeSec;
+        for (int s = 0; s <= 200; ++s) {
+            const JointVector q = trajectory.sample(t0 + (t1 - t0) * s / 200.0);
+            for (int j = 0; j < NUM_JOINTS - 1; ++j) {
+                worst = std::max(worst, std::abs(q[j] - corner[j]) / radius);
+            }
+        }
+    }
+    D1_CHECK(worst <= 1.0 + 1e-9);
+}
+
+void scaledLimitsShortenProportionally() {
+    std::mt19937 random(11);
+    JointTrajectory slow = randomPath(random, 8);
+    JointTrajectory fast = slow;
+    slow.retime(uniformLimits());
+    fast.retime(uniformLimits().scaled(2.0));
+    D1_CHECK_NEAR(fast.durationSec(), slow.durationSec() / 2.0, slow.durationSec() * 1e-3);
+}
+
+} // namespace
+
+int main() {
+    D1_RUN(retimeKeepsExactPeaksWithinLimits);
+    D1_RUN(accelerationIsContinuousAtKnots);
+    D1_RUN(pointToPointStartsAndEndsAtRest);
+    D1_RUN(stopPointsAndReversalsHaveZeroVelocity);
+    D1_RUN(dwellsKeepRecordedDuration);
+    D1_RUN(blendedCornerStaysWithinRadius);
+    D1_RUN(scaledLimitsShortenProportionally);
+    return d1test::result();
+}
@@ -0,0 +1,266 @@
+// MotionLibrary/MotionManager: круговой путь .d1ml, пересохранение поверх
+// открытой библиотеки, повреждённый блок кадров и повреждённый индекс.
+//
+// Файлы портятся побайтно по раскладке из motion_library.h: заголовок и
+// запись индекса — по 48 байт. CRC-32 индекса для подделанной записи
+// пересчитывается здесь же, побитно.
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <cstring>
+#include "motion_library.h"
+#include "motion_manager.h"
+#include "test_check.h"
+
+namespace {
+
+constexpr int HEADER_SIZE = 48;
+constexpr int ENTRY_SIZE = 48;
+constexpr int INDEX_CHECKSUM_OFFSET = 28;
+constexpr int STRINGS_SIZE_OFFSET = 24;
+
+Motion makeMotion(const QString& name, int frames, double phase) {
+    Motion motion;
+    motion.name = name;
+    motion.description = "Описание " + name;
+    motion.looping = frames % 2 == 0;
+    motion.defaultSpeed = 50 + frames;
+    for (int k = 0; k < frames; ++k) {
+        MotionKeyframe kf;
+        for (int j = 0; j < MOTION_NUM_JOINTS; ++j) {
+            kf.jointAngles[j] = phase + k * 1.25 - j * 3.5;
+        }
+        kf.transitionMs = 100 + k;
+        kf.blendRadiusDeg = k % 3;
+        kf.stop = k % 4 == 1;
+        motion.keyframes.append(kf);
+    }
+    return motion;
+}
+
+bool sameMotion(const Motion& a, const Motion& b) {
+    if (a.name != b.name || a.description != b.description || a.looping != b.looping
+        || a.defaultSpeed != b.defaultSpeed || a.keyframeCount() != b.keyframeCount()) {
+        return false;
+    }
+    for (int k = 0; k < a.keyframeCount(); ++k) {
+        const MotionKeyframe& x = a.keyframes[k];
+        const MotionKeyframe& y = b.keyframes[k];
+        for (int j = 0; j < MOTION_NUM_JOINTS; ++j) {
+            if (std::abs(x.jointAngles[j] - y.jointAngles[j]) > 1e-4) {  // float32
+                return false;
+            }
+        }
+        if (x.transitionMs != y.transitionMs || x.blendRadiusDeg != y.blendRadiusDeg || x.stop != y.stop) {
+            return false;
+        }
+    }
+    return true;
+}
+
+QVector<Motion> sampleMotions() {
+    return {makeMotion("Волна", 12, 0.0), makeMotion("Захват", 7, 10.0), makeMotion("Пустое", 0, 0.0),
+            makeMotion("Длинное", 300, -20.0)};
+}
+
+bool saveMotions(const QVector<Motion>& motions, const QString& path) {
+    MotionManager manager;
+    for (const Motion& motion : motions) {
+        manager.addMotion(motion);
+    }
+    return manager.saveToFile(path);
+}
+
+QByteArray readFile(const QString& path) {
+    QFile file(path);
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+void writeFile(const QString& path, const QByteArray& data) {
+    QFile file(path);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(data);
+    }
+}
+
+template <typename T>
+T field(const QByteArray& data, int offset) {
+    T value;
+    std::memcpy(&value, data.constData() + offset, sizeof(value));
+    return value;
+}
+
+template <typename T>
+void setField(QByteArray& data, int offset, T value) {
+    std::memcpy(data.data() + offset, &value, sizeof(value));
+}
+
+quint64 blockOffset(const QByteArray& data, int motion) {
+    return field<quint64>(data, HEADER_SIZE + motion * ENTRY_SIZE);
+}
+
+quint32 crc32(const char* data, int size) {
+    quint32 c = 0xffffffffu;
+    for (int i = 0; i < size; ++i) {
+        c ^= static_cast<uchar>(data[i]);
+        for (int k = 0; k < 8; ++k) {
+            c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+        }
+    }
+    return c ^ 0xffffffffu;
+}
+
+// Индекс и строки изменены — пересчитать их CRC в заголовке
+void resealIndex(QByteArray& data) {
+    const quint32 motions = field<quint32>(data, 8);
+    const quint32 strings = field<quint32>(data, STRINGS_SIZE_OFFSET);
+    setField(data, INDEX_CHECKSUM_OFFSET,
+             crc32(data.constData() + HEADER_SIZE, int(motions * ENTRY_SIZE + strings)));
+}
+
+void roundTripKeepsMotions() {
+    QTemporaryDir dir;
+    const QString path = dir.filePath("motions.d1ml");
+    const QVector<Motion> motions = sampleMotions();
+    D1_CHECK(saveMotions(motions, path));
+
+    MotionManager loaded;
+    D1_CHECK(loaded.loadFromFile(path));
+    D1_CHECK(loaded.getMotionCount() == motions.size());
+
+    // Список — по индексу, до декодирования кадров
+    const QVector<MotionSummary> summaries = loaded.getSummaries();
+    for (int i = 0; i < motions.size() && i < summaries.size(); ++i) {
+        D1_CHECK(summaries[i].name == motions[i].name);
+        D1_CHECK(summaries[i].keyframeCount == motions[i].keyframeCount());
+        D1_CHECK(summaries[i].durationMs == motions[i].totalDurationMs());
+    }
+    for (int i = 0; i < motions.size(); ++i) {
+        D1_CHECK(sameMotion(loaded.getMotion(i), motions[i]));
+    }
+}
+
+void resaveOverOpenLibraryKeepsUnreadBlocks() {
+    QTemporaryDir dir;
+    const QString path = dir.filePath("motions.d1ml");
+    QVector<Motion> motions = sampleMotions();
+    D1_CHECK(saveMotions(motions, path));
+
+    // Одно движение прочитано, одно переименовано, остальные — блоками;
+    // сохранение поверх файла, из которого библиотека открыта
+    MotionManager manager;
+    D1_CHECK(manager.loadFromFile(path));
+    D1_CHECK(sameMotion(manager.getMotion(1), motions[1]));
+    manager.renameMotion(3, "Длинное 2");
+    motions[3].name = "Длинное 2";
+    Motion added = makeMotion("Новое", 5, 3.0);
+    manager.addMotion(added);
+    motions.append(added);
+    D1_CHECK(manager.saveToFile(path));
+
+    // Тот же менеджер читает кадры уже из нового файла
+    for (int i = 0; i < motions.size(); ++i) {
+        D1_CHECK(sameMotion(manager.getMotion(i), motions[i]));
+    }
+    // Ещё раз поверх — все блоки теперь из нового отображения
+    D1_CHECK(manager.saveToFile(path));
+
+    MotionManager reloaded;
+    D1_CHECK(reloaded.loadFromFile(path));
+    D1_CHECK(reloaded.getMotionCount() == motions.size());
+    for (int i = 0; i < motions.size(); ++i) {
+        D1_CHECK(sameMotion(reloaded.getMotion(i), motions[i]));
+    }
+}
+
+void corruptedBlockIsReportedAndKeptOnSave() {
+    QTemporaryDir dir;
+    const QString path = dir.filePath("motions.d1ml");
+    const QVector<Motion> motions = sampleMotions();
+    D1_CHECK(saveMotions(motions, path));
+
+    QByteArray data = readFile(path);
+    const int damaged = int(blockOffset(data, 1)) + 5;
+    data[damaged] = char(data[damaged] ^ 0x40);
+    writeFile(path, data);
+
+    MotionManager manager;
+    int errors = 0;
+    QObject::connect(&manager, &MotionManager::errorOccurred, [&errors](const QString&) { ++errors; });
+    D1_CHECK(manager.loadFromFile(path));
+    D1_CHECK(errors == 0);  // Индекс цел: повреждение видно только при чтении кадров
+    D1_CHECK(sameMotion(manager.getMotion(0), motions[0]));
+    D1_CHECK(manager.getMotion(1).isEmpty());
+    D1_CHECK(errors == 1);
+    D1_CHECK(manager.getSummaries()[1].keyframeCount == motions[1].keyframeCount());
+
+    // Сохранение не превращает его в пустое движение: блок копируется как есть
+    D1_CHECK(manager.saveToFile(path));
+    D1_CHECK(manager.getMotion(1).isEmpty());
+    D1_CHECK(errors == 2);
+
+    // Тот же испорченный байт исправлен — движение снова целиком
+    data = readFile(path);
+    const int moved = int(blockOffset(data, 1)) + 5;
+    data[moved] = char(data[moved] ^ 0x40);
+    writeFile(path, data);
+    MotionManager repaired;
+    D1_CHECK(repaired.loadFromFile(path));
+    for (int i = 0; i < motions.size(); ++i) {
+        D1_CHECK(sameMotion(repaired.getMotion(i), motions[i]));
+    }
+}
+
+void corruptedIndexIsRejected() {
+    QTemporaryDir dir;
+    const QString path = dir.filePath("motions.d1ml");
+    D1_CHECK(saveMotions(sampleMotions(), path));
+    const QByteArray original = readFile(path);
+    const QString broken = dir.filePath("broken.d1ml");
+    MotionLibrary library;
+    QString error;
+
+    // Байт в строках: CRC индекса
+    QByteArray data = original;
+    const int name = HEADER_SIZE + 4 * ENTRY_SIZE + 1;
+    data[name] = char(data[name] ^ 0x01);
+    writeFile(broken, data);
+    D1_CHECK(!library.open(broken, &error));
+    D1_CHECK(!error.isEmpty());
+
+    // Обрезанный файл
+    writeFile(broken, original.left(original.size() - 16));
+    D1_CHECK(!library.open(broken));
+
+    // Смещение блока у конца 64-битного диапазона: offset + size переполняется
+    // и без отдельной проверки выглядело бы как блок внутри файла
+    data = original;
+    setField<quint64>(data, HEADER_SIZE + 3 * ENTRY_SIZE, ~quint64(0) - 15);
+    resealIndex(data);
+    writeFile(broken, data);
+    D1_CHECK(!library.open(broken));
+
+    // Неизменённая копия открывается
+    writeFile(broken, original);
+    D1_CHECK(library.open(broken));
+    D1_CHECK(library.motionCount() == 4);
+
+    MotionManager manager;
+    D1_CHECK(manager.loadFromFile(path));
+    D1_CHECK(!manager.loadFromFile(dir.filePath("missing.d1ml")));
+    D1_CHECK(manager.getMotionCount() == 4);  // Неудачная загрузка прежнее не трогает
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    QStandardPaths::setTestModeEnabled(true);
+    QCoreApplication app(argc, argv);
+    D1_RUN(roundTripKeepsMotions);
+    D1_RUN(resaveOverOpenLibraryKeepsUnreadBlocks);
+    D1_RUN(corruptedBlockIsReportedAndKeptOnSave);
+    D1_RUN(corruptedIndexIsRejected);
+    return d1test::result();
+}
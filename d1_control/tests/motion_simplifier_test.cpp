@@ -0,0 +1,210 @@
+// MotionSimplifier: паузы (сжатие, слияние, края), RDP по ломаной и допуск
+// по сплайну воспроизведения.
+//
+// Записи строятся функцией углов от номера кадра с постоянным шагом;
+// отклонение по сплайну сверяется независимо — JointTrajectory через
+// оставшиеся кадры в моменты всех исходных кадров.
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include "joint_trajectory.h"
+#include "motion_simplifier.h"
+#include "test_check.h"
+
+namespace {
+
+constexpr int STEP_MS = 100;
+
+using Angles = std::array<double, MOTION_NUM_JOINTS>;
+
+Motion record(int frames, const std::function<Angles(int)>& angles) {
+    Motion motion;
+    motion.name = "test";
+    for (int i = 0; i < frames; ++i) {
+        MotionKeyframe kf;
+        kf.jointAngles = angles(i);
+        kf.transitionMs = i == 0 ? 1000 : STEP_MS;
+        motion.keyframes.append(kf);
+    }
+    return motion;
+}
+
+double maxDelta(const Angles& a, const Angles& b) {
+    double worst = 0.0;
+    for (int j = 0; j < MOTION_NUM_JOINTS; ++j) {
+        worst = std::max(worst, std::abs(a[j] - b[j]));
+    }
+    return worst;
+}
+
+Angles ramp(double joint0) {
+    Angles q{};
+    q[0] = joint0;
+    return q;
+}
+
+void middlePauseShrinksToDwell() {
+    // Движение 2 с, стоянка 3 с, движение 2 с
+    Motion motion = record(71, [](int i) {
+        return ramp(i < 20 ? i * 2.0 : (i < 50 ? 40.0 : 40.0 + (i - 50) * 2.0));
+    });
+    SimplifyOptions options;
+    SimplifyReport report;
+    Motion simplified = MotionSimplifier::simplify(motion, options, &report);
+
+    D1_CHECK(report.idleSegments == 1);
+    D1_CHECK(report.idleRemovedMs == 3000 - options.maxDwellMs);
+    D1_CHECK(report.outputDurationMs == report.inputDurationMs - report.idleRemovedMs);
+
+    // Края паузы — остановки, между ними ровно выдержка
+    int stops = 0;
+    for (int i = 0; i < simplified.keyframeCount(); ++i) {
+        if (simplified.keyframes[i].stop) {
+            ++stops;
+            D1_CHECK_NEAR(simplified.keyframes[i].jointAngles[0], 40.0, 1e-12);
+        }
+    }
+    D1_CHECK(stops == 2);
+    D1_CHECK_NEAR(simplified.keyframes.last().jointAngles[0], 80.0, 1e-12);
+}
+
+void twoPausesShiftLaterFramesByBothCuts() {
+    Motion motion = record(101, [](int i) {
+        if (i < 10) return ramp(i * 3.0);
+        if (i < 40) return ramp(30.0);
+        if (i < 50) return ramp(30.0 + (i - 40) * 3.0);
+        if (i < 80) return ramp(60.0);
+        return ramp(60.0 + (i - 80) * 3.0);
+    });
+    SimplifyOptions options;
+    options.maxDwellMs = 0;
+    SimplifyReport report;
+    Motion simplified = MotionSimplifier::simplify(motion, options, &report);
+
+    D1_CHECK(report.idleSegments == 2);
+    D1_CHECK(report.idleRemovedMs == 2 * 3000);
+    D1_CHECK(simplified.totalDurationMs() == motion.totalDurationMs() - 6000);
+    D1_CHECK_NEAR(simplified.keyframes.last().jointAngles[0], 120.0, 1e-12);
+}
+
+void slowDriftIsNotMergedIntoOnePause() {
+    // 0,05° за кадр: каждые 10 кадров — «пауза» по допуску 0,5°, но вся запись
+    // уходит на 5°. Соседние паузы не сливаются, и конечная поза сохраняется.
+    Motion motion = record(101, [](int i) { return ramp(i * 0.05); });
+    SimplifyOptions options;
+    SimplifyReport report;
+    Motion simplified = MotionSimplifier::simplify(motion, options, &report);
+
+    D1_CHECK(simplified.keyframeCount() > 2);
+    D1_CHECK(report.idleSegments > 2);
+    const Angles& last = simplified.keyframes.last().jointAngles;
+    D1_CHECK(maxDelta(last, motion.keyframes.last().jointAngles) <= options.idleToleranceDeg + 1e-9);
+    // Между соседними оставшимися кадрами — не больше допуска паузы
+    for (int i = 1; i < simplified.keyframeCount(); ++i) {
+        D1_CHECK(maxDelta(simplified.keyframes[i].jointAngles, simplified.keyframes[i - 1].jointAngles)
+                 <= options.idleToleranceDeg + 1e-9);
+    }
+}
+
+void adjacentPauseFarFromHeldPoseIsKept() {
+    // Стоянки 30° (1 с), 30,4° (1 с), 30,8° (1 с). Первые две — одна пауза:
+    // всё в 0,5° от её начала. Третья к ней не присоединяется (0,8° от начала),
+    // а без выдержки её начало вырезано — рука стоит в 30°, и сжать третью
+    // значило бы пропустить 0,8°: она остаётся как есть
+    Motion motion = record(60, [](int i) {
+        if (i < 10) return ramp(i * 3.0);
+        if (i < 20) return ramp(30.0);
+        if (i < 30) return ramp(30.4);
+        if (i < 40) return ramp(30.8);
+        return ramp(30.8 + (i - 40) * 3.0);
+    });
+    SimplifyOptions options;
+    options.maxDwellMs = 0;
+    options.fitSpline = false;
+    SimplifyReport report;
+    Motion simplified = MotionSimplifier::simplify(motion, options, &report);
+
+    D1_CHECK(report.idleSegments == 1);
+    D1_CHECK(report.idleRemovedMs == 19 * STEP_MS);
+    D1_CHECK(report.maxDeviationDeg <= options.toleranceDeg);
+    D1_CHECK_NEAR(simplified.keyframes.last().jointAngles[0], motion.keyframes.last().jointAngles[0], 1e-12);
+}
+
+void polylineKeepsOnlyCorners() {
+    // Ломаная с изломами в кадрах 20 и 45: RDP оставляет концы и изломы
+    Motion motion = record(71, [](int i) {
+        Angles q{};
+        q[0] = i < 20 ? i * 1.5 : (i < 45 ? 30.0 - (i - 20) * 0.8 : 10.0 + (i - 45) * 1.2);
+        q[2] = i * 0.5;
+        return q;
+    });
+    SimplifyOptions options;
+    options.fitSpline = false;
+    options.removeIdle = false;
+    SimplifyReport report;
+    Motion simplified = MotionSimplifier::simplify(motion, options, &report);
+
+    D1_CHECK(simplified.keyframeCount() == 4);
+    D1_CHECK(report.maxDeviationDeg < 1e-9);
+    D1_CHECK(simplified.totalDurationMs() == motion.totalDurationMs());
+    if (simplified.keyframeCount() == 4) {
+        D1_CHECK_NEAR(simplified.keyframes[1].jointAngles[0], 30.0, 1e-12);
+        D1_CHECK_NEAR(simplified.keyframes[2].jointAngles[0], 10.0, 1e-12);
+    }
+}
+
+void splineStaysWithinTolerance() {
+    Motion motion = record(300, [](int i) {
+        Angles q{};
+        for (int j = 0; j < MOTION_NUM_JOINTS - 1; ++j) {
+            q[j] = 40.0 * std::sin(i * 0.01 * (j + 1)) + 0.2 * std::sin(i * 1.7 + j);
+        }
+        return q;
+    });
+    SimplifyOptions options;
+    options.removeIdle = false;
+    SimplifyReport report;
+    Motion simplified = MotionSimplifier::simplify(motion, options, &report);
+
+    D1_CHECK(simplified.keyframeCount() < motion.keyframeCount() / 3);
+    D1_CHECK(report.maxDeviationDeg <= options.toleranceDeg);
+
+    // Независимо: сплайн воспроизведения через оставшиеся кадры
+    JointTrajectory trajectory;
+    std::vector<double> sourceTimes;
+    double t = 0.0;
+    for (const MotionKeyframe& kf : motion.keyframes) {
+        t += kf.transitionMs / 1000.0;
+        sourceTimes.push_back(t);
+    }
+    t = 0.0;
+    for (const MotionKeyframe& kf : simplified.keyframes) {
+        t += kf.transitionMs / 1000.0;
+        JointVector q{};
+        std::copy(kf.jointAngles.begin(), kf.jointAngles.end(), q.begin());
+        trajectory.addWaypoint(t, q, kf.stop);
+    }
+    trajectory.finalize();
+    double worst = 0.0;
+    for (int i = 0; i < motion.keyframeCount(); ++i) {
+        const JointVector q = trajectory.sample(sourceTimes[i]);
+        for (int j = 0; j < MOTION_NUM_JOINTS; ++j) {
+            worst = std::max(worst, std::abs(q[j] - motion.keyframes[i].jointAngles[j]));
+        }
+    }
+    D1_CHECK(worst <= options.toleranceDeg + 1e-9);
+    D1_CHECK_NEAR(worst, report.maxDeviationDeg, 1e-9);
+}
+
+} // namespace
+
+int main() {
+    D1_RUN(middlePauseShrinksToDwell);
+    D1_RUN(twoPausesShiftLaterFramesByBothCuts);
+    D1_RUN(slowDriftIsNotMergedIntoOnePause);
+    D1_RUN(adjacentPauseFarFromHeldPoseIsKept);
+    D1_RUN(polylineKeepsOnlyCorners);
+    D1_RUN(splineStaysWithinTolerance);
+    return d1test::result();
+}
@@ -0,0 +1,54 @@
+#ifndef D1_TEST_CHECK_H
+#define D1_TEST_CHECK_H
+
+// Проверки для модульных тестов (ctest) без отдельного фреймворка.
+//
+// Проваленная проверка печатает файл, строку и выражение и не прерывает тест;
+// D1_RUN печатает итог по каждой функции, main возвращает d1test::result().
+
+#include <cmath>
+#include <cstdio>
+
+namespace d1test {
+
+inline int& failures() {
+    static int count = 0;
+    return count;
+}
+
+inline int result() {
+    if (failures() != 0) {
+        std::printf("Провалено проверок: %d\n", failures());
+    }
+    return failures() == 0 ? 0 : 1;
+}
+
+} // namespace d1test
+
+#define D1_CHECK(condition)                                                             \
+    do {                                                                                \
+        if (!(condition)) {                                                             \
+            std::fprintf(stderr, "%s:%d: не выполнено: %s\n", __FILE__, __LINE__, #condition); \
+            ++d1test::failures();                                                       \
+        }                                                                               \
+    } while (0)
+
+#define D1_CHECK_NEAR(actual, expected, tolerance)                                      \
+    do {                                                                                \
+        const double d1CheckActual = (actual);                                          \
+        const double d1CheckExpected = (expected);                                      \
+        if (!(std::abs(d1CheckActual - d1CheckExpected) <= (tolerance))) {              \
+            std::fprintf(stderr, "%s:%d: %s = %g, ожидалось %g ± %g\n", __FILE__, __LINE__, \
+                         #actual, d1CheckActual, d1CheckExpected, static_cast<double>(tolerance)); \
+            ++d1test::failures();                                                       \
+        }                                                                               \
+    } while (0)
+
+#define D1_RUN(test)                                                                    \
+    do {                                                                                \
+        const int d1RunBefore = d1test::failures();                                     \
+        test();                                                                         \
+        std::printf("%s %s\n", d1test::failures() == d1RunBefore ? "PASS" : "FAIL", #test); \
+    } while (0)
+
+#endif // D1_TEST_CHECK_H
@@ -0,0 +1,112 @@
+// Построение карты досягаемости руки D1 (ReachabilityMap) заранее.
+//
+// Запуск: ./d1_reachability [--samples=N] [--voxel-mm=N] [--threads=N]
+//                           [--urdf=ПУТЬ] [--output=ПУТЬ]
+// По умолчанию карта пишется туда, где её ищет D1Control при запуске
+// (каталог настроек приложения). Выводит время построения, размер файла
+// и долю вокселей рабочей зоны.
+
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QString>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include "reachability_map.h"
+
+namespace {
+
+const char* optionValue(const char* arg, const char* name) {
+    const size_t length = std::strlen(name);
+    if (std::strncmp(arg, name, length) == 0 && arg[length] == '=') {
+        return arg + length + 1;
+    }
+    return nullptr;
+}
+
+bool parseNumber(const char* text, double min, double max, double& out) {
+    char* end = nullptr;
+    const double value = std::strtod(text, &end);
+    if (end == text || *end != '\0' || value < min || value > max) {
+        return false;
+    }
+    out = value;
+    return true;
+}
+
+void usage() {
+    std::fprintf(stderr,
+        "Использование: d1_reachability [--samples=N] [--voxel-mm=N] [--threads=N]\n"
+        "                               [--urdf=ПУТЬ] [--output=ПУТЬ]\n"
+        "  --samples=N     случайных конфигураций (по умолчанию 4000000)\n"
+        "  --voxel-mm=N    ребро вокселя, мм (по умолчанию 25)\n"
+        "  --threads=N     потоков (по умолчанию — по числу ядер)\n"
+        "  --urdf=ПУТЬ     описание руки (по умолчанию — из ресурсов)\n"
+        "  --output=ПУТЬ   файл карты (по умолчанию — каталог настроек D1Control)\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    // Тот же каталог настроек, что у D1Control
+    QCoreApplication::setApplicationName("D1Control");
+    QCoreApplication::setOrganizationName("Unitree");
+
+    ReachabilityBuildOptions options;
+    QString urdf = ArmKinematics::DEFAULT_URDF;
+    QString output = ReachabilityMap::defaultPath();
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = nullptr;
+        double number = 0.0;
+
+        if ((value = optionValue(arg, "--samples")) != nullptr && parseNumber(value, 1000, 1e10, number)) {
+            options.samples = static_cast<quint64>(number);
+        } else if ((value = optionValue(arg, "--voxel-mm")) != nullptr && parseNumber(value, 2, 200, number)) {
+            options.voxelSizeM = number / 1000.0;
+        } else if ((value = optionValue(arg, "--threads")) != nullptr && parseNumber(value, 1, 1024, number)) {
+            options.threads = static_cast<int>(number);
+        } else if ((value = optionValue(arg, "--urdf")) != nullptr) {
+            urdf = QString::fromLocal8Bit(value);
+        } else if ((value = optionValue(arg, "--output")) != nullptr) {
+            output = QString::fromLocal8Bit(value);
+        } else {
+            std::fprintf(stderr, "Неверный аргумент: %s\n", arg);
+            usage();
+            return 2;
+        }
+    }
+
+    ArmKinematics kinematics;
+    QString error;
+    if (!kinematics.loadUrdf(urdf, &error)) {
+        std::fprintf(stderr, "%s\n", qPrintable(error));
+        return 1;
+    }
+
+    const int threads = options.threads > 0 ? options.threads : int(std::thread::hardware_concurrency());
+    std::printf("Выборок: %llu, воксель %.0f мм, потоков: %d\n",
+                static_cast<unsigned long long>(options.samples), options.voxelSizeM * 1000.0, threads);
+
+    ReachabilityMap map;
+    auto start = std::chrono::steady_clock::now();
+    if (!ReachabilityMap::build(kinematics, options, map, &error)) {
+        std::fprintf(stderr, "%s\n", qPrintable(error));
+        return 1;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (!map.save(output, &error)) {
+        std::fprintf(stderr, "%s\n", qPrintable(error));
+        return 1;
+    }
+
+    std::printf("Построено за %.2f с (%.1f млн выборок/с)\n", seconds, options.samples / seconds / 1e6);
+    std::printf("Вокселей в зоне: %u из %u, углов для IK: %u\n",
+                map.reachableVoxels(), map.voxelCount(), map.seedCount());
+    std::printf("Файл: %s (%.1f МБ)\n", qPrintable(output), QFileInfo(output).size() / 1048576.0);
+    return 0;
+}
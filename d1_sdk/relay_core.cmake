@@ -0,0 +1,28 @@
+# Библиотека d1_relay_core: ядро моста DDS (подписки на руку + очередь команд).
+# Подключается через include() из d1_sdk (udp_relay) и из d1_control
+# (опция D1_WITH_RELAY_CORE), поэтому пути считаются от этого файла.
+
+if(NOT TARGET d1_relay_core)
+    set(D1_SDK_DIR ${CMAKE_CURRENT_LIST_DIR})
+
+    add_library(d1_relay_core STATIC
+        ${D1_SDK_DIR}/src/relay_core.cpp
+        ${D1_SDK_DIR}/src/msg/ArmString_.cpp
+        ${D1_SDK_DIR}/src/msg/PubServoInfo_.cpp
+    )
+
+    set_target_properties(d1_relay_core PROPERTIES POSITION_INDEPENDENT_CODE ON)
+    target_compile_features(d1_relay_core PUBLIC cxx_std_17)
+
+    target_include_directories(d1_relay_core
+        PUBLIC
+            ${D1_SDK_DIR}/src
+            ${D1_SDK_DIR}/../d1_common/include
+        PRIVATE
+            /usr/local/include
+            /usr/local/include/ddscxx
+    )
+
+    target_link_directories(d1_relay_core PUBLIC /usr/local/lib)
+    target_link_libraries(d1_relay_core PUBLIC unitree_sdk2 ddsc ddscxx pthread)
+endif()
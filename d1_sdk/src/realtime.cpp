@@ -0,0 +1,321 @@
+#include "realtime.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace d1 {
+namespace rt {
+
+namespace {
+
+constexpr size_t PREFAULT_STACK_BYTES = 128 * 1024;
+constexpr size_t PREFAULT_HEAP_BYTES = 8 * 1024 * 1024;
+
+bool parseInt(const char* text, int minValue, int maxValue, int& out) {
+    char* end = nullptr;
+    errno = 0;
+    long value = std::strtol(text, &end, 10);
+    if (errno != 0 || end == text || *end != '\0' || value < minValue || value > maxValue) {
+        return false;
+    }
+    out = static_cast<int>(value);
+    return true;
+}
+
+bool parseCpuList(const char* text, std::vector<int>& cpus) {
+    cpus.clear();
+    std::stringstream ss(text);
+    std::string item;
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    while (std::getline(ss, item, ',')) {
+        int cpu = 0;
+        if (!parseInt(item.c_str(), 0, online > 0 ? static_cast<int>(online) - 1 : 1023, cpu)) {
+            return false;
+        }
+        cpus.push_back(cpu);
+    }
+    return !cpus.empty();
+}
+
+// Значение аргумента вида --key=value; nullptr — аргумент другой
+const char* optionValue(const char* arg, const char* key) {
+    size_t length = std::strlen(key);
+    if (std::strncmp(arg, key, length) != 0) {
+        return nullptr;
+    }
+    if (arg[length] == '=') {
+        return arg + length + 1;
+    }
+    return arg[length] == '\0' ? "" : nullptr;
+}
+
+// Касаемся страниц стека заранее, чтобы первый вызов в RT-пути не ловил page fault
+__attribute__((noinline)) void prefaultStack() {
+    volatile unsigned char buffer[PREFAULT_STACK_BYTES];
+    for (size_t i = 0; i < PREFAULT_STACK_BYTES; i += 4096) {
+        buffer[i] = 0;
+    }
+    (void)buffer[0];
+}
+
+const char* threadName(ThreadRole role) {
+    switch (role) {
+        case ThreadRole::CommandRx: return "d1-cmd-rx";
+        case ThreadRole::Publisher: return "d1-publisher";
+        case ThreadRole::ShmCommands: return "d1-shm-cmd";
+        case ThreadRole::FeedbackSender: return "d1-feedback";
+        default: return nullptr;   // Потоки DDS сохраняют свои имена
+    }
+}
+
+std::string errnoText(int err) {
+    if (err == EPERM) {
+        return "нет прав (нужен CAP_SYS_NICE или 'ulimit -r')";
+    }
+    return std::strerror(err);
+}
+
+uint64_t nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+} // namespace
+
+bool parseArgs(int argc, char** argv, Config& config, std::string& error) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = nullptr;
+
+        if (std::strcmp(arg, "--realtime") == 0) {
+            config.enabled = true;
+        } else if (std::strcmp(arg, "--no-mlock") == 0) {
+            config.lockMemory = false;
+        } else if ((value = optionValue(arg, "--rt-prio")) != nullptr) {
+            if (!parseInt(value, 1, 99, config.priority)) {
+                error = std::string("неверный приоритет: ") + arg + " (1..99)";
+                return false;
+            }
+        } else if ((value = optionValue(arg, "--rt-cpus")) != nullptr) {
+            if (!parseCpuList(value, config.cpus)) {
+                error = std::string("неверный список ядер: ") + arg;
+                return false;
+            }
+        } else if ((value = optionValue(arg, "--jitter-test")) != nullptr) {
+            config.jitterTestSeconds = 10;
+            if (*value && !parseInt(value, 1, 3600, config.jitterTestSeconds)) {
+                error = std::string("неверная длительность: ") + arg;
+                return false;
+            }
+        } else if ((value = optionValue(arg, "--jitter-period-us")) != nullptr) {
+            if (!parseInt(value, 50, 1000000, config.jitterPeriodUs)) {
+                error = std::string("неверный период: ") + arg + " (50..1000000 мкс)";
+                return false;
+            }
+        } else {
+            error = std::string("неизвестный аргумент: ") + arg;
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string usage() {
+    return "Использование: udp_relay [--realtime] [--rt-prio=N] [--rt-cpus=2,3] [--no-mlock]\n"
+           "                         [--jitter-test[=сек]] [--jitter-period-us=N]\n"
+           "  --realtime          SCHED_FIFO для потоков relay, mlockall, предотображение стеков\n"
+           "  --rt-prio=N         приоритет командного пути (1..99, по умолчанию 80)\n"
+           "  --rt-cpus=LIST      закрепить потоки relay за ядрами (через запятую)\n"
+           "  --no-mlock          не блокировать память процесса\n"
+           "  --jitter-test[=S]   самотест джиттера цикла (по умолчанию 10 с) и выход\n"
+           "  --jitter-period-us  период цикла самотеста (по умолчанию 1000 мкс)\n";
+}
+
+bool lockProcessMemory(std::string& error) {
+#if defined(__GLIBC__)
+    // Куча не возвращается системе и не уходит в отдельные mmap — иначе
+    // освобождённые и заново выделенные страницы снова приводят к page fault
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+#endif
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        int err = errno;
+        error = (err == EPERM || err == ENOMEM)
+            ? "mlockall: нет прав или мал лимит (нужен CAP_IPC_LOCK или 'ulimit -l unlimited')"
+            : std::string("mlockall: ") + std::strerror(err);
+        return false;
+    }
+
+    // Предотображаем кучу: последующие выделения берут уже закреплённые страницы
+    char* heap = static_cast<char*>(std::malloc(PREFAULT_HEAP_BYTES));
+    if (heap) {
+        long page = sysconf(_SC_PAGESIZE);
+        for (size_t i = 0; i < PREFAULT_HEAP_BYTES; i += static_cast<size_t>(page > 0 ? page : 4096)) {
+            heap[i] = 0;
+        }
+        std::free(heap);
+    }
+    return true;
+}
+
+const char* roleName(ThreadRole role) {
+    switch (role) {
+        case ThreadRole::CommandRx: return "приём команд";
+        case ThreadRole::Publisher: return "публикация DDS";
+        case ThreadRole::DdsCallback: return "callback DDS";
+        case ThreadRole::ShmCommands: return "команды shm";
+        case ThreadRole::FeedbackSender: return "рассылка feedback";
+    }
+    return "";
+}
+
+int rolePriority(const Config& config, ThreadRole role) {
+    // Командный путь — выше всех; feedback терпит задержку лучше команд
+    int offset = 0;
+    switch (role) {
+        case ThreadRole::CommandRx: offset = 0; break;
+        case ThreadRole::Publisher: offset = 0; break;
+        case ThreadRole::DdsCallback: offset = -1; break;
+        case ThreadRole::ShmCommands: offset = -2; break;
+        case ThreadRole::FeedbackSender: offset = -10; break;
+    }
+    int minPriority = sched_get_priority_min(SCHED_FIFO);
+    int maxPriority = sched_get_priority_max(SCHED_FIFO);
+    return std::max(minPriority, std::min(maxPriority, config.priority + offset));
+}
+
+bool configureCurrentThread(const Config& config, ThreadRole role, std::string& error) {
+#if defined(__linux__)
+    if (const char* name = threadName(role)) {
+        pthread_setname_np(pthread_self(), name);
+    }
+#endif
+    if (!config.enabled) {
+        return true;
+    }
+
+    bool ok = true;
+
+    struct sched_param param;
+    std::memset(&param, 0, sizeof(param));
+    param.sched_priority = rolePriority(config, role);
+    int rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (rc != 0) {
+        error = std::string("SCHED_FIFO ") + std::to_string(param.sched_priority) + ": " + errnoText(rc);
+        ok = false;
+    }
+
+#if defined(__linux__)
+    if (!config.cpus.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : config.cpus) {
+            CPU_SET(cpu, &set);
+        }
+        rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (rc != 0) {
+            error += (error.empty() ? "" : "; ") + std::string("привязка к ядрам: ") + std::strerror(rc);
+            ok = false;
+        }
+    }
+#endif
+
+    prefaultStack();
+    return ok;
+}
+
+JitterStats runJitterTest(int periodUs, int durationSeconds) {
+    JitterStats stats;
+    const uint64_t periodNs = static_cast<uint64_t>(periodUs) * 1000ULL;
+    const uint64_t iterations = static_cast<uint64_t>(durationSeconds) * 1000000ULL / static_cast<uint64_t>(periodUs);
+
+    // Буфер выделяется до цикла: внутри только часы и сон
+    std::vector<uint32_t> latenessNs;
+    latenessNs.reserve(iterations);
+
+    double periodSum = 0.0;
+    double periodSqSum = 0.0;
+    double periodMin = 1e18;
+    double periodMax = 0.0;
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    uint64_t previousWake = nowNs();
+
+    for (uint64_t i = 0; i < iterations; ++i) {
+        deadline.tv_nsec += static_cast<long>(periodNs);
+        while (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_nsec -= 1000000000L;
+            deadline.tv_sec++;
+        }
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR) {
+        }
+
+        uint64_t wake = nowNs();
+        uint64_t deadlineNs = static_cast<uint64_t>(deadline.tv_sec) * 1000000000ULL
+                            + static_cast<uint64_t>(deadline.tv_nsec);
+        uint64_t lateness = wake > deadlineNs ? wake - deadlineNs : 0;
+        latenessNs.push_back(static_cast<uint32_t>(std::min<uint64_t>(lateness, UINT32_MAX)));
+        if (lateness > periodNs) {
+            stats.missedDeadlines++;
+        }
+
+        double period = static_cast<double>(wake - previousWake) / 1000.0;
+        previousWake = wake;
+        periodSum += period;
+        periodSqSum += period * period;
+        periodMin = std::min(periodMin, period);
+        periodMax = std::max(periodMax, period);
+    }
+
+    stats.iterations = latenessNs.size();
+    if (stats.iterations == 0) {
+        return stats;
+    }
+
+    double n = static_cast<double>(stats.iterations);
+    stats.periodMinUs = periodMin;
+    stats.periodMaxUs = periodMax;
+    stats.periodMeanUs = periodSum / n;
+    stats.periodStdDevUs = std::sqrt(std::max(0.0, periodSqSum / n - stats.periodMeanUs * stats.periodMeanUs));
+
+    std::sort(latenessNs.begin(), latenessNs.end());
+    auto percentile = [&latenessNs](double p) {
+        size_t index = static_cast<size_t>(p * static_cast<double>(latenessNs.size() - 1));
+        return latenessNs[index] / 1000.0;
+    };
+    stats.latenessP50Us = percentile(0.50);
+    stats.latenessP99Us = percentile(0.99);
+    stats.latenessMaxUs = latenessNs.back() / 1000.0;
+    return stats;
+}
+
+std::string formatJitter(const JitterStats& stats, int periodUs) {
+    char buffer[512];
+    std::snprintf(buffer, sizeof(buffer),
+                  "[RT] Самотест: %llu итераций, период %d мкс\n"
+                  "[RT]   период: мин %.1f / среднее %.1f / макс %.1f мкс, СКО %.1f мкс\n"
+                  "[RT]   опоздание пробуждения: p50 %.1f / p99 %.1f / макс %.1f мкс\n"
+                  "[RT]   пропущено дедлайнов: %llu",
+                  static_cast<unsigned long long>(stats.iterations), periodUs,
+                  stats.periodMinUs, stats.periodMeanUs, stats.periodMaxUs, stats.periodStdDevUs,
+                  stats.latenessP50Us, stats.latenessP99Us, stats.latenessMaxUs,
+                  static_cast<unsigned long long>(stats.missedDeadlines));
+    return buffer;
+}
+
+} // namespace rt
+} // namespace d1
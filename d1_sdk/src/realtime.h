@@ -0,0 +1,76 @@
+#ifndef D1_REALTIME_H
+#define D1_REALTIME_H
+
+// Режим реального времени для udp_relay (--realtime).
+//
+// Потоки relay получают SCHED_FIFO с приоритетом по роли, закрепляются
+// за выбранными ядрами, память процесса блокируется (mlockall), стек
+// каждого потока заранее отображается. Без прав (CAP_SYS_NICE / rtprio,
+// memlock) relay продолжает работать в обычном режиме и сообщает, чего
+// не хватило.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace d1 {
+namespace rt {
+
+enum class ThreadRole {
+    CommandRx,       // Приём команд GUI (UDP)
+    Publisher,       // Публикация команд в DDS
+    DdsCallback,     // Потоки CycloneDDS, вызывающие обработчики
+    ShmCommands,     // Опрос кольца команд в разделяемой памяти
+    FeedbackSender   // Рассылка feedback подписчикам
+};
+
+struct Config {
+    bool enabled = false;
+    int priority = 80;              // Приоритет командного пути; остальные роли ниже
+    std::vector<int> cpus;          // Пусто — без закрепления
+    bool lockMemory = true;
+    int jitterTestSeconds = 0;      // > 0 — только самотест джиттера и выход
+    int jitterPeriodUs = 1000;
+};
+
+// Разбор аргументов командной строки:
+//   --realtime  --rt-prio=N  --rt-cpus=2,3  --no-mlock
+//   --jitter-test[=секунды]  --jitter-period-us=N
+// false — неизвестный аргумент или неверное значение (текст в error)
+bool parseArgs(int argc, char** argv, Config& config, std::string& error);
+
+std::string usage();
+
+// mlockall(MCL_CURRENT | MCL_FUTURE) и предотображение кучи
+bool lockProcessMemory(std::string& error);
+
+// Применяет политику к текущему потоку: имя, SCHED_FIFO, привязка к ядрам,
+// предотображение стека. При отключённом режиме только задаёт имя потока.
+// false — что-то не применилось (текст в error), поток продолжает работу.
+bool configureCurrentThread(const Config& config, ThreadRole role, std::string& error);
+
+const char* roleName(ThreadRole role);
+int rolePriority(const Config& config, ThreadRole role);
+
+struct JitterStats {
+    uint64_t iterations = 0;
+    uint64_t missedDeadlines = 0;   // Просыпание позже следующего периода
+    double periodMinUs = 0.0;
+    double periodMeanUs = 0.0;
+    double periodMaxUs = 0.0;
+    double periodStdDevUs = 0.0;
+    double latenessP50Us = 0.0;
+    double latenessP99Us = 0.0;
+    double latenessMaxUs = 0.0;
+};
+
+// Цикл с абсолютными дедлайнами (clock_nanosleep) в текущем потоке:
+// отклонение периода и опоздание пробуждения относительно дедлайна
+JitterStats runJitterTest(int periodUs, int durationSeconds);
+
+std::string formatJitter(const JitterStats& stats, int periodUs);
+
+} // namespace rt
+} // namespace d1
+
+#endif // D1_REALTIME_H
@@ -0,0 +1,453 @@
+#include "relay_core.h"
+#include <exception>
+#include <thread>
+#include <atomic>
+#include <cstring>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <algorithm>
+#include <unitree/robot/channel/channel_publisher.hpp>
+#include <unitree/robot/channel/channel_subscriber.hpp>
+#include "msg/ArmString_.hpp"
+#include "msg/PubServoInfo_.hpp"
+#include "async_log.h"
+
+#define CMD_TOPIC "rt/arm_Command"
+#define FEEDBACK_TOPIC "rt/arm_Feedback"
+#define SERVO_TOPIC "current_servo_angle"
+
+using namespace unitree::robot;
+
+namespace d1 {
+
+namespace {
+
+// Категории логгера: журнал TX ограничен, чтобы поток команд 50 Гц не забивал вывод
+const int LOG_TX = log::category("TX", 20);
+const int LOG_CMD = log::category("CMD");
+const int LOG_ERROR = log::category("ERROR");
+const int LOG_DDS = log::category("DDS");
+
+// ==================== Коалесцирующая очередь команд ====================
+//
+// Вместо sleep в цикле приёма команды раскладываются по ячейкам
+// "последний писатель побеждает": funcode 1 — по суставу, остальные — по funcode.
+// Поток публикации раз в тик отправляет только актуальные цели, устаревшие
+// промежуточные значения отбрасываются. Питание (funcode 5) идёт вне очереди.
+
+constexpr int CMD_NUM_JOINTS = 7;
+constexpr int CMD_MAX_FUNCODE = 16;
+constexpr int CMD_MAILBOX_SLOTS = CMD_NUM_JOINTS + CMD_MAX_FUNCODE;
+constexpr int FUNCODE_JOINT = 1;
+constexpr int FUNCODE_ALL_JOINTS = 2;
+constexpr int FUNCODE_POWER = 5;
+
+struct CommandSlot {
+    std::string json;
+    uint64_t stamp = 0;   // Порядок поступления
+    bool dirty = false;
+};
+
+struct CommandHeader {
+    int funcode = -1;
+    int id = -1;
+    int mode = -1;
+};
+
+// Быстрое извлечение целого поля "key":value без полного разбора JSON
+bool FindIntField(const std::string& data, const char* key, int& value) {
+    size_t pos = data.find(key);
+    if (pos == std::string::npos) return false;
+    pos += std::strlen(key);
+    while (pos < data.size() && (data[pos] == ' ' || data[pos] == '\t')) pos++;
+    bool negative = pos < data.size() && data[pos] == '-';
+    if (negative) pos++;
+    if (pos >= data.size() || data[pos] < '0' || data[pos] > '9') return false;
+    int result = 0;
+    while (pos < data.size() && data[pos] >= '0' && data[pos] <= '9') {
+        result = result * 10 + (data[pos] - '0');
+        pos++;
+    }
+    value = negative ? -result : result;
+    return true;
+}
+
+CommandHeader ParseCommandHeader(const std::string& json) {
+    CommandHeader header;
+    FindIntField(json, "\"funcode\":", header.funcode);
+    FindIntField(json, "\"id\":", header.id);
+    FindIntField(json, "\"mode\":", header.mode);
+    return header;
+}
+
+// ChannelFactory — синглтон SDK, инициализируется один раз на процесс
+std::once_flag dds_init_flag;
+
+} // namespace
+
+struct RelayCore::Impl {
+    SampleHandler handler;
+
+    std::unique_ptr<ChannelPublisher<unitree_arm::msg::dds_::ArmString_>> publisher;
+    std::unique_ptr<ChannelSubscriber<unitree_arm::msg::dds_::ArmString_>> feedbackSub;
+    std::unique_ptr<ChannelSubscriber<unitree_arm::msg::dds_::PubServoInfo_>> servoSub;
+
+    // Статус руки
+    std::atomic<int> errorStatus{0};
+    uint32_t feedbackSeq = 0;  // Пишется только из callback-потока DDS
+
+    // Очередь команд
+    std::mutex cmdMutex;
+    std::condition_variable cmdCv;
+    CommandSlot mailbox[CMD_MAILBOX_SLOTS];
+    std::deque<std::string> priority;   // Питание / аварийная остановка
+    std::deque<std::string> other;      // Неизвестные funcode — без слияния
+    int dirtyCount = 0;
+    uint64_t stamp = 0;
+
+    std::thread publisherThread;
+    std::atomic<bool> running{false};
+
+    std::atomic<uint64_t> samples{0};
+    std::atomic<uint64_t> received{0};
+    std::atomic<uint64_t> coalesced{0};
+    std::atomic<uint64_t> published{0};
+
+    ThreadHook threadHook;
+
+    void enterDdsThread();
+    bool failStart(const char* stage, const char* what);
+    void servoHandler(const void* message);
+    void feedbackHandler(const void* message);
+    void submit(std::string json);
+    void publish(const std::string& json);
+    void publisherLoop();
+};
+
+// Потоки callback создаёт CycloneDDS, поэтому настраиваем их при первом вызове
+void RelayCore::Impl::enterDdsThread() {
+    thread_local bool entered = false;
+    if (!entered) {
+        entered = true;
+        if (threadHook) {
+            threadHook(RelayThread::DdsCallback);
+        }
+    }
+}
+
+// Обработчик углов серво (PubServoInfo_).
+// Выполняется в потоке DDS: только формирует выборку и отдаёт её транспорту.
+void RelayCore::Impl::servoHandler(const void* message) {
+    enterDdsThread();
+
+    const unitree_arm::msg::dds_::PubServoInfo_* msg =
+        (const unitree_arm::msg::dds_::PubServoInfo_*)message;
+
+    // ИСПРАВЛЕНИЕ: Если получаем данные об углах, считаем что связь есть
+    // и моторы активны (power_status не всегда приходит в feedback)
+    FeedbackSample sample;
+    sample.seq = ++feedbackSeq;
+    sample.timestampNs = monotonicNs();
+    sample.powerStatus = 1;
+    sample.errorStatus = errorStatus.load(std::memory_order_relaxed);
+    sample.angles[0] = msg->servo0_data_();
+    sample.angles[1] = msg->servo1_data_();
+    sample.angles[2] = msg->servo2_data_();
+    sample.angles[3] = msg->servo3_data_();
+    sample.angles[4] = msg->servo4_data_();
+    sample.angles[5] = msg->servo5_data_();
+    sample.angles[6] = msg->servo6_data_();
+
+    samples.fetch_add(1, std::memory_order_relaxed);
+    if (handler) {
+        handler(sample);
+    }
+}
+
+// Обработчик статуса (ArmString_)
+void RelayCore::Impl::feedbackHandler(const void* message) {
+    enterDdsThread();
+
+    const unitree_arm::msg::dds_::ArmString_* msg =
+        (const unitree_arm::msg::dds_::ArmString_*)message;
+    std::string data = msg->data_();
+
+    // НЕ парсим power_status здесь — он управляется только в servoHandler
+    // на основе получения данных об углах
+
+    // Парсим только error_status
+    size_t pos = data.find("\"error_status\":");
+    if (pos != std::string::npos) {
+        pos += 15;
+        int status = 0;
+        while (pos < data.size() && (data[pos] == ' ' || data[pos] == '\t')) pos++;
+        while (pos < data.size() && data[pos] >= '0' && data[pos] <= '9') {
+            status = status * 10 + (data[pos] - '0');
+            pos++;
+        }
+        if (errorStatus != status) {
+            errorStatus = status;
+            D1_LOG_WARN(LOG_ERROR, "error_status=%d", status);
+        }
+    }
+
+    // НЕ отдаём транспорту — только servoHandler формирует выборки
+}
+
+// Вызывается из потоков приёма: никогда не блокируется на DDS
+void RelayCore::Impl::submit(std::string json) {
+    CommandHeader header = ParseCommandHeader(json);
+    received++;
+
+    {
+        std::lock_guard<std::mutex> lock(cmdMutex);
+
+        if (header.funcode == FUNCODE_POWER) {
+            // Отключение питания отменяет все ещё не отправленные цели движения
+            if (header.mode == 0) {
+                for (CommandSlot& slot : mailbox) {
+                    if (slot.dirty) {
+                        slot.dirty = false;
+                        coalesced++;
+                    }
+                }
+                dirtyCount = 0;
+            }
+            priority.push_back(std::move(json));
+        } else if (header.funcode < 0 || header.funcode >= CMD_MAX_FUNCODE) {
+            other.push_back(std::move(json));
+        } else {
+            int index;
+            if (header.funcode == FUNCODE_JOINT && header.id >= 0 && header.id < CMD_NUM_JOINTS) {
+                index = header.id;
+            } else {
+                index = CMD_NUM_JOINTS + header.funcode;
+            }
+
+            // Цель для всей руки заменяет ещё не отправленные цели отдельных суставов
+            if (header.funcode == FUNCODE_ALL_JOINTS) {
+                for (int i = 0; i < CMD_NUM_JOINTS; ++i) {
+                    if (mailbox[i].dirty) {
+                        mailbox[i].dirty = false;
+                        dirtyCount--;
+                        coalesced++;
+                    }
+                }
+            }
+
+            CommandSlot& slot = mailbox[index];
+            if (slot.dirty) {
+                coalesced++;
+            } else {
+                dirtyCount++;
+            }
+            slot.json = std::move(json);
+            slot.stamp = ++stamp;
+            slot.dirty = true;
+        }
+    }
+    cmdCv.notify_one();
+}
+
+void RelayCore::Impl::publish(const std::string& json) {
+    unitree_arm::msg::dds_::ArmString_ msg;
+    msg.data_() = json;
+    publisher->Write(msg);
+    published++;
+
+    D1_LOG_INFO(LOG_TX, "%.80s...", json.c_str());
+}
+
+// Поток публикации команд в DDS
+void RelayCore::Impl::publisherLoop() {
+    if (threadHook) {
+        threadHook(RelayThread::Publisher);
+    }
+
+    std::deque<std::string> urgent;
+    std::vector<CommandSlot> batch;
+    batch.reserve(CMD_MAILBOX_SLOTS);
+    std::deque<std::string> others;
+
+    auto next_tick = std::chrono::steady_clock::now();
+    auto next_stats = next_tick + std::chrono::seconds(10);
+    uint64_t last_received = 0;
+
+    while (true) {
+        bool stopping;
+        {
+            std::unique_lock<std::mutex> lock(cmdMutex);
+            cmdCv.wait(lock, [this] {
+                return !priority.empty() || dirtyCount > 0 || !other.empty() || !running;
+            });
+
+            // Пока не наступил тик, просыпаемся только ради приоритетных команд
+            if (priority.empty() && running) {
+                cmdCv.wait_until(lock, next_tick, [this] { return !priority.empty() || !running; });
+            }
+
+            stopping = !running;
+            urgent.swap(priority);
+
+            // При остановке отбрасываем цели движения: уходят только питание/стоп
+            if (!stopping && std::chrono::steady_clock::now() >= next_tick) {
+                for (CommandSlot& slot : mailbox) {
+                    if (slot.dirty) {
+                        batch.push_back(CommandSlot{std::move(slot.json), slot.stamp, true});
+                        slot.dirty = false;
+                    }
+                }
+                dirtyCount = 0;
+                others.swap(other);
+            }
+        }
+
+        // Строгий приоритет: питание и аварийная остановка уходят первыми
+        for (const std::string& json : urgent) {
+            publish(json);
+        }
+        urgent.clear();
+
+        if (stopping) {
+            return;
+        }
+
+        if (!batch.empty() || !others.empty()) {
+            std::sort(batch.begin(), batch.end(), [](const CommandSlot& a, const CommandSlot& b) {
+                return a.stamp < b.stamp;
+            });
+            for (const CommandSlot& slot : batch) {
+                publish(slot.json);
+            }
+            for (const std::string& json : others) {
+                publish(json);
+            }
+            batch.clear();
+            others.clear();
+            next_tick = std::chrono::steady_clock::now() + std::chrono::milliseconds(COMMAND_TICK_MS);
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now >= next_stats) {
+            next_stats = now + std::chrono::seconds(10);
+            if (received != last_received) {
+                last_received = received;
+                D1_LOG_INFO(LOG_CMD, "принято=%llu отброшено устаревших=%llu отправлено=%llu",
+                            static_cast<unsigned long long>(received.load()),
+                            static_cast<unsigned long long>(coalesced.load()),
+                            static_cast<unsigned long long>(published.load()));
+            }
+        }
+    }
+}
+
+// Частично созданные каналы освобождаются: следующий start() начнёт заново
+bool RelayCore::Impl::failStart(const char* stage, const char* what) {
+    D1_LOG_ERROR(LOG_DDS, "%s: %s", stage, what);
+    servoSub.reset();
+    feedbackSub.reset();
+    publisher.reset();
+    return false;
+}
+
+// ==================== RelayCore ====================
+
+RelayCore::RelayCore(SampleHandler handler)
+    : m_impl(new Impl)
+{
+    m_impl->handler = std::move(handler);
+}
+
+RelayCore::~RelayCore() {
+    stop();
+}
+
+void RelayCore::setThreadHook(ThreadHook hook) {
+    m_impl->threadHook = std::move(hook);
+}
+
+bool RelayCore::start(int domainId, const std::string& networkInterface) {
+    if (m_impl->running) {
+        return true;
+    }
+
+    Impl* impl = m_impl.get();
+
+    // SDK сообщает об ошибках (нет интерфейса, не создаётся участник DDS)
+    // исключениями: наружу — только false, чтобы вызывающий выбрал другой транспорт.
+    // call_once после исключения не считается выполненным — следующий start() повторит Init.
+    const char* stage = "ChannelFactory::Init";
+    try {
+        std::call_once(dds_init_flag, [domainId, &networkInterface]() {
+            ChannelFactory::Instance()->Init(domainId, networkInterface);
+        });
+
+        // Publisher для команд роботу
+        stage = CMD_TOPIC;
+        impl->publisher.reset(new ChannelPublisher<unitree_arm::msg::dds_::ArmString_>(CMD_TOPIC));
+        impl->publisher->InitChannel();
+        D1_LOG_INFO(LOG_DDS, "Publisher: %s", CMD_TOPIC);
+
+        // Subscriber для статуса
+        stage = FEEDBACK_TOPIC;
+        impl->feedbackSub.reset(new ChannelSubscriber<unitree_arm::msg::dds_::ArmString_>(FEEDBACK_TOPIC));
+        impl->feedbackSub->InitChannel([impl](const void* message) { impl->feedbackHandler(message); });
+        D1_LOG_INFO(LOG_DDS, "Subscriber: %s", FEEDBACK_TOPIC);
+
+        // Subscriber для углов суставов
+        stage = SERVO_TOPIC;
+        impl->servoSub.reset(new ChannelSubscriber<unitree_arm::msg::dds_::PubServoInfo_>(SERVO_TOPIC));
+        impl->servoSub->InitChannel([impl](const void* message) { impl->servoHandler(message); });
+        D1_LOG_INFO(LOG_DDS, "Subscriber: %s", SERVO_TOPIC);
+    } catch (const std::exception& e) {
+        return impl->failStart(stage, e.what());
+    } catch (...) {
+        return impl->failStart(stage, "неизвестное исключение SDK");
+    }
+
+    // Поток публикации команд (коалесцирующая очередь)
+    impl->running = true;
+    impl->publisherThread = std::thread(&Impl::publisherLoop, impl);
+    return true;
+}
+
+void RelayCore::stop() {
+    if (!m_impl->running) {
+        return;
+    }
+
+    // Сначала перестаём получать выборки, затем дописываем приоритетные команды
+    m_impl->servoSub->CloseChannel();
+    m_impl->feedbackSub->CloseChannel();
+
+    {
+        std::lock_guard<std::mutex> lock(m_impl->cmdMutex);
+        m_impl->running = false;
+    }
+    m_impl->cmdCv.notify_one();
+    if (m_impl->publisherThread.joinable()) {
+        m_impl->publisherThread.join();
+    }
+}
+
+bool RelayCore::isRunning() const {
+    return m_impl->running;
+}
+
+void RelayCore::submitCommand(std::string json) {
+    m_impl->submit(std::move(json));
+}
+
+RelayStats RelayCore::stats() const {
+    RelayStats s;
+    s.samples = m_impl->samples.load(std::memory_order_relaxed);
+    s.commandsReceived = m_impl->received.load(std::memory_order_relaxed);
+    s.commandsCoalesced = m_impl->coalesced.load(std::memory_order_relaxed);
+    s.commandsPublished = m_impl->published.load(std::memory_order_relaxed);
+    return s;
+}
+
+} // namespace d1
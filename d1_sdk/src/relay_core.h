@@ -0,0 +1,75 @@
+#ifndef D1_RELAY_CORE_H
+#define D1_RELAY_CORE_H
+
+// Ядро моста DDS: подписка на углы/статус руки и публикация команд
+// через коалесцирующую очередь. Не знает ни про UDP, ни про разделяемую
+// память — транспорт подключается обработчиком выборок.
+//
+// Используется udp_relay и (опционально, D1_WITH_RELAY_CORE) напрямую D1Control.
+// Заголовок не тянет Unitree SDK, поэтому его можно включать из Qt-кода.
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include "d1_protocol.h"
+
+namespace d1 {
+
+struct RelayStats {
+    uint64_t samples = 0;
+    uint64_t commandsReceived = 0;
+    uint64_t commandsCoalesced = 0;
+    uint64_t commandsPublished = 0;
+};
+
+// Потоки ядра, о которых сообщает ThreadHook
+enum class RelayThread {
+    Publisher,     // Поток публикации команд
+    DdsCallback    // Поток CycloneDDS, вызвавший обработчик подписки
+};
+
+class RelayCore {
+public:
+    // Вызывается в потоке DDS для каждой выборки углов: не должен блокироваться
+    using SampleHandler = std::function<void(const FeedbackSample&)>;
+
+    // Вызывается один раз в каждом потоке ядра до его основной работы
+    // (для потоков DDS — при первом callback): приоритет, привязка к ядрам
+    using ThreadHook = std::function<void(RelayThread)>;
+
+    explicit RelayCore(SampleHandler handler);
+    ~RelayCore();
+
+    RelayCore(const RelayCore&) = delete;
+    RelayCore& operator=(const RelayCore&) = delete;
+
+    // Задаётся до start()
+    void setThreadHook(ThreadHook hook);
+
+    // Инициализация DDS (один раз на процесс), подписчики и поток публикации.
+    // Пустой networkInterface — выбор CycloneDDS (cyclonedds.xml / по умолчанию).
+    bool start(int domainId = 0, const std::string& networkInterface = std::string());
+
+    // Останавливает поток публикации, предварительно отправив приоритетные команды
+    void stop();
+
+    bool isRunning() const;
+
+    // Команда в формате JSON ({"seq":..,"address":1,"funcode":..,"data":{..}}).
+    // Не блокируется на DDS: кладётся в очередь, публикуется раз в тик.
+    void submitCommand(std::string json);
+
+    RelayStats stats() const;
+
+    // Период публикации команд = граница задержки команды
+    static constexpr int COMMAND_TICK_MS = 20;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+} // namespace d1
+
+#endif // D1_RELAY_CORE_H
@@ -4,117 +4,375 @@
 #include <atomic>
 #include <cstring>
 #include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <vector>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
-#include <sstream>
-#include <iomanip>
-#include <unitree/robot/channel/channel_publisher.hpp>
-#include <unitree/robot/channel/channel_subscriber.hpp>
-#include "msg/ArmString_.hpp"
-#include "msg/PubServoInfo_.hpp"
+#include <poll.h>
+#include <cerrno>
+#include <cstdio>
+#include <csignal>
+#include "relay_core.h"
+#include "d1_protocol.h"
+#include "spsc_ring.h"
+#include "shm_channel.h"
+#include "async_log.h"
+#include "realtime.h"
 
 #define UDP_CMD_PORT 8888       // Порт для приема команд ОТ GUI
 #define UDP_FEEDBACK_PORT 8889  // Порт для отправки данных В GUI
-#define CMD_TOPIC "rt/arm_Command"
-#define FEEDBACK_TOPIC "rt/arm_Feedback"
-#define SERVO_TOPIC "current_servo_angle"
 
-using namespace unitree::robot;
-
-// Сокет для отправки данных в GUI
+// Сокет для отправки feedback подписчикам
 int gui_sock;
-struct sockaddr_in gui_addr;
 
-// Последние значения углов
-std::atomic<double> servo_angles[7] = {0, 0, 0, 0, 0, 0, 0};
-std::atomic<int> power_status{0};
-std::atomic<int> error_status{0};
+// Категории асинхронного логгера: потоки отправки и приёма не пишут в консоль сами
+const int LOG_SERVO = d1::log::category("SERVO", 10);
+const int LOG_SUB = d1::log::category("SUB", 20);
+const int LOG_SHM = d1::log::category("SHM");
+const int LOG_RT = d1::log::category("RT");
+
+// Режим реального времени (--realtime): заполняется в main() до запуска потоков
+d1::rt::Config rt_config;
+
+// Вызывается первым делом в каждом потоке relay
+void ApplyThreadPolicy(d1::rt::ThreadRole role) {
+    std::string error;
+    if (d1::rt::configureCurrentThread(rt_config, role, error)) {
+        if (rt_config.enabled) {
+            D1_LOG_INFO(LOG_RT, "%s: SCHED_FIFO %d", d1::rt::roleName(role), d1::rt::rolePriority(rt_config, role));
+        }
+    } else {
+        D1_LOG_WARN(LOG_RT, "%s: %s — поток работает с обычным приоритетом", d1::rt::roleName(role), error.c_str());
+    }
+}
+
+// Ядро DDS: подписки и очередь команд (relay_core.cpp), создаётся в main()
+d1::RelayCore* relay_core = nullptr;
+
+// Выборки от DDS callback к потоку отправки
+constexpr size_t SERVO_RING_SIZE = 1024;
+constexpr size_t SENDER_BATCH = 32;
+constexpr size_t JSON_FRAME_MAX = 512;
+constexpr int SENDER_IDLE_WAIT_MS = 2;   // Страховка от потерянного пробуждения
+
+d1::SpscRing<d1::FeedbackSample, SERVO_RING_SIZE> servo_ring;
+std::atomic<bool> sender_sleeping{false};
+std::mutex sender_mutex;
+std::condition_variable sender_cv;
+
+// Канал разделяемой памяти для клиентов на этом же хосте. Поток команд ждёт
+// пробуждения от клиента; без него (не Linux) опрашивает кольцо раз в 1 мс.
+constexpr int SHM_POLL_INTERVAL_MS = 1;
+constexpr int SHM_HEARTBEAT_INTERVAL_MS = 100;   // Клиенты считают relay мёртвым через 1 с
+d1::ShmChannel shm_channel;
+std::atomic<bool> shm_ready{false};
+
+// SIGINT/SIGTERM: обработчик только запоминает сигнал и будит main через
+// pipe — сегмент удаляется в main (shm_unlink не async-signal-safe)
+volatile std::sig_atomic_t termination_signal = 0;
+int termination_pipe[2] = {-1, -1};
+
+// ==================== Подписчики feedback ====================
+//
+// Клиенты регистрируются управляющим кадром Subscribe на порту команд,
+// указывая формат, желаемую частоту и порт приёма, и продлевают аренду
+// повторной подпиской. Клиент по умолчанию 127.0.0.1:8889 (JSON) постоянный —
+// для старых GUI; после истечения аренды он возвращается к настройкам по умолчанию.
+// Подписка принимается только с loopback и с адресов --peer, и feedback идёт
+// на адрес отправителя: чужой хост не может направить поток на третью сторону.
+
+constexpr int MAX_CLIENTS = 8;
+constexpr uint64_t CLIENT_LEASE_NS = 5000000000ULL;  // 5 секунд без продления
+
+struct FeedbackClient {
+    struct sockaddr_in addr;
+    d1::FeedbackFormat format = d1::FeedbackFormat::Json;
+    uint64_t minIntervalNs = 0;
+    uint64_t lastSentNs = 0;
+    uint64_t leaseExpiryNs = 0;
+    bool active = false;
+    bool permanent = false;
+};
+
+std::mutex clients_mutex;
+FeedbackClient clients[MAX_CLIENTS];
+
+// Адреса --peer (сетевой порядок байт); заполняется в main() до запуска потоков
+std::vector<in_addr_t> allowed_peers;
+
+bool SubscriberAllowed(const struct sockaddr_in& from) {
+    if ((ntohl(from.sin_addr.s_addr) >> 24) == 127) {
+        return true;
+    }
+    return std::find(allowed_peers.begin(), allowed_peers.end(), from.sin_addr.s_addr) != allowed_peers.end();
+}
+
+bool SameEndpoint(const struct sockaddr_in& a, const struct sockaddr_in& b) {
+    return a.sin_addr.s_addr == b.sin_addr.s_addr && a.sin_port == b.sin_port;
+}
+
+std::string EndpointString(const struct sockaddr_in& addr) {
+    char ip[INET_ADDRSTRLEN] = {0};
+    inet_ntop(AF_INET, &addr.sin_addr, ip, sizeof(ip));
+    return std::string(ip) + ":" + std::to_string(ntohs(addr.sin_port));
+}
+
+void ResetClientToDefault(FeedbackClient& client) {
+    client.format = d1::FeedbackFormat::Json;
+    client.minIntervalNs = 0;
+    client.leaseExpiryNs = 0;
+}
 
 void InitGuiSender() {
     gui_sock = socket(AF_INET, SOCK_DGRAM, 0);
-    gui_addr.sin_family = AF_INET;
-    gui_addr.sin_port = htons(UDP_FEEDBACK_PORT);
-    gui_addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+
+    FeedbackClient& legacy = clients[0];
+    std::memset(&legacy.addr, 0, sizeof(legacy.addr));
+    legacy.addr.sin_family = AF_INET;
+    legacy.addr.sin_port = htons(UDP_FEEDBACK_PORT);
+    legacy.addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    ResetClientToDefault(legacy);
+    legacy.active = true;
+    legacy.permanent = true;
 }
 
-// Отправка данных в GUI
-void SendToGui() {
-    std::ostringstream json;
-    json << std::fixed << std::setprecision(4);
-    json << "{\"seq\":1,\"address\":1,\"funcode\":4,\"data\":{";
-    json << "\"power_status\":" << power_status.load() << ",";
-    json << "\"error_status\":" << error_status.load() << ",";
-    for (int i = 0; i < 7; i++) {
-        json << "\"angle" << i << "\":" << servo_angles[i].load();
-        if (i < 6) json << ",";
-    }
-    json << "}}";
-    
-    std::string data = json.str();
-    sendto(gui_sock, data.c_str(), data.length(), 0, (struct sockaddr*)&gui_addr, sizeof(gui_addr));
+// Вызывается из потока приёма команд
+void HandleSubscription(const d1::ControlFrame& ctrl, const struct sockaddr_in& from) {
+    if (!SubscriberAllowed(from)) {
+        D1_LOG_WARN(LOG_SUB, "Подписка с %s отклонена (адрес не loopback и не --peer)", EndpointString(from).c_str());
+        return;
+    }
+
+    struct sockaddr_in addr = from;
+    if (ctrl.type == d1::ControlType::Hello) {
+        addr.sin_port = htons(UDP_FEEDBACK_PORT);
+    } else if (ctrl.port != 0) {
+        addr.sin_port = htons(ctrl.port);
+    }
+
+    std::lock_guard<std::mutex> lock(clients_mutex);
+
+    FeedbackClient* client = nullptr;
+    FeedbackClient* freeSlot = nullptr;
+    for (FeedbackClient& c : clients) {
+        if (c.active && SameEndpoint(c.addr, addr)) {
+            client = &c;
+            break;
+        }
+        if (!c.active && !freeSlot) {
+            freeSlot = &c;
+        }
+    }
+
+    if (ctrl.type == d1::ControlType::Unsubscribe) {
+        if (client) {
+            if (client->permanent) {
+                ResetClientToDefault(*client);
+            } else {
+                client->active = false;
+            }
+            D1_LOG_INFO(LOG_SUB, "Отписка %s", EndpointString(addr).c_str());
+        }
+        return;
+    }
+
+    bool isNew = client == nullptr;
+    if (isNew) {
+        if (!freeSlot) {
+            D1_LOG_WARN(LOG_SUB, "Нет свободных мест для %s", EndpointString(addr).c_str());
+            return;
+        }
+        client = freeSlot;
+        client->addr = addr;
+        client->lastSentNs = 0;
+        client->permanent = false;
+        client->active = true;
+    }
+
+    bool binary = ctrl.format == d1::FeedbackFormat::Binary;
+    bool changed = isNew || client->format != ctrl.format
+                || client->minIntervalNs != (ctrl.rateHz ? 1000000000ULL / ctrl.rateHz : 0);
+    client->format = binary ? d1::FeedbackFormat::Binary : d1::FeedbackFormat::Json;
+    client->minIntervalNs = ctrl.rateHz ? 1000000000ULL / ctrl.rateHz : 0;
+    client->leaseExpiryNs = d1::monotonicNs() + CLIENT_LEASE_NS;
+
+    if (changed) {
+        D1_LOG_INFO(LOG_SUB, "%s формат=%s частота=%s", EndpointString(addr).c_str(),
+                    binary ? "binary" : "json",
+                    ctrl.rateHz ? (std::to_string(ctrl.rateHz) + " Гц").c_str() : "полная");
+    }
 }
 
-// Обработчик углов серво (PubServoInfo_)
-void ServoHandler(const void* message) {
-    const unitree_arm::msg::dds_::PubServoInfo_* msg = 
-        (const unitree_arm::msg::dds_::PubServoInfo_*)message;
-    
-    servo_angles[0] = msg->servo0_data_();
-    servo_angles[1] = msg->servo1_data_();
-    servo_angles[2] = msg->servo2_data_();
-    servo_angles[3] = msg->servo3_data_();
-    servo_angles[4] = msg->servo4_data_();
-    servo_angles[5] = msg->servo5_data_();
-    servo_angles[6] = msg->servo6_data_();
-    
-    // ИСПРАВЛЕНИЕ: Если получаем данные об углах, считаем что связь есть
-    // и моторы активны (power_status не всегда приходит в feedback)
-    power_status = 1;
-    
-    // Логируем каждые 50 пакетов для диагностики
-    static int pkt_count = 0;
-    if (++pkt_count % 50 == 0) {
-        std::cout << "[SERVO] pkt=" << pkt_count 
-                  << " J0=" << servo_angles[0].load() 
-                  << " J1=" << servo_angles[1].load() << std::endl;
+// Сериализация выборки в заданный формат
+size_t SerializeSample(const d1::FeedbackSample& sample, d1::FeedbackFormat format, uint8_t* out) {
+    if (format == d1::FeedbackFormat::Binary) {
+        return d1::encodeFeedbackFrame(sample, out);
     }
-    
-    // Отправляем обновление в GUI
-    SendToGui();
+
+    int len = snprintf(reinterpret_cast<char*>(out), JSON_FRAME_MAX,
+                       "{\"seq\":%u,\"address\":1,\"funcode\":4,"
+                       "\"t_dds\":%llu,\"t_tx\":%llu,\"data\":{"
+                       "\"power_status\":%d,\"error_status\":%d,"
+                       "\"angle0\":%.4f,\"angle1\":%.4f,\"angle2\":%.4f,\"angle3\":%.4f,"
+                       "\"angle4\":%.4f,\"angle5\":%.4f,\"angle6\":%.4f}}",
+                       sample.seq,
+                       static_cast<unsigned long long>(sample.timestampNs),
+                       static_cast<unsigned long long>(sample.txTimestampNs),
+                       sample.powerStatus, sample.errorStatus,
+                       sample.angles[0], sample.angles[1], sample.angles[2], sample.angles[3],
+                       sample.angles[4], sample.angles[5], sample.angles[6]);
+    return len > 0 ? std::min(static_cast<size_t>(len), JSON_FRAME_MAX - 1) : 0;
 }
 
-// Обработчик статуса (ArmString_)
-void FeedbackHandler(const void* message) {
-    const unitree_arm::msg::dds_::ArmString_* msg = 
-        (const unitree_arm::msg::dds_::ArmString_*)message;
-    std::string data = msg->data_();
-    
-    // НЕ парсим power_status здесь — он управляется только в ServoHandler
-    // на основе получения данных об углах
-    
-    // Парсим только error_status
-    size_t pos = data.find("\"error_status\":");
-    if (pos != std::string::npos) {
-        pos += 15;
-        int status = 0;
-        while (pos < data.size() && (data[pos] == ' ' || data[pos] == '\t')) pos++;
-        while (pos < data.size() && data[pos] >= '0' && data[pos] <= '9') {
-            status = status * 10 + (data[pos] - '0');
-            pos++;
+// Рассылка пачки выборок всем подписчикам одним системным вызовом.
+// Каждая выборка сериализуется не более одного раза на формат и получает
+// метку времени отправки.
+void SendBatchToClients(d1::FeedbackSample* samples, size_t count) {
+    constexpr size_t NUM_FORMATS = 2;
+    constexpr size_t MAX_MESSAGES = SENDER_BATCH * MAX_CLIENTS;
+
+    static uint8_t frames[SENDER_BATCH][NUM_FORMATS][JSON_FRAME_MAX];
+    static size_t sizes[SENDER_BATCH][NUM_FORMATS];
+    static struct iovec iov[MAX_MESSAGES];
+    static struct sockaddr_in dest[MAX_MESSAGES];
+    size_t messages = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(clients_mutex);
+        uint64_t now = d1::monotonicNs();
+
+        for (FeedbackClient& client : clients) {
+            if (client.active && client.leaseExpiryNs != 0 && now > client.leaseExpiryNs) {
+                D1_LOG_INFO(LOG_SUB, "Аренда истекла: %s", EndpointString(client.addr).c_str());
+                if (client.permanent) {
+                    ResetClientToDefault(client);
+                } else {
+                    client.active = false;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            samples[i].txTimestampNs = now;
+            sizes[i][0] = 0;
+            sizes[i][1] = 0;
+            for (FeedbackClient& client : clients) {
+                if (!client.active) continue;
+                if (client.minIntervalNs && samples[i].timestampNs - client.lastSentNs < client.minIntervalNs) {
+                    continue;
+                }
+                size_t f = static_cast<size_t>(client.format) % NUM_FORMATS;
+                if (sizes[i][f] == 0) {
+                    sizes[i][f] = SerializeSample(samples[i], client.format, frames[i][f]);
+                }
+                client.lastSentNs = samples[i].timestampNs;
+                iov[messages].iov_base = frames[i][f];
+                iov[messages].iov_len = sizes[i][f];
+                dest[messages] = client.addr;
+                messages++;
+            }
+        }
+    }
+
+    if (messages == 0) {
+        return;
+    }
+
+#ifdef __linux__
+    static struct mmsghdr msgs[MAX_MESSAGES];
+    std::memset(msgs, 0, sizeof(struct mmsghdr) * messages);
+    for (size_t i = 0; i < messages; ++i) {
+        msgs[i].msg_hdr.msg_name = &dest[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(dest[i]);
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    size_t sent = 0;
+    while (sent < messages) {
+        int n = sendmmsg(gui_sock, msgs + sent, static_cast<unsigned int>(messages - sent), 0);
+        if (n <= 0) {
+            // Недоступный клиент не должен блокировать остальных
+            sent++;
+            continue;
+        }
+        sent += static_cast<size_t>(n);
+    }
+#else
+    for (size_t i = 0; i < messages; ++i) {
+        sendto(gui_sock, iov[i].iov_base, iov[i].iov_len, 0, (struct sockaddr*)&dest[i], sizeof(dest[i]));
+    }
+#endif
+}
+
+// Поток отправки feedback: забирает выборки из кольца, сериализует и шлёт
+void FeedbackSenderThread() {
+    ApplyThreadPolicy(d1::rt::ThreadRole::FeedbackSender);
+
+    d1::FeedbackSample batch[SENDER_BATCH];
+    uint64_t pkt_count = 0;
+    uint64_t last_overruns = 0;
+
+    while (true) {
+        size_t count = servo_ring.popBatch(batch, SENDER_BATCH);
+        if (count == 0) {
+            std::unique_lock<std::mutex> lock(sender_mutex);
+            sender_sleeping = true;
+            sender_cv.wait_for(lock, std::chrono::milliseconds(SENDER_IDLE_WAIT_MS),
+                               [] { return !servo_ring.empty(); });
+            sender_sleeping = false;
+            continue;
+        }
+
+        // Локального клиента будим отсюда, а не из callback DDS
+        if (shm_ready.load(std::memory_order_acquire)) {
+            shm_channel.wakeWaiter();
+        }
+
+        SendBatchToClients(batch, count);
+
+        // Логируем каждые 50 пакетов для диагностики
+        uint64_t prev = pkt_count;
+        pkt_count += count;
+        if (pkt_count / 50 != prev / 50) {
+            const d1::FeedbackSample& last = batch[count - 1];
+            D1_LOG_INFO(LOG_SERVO, "pkt=%llu J0=%g J1=%g", static_cast<unsigned long long>(pkt_count),
+                        last.angles[0], last.angles[1]);
         }
-        if (error_status != status) {
-            error_status = status;
-            std::cout << "[ERROR] error_status=" << status << std::endl;
+
+        uint64_t overruns = servo_ring.overruns();
+        if (overruns != last_overruns) {
+            D1_LOG_WARN(LOG_SERVO, "переполнение кольца: потеряно %llu выборок (всего %llu)",
+                        static_cast<unsigned long long>(overruns - last_overruns),
+                        static_cast<unsigned long long>(overruns));
+            last_overruns = overruns;
         }
     }
+}
+
+// Обработчик выборок ядра DDS.
+// Выполняется в потоке DDS: только кладёт выборку в кольцо, без сокетов и вывода.
+void OnServoSample(const d1::FeedbackSample& sample) {
+    // Снимок для локальных клиентов: seqlock, без системных вызовов
+    // (ждущего клиента будит поток отправки)
+    if (shm_ready.load(std::memory_order_acquire)) {
+        shm_channel.publish(sample);
+    }
     
-    // НЕ отправляем в GUI — только ServoHandler отправляет данные
+    servo_ring.tryPush(sample);
+    if (sender_sleeping.load()) {
+        sender_cv.notify_one();
+    }
 }
 
 // Поток приема команд от GUI
-void UdpServerThread(ChannelPublisher<unitree_arm::msg::dds_::ArmString_>* publisher) {
+void UdpServerThread() {
+    ApplyThreadPolicy(d1::rt::ThreadRole::CommandRx);
+
     int sockfd;
     char buffer[4096];
     struct sockaddr_in servaddr, cliaddr;
@@ -140,67 +398,190 @@ void UdpServerThread(ChannelPublisher<unitree_arm::msg::dds_::ArmString_>* publi
 
     std::cout << "[UDP] Слушаю команды на порту " << UDP_CMD_PORT << std::endl;
 
-    // Throttling: минимальная задержка между командами
-    auto last_cmd_time = std::chrono::steady_clock::now();
-    constexpr int MIN_CMD_INTERVAL_MS = 50;  // Минимум 50мс между командами
-
     while (true) {
         socklen_t len = sizeof(cliaddr);
-        int n = recvfrom(sockfd, (char *)buffer, 4096, 0, (struct sockaddr *)&cliaddr, &len);
+        int n = recvfrom(sockfd, (char *)buffer, sizeof(buffer) - 1, 0, (struct sockaddr *)&cliaddr, &len);
         if (n > 0) {
-            buffer[n] = '\0';
-            std::string json_cmd(buffer);
-
-            // Throttling: ждём минимальный интервал между командами
-            auto now = std::chrono::steady_clock::now();
-            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_cmd_time).count();
-            if (elapsed < MIN_CMD_INTERVAL_MS) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(MIN_CMD_INTERVAL_MS - elapsed));
+            // Управляющие кадры обрабатываем сами и не пересылаем в DDS
+            d1::ControlFrame ctrl;
+            if (d1::decodeControlFrame(reinterpret_cast<const uint8_t*>(buffer), n, ctrl)) {
+                HandleSubscription(ctrl, cliaddr);
+                continue;
             }
-            last_cmd_time = std::chrono::steady_clock::now();
 
-            // Отправляем в DDS (роботу)
-            unitree_arm::msg::dds_::ArmString_ msg;
-            msg.data_() = json_cmd;
-            publisher->Write(msg);
-            
-            std::cout << "[TX] " << json_cmd.substr(0, 80) << "..." << std::endl;
+            // Команда уходит в очередь, публикация — в отдельном потоке
+            relay_core->submitCommand(std::string(buffer, n));
         }
     }
 }
 
-int main() {
+// Поток приёма команд из разделяемой памяти. Заодно обновляет метку жизни,
+// по которой клиенты решают, можно ли пользоваться каналом.
+void ShmCommandThread() {
+    ApplyThreadPolicy(d1::rt::ThreadRole::ShmCommands);
+
+    d1::ShmCommand command;
+    uint64_t last_overruns = 0;
+    struct pollfd wake;
+    wake.fd = shm_channel.commandWakeFd();
+    wake.events = POLLIN;
+
+    while (true) {
+        shm_channel.heartbeat();
+        // Пробуждения вычитываются до разбора кольца: команда, положенная
+        // после этого, пришлёт новое и разбудит следующий poll()
+        if (wake.fd >= 0) {
+            d1::ShmChannel::drainWakeup(wake.fd);
+        }
+        while (shm_channel.popCommand(command)) {
+            relay_core->submitCommand(std::string(command.data, std::min<size_t>(command.length, d1::SHM_COMMAND_MAX)));
+        }
+
+        uint64_t overruns = shm_channel.commandOverruns();
+        if (overruns != last_overruns) {
+            D1_LOG_WARN(LOG_SHM, "переполнение кольца команд: потеряно %llu",
+                        static_cast<unsigned long long>(overruns - last_overruns));
+            last_overruns = overruns;
+        }
+
+        if (wake.fd >= 0) {
+            poll(&wake, 1, SHM_HEARTBEAT_INTERVAL_MS);
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(SHM_POLL_INTERVAL_MS));
+        }
+    }
+}
+
+void HandleTerminationSignal(int sig) {
+    termination_signal = sig;
+    char byte = 0;
+    ssize_t written = write(termination_pipe[1], &byte, sizeof(byte));
+    (void)written;
+}
+
+std::string Usage() {
+    return d1::rt::usage()
+         + "  --peer=IP           принимать подписки на feedback с этого адреса (кроме loopback)\n";
+}
+
+int main(int argc, char** argv) {
+    // --peer разбираем здесь, остальное — параметры режима реального времени
+    std::vector<char*> rtArgs{argv[0]};
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--peer=", 7) == 0) {
+            struct in_addr peer;
+            if (inet_pton(AF_INET, argv[i] + 7, &peer) != 1) {
+                std::cerr << "неверный адрес: " << argv[i] << std::endl << Usage();
+                return 1;
+            }
+            allowed_peers.push_back(peer.s_addr);
+        } else {
+            rtArgs.push_back(argv[i]);
+        }
+    }
+
+    std::string argError;
+    if (!d1::rt::parseArgs(static_cast<int>(rtArgs.size()), rtArgs.data(), rt_config, argError)) {
+        std::cerr << argError << std::endl << Usage();
+        return 1;
+    }
+
     std::cout << "============================================" << std::endl;
     std::cout << "  UNITREE D1 - UDP BRIDGE (v4 с углами)" << std::endl;
     std::cout << "============================================" << std::endl;
 
-    InitGuiSender();
+    d1::log::Logger::instance().start();
 
-    // Инициализация Unitree SDK
-    ChannelFactory::Instance()->Init(0);
+    if (rt_config.enabled && rt_config.lockMemory) {
+        std::string error;
+        if (d1::rt::lockProcessMemory(error)) {
+            std::cout << "[RT] Память процесса заблокирована (mlockall)" << std::endl;
+        } else {
+            std::cout << "[RT] " << error << std::endl;
+        }
+    }
+
+    // Самотест: цикл с периодом jitterPeriodUs в потоке с политикой командного пути
+    if (rt_config.jitterTestSeconds > 0) {
+        std::cout << "[RT] Самотест джиттера: " << rt_config.jitterTestSeconds << " с"
+                  << (rt_config.enabled ? " (realtime)" : " (обычный приоритет)") << std::endl;
+        // Отдельный поток: имя, SCHED_FIFO и привязка к ядрам не остаются на главном
+        d1::rt::JitterStats stats;
+        std::thread jitter_thread([&stats]() {
+            ApplyThreadPolicy(d1::rt::ThreadRole::CommandRx);
+            stats = d1::rt::runJitterTest(rt_config.jitterPeriodUs, rt_config.jitterTestSeconds);
+        });
+        jitter_thread.join();
+        d1::log::Logger::instance().flush();
+        std::cout << d1::rt::formatJitter(stats, rt_config.jitterPeriodUs) << std::endl;
+        return 0;
+    }
 
-    // Publisher для команд роботу
-    ChannelPublisher<unitree_arm::msg::dds_::ArmString_> publisher(CMD_TOPIC);
-    publisher.InitChannel();
-    std::cout << "[DDS] Publisher: " << CMD_TOPIC << std::endl;
+    InitGuiSender();
 
-    // Subscriber для статуса
-    ChannelSubscriber<unitree_arm::msg::dds_::ArmString_> feedbackSub(FEEDBACK_TOPIC);
-    feedbackSub.InitChannel(FeedbackHandler);
-    std::cout << "[DDS] Subscriber: " << FEEDBACK_TOPIC << std::endl;
+    if (shm_channel.create()) {
+        shm_ready = true;
+        if (pipe(termination_pipe) == 0) {
+            std::signal(SIGINT, HandleTerminationSignal);
+            std::signal(SIGTERM, HandleTerminationSignal);
+        }
+        std::cout << "[SHM] Канал разделяемой памяти: " << d1::SHM_NAME << std::endl;
+    } else {
+        std::cout << "[SHM] Не удалось создать " << d1::SHM_NAME << ": " << std::strerror(errno)
+                  << " — клиенты будут использовать UDP" << std::endl;
+    }
 
-    // Subscriber для углов суставов
-    ChannelSubscriber<unitree_arm::msg::dds_::PubServoInfo_> servoSub(SERVO_TOPIC);
-    servoSub.InitChannel(ServoHandler);
-    std::cout << "[DDS] Subscriber: " << SERVO_TOPIC << std::endl;
+    // Поток отправки feedback в GUI
+    std::thread sender_thread(FeedbackSenderThread);
+    sender_thread.detach();
+
+    // Ядро DDS: publisher команд, подписчики статуса и углов, поток публикации
+    d1::RelayCore core(OnServoSample);
+    core.setThreadHook([](d1::RelayThread thread) {
+        ApplyThreadPolicy(thread == d1::RelayThread::Publisher ? d1::rt::ThreadRole::Publisher
+                                                               : d1::rt::ThreadRole::DdsCallback);
+    });
+    relay_core = &core;
+    if (!core.start(0)) {
+        d1::log::Logger::instance().flush();
+        std::cerr << "[DDS] Не удалось инициализировать DDS (см. журнал выше)" << std::endl;
+        return 1;
+    }
 
     // Поток для приёма команд от GUI
-    std::thread udp_thread(UdpServerThread, &publisher);
+    std::thread udp_thread(UdpServerThread);
+
+    if (shm_ready) {
+        std::thread shm_thread(ShmCommandThread);
+        shm_thread.detach();
+    }
 
-    std::cout << "[UDP] Отправка данных в GUI на порт " << UDP_FEEDBACK_PORT << std::endl;
+    std::cout << "[UDP] Feedback: 127.0.0.1:" << UDP_FEEDBACK_PORT
+              << " + подписчики (до " << MAX_CLIENTS << ", loopback";
+    for (in_addr_t peer : allowed_peers) {
+        struct in_addr addr;
+        addr.s_addr = peer;
+        std::cout << ", " << inet_ntoa(addr);
+    }
+    std::cout << ")" << std::endl;
     std::cout << "============================================" << std::endl;
     std::cout << "Ожидаю данных от робота..." << std::endl;
 
-    udp_thread.join();
+    if (termination_pipe[0] < 0) {
+        udp_thread.join();
+        return 0;
+    }
+
+    // Ctrl+C: сегмент удаляется, чтобы новые клиенты сразу выбирали UDP.
+    // Отображение остаётся — потоки relay дорабатывают до выхода процесса.
+    udp_thread.detach();
+    char byte;
+    while (read(termination_pipe[0], &byte, sizeof(byte)) < 0 && errno == EINTR) {
+    }
+    shm_unlink(d1::SHM_NAME);
+    d1::log::Logger::instance().flush();
+    const int sig = termination_signal ? termination_signal : SIGTERM;
+    std::signal(sig, SIG_DFL);
+    std::raise(sig);
     return 0;
 }
\ No newline at end of file